@@ -0,0 +1,195 @@
+/* Test program for the bitsliced batch kernels */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "tetra_common.h"
+#include <lower_mac/crc_simple.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_rm3014.h>
+#include <lower_mac/tetra_batch.h>
+#include "testcheck.h"
+
+/* not a multiple of the lane count on purpose */
+#define NUM_BLK		150
+#define BENCH_BLK	4096
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint8_t **alloc_blocks(unsigned int num, unsigned int bits)
+{
+	uint8_t **blk = calloc(num, sizeof(*blk));
+	unsigned int n, i;
+
+	for (n = 0; n < num; n++) {
+		blk[n] = malloc(bits);
+		for (i = 0; i < bits; i++)
+			blk[n][i] = rand() & 1;
+	}
+	return blk;
+}
+
+static void free_blocks(uint8_t **blk, unsigned int num)
+{
+	unsigned int n;
+
+	for (n = 0; n < num; n++)
+		free(blk[n]);
+	free(blk);
+}
+
+static void test_scramb(enum tp_sap_data_type type)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+	uint8_t **blk = alloc_blocks(NUM_BLK, tbp->type345_bits);
+	uint8_t *ref[NUM_BLK];
+	uint32_t init[NUM_BLK];
+	char name[64];
+	int n, ok = 1;
+
+	for (n = 0; n < NUM_BLK; n++)
+		init[n] = tetra_scramb_get_init(rand(), rand(), rand());
+
+	for (n = 0; n < NUM_BLK; n++)
+		ref[n] = malloc(tbp->type345_bits);
+	for (n = 0; n < NUM_BLK; n++) {
+		memcpy(ref[n], blk[n], tbp->type345_bits);
+		tetra_scramb_bits(init[n], ref[n], tbp->type345_bits);
+	}
+
+	tetra_batch_scramb(tbp, blk, init, NUM_BLK);
+	for (n = 0; n < NUM_BLK; n++) {
+		if (memcmp(blk[n], ref[n], tbp->type345_bits))
+			ok = 0;
+		free(ref[n]);
+	}
+	free_blocks(blk, NUM_BLK);
+
+	snprintf(name, sizeof(name), "tetra_batch_scramb(%s)", tbp->name);
+	check(ok, name);
+}
+
+static void test_crc(enum tp_sap_data_type type)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+	unsigned int bits = tbp->type1_bits + 16;
+	uint8_t **blk = alloc_blocks(NUM_BLK, bits);
+	uint16_t crc[NUM_BLK];
+	char name[64];
+	int n, ok = 1;
+
+	tetra_batch_crc16(tbp, blk, NUM_BLK, crc);
+	for (n = 0; n < NUM_BLK; n++) {
+		if (crc[n] != crc16_ccitt_bits(blk[n], bits))
+			ok = 0;
+	}
+	free_blocks(blk, NUM_BLK);
+
+	snprintf(name, sizeof(name), "tetra_batch_crc16(%s)", tbp->name);
+	check(ok, name);
+}
+
+static void test_rm3014(void)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(TPSAP_T_BBK);
+	uint8_t **type1 = alloc_blocks(NUM_BLK, 14);
+	uint8_t **type2 = alloc_blocks(NUM_BLK, 30);
+	int n, i, ok = 1;
+
+	tetra_batch_rm3014(tbp, type1, type2, NUM_BLK);
+	for (n = 0; n < NUM_BLK; n++) {
+		uint16_t in = bits_to_uint(type1[n], 14);
+		uint32_t out = tetra_rm3014_compute(in);
+		for (i = 0; i < 30; i++) {
+			if (type2[n][i] != ((out >> (29-i)) & 1))
+				ok = 0;
+		}
+	}
+	free_blocks(type1, NUM_BLK);
+	free_blocks(type2, NUM_BLK);
+
+	check(ok, "tetra_batch_rm3014(BBK)");
+}
+
+static void bench(void)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(TPSAP_T_SCH_F);
+	uint8_t **blk = alloc_blocks(BENCH_BLK, tbp->type345_bits);
+	uint16_t crc[BENCH_BLK];
+	uint32_t init[BENCH_BLK];
+	double t0, t1;
+	int n;
+
+	for (n = 0; n < BENCH_BLK; n++)
+		init[n] = tetra_scramb_get_init(rand(), rand(), rand());
+
+	t0 = now_ns();
+	for (n = 0; n < BENCH_BLK; n++)
+		tetra_scramb_bits(init[n], blk[n], tbp->type345_bits);
+	t1 = now_ns();
+	printf("tetra_scramb_bits(SCH/F):\t%8.1f ns/block\n", (t1-t0)/BENCH_BLK);
+
+	t0 = now_ns();
+	tetra_batch_scramb(tbp, blk, init, BENCH_BLK);
+	t1 = now_ns();
+	printf("tetra_batch_scramb(SCH/F):\t%8.1f ns/block\n", (t1-t0)/BENCH_BLK);
+
+	t0 = now_ns();
+	for (n = 0; n < BENCH_BLK; n++)
+		crc[n] = crc16_ccitt_bits(blk[n], tbp->type1_bits+16);
+	t1 = now_ns();
+	printf("crc16_ccitt_bits(SCH/F):\t%8.1f ns/block\n", (t1-t0)/BENCH_BLK);
+
+	t0 = now_ns();
+	tetra_batch_crc16(tbp, blk, BENCH_BLK, crc);
+	t1 = now_ns();
+	printf("tetra_batch_crc16(SCH/F):\t%8.1f ns/block\n", (t1-t0)/BENCH_BLK);
+
+	free_blocks(blk, BENCH_BLK);
+}
+
+int main(int argc, char **argv)
+{
+	srand(time(NULL));
+
+	tetra_rm3014_init();
+
+	test_scramb(TPSAP_T_SB1);
+	test_scramb(TPSAP_T_NDB);
+	test_scramb(TPSAP_T_SCH_F);
+	test_crc(TPSAP_T_SB1);
+	test_crc(TPSAP_T_NDB);
+	test_crc(TPSAP_T_SCH_F);
+	test_rm3014();
+
+	if (argc > 1 && !strcmp(argv[1], "-b"))
+		bench();
+
+	check_exit();
+}
@@ -0,0 +1,249 @@
+/* Test program for the polyphase channelizer */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <math.h>
+#include <complex.h>
+
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/utils.h>
+
+#include "tetra_kernel.h"
+#include <phy/tetra_demod.h>
+#include <phy/tetra_chan.h>
+#include "testcheck.h"
+
+/* 800 kS/s */
+#define NUM_CHAN	64
+#define RATE		(NUM_CHAN * TETRA_CHAN_SPACING)
+#define NUM_SYM		1500
+#define NUM_SAMPLES	(NUM_SYM * (RATE / TETRA_SYM_RATE))
+#define MAX_OUT		(NUM_SYM * TETRA_DEMOD_SPS + 1000)
+/* symbols the demodulator gets to settle */
+#define SETTLE		300
+
+void *tetra_tall_ctx;
+
+struct carrier {
+	int32_t offset_hz;
+	float amplitude;
+	uint8_t bits[2*NUM_SYM];
+	float complex sym[NUM_SYM];
+	/* channelizer output */
+	float complex out[MAX_OUT];
+	unsigned int num_out;
+};
+
+static struct carrier carriers[4] = {
+	{ .offset_hz = 100000, .amplitude = 1 },
+	/* off the 25 kHz raster by 12.5 and 6.25 kHz */
+	{ .offset_hz = -187500, .amplitude = 1 },
+	{ .offset_hz = 256250, .amplitude = 0.5 },
+	/* adjacent to the first one and 10 dB stronger */
+	{ .offset_hz = 125000, .amplitude = 3.16 },
+};
+#define NUM_DECODED	3
+
+static float complex wide[NUM_SAMPLES];
+
+static float gauss(void)
+{
+	float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+	float u2 = rand() / (RAND_MAX + 1.0f);
+
+	return sqrtf(-2 * logf(u1)) * cosf(2 * M_PI * u2);
+}
+
+static void chan_cb(unsigned int idx, const float complex *samples,
+		    unsigned int n, void *priv)
+{
+	struct carrier *c = &carriers[idx];
+
+	if (c->num_out + n > MAX_OUT)
+		n = MAX_OUT - c->num_out;
+	memcpy(c->out + c->num_out, samples, n * sizeof(*samples));
+	c->num_out += n;
+}
+
+/* all carriers, pi/4-DQPSK modulated with random bits, plus noise */
+static void modulate(void)
+{
+	static const int phase_step[4] = { 1, 3, -1, -3 };
+	unsigned int i, j, n;
+
+	for (j = 0; j < ARRAY_SIZE(carriers); j++) {
+		struct carrier *c = &carriers[j];
+		int phase = 0;
+
+		for (i = 0; i < NUM_SYM; i++) {
+			c->bits[2*i] = rand() & 1;
+			c->bits[2*i+1] = rand() & 1;
+			phase = (phase + phase_step[c->bits[2*i] * 2 + c->bits[2*i+1]]) & 7;
+			c->sym[i] = c->amplitude * cexpf(I * phase * M_PI / 4);
+		}
+	}
+
+	for (n = 0; n < NUM_SAMPLES; n++) {
+		float t = (float) n * TETRA_SYM_RATE / RATE;
+		float complex v = 0;
+
+		for (j = 0; j < ARRAY_SIZE(carriers); j++) {
+			struct carrier *c = &carriers[j];
+			float complex s = 0;
+			int m;
+
+			for (m = floorf(t) - 6; m <= (int) floorf(t) + 6; m++) {
+				if (m >= 0 && m < NUM_SYM)
+					s += c->sym[m] * tetra_rrc(t - m, TETRA_RRC_ALPHA);
+			}
+			v += s * cexpf(I * 2 * M_PI * remainderf((float) c->offset_hz * n / RATE, 1));
+		}
+		wide[n] = v + 0.02f * (gauss() + I * gauss());
+	}
+}
+
+static unsigned int bit_errors(const struct carrier *c, const uint8_t *rx_bits,
+			       unsigned int num_sym)
+{
+	unsigned int best = ~0U;
+	int offs;
+
+	for (offs = -40; offs <= 40; offs++) {
+		unsigned int i, err = 0;
+
+		for (i = SETTLE; i < num_sym - 40; i++) {
+			int j = i + offs;
+
+			if (j < 1 || j >= NUM_SYM) {
+				err += 2;
+				continue;
+			}
+			err += rx_bits[2*i] != c->bits[2*j];
+			err += rx_bits[2*i+1] != c->bits[2*j+1];
+		}
+		if (err < best)
+			best = err;
+	}
+
+	return best;
+}
+
+static void test_carriers(void)
+{
+	static float soft[TETRA_DEMOD_MAX_SYM(MAX_OUT)];
+	static uint8_t bits[2*TETRA_DEMOD_MAX_SYM(MAX_OUT)];
+	struct tetra_chan *ch;
+	unsigned int i, pos;
+
+	modulate();
+
+	ch = tetra_chan_alloc(NULL, NUM_CHAN, chan_cb, NULL);
+	for (i = 0; i < ARRAY_SIZE(carriers); i++)
+		tetra_chan_add(ch, carriers[i].offset_hz);
+
+	/* in uneven pieces */
+	for (pos = 0; pos < NUM_SAMPLES; ) {
+		unsigned int len = 1 + rand() % 9000;
+
+		if (len > NUM_SAMPLES - pos)
+			len = NUM_SAMPLES - pos;
+		tetra_chan_in(ch, wide + pos, len);
+		pos += len;
+	}
+
+	check(ch->stats.samples == NUM_SAMPLES &&
+	      ch->stats.ffts == (NUM_SAMPLES - ch->num_taps) / ch->decim + 1, "FFT count");
+	check(abs((int) carriers[0].num_out -
+		  (int) ((uint64_t) NUM_SAMPLES * TETRA_DEMOD_RATE / RATE)) < 60, "output rate");
+
+	for (i = 0; i < NUM_DECODED; i++) {
+		struct tetra_demod td;
+		unsigned int num_sym;
+		char what[64];
+
+		tetra_demod_init(&td);
+		num_sym = tetra_demod_in(&td, carriers[i].out, carriers[i].num_out, soft);
+		tetra_demod_slice(soft, num_sym, bits);
+		snprintf(what, sizeof(what), "carrier at %d Hz", carriers[i].offset_hz);
+		check(num_sym > SETTLE + 100 && bit_errors(&carriers[i], bits, num_sym) == 0, what);
+	}
+
+	talloc_free(ch);
+}
+
+/* a tone in the middle of one carrier, and how much of it shows in the
+ * others */
+static void test_tone(void)
+{
+	const int32_t offs[] = { 125000, 150000, 175000, -125000 };
+	float power[ARRAY_SIZE(offs)];
+	struct tetra_chan *ch;
+	unsigned int i, n;
+
+	for (n = 0; n < NUM_SAMPLES; n++)
+		wide[n] = cexpf(I * 2 * M_PI * remainderf((float) offs[0] * n / RATE, 1));
+
+	ch = tetra_chan_alloc(NULL, NUM_CHAN, chan_cb, NULL);
+	for (i = 0; i < ARRAY_SIZE(offs); i++) {
+		carriers[i].num_out = 0;
+		tetra_chan_add(ch, offs[i]);
+	}
+	tetra_chan_in(ch, wide, NUM_SAMPLES);
+
+	for (i = 0; i < ARRAY_SIZE(offs); i++) {
+		struct carrier *c = &carriers[i];
+		float sum = 0;
+
+		/* past the filter delays */
+		for (n = 500; n < c->num_out; n++)
+			sum += crealf(c->out[n] * conjf(c->out[n]));
+		power[i] = 10 * log10f(sum / (c->num_out - 500) + 1e-30f);
+	}
+	printf("tone: %.2f dB, adjacent %.1f dB, %.1f dB, image %.1f dB\n",
+	       power[0], power[1], power[2], power[3]);
+	check(fabsf(power[0]) < 0.5f, "tone gain");
+	check(power[1] < -40 && power[2] < -60 && power[3] < -60, "channel isolation");
+
+	talloc_free(ch);
+}
+
+int main(int argc, char **argv)
+{
+	struct tetra_chan *ch;
+
+	srand(42);
+	tetra_kernel_init();
+
+	check(!tetra_chan_alloc(NULL, 100, NULL, NULL) &&
+	      !tetra_chan_alloc(NULL, 4, NULL, NULL), "channel count");
+	ch = tetra_chan_alloc(NULL, NUM_CHAN, NULL, NULL);
+	check(ch && tetra_chan_add(ch, RATE / 2) == -EINVAL &&
+	      tetra_chan_add(ch, -RATE / 2 + 25000) == 0, "carrier range");
+	talloc_free(ch);
+
+	test_carriers();
+	test_tone();
+
+	check_exit();
+}
@@ -38,6 +38,7 @@
 #include <lower_mac/viterbi.h>
 #include <phy/tetra_burst.h>
 #include "testpdu.h"
+#include "tetra_kernel.h"
 
 
 #define swap16(x) ((x)<<8)|((x)>>8)
@@ -45,7 +46,8 @@
 static unsigned int num_crc_err;
 
 /* incoming TP-SAP UNITDATA.ind  from PHY into lower MAC */
-void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits, unsigned int len, void *priv)
+void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits,
+		      const int8_t *soft, unsigned int len, void *priv)
 {
 }
 
@@ -88,8 +90,8 @@ static void decode_schf(const uint8_t *bits)
 int build_ndb_schf()
 {
 	/* input: 268 type-1 bits */
-	uint8_t type2[284];
-	uint8_t master[284*4];
+	uint8_t type2[288];
+	uint8_t master[288*4];
 	uint8_t type3[432];
 	uint8_t type4[432];
 	uint8_t type5[432];
@@ -203,8 +205,8 @@ int build_sb()
 	uint8_t sb_type4[120];
 	uint8_t sb_type5[120];
 
-	uint8_t si_type2[140];
-	uint8_t si_master[140*4];
+	uint8_t si_type2[144];
+	uint8_t si_master[144*4];
 	uint8_t si_type3[216];
 	uint8_t si_type4[216];
 	uint8_t si_type5[216];
@@ -316,6 +318,7 @@ int main(int argc, char **argv)
 		exit(1);
 
 	tetra_rm3014_init();
+	tetra_kernel_init();
 #if 0
 	ret = tetra_rm3014_compute(0x1001);
 	printf("RM3014: 0x%08x\n", ret);
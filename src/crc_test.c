@@ -16,16 +16,182 @@
  *
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <osmocom/core/bits.h>
 
+#include <osmocom/core/msgb.h>
+#include <osmocom/core/talloc.h>
+
 #include "tetra_common.h"
+#include "tetra_llc_pdu.h"
+#include "tetra_mac_pdu.h"
+#include "tetra_mle_pdu.h"
+#include "tetra_filter.h"
+#include "tetra_prim.h"
+#include "tetra_upper_mac.h"
 #include <lower_mac/crc_simple.h>
 
+void *tetra_tall_ctx;
+
+static uint32_t crc32_bitwise(uint32_t crc, const uint8_t *input, int number_bits)
+{
+	int i;
+
+	for (i = 0; i < number_bits; i++) {
+		crc ^= (uint32_t)(input[i] & 1) << 31;
+		crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+	}
+	return crc;
+}
+
+/* CRC-32 of the LLC FCS, and FCS verification of a BL-DATA-FCS PDU */
+static int test_fcs(void)
+{
+	uint8_t bits[8*9], pdu[4+1+200+32];
+	uint32_t crc, fcs;
+	struct tetra_llc_pdu lpp;
+	int i, len, num_err = 0;
+
+	/* the check value of CRC-32/MPEG-2 */
+	osmo_pbit2ubit(bits, (const uint8_t *) "123456789", 8*9);
+	crc = crc32_bits(0xffffffff, bits, 8*9);
+	printf("The CRC-32 is now: 0x%08x\n", crc);
+	if (crc != 0x0376e6e7)
+		num_err++;
+
+	for (len = 0; len <= 200; len++) {
+		for (i = 0; i < len; i++)
+			pdu[5+i] = rand() & 1;
+		if (crc32_bits(0xffffffff, pdu+5, len) !=
+		    crc32_bitwise(0xffffffff, pdu+5, len))
+			num_err++;
+	}
+
+	/* BL-DATA-FCS with N(S), 200 bits TL-SDU and FCS */
+	osmo_pbit2ubit(pdu, (const uint8_t *) "\x50", 4);
+	pdu[4] = 1;
+	fcs = ~crc32_bits(0xffffffff, pdu+5, 200);
+	for (i = 0; i < 32; i++)
+		pdu[5+200+i] = (fcs >> (31 - i)) & 1;
+
+	memset(&lpp, 0, sizeof(lpp));
+	tetra_llc_pdu_parse(&lpp, pdu, sizeof(pdu));
+	printf("BL-DATA-FCS: len=%u fcs=%u valid=%u\n", lpp.tl_sdu_len,
+		lpp.have_fcs, lpp.fcs_valid);
+	if (lpp.tl_sdu_len != 200 || !lpp.have_fcs || !lpp.fcs_valid)
+		num_err++;
+
+	pdu[100] ^= 1;
+	memset(&lpp, 0, sizeof(lpp));
+	tetra_llc_pdu_parse(&lpp, pdu, sizeof(pdu));
+	printf("BL-DATA-FCS corrupted: valid=%u\n", lpp.fcs_valid);
+	if (lpp.fcs_valid)
+		num_err++;
+
+	printf("FCS %s\n", num_err ? "FAILED" : "OK");
+	return num_err;
+}
+
+/* a SCH/F with a MAC-RESOURCE carrying 'llc', and random bits after the
+ * end of the MAC PDU, through the upper MAC */
+static void send_resource(struct tetra_mac_state *tms, const uint8_t *llc,
+			  unsigned int llc_len)
+{
+	struct tetra_tmvsap_prim *ttp;
+	struct tetra_resrc_decoded rsd;
+	uint8_t *bits;
+	unsigned int hdr_len, i;
+
+	ttp = talloc_zero(NULL, struct tetra_tmvsap_prim);
+	ttp->oph.msg = msgb_alloc(412, "crc_test");
+	ttp->oph.sap = TETRA_SAP_TMV;
+	ttp->oph.primitive = PRIM_TMV_UNITDATA;
+	ttp->oph.operation = PRIM_OP_INDICATION;
+	ttp->u.unitdata.lchan = TETRA_LC_SCH_F;
+	ttp->u.unitdata.crc_ok = 1;
+	ttp->oph.msg->l1h = msgb_put(ttp->oph.msg, 268);
+	bits = ttp->oph.msg->l1h;
+
+	memset(&rsd, 0, sizeof(rsd));
+	rsd.addr.type = ADDR_TYPE_SSI;
+	rsd.addr.ssi = 4711;
+	rsd.macpdu_length = 1;
+	hdr_len = macpdu_encode_resource(&rsd, 0, bits);
+	rsd.macpdu_length = (hdr_len + llc_len + 7) / 8;
+	macpdu_encode_resource(&rsd, (hdr_len + llc_len) % 8 != 0, bits);
+	memcpy(bits + hdr_len, llc, llc_len);
+	for (i = hdr_len + llc_len; i < 268; i++)
+		bits[i] = rand() & 1;
+	/* fill bits up to the end of the octet */
+	if ((hdr_len + llc_len) % 8) {
+		bits[hdr_len + llc_len] = 1;
+		for (i = hdr_len + llc_len + 1; i < rsd.macpdu_length * 8; i++)
+			bits[i] = 0;
+	}
+
+	upper_mac_prim_recv(&ttp->oph, tms);
+}
+
+/* FCS PDUs of any length, in a MAC-RESOURCE with or without fill bits */
+static int test_fcs_upper_mac(void)
+{
+	static const enum tllc_pdut_dec types[] = {
+		TLLC_PDUT_DEC_BL_ADATA, TLLC_PDUT_DEC_BL_DATA, TLLC_PDUT_DEC_BL_UDATA,
+	};
+	struct tetra_mac_state tms;
+	struct tetra_filter filter;
+	struct tetra_llc_pdu lpp;
+	uint8_t sdu[160], llc[256];
+	unsigned int t, sdu_len, num = 0, i;
+	int llc_len, num_err = 0;
+
+	memset(&tms, 0, sizeof(tms));
+	tetra_mac_state_init(&tms);
+	/* only to count the TL-SDUs which make it through */
+	memset(&filter, 0, sizeof(filter));
+	tetra_filter_add(&filter, 'p', "CMCE");
+	tms.filter = &filter;
+
+	for (t = 0; t < 3; t++) {
+		for (sdu_len = 8; sdu_len <= sizeof(sdu); sdu_len += 19) {
+			memset(&lpp, 0, sizeof(lpp));
+			lpp.pdu_type = types[t];
+			lpp.have_fcs = 1;
+			uint_to_bits(TMLE_PDISC_CMCE, 3, sdu);
+			for (i = 3; i < sdu_len; i++)
+				sdu[i] = rand() & 1;
+			llc_len = tetra_llc_pdu_encode(&lpp, sdu, sdu_len, llc);
+			send_resource(&tms, llc, llc_len);
+			num++;
+		}
+	}
+	printf("FCS PDUs through the upper MAC: %u/%u passed, %u bad FCS\n",
+	       filter.stats.sdu_pass, num, tms.llcs.rx.stats.fcs_err);
+	if (filter.stats.sdu_pass != num || tms.llcs.rx.stats.fcs_err)
+		num_err++;
+
+	/* and a corrupted one */
+	llc[llc_len - 40] ^= 1;
+	send_resource(&tms, llc, llc_len);
+	printf("corrupted FCS PDU: %u bad FCS\n", tms.llcs.rx.stats.fcs_err);
+	if (filter.stats.sdu_pass != num || tms.llcs.rx.stats.fcs_err != 1)
+		num_err++;
+
+	printf("FCS in the upper MAC %s\n", num_err ? "FAILED" : "OK");
+	return num_err;
+}
+
 int main(int argc, char **argv)
 {
 	uint8_t input1[] = { 0x01 };
 	uint16_t crc;
+	int num_err;
+
+	tetra_verbosity = TETRA_V_NONE;
+	num_err = test_fcs();
+	num_err += test_fcs_upper_mac();
 
 	crc = crc16_itut_bytes(0x0, input1, 8);
 	printf("The CRC is now: %u/0x%x\n", crc, crc);
@@ -71,5 +237,5 @@ int main(int argc, char **argv)
 	else
 		printf("Failed to decode.\n");
 
-	return 0;
+	return num_err ? 1 : 0;
 }
@@ -0,0 +1,209 @@
+/* Test program for the pi/4-DQPSK demodulator */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+
+#include "tetra_kernel.h"
+#include <phy/tetra_demod.h>
+#include "testcheck.h"
+
+#define NUM_SYM		4000
+/* symbols the loops get to settle */
+#define SETTLE		300
+
+struct channel {
+	float delay;	/* in symbols */
+	float ppm;	/* sample clock error */
+	float freq_hz;
+	float snr_db;	/* Es/N0 */
+};
+
+static uint8_t tx_bits[2*NUM_SYM];
+static float complex tx_sym[NUM_SYM];
+static float complex samples[NUM_SYM * TETRA_DEMOD_SPS];
+static float soft[TETRA_DEMOD_MAX_SYM(NUM_SYM * TETRA_DEMOD_SPS)];
+static uint8_t rx_bits[2*TETRA_DEMOD_MAX_SYM(NUM_SYM * TETRA_DEMOD_SPS)];
+
+static float gauss(void)
+{
+	float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+	float u2 = rand() / (RAND_MAX + 1.0f);
+
+	return sqrtf(-2 * logf(u1)) * cosf(2 * M_PI * u2);
+}
+
+/* random bits, pi/4-DQPSK modulated and sent through the channel */
+static unsigned int modulate(const struct channel *ch)
+{
+	static const int phase_step[4] = { 1, 3, -1, -3 };
+	float sigma = sqrtf(powf(10, -ch->snr_db / 10) / 2);
+	int phase = 0;
+	unsigned int i, n = 0;
+
+	for (i = 0; i < NUM_SYM; i++) {
+		tx_bits[2*i] = rand() & 1;
+		tx_bits[2*i+1] = rand() & 1;
+		phase = (phase + phase_step[tx_bits[2*i] * 2 + tx_bits[2*i+1]]) & 7;
+		tx_sym[i] = cexpf(I * phase * M_PI / 4);
+	}
+
+	for (n = 0; n < NUM_SYM * TETRA_DEMOD_SPS; n++) {
+		float t = n * (1 + ch->ppm * 1e-6f) / TETRA_DEMOD_SPS - ch->delay;
+		float complex v = 0;
+		int m;
+
+		if (t > NUM_SYM - 8)
+			break;
+		for (m = floorf(t) - 6; m <= (int) floorf(t) + 6; m++) {
+			if (m >= 0 && m < NUM_SYM)
+				v += tx_sym[m] * tetra_rrc(t - m, TETRA_RRC_ALPHA);
+		}
+		v *= cexpf(I * 2 * M_PI * ch->freq_hz * n / TETRA_DEMOD_RATE);
+		samples[n] = v + sigma * (gauss() + I * gauss());
+	}
+
+	return n;
+}
+
+/* bit errors after the loops have settled, at the best alignment of the
+ * received bits against the transmitted ones */
+static unsigned int bit_errors(unsigned int num_sym)
+{
+	unsigned int best = ~0U;
+	int offs;
+
+	tetra_demod_slice(soft, num_sym, rx_bits);
+
+	for (offs = -16; offs <= 16; offs++) {
+		unsigned int i, err = 0;
+
+		for (i = SETTLE; i < num_sym - 16; i++) {
+			int j = i + offs;
+
+			if (j < 1 || j >= NUM_SYM)
+				continue;
+			err += rx_bits[2*i] != tx_bits[2*j];
+			err += rx_bits[2*i+1] != tx_bits[2*j+1];
+		}
+		if (err < best)
+			best = err;
+	}
+
+	return best;
+}
+
+/* rms distance of the soft symbols from the nearest of +-1, +-3 */
+static float soft_rms(unsigned int num_sym)
+{
+	float sum = 0;
+	unsigned int i;
+
+	for (i = SETTLE; i < num_sym; i++) {
+		float d = soft[i] - (2 * floorf(soft[i] / 2) + 1);
+		sum += d * d;
+	}
+
+	return sqrtf(sum / (num_sym - SETTLE));
+}
+
+static void run(const char *name, const struct channel *ch, float max_rms)
+{
+	struct tetra_demod td;
+	unsigned int n, num_sym;
+	char what[128];
+
+	n = modulate(ch);
+	tetra_demod_init(&td);
+	num_sym = tetra_demod_in(&td, samples, n, soft);
+
+	snprintf(what, sizeof(what), "%s: symbol count", name);
+	check(abs((int) num_sym - (int) (n / TETRA_DEMOD_SPS)) <= 2 &&
+	      td.stats.symbols == num_sym && td.stats.samples == n, what);
+	snprintf(what, sizeof(what), "%s: bit errors", name);
+	check(bit_errors(num_sym) == 0, what);
+	snprintf(what, sizeof(what), "%s: soft symbols (rms %.3f)", name, soft_rms(num_sym));
+	check(soft_rms(num_sym) < max_rms, what);
+	snprintf(what, sizeof(what), "%s: frequency (%.1f Hz)", name, tetra_demod_freq_hz(&td));
+	check(fabsf(tetra_demod_freq_hz(&td) - ch->freq_hz) < 30, what);
+}
+
+/* feeding the samples in odd sized pieces changes nothing */
+static void test_chunks(void)
+{
+	static float soft2[TETRA_DEMOD_MAX_SYM(NUM_SYM * TETRA_DEMOD_SPS)];
+	const struct channel ch = { .delay = 0.3, .freq_hz = 100, .snr_db = 25 };
+	struct tetra_demod td;
+	unsigned int n, i, num, num2 = 0;
+
+	n = modulate(&ch);
+	tetra_demod_init(&td);
+	num = tetra_demod_in(&td, samples, n, soft);
+
+	tetra_demod_init(&td);
+	for (i = 0; i < n; ) {
+		unsigned int len = 1 + rand() % 700;
+
+		if (len > n - i)
+			len = n - i;
+		num2 += tetra_demod_in(&td, samples + i, len, soft2 + num2);
+		i += len;
+	}
+
+	check(num == num2 && !memcmp(soft, soft2, num * sizeof(*soft)), "chunked input");
+}
+
+static void test_slice(void)
+{
+	static const float sym[] = { 3.5, 2.01, 2, 1, 0.01, 0, -0.5, -2, -2.01, -3, NAN };
+	static const uint8_t bits[] = { 0,1, 0,1, 0,0, 0,0, 0,0, 1,0, 1,0, 1,0, 1,1, 1,1, 1,0 };
+	/* the distance from the nearest threshold, scaled */
+	static const int8_t soft[] = { 32,-96, 127,-1, 127,0, 64,64, 1,127, 0,127,
+				       -32,96, -127,0, -127,-1, -64,-64, 0,127 };
+	uint8_t out[sizeof(bits)];
+	int8_t soft_out[sizeof(soft)];
+
+	tetra_demod_slice(sym, sizeof(sym) / sizeof(sym[0]), out);
+	check(!memcmp(out, bits, sizeof(bits)), "slicer");
+	tetra_kern.slice_soft(sym, sizeof(sym) / sizeof(sym[0]), soft_out);
+	check(!memcmp(soft_out, soft, sizeof(soft)), "soft slicer");
+}
+
+int main(int argc, char **argv)
+{
+	const struct channel clean = { .snr_db = 60 };
+	const struct channel late = { .delay = 0.5, .ppm = 40, .freq_hz = 400, .snr_db = 20 };
+	const struct channel off = { .delay = 0.25, .ppm = -60, .freq_hz = -1500, .snr_db = 20 };
+
+	srand(42);
+	tetra_kernel_init();
+
+	test_slice();
+	run("clean", &clean, 0.05);
+	run("half symbol late, 400 Hz", &late, 0.3);
+	run("-1500 Hz", &off, 0.3);
+	test_chunks();
+
+	check_exit();
+}
@@ -0,0 +1,163 @@
+/* Test program for the pcap sink of the IP packet egress */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#include <osmocom/core/bits.h>
+
+#include "tetra_egress.h"
+#include "testcheck.h"
+
+#define NUM_PKTS	100
+#define PCAP_HDR_LEN	24
+#define REC_HDR_LEN	16
+
+static uint32_t get_u32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, 4);
+	return v;
+}
+
+/* packet 'i' is 20 + i bytes of i, i+1, ... */
+static unsigned int pkt_len(unsigned int i)
+{
+	return 20 + i;
+}
+
+static void put_pkts(struct tetra_egress *eg)
+{
+	ubit_t bits[8 * 256];
+	uint8_t data[256];
+	unsigned int i, j;
+
+	for (i = 0; i < NUM_PKTS; i++) {
+		for (j = 0; j < pkt_len(i); j++)
+			data[j] = i + j;
+		osmo_pbit2ubit(bits, data, pkt_len(i) * 8);
+		tetra_egress_put(eg, i & 3, bits, pkt_len(i) * 8);
+	}
+}
+
+static void test_pcap(const char *path)
+{
+	struct tetra_egress_stats st;
+	struct tetra_egress *eg;
+	unsigned int i, j, good = 0;
+	uint8_t buf[PCAP_HDR_LEN + NUM_PKTS * (REC_HDR_LEN + 256)];
+	const uint8_t *p = buf;
+	size_t len;
+	FILE *f;
+
+	eg = tetra_egress_alloc(NULL, TETRA_EGRESS_PCAP, path, 0);
+	check(eg != NULL, "open pcap file");
+	if (!eg)
+		return;
+	put_pkts(eg);
+	tetra_egress_free(eg, &st);
+	check(st.queued == NUM_PKTS && st.written == NUM_PKTS && st.write_err == 0,
+	      "packets written");
+
+	f = fopen(path, "r");
+	len = fread(buf, 1, sizeof(buf), f);
+	fclose(f);
+
+	/* raw IP, microsecond timestamps */
+	check(len >= PCAP_HDR_LEN && get_u32(p) == 0xa1b2c3d4 && get_u32(p + 20) == 101,
+	      "file header");
+	p += PCAP_HDR_LEN;
+
+	for (i = 0; i < NUM_PKTS && p + REC_HDR_LEN <= buf + len; i++) {
+		uint32_t incl_len = get_u32(p + 8);
+		int same = incl_len == pkt_len(i) && get_u32(p + 12) == incl_len;
+
+		p += REC_HDR_LEN;
+		if (p + incl_len > buf + len)
+			break;
+		for (j = 0; same && j < incl_len; j++)
+			same = p[j] == (uint8_t)(i + j);
+		good += same;
+		p += incl_len;
+	}
+	check(good == NUM_PKTS && p == buf + len, "records in order");
+}
+
+/* with a file size limit the write stops in the middle of a packet: the
+ * packets before it are written, the rest are counted as lost */
+static void test_short_write(const char *path)
+{
+	struct tetra_egress_stats st;
+	struct tetra_egress *eg;
+	struct rlimit rl, rl_save;
+	unsigned int i, limit = PCAP_HDR_LEN;
+	struct stat sb;
+
+	for (i = 0; i < 10; i++)
+		limit += REC_HDR_LEN + pkt_len(i);
+	limit += REC_HDR_LEN + 5;
+
+	signal(SIGXFSZ, SIG_IGN);
+	getrlimit(RLIMIT_FSIZE, &rl_save);
+	rl = rl_save;
+	rl.rlim_cur = limit;
+	if (setrlimit(RLIMIT_FSIZE, &rl) < 0) {
+		printf("cannot limit the file size, skipped\n");
+		return;
+	}
+
+	eg = tetra_egress_alloc(NULL, TETRA_EGRESS_PCAP, path, 0);
+	check(eg != NULL, "open pcap file");
+	if (eg) {
+		put_pkts(eg);
+		tetra_egress_free(eg, &st);
+		check(st.written == 10 && st.write_err == NUM_PKTS - 10,
+		      "complete packets counted as written");
+	}
+	setrlimit(RLIMIT_FSIZE, &rl_save);
+
+	check(stat(path, &sb) == 0 && sb.st_size == limit, "written up to the limit");
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/egress_test.XXXXXX";
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		exit(1);
+	}
+	close(fd);
+
+	test_pcap(path);
+	test_short_write(path);
+	unlink(path);
+
+	check_exit();
+}
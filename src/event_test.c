@@ -0,0 +1,293 @@
+/* Test program for the binary decoder event stream */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <osmocom/core/bits.h>
+
+#include "tetra_common.h"
+#include "tetra_tdma.h"
+#include "tetra_event.h"
+#include "testcheck.h"
+
+/* more than the smallest buffer holds */
+#define NUM_RECS	3000
+#define SLOT0		4000000000ULL
+
+/* the bits of record 'i' */
+static unsigned int rec_bits(unsigned int i, uint8_t *bits)
+{
+	unsigned int j, len = (i * 37) % 500;
+
+	for (j = 0; j < len; j++)
+		bits[j] = ((i * 5 + j * 11) >> 3) & 1;
+	return len;
+}
+
+/* record 'i' is of type i % 6 + 1, in slot SLOT0 + i / 3 */
+static int put_rec(unsigned int i)
+{
+	uint8_t bits[512];
+	unsigned int num_bits = rec_bits(i, bits);
+
+	tetra_event_set_time(SLOT0 + i / 3);
+
+	switch (i % 6 + 1) {
+	case TETRA_EV_BURST: {
+		struct tetra_ev_burst ev = { .train_seq = i % 5, .locked = i & 1, .offset = i };
+		return tetra_event_put(TETRA_EV_BURST, &ev, sizeof(ev), NULL, 0);
+	}
+	case TETRA_EV_BLOCK: {
+		struct tetra_ev_block ev = { .blk_type = i % 7, .lchan = i % 11,
+					     .crc_ok = i & 1, .crc = i * 3, .num_bits = num_bits };
+		return tetra_event_put(TETRA_EV_BLOCK, &ev, sizeof(ev), bits, num_bits);
+	}
+	case TETRA_EV_SYNC: {
+		struct tetra_ev_sync ev = { .mcc = 262, .mnc = i, .colour_code = i % 64,
+					    .tn = 1, .fn = 18, .mn = 60 };
+		return tetra_event_put(TETRA_EV_SYNC, &ev, sizeof(ev), NULL, 0);
+	}
+	case TETRA_EV_SYSINFO: {
+		struct tetra_ev_sysinfo ev = { .dl_freq = 390000000 + i, .ul_freq = i,
+					       .hf_or_cck = i, .cck_valid = i & 1 };
+		return tetra_event_put(TETRA_EV_SYSINFO, &ev, sizeof(ev), NULL, 0);
+	}
+	case TETRA_EV_PDU: {
+		struct tetra_ev_pdu ev = { .proto = i % 5 + 1, .pdu_type = i,
+					   .num_bits = num_bits, .addr = i * 7, .aux = i * 13 };
+		return tetra_event_put(TETRA_EV_PDU, &ev, sizeof(ev), bits, num_bits);
+	}
+	default:
+		tetra_event_defrag(i % 8, i, i >> 1, i >> 2);
+		return 0;
+	}
+}
+
+/* what put_rec() wrote for record 'i', packed */
+static unsigned int expect_rec(unsigned int i, uint8_t *payload)
+{
+	uint8_t bits[512];
+	unsigned int num_bits = rec_bits(i, bits);
+	unsigned int len;
+
+	switch (i % 6 + 1) {
+	case TETRA_EV_BURST: {
+		struct tetra_ev_burst ev = { .train_seq = i % 5, .locked = i & 1, .offset = i };
+		memcpy(payload, &ev, sizeof(ev));
+		return sizeof(ev);
+	}
+	case TETRA_EV_BLOCK: {
+		struct tetra_ev_block ev = { .blk_type = i % 7, .lchan = i % 11,
+					     .crc_ok = i & 1, .crc = i * 3, .num_bits = num_bits };
+		memcpy(payload, &ev, sizeof(ev));
+		len = sizeof(ev);
+		break;
+	}
+	case TETRA_EV_SYNC: {
+		struct tetra_ev_sync ev = { .mcc = 262, .mnc = i, .colour_code = i % 64,
+					    .tn = 1, .fn = 18, .mn = 60 };
+		memcpy(payload, &ev, sizeof(ev));
+		return sizeof(ev);
+	}
+	case TETRA_EV_SYSINFO: {
+		struct tetra_ev_sysinfo ev = { .dl_freq = 390000000 + i, .ul_freq = i,
+					       .hf_or_cck = i, .cck_valid = i & 1 };
+		memcpy(payload, &ev, sizeof(ev));
+		return sizeof(ev);
+	}
+	case TETRA_EV_PDU: {
+		struct tetra_ev_pdu ev = { .proto = i % 5 + 1, .pdu_type = i,
+					   .num_bits = num_bits, .addr = i * 7, .aux = i * 13 };
+		memcpy(payload, &ev, sizeof(ev));
+		len = sizeof(ev);
+		break;
+	}
+	default: {
+		struct tetra_ev_defrag ev = { .kind = i % 8, .ns = i >> 1, .ss = i >> 2,
+					      .addr = i };
+		memcpy(payload, &ev, sizeof(ev));
+		return sizeof(ev);
+	}
+	}
+
+	return len + osmo_ubit2pbit(payload + len, bits, num_bits);
+}
+
+static void test_round_trip(const char *path)
+{
+	struct tetra_ev_file_hdr fh;
+	struct tetra_ev_hdr eh;
+	uint8_t payload[65536], expect[2048], bits[TETRA_EV_MAX_PAYLOAD * 8 + 8];
+	unsigned int i, len, good = 0, valid = 0;
+	int rc = 0;
+	FILE *f;
+
+	/* nothing is written without an open file */
+	check(!tetra_event_active && put_rec(0) == 0, "inactive");
+
+	/* the smallest buffer, flushed many times */
+	check(tetra_event_open(path, 1) == 0 && tetra_event_active, "open");
+	check(tetra_event_open(path, 0) == -EBUSY, "open twice");
+	for (i = 0; i < NUM_RECS; i++)
+		rc |= put_rec(i);
+	check(rc == 0, "records written");
+	memset(bits, 1, sizeof(bits));
+	check(tetra_event_put(TETRA_EV_PDU, &eh, 4, bits, TETRA_EV_MAX_PAYLOAD * 8) == -EMSGSIZE,
+	      "oversized record");
+	tetra_event_close();
+	check(!tetra_event_active, "close");
+
+	f = fopen(path, "rb");
+	check(f && tetra_event_read_hdr(f, &fh) == 0 && fh.version == TETRA_EV_VERSION &&
+	      fh.hdr_len == sizeof(eh), "file header");
+	if (!f)
+		return;
+
+	for (i = 0; i < NUM_RECS; i++) {
+		if (tetra_event_read(f, &fh, &eh, payload) != 1)
+			break;
+		len = expect_rec(i, expect);
+		valid += tetra_event_valid(&eh, payload);
+		good += eh.type == i % 6 + 1 && eh.flags == 0 && eh.len == len &&
+			tetra_event_ts2slot(fh.version, eh.ts) == (uint32_t)(SLOT0 + i / 3) &&
+			!memcmp(payload, expect, len);
+	}
+	check(good == NUM_RECS && valid == NUM_RECS, "records read back in order");
+	check(tetra_event_read(f, &fh, &eh, payload) == 0, "end of file");
+	fclose(f);
+}
+
+static void write_file(const char *path, const void *data, unsigned int len)
+{
+	FILE *f = fopen(path, "wb");
+
+	fwrite(data, 1, len, f);
+	fclose(f);
+}
+
+/* a version 1 file whose record headers were extended by 4 bytes, and
+ * which ends within a record */
+static void test_read(const char *path)
+{
+	struct {
+		struct tetra_ev_file_hdr fh;
+		struct tetra_ev_hdr eh;
+		uint32_t ext;
+		struct tetra_ev_defrag ev;
+		struct tetra_ev_hdr eh2;
+		uint32_t ext2;
+		uint8_t part[3];
+	} __attribute__((packed)) file = {
+		.fh = { TETRA_EV_MAGIC, 1, sizeof(struct tetra_ev_hdr) + 4 },
+		.eh = { .type = TETRA_EV_DEFRAG, .len = sizeof(struct tetra_ev_defrag), .ts = 76 },
+		.ext = 0xffffffff,
+		.ev = { .kind = TETRA_EV_DF_DUP, .addr = 4711 },
+		.eh2 = { .type = TETRA_EV_SYNC, .len = sizeof(struct tetra_ev_sync) },
+	};
+	struct tetra_ev_file_hdr fh;
+	struct tetra_ev_hdr eh;
+	uint8_t payload[65536];
+	FILE *f;
+
+	write_file(path, &file, sizeof(file));
+	f = fopen(path, "rb");
+	check(tetra_event_read_hdr(f, &fh) == 0 && fh.version == 1, "version 1 header");
+	check(tetra_event_read(f, &fh, &eh, payload) == 1 && eh.type == TETRA_EV_DEFRAG &&
+	      tetra_event_valid(&eh, payload) &&
+	      !memcmp(payload, &file.ev, sizeof(file.ev)) &&
+	      tetra_event_ts2slot(fh.version, eh.ts) == 0, "extended record header");
+	check(tetra_event_read(f, &fh, &eh, payload) == -EIO, "truncated record");
+	fclose(f);
+
+	file.fh.version = TETRA_EV_VERSION + 1;
+	write_file(path, &file, sizeof(file));
+	f = fopen(path, "rb");
+	check(tetra_event_read_hdr(f, &fh) == -EPROTONOSUPPORT, "newer version");
+	fclose(f);
+
+	file.fh.magic = 0;
+	write_file(path, &file, sizeof(file));
+	f = fopen(path, "rb");
+	check(tetra_event_read_hdr(f, &fh) == -EINVAL, "no event file");
+	fclose(f);
+
+	/* too short for the bits it announces */
+	eh.type = TETRA_EV_BLOCK;
+	eh.len = sizeof(struct tetra_ev_block) + 1;
+	((struct tetra_ev_block *) payload)->num_bits = 9;
+	check(!tetra_event_valid(&eh, payload), "short record");
+	eh.type = 0;
+	check(!tetra_event_valid(&eh, payload), "unknown record type");
+}
+
+/* the timestamp of TN tn (0..3) in FN fn, MN mn of a version 1 file */
+static uint32_t v1_ts(uint32_t hn, uint32_t mn, uint32_t fn, uint32_t tn)
+{
+	return (((hn * 60) + mn) * 18 + fn) * 4 + tn;
+}
+
+static void test_v1_time(void)
+{
+	char buf[TETRA_TDMA_DUMP_LEN];
+	uint32_t mn, fn, tn, ok = 1;
+
+	check(!strcmp(tetra_tdma_slot_dump(tetra_event_ts2slot(1, v1_ts(0, 60, 18, 3)), buf),
+		      "60/18/4"), "version 1 MN 60");
+	check(!strcmp(tetra_tdma_slot_dump(tetra_event_ts2slot(1, v1_ts(7, 1, 1, 0)), buf),
+		      "01/01/1"), "version 1 MN 1");
+
+	for (mn = 1; mn <= 60; mn++) {
+		for (fn = 1; fn <= 18; fn++) {
+			for (tn = 0; tn < 4; tn++) {
+				uint64_t slot = tetra_event_ts2slot(1, v1_ts(3, mn, fn, tn));
+
+				ok &= tetra_tdma_mn(slot) == mn && tetra_tdma_fn(slot) == fn &&
+				      tetra_tdma_tn(slot) == tn + 1 && tetra_tdma_hn(slot) == 3;
+			}
+		}
+	}
+	check(ok, "version 1 time");
+	check(tetra_event_ts2slot(2, 4711) == 4711, "version 2 time");
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/event_test.XXXXXX";
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		exit(1);
+	}
+	close(fd);
+
+	test_round_trip(path);
+	test_read(path);
+	unlink(path);
+	test_v1_time();
+
+	check_exit();
+}
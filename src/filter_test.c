@@ -0,0 +1,333 @@
+/* Test program for the subscriber / PDU filter of the upper MAC */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <osmocom/core/msgb.h>
+#include <osmocom/core/talloc.h>
+
+#include "tetra_common.h"
+#include "tetra_llc_pdu.h"
+#include "tetra_mac_pdu.h"
+#include "tetra_mle_pdu.h"
+#include "tetra_filter.h"
+#include "tetra_prim.h"
+#include "tetra_upper_mac.h"
+#include "testcheck.h"
+
+void *tetra_tall_ctx;
+
+static void test_add(void)
+{
+	struct tetra_filter flt;
+	char buf[16];
+	int i, rc = 0;
+
+	memset(&flt, 0, sizeof(flt));
+	check(!tetra_filter_active(&flt), "empty filter is inactive");
+
+	check(tetra_filter_add(&flt, 's', "1000-1999,2342,0x10") == 0 && flt.num_ssi == 3 &&
+	      flt.ssi[0].lo == 1000 && flt.ssi[0].hi == 1999 &&
+	      flt.ssi[1].lo == 2342 && flt.ssi[1].hi == 2342 &&
+	      flt.ssi[2].lo == 16 && flt.ssi[2].hi == 16, "SSI ranges");
+	check(tetra_filter_active(&flt), "filter is active");
+	check(tetra_filter_add(&flt, 's', "5-3") == -EINVAL &&
+	      tetra_filter_add(&flt, 's', "abc") == -EINVAL &&
+	      tetra_filter_add(&flt, 's', "12a") == -EINVAL &&
+	      tetra_filter_add(&flt, 's', "7-") == -EINVAL &&
+	      tetra_filter_add(&flt, 's', "0x1000000") == -EINVAL, "bad SSI ranges");
+
+	for (i = flt.num_ssi; i < TETRA_FILTER_MAX_SSI; i++) {
+		snprintf(buf, sizeof(buf), "%d", i);
+		rc |= tetra_filter_add(&flt, 's', buf);
+	}
+	check(rc == 0 && tetra_filter_add(&flt, 's', "42") == -ENOSPC, "too many SSI ranges");
+
+	memset(&flt, 0, sizeof(flt));
+	check(tetra_filter_add(&flt, 'a', "1,3") == 0 && flt.addr_types == 0x0a &&
+	      tetra_filter_add(&flt, 'a', "8") == -EINVAL, "address types");
+	check(tetra_filter_add(&flt, 'p', "CMCE,mm,5") == 0 &&
+	      flt.mle_pdisc == (1 << TMLE_PDISC_CMCE | 1 << TMLE_PDISC_MM | 1 << TMLE_PDISC_MLE) &&
+	      tetra_filter_add(&flt, 'p', "bogus") == -EINVAL &&
+	      tetra_filter_add(&flt, 'p', "8") == -EINVAL, "protocol discriminators");
+	check(tetra_filter_add(&flt, 'c', "0,31") == 0 && flt.cmce_pdut == 0x80000001 &&
+	      tetra_filter_add(&flt, 'c', "32") == -EINVAL, "CMCE PDU types");
+	check(tetra_filter_add(&flt, 'm', "15") == 0 && flt.mm_pdut == 0x8000 &&
+	      tetra_filter_add(&flt, 'm', "16") == -EINVAL, "MM PDU types");
+	check(tetra_filter_add(&flt, 'x', "1") == -EINVAL &&
+	      tetra_filter_add(&flt, 's', "") == 0 && flt.num_ssi == 0, "other arguments");
+}
+
+static int addr(struct tetra_filter *flt, uint8_t type, uint32_t ssi, uint16_t label)
+{
+	struct tetra_addr a;
+
+	memset(&a, 0, sizeof(a));
+	a.type = type;
+	a.ssi = ssi;
+	a.event_label = label;
+	return tetra_filter_addr(flt, &a);
+}
+
+static void test_addr(void)
+{
+	struct tetra_filter flt;
+	unsigned int i;
+	int ok = 1;
+
+	memset(&flt, 0, sizeof(flt));
+	tetra_filter_add(&flt, 's', "1000-1999,2342");
+	check(addr(&flt, ADDR_TYPE_SSI, 1000, 0) && addr(&flt, ADDR_TYPE_SSI, 1999, 0) &&
+	      addr(&flt, ADDR_TYPE_USSI, 2342, 0) && !addr(&flt, ADDR_TYPE_SSI, 999, 0) &&
+	      !addr(&flt, ADDR_TYPE_SSI, 2000, 0) && !addr(&flt, ADDR_TYPE_SMI, 2343, 0),
+	      "SSI ranges");
+	check(flt.stats.addr_pass == 3 && flt.stats.addr_drop == 3, "address statistics");
+
+	/* the label of a matching SSI is remembered, others are not */
+	check(!addr(&flt, ADDR_TYPE_EVENT_LABEL, 0, 17) &&
+	      !addr(&flt, ADDR_TYPE_SSI_EVENT, 3000, 17) &&
+	      !addr(&flt, ADDR_TYPE_EVENT_LABEL, 0, 17) &&
+	      addr(&flt, ADDR_TYPE_SSI_EVENT, 1500, 17) &&
+	      addr(&flt, ADDR_TYPE_EVENT_LABEL, 0, 17) &&
+	      !addr(&flt, ADDR_TYPE_EVENT_LABEL, 0, 18), "event labels");
+
+	/* the oldest labels are forgotten first */
+	for (i = 0; i < TETRA_FILTER_MAX_LABELS; i++)
+		ok &= addr(&flt, ADDR_TYPE_SMI_EVENT, 1000 + i, 100 + i);
+	check(ok && !addr(&flt, ADDR_TYPE_EVENT_LABEL, 0, 17) &&
+	      addr(&flt, ADDR_TYPE_EVENT_LABEL, 0, 100) &&
+	      addr(&flt, ADDR_TYPE_EVENT_LABEL, 0, 100 + TETRA_FILTER_MAX_LABELS - 1),
+	      "event label memory");
+
+	/* address types alone, or together with the SSIs */
+	memset(&flt, 0, sizeof(flt));
+	tetra_filter_add(&flt, 'a', "1");
+	check(addr(&flt, ADDR_TYPE_SSI, 5, 0) && !addr(&flt, ADDR_TYPE_USSI, 5, 0),
+	      "address types");
+	tetra_filter_add(&flt, 's', "5");
+	check(addr(&flt, ADDR_TYPE_SSI, 5, 0) && !addr(&flt, ADDR_TYPE_SSI, 6, 0) &&
+	      !addr(&flt, ADDR_TYPE_USSI, 5, 0), "address types and SSIs");
+}
+
+/* a TL-SDU with 'pdisc' and a PDU type of 'type_len' bits */
+static unsigned int sdu(uint8_t *bits, uint8_t pdisc, uint8_t type, unsigned int type_len)
+{
+	memset(bits, 0, 64);
+	uint_to_bits(pdisc, 3, bits);
+	uint_to_bits(type, type_len, bits + 3);
+	return 64;
+}
+
+static void test_sdu(void)
+{
+	struct tetra_filter flt;
+	uint8_t bits[64];
+
+	memset(&flt, 0, sizeof(flt));
+	tetra_filter_add(&flt, 's', "1");
+	check(tetra_filter_sdu(&flt, bits, 0) && flt.stats.sdu_pass == 1,
+	      "no SDU criteria");
+
+	tetra_filter_add(&flt, 'p', "SNDCP,MM");
+	check(tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_SNDCP, 0, 4)) &&
+	      tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_MM, 5, 4)) &&
+	      !tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_CMCE, 7, 5)) &&
+	      !tetra_filter_sdu(&flt, bits, 2), "protocol discriminators");
+
+	/* a PDU type selects its pdisc as well */
+	memset(&flt, 0, sizeof(flt));
+	tetra_filter_add(&flt, 'c', "7");
+	check(tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_CMCE, 7, 5)) &&
+	      !tetra_filter_sdu(&flt, bits, 3+4) &&
+	      !tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_CMCE, 8, 5)) &&
+	      !tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_MM, 7, 4)), "CMCE PDU types");
+
+	tetra_filter_add(&flt, 'm', "5");
+	check(tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_MM, 5, 4)) &&
+	      !tetra_filter_sdu(&flt, bits, 3+3) &&
+	      !tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_MM, 6, 4)), "MM PDU types");
+
+	/* another pdisc only passes if selected, and then the pdiscs of the
+	 * PDU types have to be selected as well */
+	check(!tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_SNDCP, 0, 4)), "other pdisc");
+	tetra_filter_add(&flt, 'p', "SNDCP");
+	check(tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_SNDCP, 0, 4)) &&
+	      !tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_CMCE, 7, 5)),
+	      "selected pdisc");
+	tetra_filter_add(&flt, 'p', "CMCE");
+	check(tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_CMCE, 7, 5)) &&
+	      !tetra_filter_sdu(&flt, bits, sdu(bits, TMLE_PDISC_CMCE, 8, 5)),
+	      "selected pdisc with PDU types");
+	check(flt.stats.sdu_pass == 4 && flt.stats.sdu_drop == 8, "SDU statistics");
+}
+
+static void send_block(struct tetra_mac_state *tms, uint64_t slot, const uint8_t *bits)
+{
+	struct tetra_tmvsap_prim *ttp;
+
+	ttp = talloc_zero(NULL, struct tetra_tmvsap_prim);
+	ttp->oph.msg = msgb_alloc(412, "filter_test");
+	ttp->oph.sap = TETRA_SAP_TMV;
+	ttp->oph.primitive = PRIM_TMV_UNITDATA;
+	ttp->oph.operation = PRIM_OP_INDICATION;
+	ttp->u.unitdata.lchan = TETRA_LC_SCH_F;
+	ttp->u.unitdata.crc_ok = 1;
+	ttp->u.unitdata.tdma_slot = slot;
+	ttp->oph.msg->l1h = msgb_put(ttp->oph.msg, 268);
+	memcpy(ttp->oph.msg->l1h, bits, 268);
+
+	upper_mac_prim_recv(&ttp->oph, tms);
+}
+
+/* the first fragment of a MAC PDU for 'ssi', a BL-UDATA with a CMCE PDU */
+static void send_start(struct tetra_mac_state *tms, uint64_t slot, uint32_t ssi,
+		       uint8_t cmce_type)
+{
+	struct tetra_resrc_decoded rsd;
+	struct tetra_llc_pdu lpp;
+	uint8_t bits[268], tl_sdu[64];
+	int hdr_len;
+
+	memset(bits, 0, sizeof(bits));
+	memset(&rsd, 0, sizeof(rsd));
+	rsd.addr.type = ADDR_TYPE_SSI;
+	rsd.addr.ssi = ssi;
+	rsd.macpdu_length = 1;
+	hdr_len = macpdu_encode_resource(&rsd, 0, bits);
+	/* the length indication of the start of fragmentation */
+	uint_to_bits(0x3f, 6, bits + 7);
+
+	memset(&lpp, 0, sizeof(lpp));
+	lpp.pdu_type = TLLC_PDUT_DEC_BL_UDATA;
+	tetra_llc_pdu_encode(&lpp, tl_sdu, sdu(tl_sdu, TMLE_PDISC_CMCE, cmce_type, 5),
+			     bits + hdr_len);
+
+	send_block(tms, slot, bits);
+}
+
+/* a MAC-FRAG or MAC-END continuing a MAC PDU */
+static void send_frag(struct tetra_mac_state *tms, uint64_t slot, int end)
+{
+	uint8_t bits[268];
+	unsigned int i;
+
+	for (i = 0; i < sizeof(bits); i++)
+		bits[i] = rand() & 1;
+	uint_to_bits(TETRA_PDU_T_MAC_FRAG_END, 2, bits);
+	bits[2] = bits[3] = end ? TETRA_MAC_FRAGE_END : TETRA_MAC_FRAGE_FRAG;
+
+	send_block(tms, slot, bits);
+}
+
+static void send_suppl(struct tetra_mac_state *tms, uint64_t slot)
+{
+	uint8_t bits[268];
+	unsigned int i;
+
+	for (i = 0; i < sizeof(bits); i++)
+		bits[i] = rand() & 1;
+	uint_to_bits(TETRA_PDU_T_MAC_SUPPL, 2, bits);
+
+	send_block(tms, slot, bits);
+}
+
+/* MAC-FRAG, MAC-END and SUPPL carry no address: they are dropped with the
+ * first fragment of their MAC PDU, on the same timeslot */
+static void test_upper_mac(void)
+{
+	struct tetra_filter_stats st;
+	struct tetra_mac_state tms;
+	struct tetra_filter flt;
+	int f1, f2, f3;
+
+	memset(&tms, 0, sizeof(tms));
+	tetra_mac_state_init(&tms);
+	memset(&flt, 0, sizeof(flt));
+	tetra_filter_add(&flt, 's', "4711");
+	tetra_filter_add(&flt, 'c', "7");
+	tms.filter = &flt;
+
+	/* another subscriber on TN 2, ours on TN 3 */
+	send_start(&tms, 1, 999, 7);
+	f1 = tms.cur_burst.filtered;
+	send_start(&tms, 2, 4711, 7);
+	f2 = tms.cur_burst.filtered;
+	check(f1 && !f2 && flt.stats.addr_drop == 1 && flt.stats.addr_pass == 1 &&
+	      flt.stats.sdu_pass == 1, "first fragments");
+
+	st = flt.stats;
+	send_frag(&tms, 5, 0);
+	f1 = tms.cur_burst.filtered;
+	send_frag(&tms, 6, 0);
+	f2 = tms.cur_burst.filtered;
+	send_suppl(&tms, 5);
+	f3 = tms.cur_burst.filtered;
+	check(f1 && !f2 && f3, "fragments");
+	send_frag(&tms, 9, 1);
+	f1 = tms.cur_burst.filtered;
+	send_frag(&tms, 10, 1);
+	f2 = tms.cur_burst.filtered;
+	check(f1 && !f2, "last fragments");
+	check(!memcmp(&st, &flt.stats, sizeof(st)), "continuations not filtered again");
+
+	/* after the end, nothing continues on TN 3 */
+	send_frag(&tms, 14, 0);
+	check(tms.cur_burst.filtered, "fragment without a start");
+
+	/* our subscriber, but a CMCE PDU which is not selected: all of it is
+	 * dropped, the decision is made at the first fragment */
+	send_start(&tms, 18, 4711, 8);
+	f1 = tms.cur_burst.filtered;
+	send_frag(&tms, 22, 0);
+	f2 = tms.cur_burst.filtered;
+	send_frag(&tms, 26, 1);
+	f3 = tms.cur_burst.filtered;
+	check(f1 && f2 && f3 && flt.stats.sdu_drop == st.sdu_drop + 1,
+	      "PDU type decided at the first fragment");
+
+	/* another subscriber on TN 4, the last of the frame */
+	tms.last_sid.main_carrier = 0x1234;
+	send_start(&tms, 31, 999, 7);
+	f1 = tms.cur_burst.filtered;
+	send_frag(&tms, 35, 1);
+	f2 = tms.cur_burst.filtered;
+	check(f1 && f2 && tms.last_sid.main_carrier == 0x1234, "TN 4");
+
+	/* without a filter, continuations are decoded as before */
+	tms.filter = NULL;
+	send_frag(&tms, 38, 0);
+	check(!tms.cur_burst.filtered, "no filter");
+}
+
+int main(int argc, char **argv)
+{
+	tetra_verbosity = TETRA_V_NONE;
+
+	test_add();
+	test_addr();
+	test_sdu();
+	test_upper_mac();
+
+	check_exit();
+}
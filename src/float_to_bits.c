@@ -24,114 +24,123 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <errno.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
 
-static int process_sym_fl(float fl)
-{
-	int ret;
-
-	/* very simplistic scheme */
-	if (fl > 2)
-		ret = 3;
-	else if (fl > 0)
-		ret = 1;
-	else if (fl < -2)
-		ret = -3;
-	else
-		ret = -1;
-
-	return ret;
-}
+#include "tetra_kernel.h"
 
-static void sym_int2bits(int sym, uint8_t *ret)
+// size of IO buffers (number of symbols)
+#define BUF_SIZE 65536
+
+static int write_all(int fd, const void *buf, size_t len)
 {
-	switch (sym) {
-	case -3:
-		ret[0] = 1;
-		ret[1] = 1;
-		break;
-	case 1:
-		ret[0] = 0;
-		ret[1] = 0;
-		break;
-	//case -1:
-	case 3:
-		ret[0] = 0;
-		ret[1] = 1;
-		break;
-	//case 3:
-	case -1:
-		ret[0] = 1;
-		ret[1] = 0;
-		break;
+	const uint8_t *p = buf;
+
+	while (len) {
+		ssize_t rc = write(fd, p, len);
+
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		p += rc;
+		len -= rc;
 	}
+	return 0;
 }
 
-// size of IO buffers (number of elements)
-#define BUF_SIZE 1024
+static void print_help(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-v] [-s] [<infile> [<outfile>]]\n", prog);
+	fprintf(stderr, "  -v   also print the bits as text\n");
+	fprintf(stderr, "  -s   write soft bits, one int8 each: +127 a sure 0, -127 a sure 1\n");
+	fprintf(stderr, "infile and outfile default to stdin and stdout, \"-\" is either\n");
+}
 
 int main(int argc, char **argv)
 {
-	int fd, fd_out, opt;
-
-	int opt_verbose = 0;
+	static float fl[BUF_SIZE];
+	static uint8_t bits[2*BUF_SIZE];
+	static char text[2*BUF_SIZE];
+	int fd = 0, fd_out = 1, opt;
+	int opt_verbose = 0, opt_soft = 0;
+	FILE *text_out = stdout;
 
-	while ((opt = getopt(argc, argv, "v")) != -1) {
+	while ((opt = getopt(argc, argv, "vsh")) != -1) {
 		switch (opt) {
 		case 'v':
 			opt_verbose = 1;
 			break;
+		case 's':
+			opt_soft = 1;
+			break;
 		default:
+			print_help(argv[0]);
 			exit(2);
 		}
 	}
 
-	if (argc <= optind+1) {
-		fprintf(stderr, "Usage: %s [-v] <infile> <outfile>\n", argv[0]);
-		exit(2);
-	}
-
-	fd = open(argv[optind], O_RDONLY);
-	if (fd < 0) {
-		perror("open infile");
-		exit(1);
+	if (argc > optind && strcmp(argv[optind], "-")) {
+		fd = open(argv[optind], O_RDONLY);
+		if (fd < 0) {
+			perror("open infile");
+			exit(1);
+		}
 	}
-	fd_out = creat(argv[optind+1], 0660);
-	if (fd_out < 0) {
-		perror("open outfile");
-		exit(1);
+	if (argc > optind + 1 && strcmp(argv[optind+1], "-")) {
+		fd_out = creat(argv[optind+1], 0660);
+		if (fd_out < 0) {
+			perror("open outfile");
+			exit(1);
+		}
 	}
+	/* the text must not end up in the middle of the bits */
+	if (fd_out == 1)
+		text_out = stderr;
+
+	tetra_kernel_init();
+
 	while (1) {
-		int rc;
-		float fl[BUF_SIZE];
-		uint8_t bits[2*BUF_SIZE];
-		rc = read(fd, fl, sizeof(*fl) * BUF_SIZE);
-		if (rc < 0) {
+		int len, rc, i;
+
+		/* a partial symbol at the end is dropped */
+		len = tetra_read_full(fd, fl, sizeof(fl));
+		if (len < 0) {
+			errno = -len;
 			perror("read");
 			exit(1);
-		} else if (rc == 0) {
-			break;
 		}
-		rc /= sizeof(*fl);
-		int i;
-		for (i = 0; i < rc; ++i) {
-			int sym = process_sym_fl(fl[i]);
-			sym_int2bits(sym, bits + i*2);
-			//printf("%2d %1u %1u  %f\n", rc, bits[0], bits[1], fl);
-			if (opt_verbose) {
-				printf("%1u%1u", bits[2*i + 0], bits[2*i + 1]);
-			}
+		rc = len / sizeof(*fl);
+		if (!rc)
+			break;
+
+		if (opt_soft)
+			tetra_kern.slice_soft(fl, rc, (int8_t *) bits);
+		else
+			tetra_kern.slice(fl, rc, bits);
+
+		if (opt_verbose) {
+			if (opt_soft)
+				tetra_kern.slice(fl, rc, (uint8_t *) text);
+			else
+				memcpy(text, bits, 2 * rc);
+			for (i = 0; i < 2 * rc; i++)
+				text[i] += '0';
+			fwrite(text, 2 * rc, 1, text_out);
 		}
 
-		rc = write(fd_out, bits, rc * 2);
+		rc = write_all(fd_out, bits, rc * 2);
 		if (rc < 0) {
+			errno = -rc;
 			perror("write");
 			exit(1);
-		} else if (rc == 0)
+		}
+		if (len < sizeof(fl))
 			break;
 	}
 	exit(0);
@@ -0,0 +1,286 @@
+/* Test program for the synthetic downlink generator */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <osmocom/core/utils.h>
+
+#include "tetra_kernel.h"
+#include <tetra_common.h>
+#include <tetra_tdma.h>
+#include <tetra_mac_pdu.h>
+#include <tetra_llc_pdu.h>
+#include <tetra_mle_pdu.h>
+#include <tetra_cmce_pdu.h>
+#include <phy/tetra_burst.h>
+#include <phy/tetra_burst_sync.h>
+#include <phy/tetra_gen.h>
+#include <lower_mac/tetra_lower_mac.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/tetra_conv_enc.h>
+#include <lower_mac/viterbi.h>
+#include "testcheck.h"
+
+/* eight multiframes and a bit */
+#define NUM_BURSTS	(8 * TETRA_SLOTS_PER_MN + 24)
+
+void *tetra_tall_ctx;
+
+static struct tetra_gen tg;
+static uint8_t stream[NUM_BURSTS * TETRA_BITS_PER_TS];
+
+static struct {
+	unsigned int blocks, crc_err;
+	unsigned int sync, sync_err;
+	unsigned int sysinfo, sysinfo_err;
+	unsigned int aach, aach_err;
+	unsigned int cmce, null, pdu_err;
+} rx;
+
+/* the reverse of tetra_blk_encode(), returns the CRC */
+static uint16_t decode(enum tp_sap_data_type type, const uint8_t *bits, uint32_t scramb_init,
+		       uint8_t *type1)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+	uint8_t type4[512], type3[512], type3dp[512*4];
+
+	memcpy(type4, bits, tbp->type345_bits);
+	tetra_scramb_bits(scramb_init, type4, tbp->type345_bits);
+	if (!tbp->interleave_a) {
+		/* systematic code */
+		memcpy(type1, type4, tbp->type1_bits);
+		return TETRA_CRC_OK;
+	}
+
+	block_deinterleave(tbp->type345_bits, tbp->interleave_a, type4, type3);
+	memset(type3dp, 0xff, sizeof(type3dp));
+	tetra_rcpc_depunct(TETRA_RCPC_PUNCT_2_3, type3, tbp->type345_bits, type3dp);
+	viterbi_dec_sb1_wrapper(type3dp, type1, tbp->type2_bits);
+
+	return tetra_kern.crc16(0xffff, type1, tbp->type1_bits + 16);
+}
+
+static void check_sync(const uint8_t *b)
+{
+	uint32_t tn = bits_to_uint(b + 10, 2) + 1;
+	uint32_t fn = bits_to_uint(b + 12, 5);
+	uint32_t mn = bits_to_uint(b + 17, 6);
+
+	rx.sync++;
+	if (bits_to_uint(b + 4, 6) != tg.colour_code || bits_to_uint(b + 31, 10) != tg.mcc ||
+	    bits_to_uint(b + 41, 14) != tg.mnc || fn != 18 || tn != 4 - ((mn + 3) % 4))
+		rx.sync_err++;
+	/* the time for the following blocks */
+	t_phy_state.slot = (uint64_t) (mn - 1) * TETRA_SLOTS_PER_MN + (fn - 1) * TETRA_TN_PER_FN + tn - 1;
+}
+
+static void check_sysinfo(const uint8_t *b)
+{
+	struct tetra_si_decoded sid;
+
+	rx.sysinfo++;
+	macpdu_decode_sysinfo(&sid, b);
+	if (sid.main_carrier != TETRA_GEN_CARRIER || sid.freq_band != TETRA_GEN_BAND ||
+	    sid.mle_si.la != tg.la || sid.mle_si.bs_service_details != tg.bs_service_details)
+		rx.sysinfo_err++;
+}
+
+static void check_aach(const uint8_t *b)
+{
+	struct tetra_acc_ass_decoded aad;
+	int f18 = tetra_tdma_fn(t_phy_state.slot) == 18;
+
+	rx.aach++;
+	macpdu_decode_access_assign(&aad, b, f18);
+	if (f18) {
+		if (aad.hdr != TETRA_ACC_ASS_ULCO)
+			rx.aach_err++;
+	} else if (tetra_tdma_tn(t_phy_state.slot) == 1) {
+		if (aad.hdr != TETRA_ACC_ASS_DLCC_ULCO ||
+		    aad.access[0].base_frame_len != TETRA_ACC_BFL_4)
+			rx.aach_err++;
+	} else if (aad.hdr != TETRA_ACC_ASS_DLF1_ULF1 || aad.dl_usage != TETRA_DL_US_UNALLOC)
+		rx.aach_err++;
+}
+
+static void check_schf(uint8_t *b)
+{
+	struct tetra_resrc_decoded rsd;
+	struct tetra_llc_pdu lpp;
+	unsigned int len;
+	int hdr_len;
+
+	if (bits_to_uint(b, 2) != TETRA_PDU_T_MAC_RESOURCE) {
+		rx.pdu_err++;
+		return;
+	}
+	memset(&rsd, 0, sizeof(rsd));
+	hdr_len = macpdu_decode_resource(&rsd, b);
+	if (rsd.addr.type == ADDR_TYPE_NULL) {
+		rx.null++;
+		if (rsd.macpdu_length != 2)
+			rx.pdu_err++;
+		return;
+	}
+
+	rx.cmce++;
+	len = rsd.macpdu_length * 8;
+	if (rsd.addr.type != ADDR_TYPE_SSI || rsd.addr.ssi < tg.ssi_base ||
+	    rsd.addr.ssi >= tg.ssi_base + tg.num_ssi || tetra_tdma_tn(t_phy_state.slot) != 1 ||
+	    hdr_len <= 0 || len > 268 || len < hdr_len) {
+		rx.pdu_err++;
+		return;
+	}
+
+	memset(&lpp, 0, sizeof(lpp));
+	tetra_llc_pdu_parse(&lpp, b + hdr_len, len - hdr_len);
+	if ((lpp.pdu_type != TLLC_PDUT_DEC_BL_DATA && lpp.pdu_type != TLLC_PDUT_DEC_BL_UDATA) ||
+	    lpp.tl_sdu_len < 8 || bits_to_uint(lpp.tl_sdu, 3) != TMLE_PDISC_CMCE) {
+		rx.pdu_err++;
+		return;
+	}
+	switch (bits_to_uint(lpp.tl_sdu + 3, 5)) {
+	case TCMCE_PDU_T_D_SETUP:
+	case TCMCE_PDU_T_D_RELEASE:
+	case TCMCE_PDU_T_D_STATUS:
+	case TCMCE_PDU_T_D_SDS_DATA:
+		break;
+	default:
+		rx.pdu_err++;
+	}
+}
+
+/* instead of the lower MAC */
+void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits,
+		      const int8_t *soft, unsigned int len, void *priv)
+{
+	uint32_t scramb_init = tetra_scramb_get_init(tg.mcc, tg.mnc, tg.colour_code);
+	uint8_t type1[512];
+
+	if (type == TPSAP_T_SB1)
+		scramb_init = SCRAMB_INIT;
+
+	rx.blocks++;
+	if (decode(type, bits, scramb_init, type1) != TETRA_CRC_OK) {
+		rx.crc_err++;
+		return;
+	}
+
+	switch (type) {
+	case TPSAP_T_SB1:
+		check_sync(type1);
+		break;
+	case TPSAP_T_SB2:
+		check_sysinfo(type1);
+		break;
+	case TPSAP_T_BBK:
+		check_aach(type1);
+		break;
+	case TPSAP_T_SCH_F:
+		check_schf(type1);
+		break;
+	default:
+		rx.pdu_err++;
+		break;
+	}
+}
+
+static void test_stream(void)
+{
+	struct tetra_rx_state trs;
+	unsigned int i, pos, lost = 0, cmce_lost = 0;
+
+	tetra_gen_init(&tg, 42);
+	tg.load = 0.5f;
+	for (i = 0; i < NUM_BURSTS; i++) {
+		/* nothing is received before the first SYNC */
+		if (!tg.stats.sync) {
+			lost = i + 1;
+			cmce_lost = tg.stats.cmce;
+		}
+		tetra_gen_burst(&tg, stream + i * TETRA_BITS_PER_TS);
+	}
+
+	memset(&trs, 0, sizeof(trs));
+	/* the synchronizer locks on the first SYNC burst, but only passes
+	 * on the bursts after it */
+	t_phy_state.slot = lost - 1;
+	/* less than a burst at a time */
+	for (pos = 0; pos < sizeof(stream); pos += 100)
+		tetra_burst_sync_in(&trs, stream + pos, sizeof(stream) - pos < 100 ?
+				    sizeof(stream) - pos : 100);
+
+	printf("%u blocks, %u SYNC, %u SYSINFO, %u AACH, %u CMCE, %u Null\n",
+	       rx.blocks, rx.sync, rx.sysinfo, rx.aach, rx.cmce, rx.null);
+
+	/* one per multiframe */
+	check(tg.stats.bursts == NUM_BURSTS && tg.stats.sync == 8 &&
+	      tg.stats.sync + tg.stats.cmce + tg.stats.null == NUM_BURSTS, "burst types");
+	/* the last burst may still be in the synchronizer */
+	check(rx.blocks >= 2 * (NUM_BURSTS - lost - 1) && !rx.crc_err, "all blocks decode");
+	check(rx.sync + 1 == tg.stats.sync && !rx.sync_err, "SYNC");
+	check(rx.sysinfo + 1 == tg.stats.sync && !rx.sysinfo_err, "SYSINFO");
+	check(rx.aach + lost + 1 >= NUM_BURSTS && !rx.aach_err, "ACCESS-ASSIGN");
+	/* about half of the MCCH slots */
+	check(rx.cmce > NUM_BURSTS / 10 && rx.cmce + cmce_lost + 1 >= tg.stats.cmce && !rx.pdu_err,
+	      "MAC-RESOURCE, LLC and CMCE");
+}
+
+static void test_ber(void)
+{
+	uint8_t burst[TETRA_BITS_PER_TS];
+	unsigned int i;
+
+	tetra_gen_init(&tg, 7);
+	tg.ber = 1e-3;
+	for (i = 0; i < 2000; i++)
+		tetra_gen_burst(&tg, burst);
+	/* 1020 expected, 32 standard deviation */
+	printf("%llu bit errors\n", (unsigned long long) tg.stats.bit_errors);
+	check(tg.stats.bit_errors > 900 && tg.stats.bit_errors < 1140, "bit error rate");
+}
+
+static void test_symbols(void)
+{
+	uint8_t burst[TETRA_BITS_PER_TS], back[TETRA_BITS_PER_TS];
+	float sym[TETRA_SYM_PER_TS];
+
+	tetra_gen_init(&tg, 1);
+	tetra_gen_burst(&tg, burst);
+	tetra_gen_symbols(burst, TETRA_SYM_PER_TS, sym);
+	tetra_kern.slice(sym, TETRA_SYM_PER_TS, back);
+	check(!memcmp(burst, back, sizeof(burst)), "symbols slice back");
+}
+
+int main(int argc, char **argv)
+{
+	tetra_verbosity = TETRA_V_NONE;
+	tetra_kernel_init();
+
+	test_stream();
+	test_ber();
+	test_symbols();
+
+	check_exit();
+}
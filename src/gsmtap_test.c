@@ -0,0 +1,298 @@
+/* Test program for the batched GSMTAP output and its pcapng file */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <osmocom/core/bits.h>
+#include <osmocom/core/gsmtap.h>
+
+#include "tetra_common.h"
+#include "tetra_tdma.h"
+#include "tetra_gsmtap.h"
+#include "testcheck.h"
+
+#define NUM_MSGS	300	/* several batches */
+#define NUM_UDP_MSGS	100	/* fit the socket buffer of the receiver */
+#define SLOT0		1000
+#define T0_NS		1700000000000000000ULL
+
+static uint32_t get_u32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+	uint16_t v;
+
+	memcpy(&v, p, 2);
+	return v;
+}
+
+/* the content of message 'i' */
+static unsigned int msg_bits(unsigned int i, ubit_t *bits)
+{
+	unsigned int j, len = 60 + i % 200;
+
+	for (j = 0; j < len; j++)
+		bits[j] = ((i * 7 + j * 13) >> 2) & 1;
+	return len;
+}
+
+/* message 'i' is sent in slot SLOT0 + i */
+static void queue_msgs(unsigned int first, unsigned int num)
+{
+	ubit_t bits[432];
+	unsigned int i, len;
+
+	for (i = first; i < first + num; i++) {
+		len = msg_bits(i, bits);
+		tetra_gsmtap_enqueue(SLOT0 + i, i & 1 ? TETRA_LC_SCH_HD : TETRA_LC_BSCH,
+				     tetra_tdma_tn(SLOT0 + i), i & 1, -50, 10, bits, len);
+	}
+}
+
+static uint8_t *read_file(const char *path, long *len)
+{
+	uint8_t *buf;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	*len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buf = malloc(*len + 1);
+	if (fread(buf, 1, *len, f) != *len)
+		*len = 0;
+	fclose(f);
+
+	return buf;
+}
+
+/* the GSMTAP header and payload of message 'i' */
+static int check_gsmtap(const uint8_t *p, unsigned int len, unsigned int i)
+{
+	const struct gsmtap_hdr *gh = (const struct gsmtap_hdr *)p;
+	uint64_t slot = SLOT0 + i;
+	ubit_t bits[432];
+	uint8_t data[64];
+	unsigned int data_len;
+
+	data_len = osmo_ubit2pbit(data, bits, msg_bits(i, bits));
+	if (len != sizeof(*gh) + data_len)
+		return 0;
+	if (gh->version != GSMTAP_VERSION || gh->type != GSMTAP_TYPE_TETRA_I1 ||
+	    gh->sub_type != (i & 1 ? GSMTAP_TETRA_SCH_HD : GSMTAP_TETRA_BSCH) ||
+	    gh->timeslot != tetra_tdma_tn(slot) || gh->sub_slot != (i & 1) ||
+	    ntohl(gh->frame_number) != tetra_tdma_slot2gsmtap_fn(slot))
+		return 0;
+
+	return !memcmp(p + sizeof(*gh), data, data_len);
+}
+
+/* IPv4/UDP/GSMTAP in an enhanced packet block of 'len' bytes */
+static int check_epb(const uint8_t *p, uint32_t len, unsigned int i)
+{
+	uint64_t slot = SLOT0 + i, ts;
+	ubit_t bits[432];
+	uint8_t data[64];
+	unsigned int pkt_len, data_len, j;
+	uint32_t sum = 0;
+
+	data_len = osmo_ubit2pbit(data, bits, msg_bits(i, bits));
+	pkt_len = 20 + 8 + sizeof(struct gsmtap_hdr) + data_len;
+	ts = ((uint64_t)get_u32(p + 12) << 32) | get_u32(p + 16);
+
+	if (get_u32(p) != 0x00000006 || len != 28 + ((pkt_len + 3) & ~3) + 4 ||
+	    get_u32(p + len - 4) != len || get_u32(p + 8) != 0 ||
+	    get_u32(p + 20) != pkt_len || get_u32(p + 24) != pkt_len)
+		return 0;
+	if (ts != tetra_tdma_slot2ns(&t_phy_state.clock, slot))
+		return 0;
+	p += 28;
+
+	/* IPv4 from and to 127.0.0.1, with a good header checksum */
+	for (j = 0; j < 20; j += 2)
+		sum += (p[j] << 8) | p[j+1];
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	if (p[0] != 0x45 || ((p[2] << 8) | p[3]) != pkt_len || p[9] != 17 ||
+	    sum != 0xffff || get_u32(p + 12) != htonl(0x7f000001) ||
+	    get_u32(p + 16) != htonl(0x7f000001))
+		return 0;
+	p += 20;
+
+	if (ntohs(get_u16(p + 2)) != GSMTAP_UDP_PORT ||
+	    ntohs(get_u16(p + 4)) != pkt_len - 20)
+		return 0;
+	p += 8;
+
+	return check_gsmtap(p, pkt_len - 28, i);
+}
+
+static void test_pcapng(const char *path)
+{
+	struct tetra_gsmtap_stats st;
+	unsigned int i, good = 0;
+	const uint8_t *p;
+	uint8_t *buf;
+	long len;
+
+	check(tetra_gsmtap_file_init(path, 0) == 0, "open pcapng file");
+	queue_msgs(0, NUM_MSGS);
+	tetra_gsmtap_exit(&st);
+	check(st.queued == NUM_MSGS && st.written == NUM_MSGS && st.write_err == 0 &&
+	      st.files == 1, "messages written");
+
+	buf = read_file(path, &len);
+	check(buf && len > 28 + 32, "read back");
+	if (!buf || len <= 28 + 32)
+		return;
+	p = buf;
+
+	check(get_u32(p) == 0x0A0D0D0A && get_u32(p + 4) == 28 &&
+	      get_u32(p + 8) == 0x1A2B3C4D && get_u16(p + 12) == 1 &&
+	      get_u32(p + 24) == 28, "section header block");
+	p += 28;
+
+	/* raw IP, nanosecond timestamps */
+	check(get_u32(p) == 0x00000001 && get_u32(p + 4) == 32 && get_u16(p + 8) == 101 &&
+	      get_u16(p + 16) == 9 && get_u16(p + 18) == 1 && p[20] == 9 &&
+	      get_u32(p + 28) == 32, "interface description block");
+	p += 32;
+
+	for (i = 0; p + 32 <= buf + len && i < NUM_MSGS; i++) {
+		uint32_t blk_len = get_u32(p + 4);
+
+		if (p + blk_len > buf + len)
+			break;
+		good += check_epb(p, blk_len, i);
+		p += blk_len;
+	}
+	check(good == NUM_MSGS && p == buf + len, "enhanced packet blocks in order");
+
+	free(buf);
+}
+
+/* nothing can be written to /dev/full: all messages are lost, and counted */
+static void test_write_err(void)
+{
+	struct tetra_gsmtap_stats st, st0;
+
+	tetra_gsmtap_exit(&st0);
+	if (tetra_gsmtap_file_init("/dev/full", 0) < 0) {
+		printf("no /dev/full, skipped\n");
+		return;
+	}
+	queue_msgs(0, NUM_MSGS);
+	tetra_gsmtap_exit(&st);
+	check(st.written == st0.written && st.write_err - st0.write_err == NUM_MSGS,
+	      "write errors counted");
+}
+
+/* receive messages first ... first + num - 1, in order */
+static int recv_msgs(int fd, unsigned int first, unsigned int num)
+{
+	uint8_t buf[256];
+	unsigned int i, good = 0;
+	ssize_t rc;
+
+	for (i = first; i < first + num; i++) {
+		rc = recv(fd, buf, sizeof(buf), 0);
+		if (rc < 0)
+			break;
+		good += check_gsmtap(buf, rc, i);
+	}
+
+	return good;
+}
+
+static void test_udp(void)
+{
+	struct sockaddr_in sin = { .sin_family = AF_INET };
+	socklen_t sin_len = sizeof(sin);
+	struct timeval tv = { .tv_sec = 1 };
+	struct tetra_gsmtap_stats st, st0;
+	int fd;
+
+	tetra_gsmtap_exit(&st0);
+	sin.sin_addr.s_addr = htonl(0x7f000001);
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0 || bind(fd, (struct sockaddr *)&sin, sizeof(sin)) < 0 ||
+	    getsockname(fd, (struct sockaddr *)&sin, &sin_len) < 0) {
+		printf("no UDP socket, skipped\n");
+		return;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	check(tetra_gsmtap_init("127.0.0.1", ntohs(sin.sin_port)) == 0, "open UDP sink");
+
+	/* less than a batch within one TDMA frame, and then no more input:
+	 * the sender has to publish them on its own */
+	queue_msgs(0, 3);
+	check(recv_msgs(fd, 0, 3) == 3, "timed flush");
+
+	/* a batch per TDMA frame, in order */
+	queue_msgs(3, NUM_UDP_MSGS - 3);
+	check(recv_msgs(fd, 3, NUM_UDP_MSGS - 3) == NUM_UDP_MSGS - 3,
+	      "messages sent in order");
+
+	tetra_gsmtap_exit(&st);
+	check(st.sent - st0.sent == NUM_UDP_MSGS && st.send_err == st0.send_err &&
+	      st.syscalls - st0.syscalls < NUM_UDP_MSGS / 2, "sent in batches");
+	close(fd);
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/gsmtap_test.XXXXXX";
+	int fd;
+
+	tetra_verbosity = TETRA_V_NONE;
+	fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		exit(1);
+	}
+	close(fd);
+
+	t_phy_state.clock.valid = 1;
+	t_phy_state.clock.slot = SLOT0;
+	t_phy_state.clock.ns = T0_NS;
+
+	test_pcapng(path);
+	unlink(path);
+	test_write_err();
+	test_udp();
+
+	check_exit();
+}
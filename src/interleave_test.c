@@ -0,0 +1,200 @@
+/* Test program for the interleaving / bit reordering permutations */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/tch_reordering.h>
+#include "testcheck.h"
+
+#define ACELP_T2_BITS	(2*TETRA_ACELP_FRAME_BITS)
+#define BENCH_ITER	200000
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* EN 300 395-2 5.5.3: write line by line, read column by column */
+static void test_matrix(void)
+{
+	static const uint8_t in[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+	static const uint8_t ref[12] = { 0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11 };
+	uint8_t out[12], back[12];
+	uint16_t tbl[12];
+
+	matrix_interleave(3, 4, in, out);
+	check(!memcmp(out, ref, sizeof(ref)), "matrix_interleave(3,4) reference");
+	matrix_deinterleave(3, 4, out, back);
+	check(!memcmp(back, in, sizeof(in)), "matrix_deinterleave(3,4) reference");
+
+	matrix_interl_table(3, 4, tbl);
+	tetra_perm_gather(tbl, 12, in, out);
+	check(!memcmp(out, ref, sizeof(ref)), "matrix_interl_table(3,4) gather");
+	matrix_deinterl_table(3, 4, tbl);
+	tetra_perm_gather(tbl, 12, ref, back);
+	check(!memcmp(back, in, sizeof(in)), "matrix_deinterl_table(3,4) gather");
+}
+
+static void test_block(uint32_t K, uint32_t a)
+{
+	uint8_t in[512], out_ref[512], out[512];
+	uint16_t tbl[512];
+	char name[64];
+	int i;
+
+	for (i = 0; i < K; i++)
+		in[i] = rand() & 1;
+
+	block_deinterleave(K, a, in, out_ref);
+	block_deinterl_table(K, a, tbl);
+	tetra_perm_gather(tbl, K, in, out);
+
+	snprintf(name, sizeof(name), "block_deinterl_table(%u,%u)", K, a);
+	check(!memcmp(out, out_ref, K), name);
+}
+
+static void test_acelp(void)
+{
+	uint8_t in[ACELP_T2_BITS], out[ACELP_T2_BITS], back[ACELP_T2_BITS];
+	uint8_t seen[ACELP_T2_BITS];
+	int i, ok = 1;
+
+	/* single-bit probes: type-2 bit -> (frame, 1-based codec position) */
+	static const struct { uint16_t t2; uint16_t codec; } probes[] = {
+		{ 0,	34 },				/* class 0, first bit, frame 1 */
+		{ 1,	TETRA_ACELP_FRAME_BITS + 34 },	/* class 0, first bit, frame 2 */
+		{ 16,	42 },				/* class 0, position 43 */
+		{ 30,	63 },				/* class 0, position 64 */
+		{ 101,	TETRA_ACELP_FRAME_BITS + 136 },	/* class 0, last bit, frame 2 */
+		{ 102,	57 },				/* class 1, first bit */
+		{ 214,	17 },				/* class 2, first bit */
+		{ 273,	TETRA_ACELP_FRAME_BITS + 131 },	/* class 2, last bit, frame 2 */
+	};
+
+	for (i = 0; i < sizeof(probes)/sizeof(probes[0]); i++) {
+		memset(in, 0, sizeof(in));
+		in[probes[i].t2] = 1;
+		tetra_acelp_type2_to_codec(in, out);
+		if (out[probes[i].codec] != 1) {
+			printf("type2 bit %u not at codec bit %u\n",
+				probes[i].t2, probes[i].codec);
+			ok = 0;
+		}
+	}
+	check(ok, "tetra_acelp_type2_to_codec reference vectors");
+
+	/* every codec bit has to be hit exactly once */
+	memset(seen, 0, sizeof(seen));
+	for (i = 0; i < ACELP_T2_BITS; i++) {
+		int j;
+		memset(in, 0, sizeof(in));
+		in[i] = 1;
+		tetra_acelp_type2_to_codec(in, out);
+		for (j = 0; j < ACELP_T2_BITS; j++)
+			seen[j] += out[j];
+	}
+	for (i = 0; i < ACELP_T2_BITS; i++)
+		if (seen[i] != 1)
+			ok = 0;
+	check(ok, "tetra_acelp_type2_to_codec is a permutation");
+
+	for (i = 0; i < ACELP_T2_BITS; i++)
+		in[i] = rand() & 1;
+	tetra_acelp_type2_to_codec(in, out);
+	tetra_acelp_codec_to_acelp(out, back);
+	check(!memcmp(in, back, sizeof(in)), "tetra_acelp_codec_to_acelp inverse");
+}
+
+static void bench(void)
+{
+	uint8_t in[512], out[512];
+	uint16_t tbl[512];
+	double t0, t1;
+	int i;
+
+	for (i = 0; i < sizeof(in); i++)
+		in[i] = rand() & 1;
+
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++) {
+		block_deinterleave(432, 103, in, out);
+		in[i % 432] ^= out[0];
+	}
+	t1 = now_ns();
+	printf("block_deinterleave(432,103):\t%8.1f ns/block\n", (t1-t0)/BENCH_ITER);
+
+	block_deinterl_table(432, 103, tbl);
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++) {
+		tetra_perm_gather(tbl, 432, in, out);
+		in[i % 432] ^= out[0];
+	}
+	t1 = now_ns();
+	printf("gather (432,103):\t\t%8.1f ns/block\n", (t1-t0)/BENCH_ITER);
+
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++) {
+		matrix_interleave(24, 18, in, out);
+		in[i % 432] ^= out[0];
+	}
+	t1 = now_ns();
+	printf("matrix_interleave(24,18):\t%8.1f ns/block\n", (t1-t0)/BENCH_ITER);
+
+	matrix_interl_table(24, 18, tbl);
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++) {
+		tetra_perm_gather(tbl, 432, in, out);
+		in[i % 432] ^= out[0];
+	}
+	t1 = now_ns();
+	printf("gather (24,18):\t\t\t%8.1f ns/block\n", (t1-t0)/BENCH_ITER);
+
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++) {
+		tetra_acelp_type2_to_codec(in, out);
+		in[i % ACELP_T2_BITS] ^= out[0];
+	}
+	t1 = now_ns();
+	printf("tetra_acelp_type2_to_codec:\t%8.1f ns/frame\n", (t1-t0)/BENCH_ITER);
+}
+
+int main(int argc, char **argv)
+{
+	srand(time(NULL));
+
+	test_matrix();
+	test_block(120, 11);
+	test_block(216, 101);
+	test_block(168, 13);
+	test_block(432, 103);
+	test_acelp();
+
+	if (argc > 1 && !strcmp(argv[1], "-b"))
+		bench();
+
+	check_exit();
+}
@@ -0,0 +1,252 @@
+/* Test program for the IQ file reader */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <complex.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/utils.h>
+
+#include "tetra_kernel.h"
+#include <phy/tetra_iq.h>
+#include "testcheck.h"
+
+/* not a multiple of TETRA_IQ_BLK */
+#define NUM_SAMPLES	(3 * TETRA_IQ_BLK + 123)
+
+void *tetra_tall_ctx;
+
+static uint8_t raw[NUM_SAMPLES * 8];
+static float complex ref[NUM_SAMPLES];
+static float complex got[NUM_SAMPLES];
+
+/* a tone at amplitude 0.5 plus a DC offset of 'dc', in 'fmt' */
+static void make_tone(enum tetra_iq_fmt fmt, float complex dc)
+{
+	unsigned int i, j;
+
+	for (i = 0; i < NUM_SAMPLES; i++) {
+		float complex v = 0.5f * cexpf(I * 0.1f * i) + dc;
+		float x[2] = { crealf(v), cimagf(v) };
+
+		for (j = 0; j < 2; j++) {
+			switch (fmt) {
+			case TETRA_IQ_CU8:
+				raw[2*i+j] = lroundf(x[j] * 128 + 127.5f);
+				x[j] = ((float) raw[2*i+j] - 127.5f) / 128;
+				break;
+			case TETRA_IQ_CS8:
+				((int8_t *) raw)[2*i+j] = lroundf(x[j] * 127);
+				x[j] = ((int8_t *) raw)[2*i+j] / 128.0f;
+				break;
+			case TETRA_IQ_CS16:
+				((int16_t *) raw)[2*i+j] = lroundf(x[j] * 32767);
+				x[j] = ((int16_t *) raw)[2*i+j] / 32768.0f;
+				break;
+			case TETRA_IQ_CF32:
+				((float *) raw)[2*i+j] = x[j];
+				break;
+			}
+		}
+		ref[i] = x[0] + I * x[1];
+	}
+}
+
+static void write_file(const char *path, unsigned int len)
+{
+	FILE *f = fopen(path, "w");
+
+	fwrite(raw, len, 1, f);
+	fclose(f);
+}
+
+/* all of 'path' into got[], returns the number of samples */
+static unsigned int read_all(const char *path, enum tetra_iq_fmt fmt, int dc_block)
+{
+	const float complex *in;
+	struct tetra_iq *iq;
+	unsigned int num = 0;
+	int n;
+
+	iq = tetra_iq_open(NULL, path, fmt, dc_block);
+	if (!iq)
+		return 0;
+	while ((n = tetra_iq_read(iq, &in)) > 0) {
+		if (n > TETRA_IQ_BLK || num + n > NUM_SAMPLES)
+			break;
+		memcpy(got + num, in, n * sizeof(*in));
+		num += n;
+	}
+	tetra_iq_close(iq);
+
+	return num;
+}
+
+static float max_err(unsigned int from, float complex dc)
+{
+	float err = 0;
+	unsigned int i;
+
+	for (i = from; i < NUM_SAMPLES; i++) {
+		float e = cabsf(got[i] - (ref[i] - dc));
+
+		if (e > err)
+			err = e;
+	}
+	return err;
+}
+
+static void test_formats(const char *path)
+{
+	enum tetra_iq_fmt fmt;
+	char what[64];
+
+	for (fmt = TETRA_IQ_CU8; fmt <= TETRA_IQ_CF32; fmt++) {
+		unsigned int size = tetra_iq_sample_size(fmt);
+		unsigned int num;
+
+		make_tone(fmt, 0);
+		/* and half a sample at the end */
+		write_file(path, NUM_SAMPLES * size + size / 2);
+		num = read_all(path, fmt, 0);
+		snprintf(what, sizeof(what), "%s conversion", get_value_string(tetra_iq_fmt_names, fmt));
+		check(num == NUM_SAMPLES && max_err(0, 0) < 1e-6f, what);
+	}
+}
+
+static void test_dc(const char *path)
+{
+	const float complex dc = 0.1f - 0.05f * I;
+	unsigned int num;
+
+	make_tone(TETRA_IQ_CS16, dc);
+	write_file(path, NUM_SAMPLES * 4);
+
+	num = read_all(path, TETRA_IQ_CS16, 0);
+	check(num == NUM_SAMPLES && max_err(0, 0) < 1e-6f, "DC kept");
+	num = read_all(path, TETRA_IQ_CS16, 1);
+	/* the tone averages out over a block, to within a few 1e-3 */
+	check(num == NUM_SAMPLES && max_err(0, dc) < 5e-3f, "DC removed");
+}
+
+/* tetra_iq_pack() undoes the conversion, but for clipping */
+static void test_pack(const char *path)
+{
+	enum tetra_iq_fmt fmt;
+	char what[64];
+
+	for (fmt = TETRA_IQ_CU8; fmt <= TETRA_IQ_CF32; fmt++) {
+		unsigned int num;
+
+		make_tone(fmt, 0);
+		memcpy(got, ref, sizeof(ref));
+		tetra_iq_pack(fmt, got, NUM_SAMPLES, raw);
+		write_file(path, NUM_SAMPLES * tetra_iq_sample_size(fmt));
+		num = read_all(path, fmt, 0);
+		snprintf(what, sizeof(what), "%s packing", get_value_string(tetra_iq_fmt_names, fmt));
+		check(num == NUM_SAMPLES && max_err(0, 0) < 1e-6f, what);
+	}
+
+	got[0] = 2 - 2 * I;
+	tetra_iq_pack(TETRA_IQ_CS16, got, 1, raw);
+	check(((int16_t *) raw)[0] == 32767 && ((int16_t *) raw)[1] == -32768, "clipping");
+}
+
+/* the same input through a pipe, written in uneven pieces */
+static void test_pipe(const char *path)
+{
+	static float complex expect[NUM_SAMPLES];
+	const unsigned int size = tetra_iq_sample_size(TETRA_IQ_CU8);
+	unsigned int num;
+	pid_t pid;
+
+	make_tone(TETRA_IQ_CU8, 0.02f);
+	unlink(path);
+	if (mkfifo(path, 0600) < 0) {
+		check(0, "mkfifo");
+		return;
+	}
+
+	pid = fork();
+	if (pid == 0) {
+		FILE *f = fopen(path, "w");
+		unsigned int pos = 0;
+
+		while (pos < NUM_SAMPLES * size) {
+			unsigned int len = 1 + rand() % 3000;
+
+			if (len > NUM_SAMPLES * size - pos)
+				len = NUM_SAMPLES * size - pos;
+			fwrite(raw + pos, len, 1, f);
+			fflush(f);
+			pos += len;
+		}
+		fclose(f);
+		_exit(0);
+	}
+
+	num = read_all(path, TETRA_IQ_CU8, 1);
+	waitpid(pid, NULL, 0);
+	memcpy(expect, got, sizeof(got));
+	unlink(path);
+
+	/* exactly as from the file */
+	write_file(path, NUM_SAMPLES * size);
+	check(num == NUM_SAMPLES && read_all(path, TETRA_IQ_CU8, 1) == NUM_SAMPLES &&
+	      !memcmp(expect, got, sizeof(got)), "pipe");
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/iq_test.XXXXXX";
+	int fd;
+
+	srand(42);
+	tetra_kernel_init();
+
+	check(tetra_iq_fmt_parse("cu8") == TETRA_IQ_CU8 &&
+	      tetra_iq_fmt_parse("cf32") == TETRA_IQ_CF32 &&
+	      tetra_iq_fmt_parse("cu16") == -EINVAL, "format names");
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		exit(1);
+	}
+	close(fd);
+
+	check(!tetra_iq_open(NULL, "/nonexistent", TETRA_IQ_CU8, 0) && errno == ENOENT,
+	      "missing file");
+	test_formats(path);
+	test_dc(path);
+	test_pack(path);
+	test_pipe(path);
+	unlink(path);
+
+	check_exit();
+}
@@ -0,0 +1,152 @@
+/* Test program for the CPU specific kernels */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "tetra_common.h"
+#include "tetra_kernel.h"
+#include <phy/tetra_burst.h>
+#include <lower_mac/crc_simple.h>
+#include <lower_mac/tetra_conv_enc.h>
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/viterbi_cch.h>
+
+#define BENCH_ITER	20000
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* encode random SCH/F type-2 bits and make sure the selected Viterbi
+ * decoder gets them back, also with some bits erased */
+static int test_viterbi_roundtrip(void)
+{
+	struct conv_enc_state ces;
+	uint8_t type2[288], type3[288*4], out[288];
+	int8_t soft[288*4];
+	int i;
+
+	for (i = 0; i < 284; i++)
+		type2[i] = rand() & 1;
+	memset(type2 + 284, 0, 4);
+
+	conv_enc_init(&ces);
+	conv_enc_input(&ces, type2, 288, type3);
+
+	for (i = 0; i < 288*4; i++) {
+		if (i % 3 == 2)
+			soft[i] = 0;
+		else
+			soft[i] = type3[i] ? -127 : 127;
+	}
+
+	tetra_kern.viterbi_cch(soft, out, 288);
+
+	return memcmp(out, type2, 288) ? -1 : 0;
+}
+
+static void bench(void)
+{
+	static uint8_t bits[1024], out[1024];
+	static int8_t soft[288*4];
+	uint16_t tbl[432];
+	double t0, t_vit, t_find, t_crc, t_scr, t_gat;
+	int i;
+
+	for (i = 0; i < sizeof(bits); i++)
+		bits[i] = rand() & 1;
+	for (i = 0; i < sizeof(soft); i++)
+		soft[i] = (rand() % 255) - 127;
+	block_deinterl_table(432, 103, tbl);
+
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++)
+		tetra_kern.viterbi_cch(soft, out, 288);
+	t_vit = (now_ns() - t0) / BENCH_ITER;
+
+	/* training sequence search over two timeslots */
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++)
+		tetra_kern.find_seq(bits, TETRA_BITS_PER_TS*2, bits + 900, 38);
+	t_find = (now_ns() - t0) / BENCH_ITER;
+
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++)
+		tetra_kern.crc16(0xffff, bits, 284);
+	t_crc = (now_ns() - t0) / BENCH_ITER;
+
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++)
+		tetra_kern.scramb(i, bits, 432);
+	t_scr = (now_ns() - t0) / BENCH_ITER;
+
+	t0 = now_ns();
+	for (i = 0; i < BENCH_ITER; i++)
+		tetra_kern.gather(tbl, 432, bits, out);
+	t_gat = (now_ns() - t0) / BENCH_ITER;
+
+	printf("%-8s viterbi %8.1f  find_seq %7.1f  crc16 %7.1f  scramb %7.1f  gather %7.1f ns\n",
+		tetra_kernel_isa_name(tetra_kernel_isa()),
+		t_vit, t_find, t_crc, t_scr, t_gat);
+}
+
+int main(int argc, char **argv)
+{
+	enum tetra_kernel_isa isa, max = tetra_kernel_cpu_isa();
+	int do_bench = argc > 1 && !strcmp(argv[1], "-b");
+	int num_err = 0;
+
+	srand(time(NULL));
+
+	for (isa = TETRA_ISA_SCALAR; isa <= max; isa++) {
+		int err;
+
+		if (tetra_kernel_select(isa) < 0) {
+			printf("%s: cannot select\n", tetra_kernel_isa_name(isa));
+			num_err++;
+			continue;
+		}
+		err = tetra_kernel_selftest();
+		if (test_viterbi_roundtrip() < 0) {
+			printf("%s: viterbi round trip FAILED\n", tetra_kernel_isa_name(isa));
+			err++;
+		}
+		printf("%s: %s\n", tetra_kernel_isa_name(isa), err ? "FAILED" : "OK");
+		num_err += err;
+
+		if (do_bench)
+			bench();
+	}
+
+	isa = tetra_kernel_init();
+	printf("selected: %s\n", tetra_kernel_isa_name(isa));
+
+	printf("total number of errors: %u\n", num_err);
+
+	exit(num_err ? 1 : 0);
+}
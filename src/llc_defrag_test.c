@@ -0,0 +1,218 @@
+/* Test program for the LLC defragmenter */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <osmocom/core/msgb.h>
+
+#include "tetra_llc_pdu.h"
+#include <lower_mac/crc_simple.h>
+#include "testcheck.h"
+
+static uint8_t seg_bits[TLLC_DEFRAG_MAX_BITS];
+
+static int seg_in(struct tllc_state *llcs, uint32_t addr, unsigned int ns,
+		  unsigned int ss, unsigned int len, uint32_t ts)
+{
+	struct tetra_llc_pdu lpp;
+
+	memset(&lpp, 0, sizeof(lpp));
+	lpp.ns = ns;
+	lpp.ss = ss;
+	lpp.tl_sdu = seg_bits + ss * len;
+	lpp.tl_sdu_len = len;
+
+	return tllc_defrag_in(llcs, addr, &lpp, ts);
+}
+
+static struct msgb *seg_out(struct tllc_state *llcs, uint32_t addr, unsigned int ns)
+{
+	struct tetra_llc_pdu lpp;
+
+	memset(&lpp, 0, sizeof(lpp));
+	lpp.ns = ns;
+
+	return tllc_defrag_out(llcs, addr, &lpp);
+}
+
+static void test_complete(struct tllc_state *llcs)
+{
+	struct msgb *msg;
+	int i;
+
+	/* two interleaved SDUs of different MSs with the same N(S) */
+	for (i = 0; i < 4; i++) {
+		seg_in(llcs, 1001, 3, i, 100, i);
+		seg_in(llcs, 1002, 3, i, 100, i);
+	}
+	msg = seg_out(llcs, 1001, 3);
+	check(msg && msgb_l3len(msg) == 400 && !memcmp(msg->l3h, seg_bits, 400),
+		"reassembly");
+	if (msg)
+		msgb_free(msg);
+	msg = seg_out(llcs, 1002, 3);
+	check(msg && msgb_l3len(msg) == 400, "reassembly of second MS");
+	if (msg)
+		msgb_free(msg);
+	check(llcs->rx.stats.completed == 2, "completed counter");
+	check(llist_empty(&llcs->rx.lru) && llcs->rx.mem_used == 0, "slots released");
+}
+
+static void test_dup(struct tllc_state *llcs)
+{
+	struct msgb *msg;
+
+	/* segment 1 sent twice, then the rest */
+	seg_in(llcs, 1, 5, 0, 100, 0);
+	seg_in(llcs, 1, 5, 1, 100, 1);
+	check(seg_in(llcs, 1, 5, 1, 100, 2) == 0, "repeated segment accepted");
+	seg_in(llcs, 1, 5, 2, 100, 3);
+	msg = seg_out(llcs, 1, 5);
+	check(msg && msgb_l3len(msg) == 300 && !memcmp(msg->l3h, seg_bits, 300),
+		"reassembly kept");
+	if (msg)
+		msgb_free(msg);
+
+	/* a repeated first segment */
+	seg_in(llcs, 1, 6, 0, 100, 0);
+	seg_in(llcs, 1, 6, 0, 100, 1);
+	seg_in(llcs, 1, 6, 1, 100, 2);
+	msg = seg_out(llcs, 1, 6);
+	check(msg && msgb_l3len(msg) == 200, "repeated first segment");
+	if (msg)
+		msgb_free(msg);
+	check(llcs->rx.stats.dup == 2 && llcs->rx.stats.missed == 0, "dup counter");
+}
+
+static void test_fcs(struct tllc_state *llcs)
+{
+	struct tetra_llc_pdu lpp;
+	struct msgb *msg;
+	int i;
+
+	/* the FCS of an AL-FINAL covers the whole TL-SDU */
+	for (i = 0; i < 3; i++)
+		seg_in(llcs, 1, 4, i, 100, i);
+	memset(&lpp, 0, sizeof(lpp));
+	lpp.ns = 4;
+	lpp.have_fcs = 1;
+	lpp._fcs = ~crc32_bits(0xffffffff, seg_bits, 300);
+	lpp.fcs = &lpp._fcs;
+	msg = tllc_defrag_out(llcs, 1, &lpp);
+	check(msg != NULL, "reassembly with good FCS");
+	if (msg)
+		msgb_free(msg);
+
+	for (i = 0; i < 3; i++)
+		seg_in(llcs, 1, 4, i, 100, i);
+	lpp._fcs ^= 1;
+	check(tllc_defrag_out(llcs, 1, &lpp) == NULL && llcs->rx.stats.fcs_err == 1,
+		"reassembly with bad FCS dropped");
+	check(llist_empty(&llcs->rx.lru), "slots released");
+}
+
+static void test_errors(struct tllc_state *llcs)
+{
+	/* FINAL without anything before it */
+	check(seg_out(llcs, 1, 0) == NULL, "FINAL without segments");
+
+	/* gap in S(S) */
+	seg_in(llcs, 1, 1, 0, 100, 0);
+	check(seg_in(llcs, 1, 1, 2, 100, 1) < 0, "gap in S(S) detected");
+	check(seg_out(llcs, 1, 1) == NULL, "no SDU after gap");
+	check(seg_in(llcs, 1, 1, 3, 100, 1) < 0, "segment without start");
+	check(llcs->rx.stats.missed == 2, "missed counter");
+
+	/* too long */
+	seg_in(llcs, 1, 2, 0, TLLC_DEFRAG_MAX_BITS / 2, 0);
+	seg_in(llcs, 1, 2, 1, TLLC_DEFRAG_MAX_BITS / 2, 0);
+	check(seg_in(llcs, 1, 2, 2, 1, 0) < 0 && llcs->rx.stats.overflow == 1,
+		"overflow");
+	check(llist_empty(&llcs->rx.lru) && llcs->rx.mem_used == 0, "slots released");
+}
+
+static void test_timeout(struct tllc_state *llcs)
+{
+	seg_in(llcs, 1, 0, 0, 100, 1000);
+	seg_in(llcs, 2, 0, 0, 100, 1100);
+	tllc_defrag_expire(llcs, 1000 + llcs->rx.timeout);
+	check(llcs->rx.stats.timed_out == 0, "no timeout yet");
+	tllc_defrag_expire(llcs, 1001 + llcs->rx.timeout);
+	check(llcs->rx.stats.timed_out == 1, "timeout of the oldest");
+	/* a new segment refreshes the entry */
+	seg_in(llcs, 2, 0, 1, 100, 1200);
+	tllc_defrag_expire(llcs, 1101 + llcs->rx.timeout);
+	check(llcs->rx.stats.timed_out == 1, "refreshed entry kept");
+	tllc_defrag_flush(llcs);
+
+	/* so does a repeated one, the older entry behind it still expires */
+	seg_in(llcs, 3, 0, 0, 100, 2000);
+	seg_in(llcs, 4, 0, 0, 100, 2010);
+	seg_in(llcs, 3, 0, 0, 100, 2020);
+	tllc_defrag_expire(llcs, 2011 + llcs->rx.timeout);
+	check(llcs->rx.stats.timed_out == 2 && seg_out(llcs, 4, 0) == NULL,
+	      "timeout behind a repeated segment");
+	tllc_defrag_flush(llcs);
+}
+
+static void test_evict(struct tllc_state *llcs)
+{
+	unsigned int i;
+
+	/* more concurrent reassemblies than slots */
+	for (i = 0; i < 4 * TLLC_DEFRAG_SLOTS; i++)
+		seg_in(llcs, 5000 + i, i & 7, 0, 100, i);
+	check(llcs->rx.stats.evicted > 0, "slot eviction");
+	check(llcs->rx.mem_used <= llcs->rx.mem_cap, "memory below cap");
+	tllc_defrag_flush(llcs);
+
+	/* memory cap: four buffers of 1024 bytes fit, the fifth evicts */
+	llcs->rx.stats.evicted = 0;
+	llcs->rx.mem_cap = 4 * 1024;
+	for (i = 0; i < 5; i++)
+		seg_in(llcs, 7000 + i, 0, 0, 1000, i);
+	check(llcs->rx.stats.evicted == 1 && llcs->rx.mem_used <= 4 * 1024,
+		"memory cap eviction");
+	check(seg_out(llcs, 7000, 0) == NULL, "least recently used evicted");
+	tllc_defrag_flush(llcs);
+	check(llcs->rx.mem_used == 0, "flush");
+}
+
+int main(int argc, char **argv)
+{
+	struct tllc_state llcs;
+	int i;
+
+	for (i = 0; i < sizeof(seg_bits); i++)
+		seg_bits[i] = rand() & 1;
+
+	tllc_defrag_init(&llcs);
+	test_complete(&llcs);
+	test_dup(&llcs);
+	test_fcs(&llcs);
+	test_errors(&llcs);
+	test_timeout(&llcs);
+	test_evict(&llcs);
+
+	check_exit();
+}
@@ -22,6 +22,8 @@
 #include <lower_mac/crc_simple.h>
 #include <stdio.h>
 
+#include "tetra_common.h"
+
 /**
  * X.25 rec 2.2.7.4 Frame Check Sequence. This should be
  * CRC ITU-T from the kernel or such.
@@ -100,7 +102,72 @@ uint16_t crc16_itut_poly(uint16_t crc, uint32_t poly, const uint8_t *input, int
 	return crc;
 }
 
+void crc16_itut_bits_bitsliced(uint16_t crc_init, const uint64_t *input,
+				int number_bits, uint64_t *crc)
+{
+	int i, k;
+
+	for (k = 0; k < 16; k++)
+		crc[k] = (crc_init >> k) & 1 ? ~0ULL : 0;
+
+	for (i = 0; i < number_bits; ++i) {
+		uint64_t fb = crc[15] ^ input[i];
+
+		for (k = 15; k > 0; k--)
+			crc[k] = crc[k-1];
+		/* GEN_POLY 0x1021 */
+		crc[12] ^= fb;
+		crc[5] ^= fb;
+		crc[0] = fb;
+	}
+}
+
 uint16_t crc16_ccitt_bits(uint8_t *bits, unsigned int len)
 {
 	return crc16_itut_bits(0xffff, bits, len);
 }
+
+/* EN 300 392-2 22.3.3.3: the LLC Frame Check Sequence is a CRC-32 with the
+ * generator polynomial of ISO/IEC 3309, processed MSB first */
+#define FCS_POLY 0x04C11DB7
+
+static uint32_t crc32_tbl[256];
+static int crc32_tbl_ready;
+
+static void crc32_init_tbl(void)
+{
+	uint32_t i, k, crc;
+
+	for (i = 0; i < 256; i++) {
+		crc = i << 24;
+		for (k = 0; k < 8; k++)
+			crc = (crc & 0x80000000) ? (crc << 1) ^ FCS_POLY : crc << 1;
+		crc32_tbl[i] = crc;
+	}
+	crc32_tbl_ready = 1;
+}
+
+uint32_t crc32_bits(uint32_t crc, const uint8_t *input, int number_bits)
+{
+	int i;
+
+	if (!crc32_tbl_ready)
+		crc32_init_tbl();
+
+	/* four bytes at a time, packed by bits_to_uint() */
+	for (i = 0; i + 32 <= number_bits; i += 32) {
+		uint32_t w = bits_to_uint(input + i, 32);
+
+		crc = (crc << 8) ^ crc32_tbl[(crc >> 24) ^ (w >> 24)];
+		crc = (crc << 8) ^ crc32_tbl[(crc >> 24) ^ ((w >> 16) & 0xff)];
+		crc = (crc << 8) ^ crc32_tbl[(crc >> 24) ^ ((w >> 8) & 0xff)];
+		crc = (crc << 8) ^ crc32_tbl[(crc >> 24) ^ (w & 0xff)];
+	}
+
+	for (; i < number_bits; i++) {
+		crc ^= (uint32_t)(input[i] & 1) << 31;
+		crc = (crc & 0x80000000) ? (crc << 1) ^ FCS_POLY : crc << 1;
+	}
+
+	return crc;
+}
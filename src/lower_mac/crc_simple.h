@@ -42,7 +42,21 @@ uint16_t crc16_itut_bytes(uint16_t crc,
 uint16_t crc16_itut_bits(uint16_t crc,
 			 const uint8_t *input, const int number_bits);
 
+/**
+ * Bitsliced variant of crc16_itut_bits() for up to 64 blocks at once.
+ * Bit n of input[i] is bit i of block n, bit n of crc[k] is bit k of
+ * the resulting CRC of block n.
+ */
+void crc16_itut_bits_bitsliced(uint16_t crc_init, const uint64_t *input,
+				int number_bits, uint64_t *crc);
 
 uint16_t crc16_ccitt_bits(uint8_t *bits, unsigned int len);
 
+/**
+ * Each byte contains one bit. Calculate the CRC-32 with the polynom
+ * 0x04C11DB7 (as used by the TETRA LLC FCS), high bits first and without
+ * any final inversion.
+ */
+uint32_t crc32_bits(uint32_t crc, const uint8_t *input, int number_bits);
+
 #endif
@@ -22,6 +22,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <lower_mac/tch_reordering.h>
+#include <lower_mac/tetra_interleave.h>
 
 /* EN 300 395-2 V1.3.1 Table 4 */
 
@@ -30,11 +32,11 @@
 static const uint8_t class0_positions[NUM_ACELP_CLASS0_BITS] = {
 	35, 36, 37,
 	38, 39, 40,
-	41, 42, 33,
+	41, 42, 43,
 	47, 48,
 	56,
 	61, 62, 63,
-	65, 66, 67,
+	64, 65, 66, 67,
 	68, 69, 70,
 	74, 75,
 	83,
@@ -89,52 +91,53 @@ static const uint8_t class2_positions[NUM_ACELP_CLASS2_BITS] = {
 
 #define NUM_ACELP_BITS	(NUM_ACELP_CLASS0_BITS+NUM_ACELP_CLASS1_BITS+NUM_ACELP_CLASS2_BITS)
 
-/* reorder the 432-bit incoming (decoded) type2 bits of a full-rate speech
- * frame in order to generate two consecutive 216-bit ACELP codec frames */
-void tetra_acelp_type2_to_codec(const uint8_t *in, uint8_t *out)
-{
-	int bit, frame;
-	const uint8_t *in_cur = in;
+/* Gather tables for the full two-frame reordering, built once from the
+ * per-class position tables above */
+static uint16_t type2_to_codec_tbl[2*NUM_ACELP_BITS];
+static uint16_t codec_to_type2_tbl[2*NUM_ACELP_BITS];
+static int reorder_tbl_init;
 
-	for (bit = 0; bit < NUM_ACELP_CLASS0_BITS; bit++) {
-		for (frame = 0; frame < 2; frame++) 
-			out[frame*NUM_ACELP_BITS + class0_positions[bit] - 1] = in_cur[2*bit + frame];
+static unsigned int fill_class(unsigned int t2, const uint8_t *pos, unsigned int num)
+{
+	unsigned int bit, frame;
+
+	for (bit = 0; bit < num; bit++) {
+		for (frame = 0; frame < 2; frame++) {
+			unsigned int codec = frame*NUM_ACELP_BITS + pos[bit] - 1;
+			type2_to_codec_tbl[codec] = t2;
+			codec_to_type2_tbl[t2] = codec;
+			t2++;
+		}
 	}
-	in_cur += 2*NUM_ACELP_CLASS0_BITS;
+	return t2;
+}
 
-	for (bit = 0; bit < NUM_ACELP_CLASS1_BITS; bit++) {
-		for (frame = 0; frame < 2; frame++) 
-			out[frame*NUM_ACELP_BITS + class1_positions[bit] - 1] = in_cur[2*bit + frame];
-	}
-	in_cur += 2*NUM_ACELP_CLASS1_BITS;
+void tetra_acelp_reorder_init(void)
+{
+	unsigned int t2 = 0;
 
-	for (bit = 0; bit < NUM_ACELP_CLASS2_BITS; bit++) {
-		for (frame = 0; frame < 2; frame++) 
-			out[frame*NUM_ACELP_BITS + class2_positions[bit] - 1] = in_cur[2*bit + frame];
-	}
+	if (reorder_tbl_init)
+		return;
 
-	/* FIXME: same for STCH use */
+	t2 = fill_class(t2, class0_positions, NUM_ACELP_CLASS0_BITS);
+	t2 = fill_class(t2, class1_positions, NUM_ACELP_CLASS1_BITS);
+	t2 = fill_class(t2, class2_positions, NUM_ACELP_CLASS2_BITS);
+
+	reorder_tbl_init = 1;
 }
 
-void tetra_acelp_codec_to_acelp(const uint8_t *in, uint8_t *out)
+/* reorder the 274 incoming (decoded) type2 bits of a full-rate speech
+ * frame in order to generate two consecutive 137-bit ACELP codec frames */
+void tetra_acelp_type2_to_codec(const uint8_t *in, uint8_t *out)
 {
-	int bit, frame;
-	uint8_t *out_cur = out;
-
-	for (bit = 0; bit < NUM_ACELP_CLASS0_BITS; bit++) {
-		for (frame = 0; frame < 2; frame++) 
-			out_cur[2*bit + frame] = in[frame*NUM_ACELP_BITS + class0_positions[bit] - 1];
-	}
-	out_cur += 2*NUM_ACELP_CLASS0_BITS;
+	tetra_acelp_reorder_init();
+	tetra_perm_gather(type2_to_codec_tbl, 2*NUM_ACELP_BITS, in, out);
 
-	for (bit = 0; bit < NUM_ACELP_CLASS1_BITS; bit++) {
-		for (frame = 0; frame < 2; frame++) 
-			out_cur[2*bit + frame] = in[frame*NUM_ACELP_BITS + class1_positions[bit] - 1];
-	}
-	out_cur += 2*NUM_ACELP_CLASS1_BITS;
+	/* FIXME: same for STCH use */
+}
 
-	for (bit = 0; bit < NUM_ACELP_CLASS2_BITS; bit++) {
-		for (frame = 0; frame < 2; frame++) 
-			out_cur[2*bit + frame] = in[frame*NUM_ACELP_BITS + class2_positions[bit] - 1];
-	}
+void tetra_acelp_codec_to_acelp(const uint8_t *in, uint8_t *out)
+{
+	tetra_acelp_reorder_init();
+	tetra_perm_gather(codec_to_type2_tbl, 2*NUM_ACELP_BITS, in, out);
 }
@@ -0,0 +1,18 @@
+#ifndef TCH_REORDERING_H
+#define TCH_REORDERING_H
+/* Bit re-ordering for TETRA ACELP speech codec, EN 300 395-2 Table 4 */
+
+#include <stdint.h>
+
+#define TETRA_ACELP_FRAME_BITS	137
+
+/* build the reordering tables; called implicitly on first use */
+void tetra_acelp_reorder_init(void);
+
+/* 2*137 type-2 bits of a full-rate speech frame -> two codec frames */
+void tetra_acelp_type2_to_codec(const uint8_t *in, uint8_t *out);
+
+/* two codec frames -> 2*137 type-2 bits of a full-rate speech frame */
+void tetra_acelp_codec_to_acelp(const uint8_t *in, uint8_t *out);
+
+#endif /* TCH_REORDERING_H */
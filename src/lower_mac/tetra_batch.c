@@ -0,0 +1,139 @@
+/* Bitsliced batch processing of many equal-length TETRA blocks */
+
+/* Up to 64 blocks are transposed so that word i holds bit i of every block,
+ * one block per bit lane.  Each LFSR or CRC step then is a single word
+ * operation for all 64 blocks. */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <lower_mac/crc_simple.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_rm3014.h>
+#include <lower_mac/tetra_batch.h>
+
+/* largest block we handle: SCH/F type-5 */
+#define BATCH_MAX_BITS	TETRA_BLK_MAX_BITS
+
+static void transpose_in(uint8_t * const *blk, unsigned int lanes,
+			 unsigned int bits, uint64_t *w)
+{
+	unsigned int l, i;
+
+	memset(w, 0, bits * sizeof(*w));
+	for (l = 0; l < lanes; l++) {
+		const uint8_t *cur = blk[l];
+		for (i = 0; i < bits; i++)
+			w[i] |= (uint64_t)(cur[i] & 1) << l;
+	}
+}
+
+static void transpose_out(const uint64_t *w, unsigned int lanes,
+			  unsigned int bits, uint8_t **blk)
+{
+	unsigned int l, i;
+
+	for (l = 0; l < lanes; l++) {
+		uint8_t *cur = blk[l];
+		for (i = 0; i < bits; i++)
+			cur[i] = (w[i] >> l) & 1;
+	}
+}
+
+int tetra_batch_scramb(const struct tetra_blk_param *tbp, uint8_t **blk,
+		       const uint32_t *lfsr_init, unsigned int num)
+{
+	uint64_t ks[BATCH_MAX_BITS];
+	unsigned int bits = tbp->type345_bits;
+	unsigned int n, l, i;
+
+	if (bits > BATCH_MAX_BITS)
+		return -EINVAL;
+
+	for (n = 0; n < num; n += TETRA_BATCH_LANES) {
+		unsigned int lanes = num - n;
+		if (lanes > TETRA_BATCH_LANES)
+			lanes = TETRA_BATCH_LANES;
+
+		tetra_scramb_get_bits_bitsliced(lfsr_init + n, lanes, ks, bits);
+
+		for (l = 0; l < lanes; l++) {
+			uint8_t *cur = blk[n + l];
+			for (i = 0; i < bits; i++)
+				cur[i] ^= (ks[i] >> l) & 1;
+		}
+	}
+
+	return 0;
+}
+
+int tetra_batch_crc16(const struct tetra_blk_param *tbp, uint8_t * const *type2,
+		      unsigned int num, uint16_t *crc)
+{
+	uint64_t w[BATCH_MAX_BITS];
+	uint64_t crc_w[16];
+	unsigned int bits = tbp->type1_bits + 16;
+	unsigned int n, l, k;
+
+	if (!tbp->have_crc16 || bits > BATCH_MAX_BITS)
+		return -EINVAL;
+
+	for (n = 0; n < num; n += TETRA_BATCH_LANES) {
+		unsigned int lanes = num - n;
+		if (lanes > TETRA_BATCH_LANES)
+			lanes = TETRA_BATCH_LANES;
+
+		transpose_in(type2 + n, lanes, bits, w);
+		crc16_itut_bits_bitsliced(0xffff, w, bits, crc_w);
+
+		for (l = 0; l < lanes; l++) {
+			uint16_t c = 0;
+			for (k = 0; k < 16; k++)
+				c |= ((crc_w[k] >> l) & 1) << k;
+			crc[n + l] = c;
+		}
+	}
+
+	return 0;
+}
+
+int tetra_batch_rm3014(const struct tetra_blk_param *tbp, uint8_t * const *type1,
+		       uint8_t **type2, unsigned int num)
+{
+	uint64_t in[14], out[30];
+	unsigned int n;
+
+	if (tbp->type1_bits != 14 || tbp->type2_bits != 30)
+		return -EINVAL;
+
+	for (n = 0; n < num; n += TETRA_BATCH_LANES) {
+		unsigned int lanes = num - n;
+		if (lanes > TETRA_BATCH_LANES)
+			lanes = TETRA_BATCH_LANES;
+
+		transpose_in(type1 + n, lanes, 14, in);
+		tetra_rm3014_compute_bitsliced(in, out);
+		transpose_out(out, lanes, 30, type2 + n);
+	}
+
+	return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef TETRA_BATCH_H
+#define TETRA_BATCH_H
+/* Bitsliced batch processing of many equal-length TETRA blocks */
+
+#include <stdint.h>
+
+#include <lower_mac/tetra_lower_mac.h>
+
+/* number of blocks processed by one word operation */
+#define TETRA_BATCH_LANES	64
+
+/* XOR each of the 'num' type-5 blocks in blk[] (type345_bits long) with the
+ * scrambling sequence of the respective lfsr_init[] */
+int tetra_batch_scramb(const struct tetra_blk_param *tbp, uint8_t **blk,
+		       const uint32_t *lfsr_init, unsigned int num);
+
+/* compute the CRC16-CCITT over type1_bits+16 bits of each type-2 block,
+ * TETRA_CRC_OK in crc[n] means block n is fine */
+int tetra_batch_crc16(const struct tetra_blk_param *tbp, uint8_t * const *type2,
+		      unsigned int num, uint16_t *crc);
+
+/* (30,14) Reed-Muller encode the type-1 bits of 'num' broadcast blocks,
+ * requires tetra_rm3014_init() to have been called */
+int tetra_batch_rm3014(const struct tetra_blk_param *tbp, uint8_t * const *type1,
+		       uint8_t **type2, unsigned int num);
+
+#endif /* TETRA_BATCH_H */
@@ -0,0 +1,71 @@
+/* Downlink channel coding of the blocks carried over TP-SAP */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <tetra_common.h>
+#include <lower_mac/crc_simple.h>
+#include <lower_mac/tetra_conv_enc.h>
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/tetra_rm3014.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_blk_enc.h>
+
+int tetra_blk_encode(enum tp_sap_data_type type, const uint8_t *type1,
+		     uint32_t scramb_init, uint8_t *type5)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+	uint8_t type2[TETRA_BLK_MAX_BITS];
+	uint8_t master[TETRA_BLK_MAX_BITS*4];
+	uint8_t type3[TETRA_BLK_MAX_BITS];
+	struct conv_enc_state ces;
+
+	if (!tbp)
+		return -EINVAL;
+
+	if (!tbp->interleave_a) {
+		/* the broadcast block: type-2, -3 and -4 bits are the same */
+		if (type != TPSAP_T_BBK)
+			return -EINVAL;
+		uint_to_bits(tetra_rm3014_compute(bits_to_uint(type1, tbp->type1_bits)),
+			     tbp->type345_bits, type5);
+		tetra_scramb_bits(scramb_init, type5, tbp->type345_bits);
+		return tbp->type345_bits;
+	}
+
+	/* type-2: CRC (sent inverted, so that the receiver gets
+	 * TETRA_CRC_OK over both) and zero tail bits */
+	memset(type2, 0, tbp->type2_bits);
+	memcpy(type2, type1, tbp->type1_bits);
+	uint_to_bits(~crc16_ccitt_bits(type2, tbp->type1_bits), 16, type2 + tbp->type1_bits);
+
+	/* type-3: rate 2/3 out of the 1/4 mother code */
+	conv_enc_init(&ces);
+	conv_enc_input(&ces, type2, tbp->type2_bits, master);
+	get_punctured_rate(TETRA_RCPC_PUNCT_2_3, master, tbp->type345_bits, type3);
+
+	/* type-4 and type-5 */
+	block_interleave(tbp->type345_bits, tbp->interleave_a, type3, type5);
+	tetra_scramb_bits(scramb_init, type5, tbp->type345_bits);
+
+	return tbp->type345_bits;
+}
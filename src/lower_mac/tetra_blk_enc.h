@@ -0,0 +1,17 @@
+#ifndef TETRA_BLK_ENC_H
+#define TETRA_BLK_ENC_H
+/* Downlink channel coding of the blocks carried over TP-SAP */
+
+#include <stdint.h>
+
+#include <lower_mac/tetra_lower_mac.h>
+
+/* The type-1 bits of a block to its type-5 bits, the reverse of what the
+ * lower MAC does on receive: CRC and tail bits, rate 2/3 RCPC code, block
+ * interleaving and scrambling, or for the broadcast block the (30,14)
+ * Reed-Muller code and scrambling.  The latter requires tetra_rm3014_init()
+ * to have been called.  Returns the number of type-5 bits, or -EINVAL. */
+int tetra_blk_encode(enum tp_sap_data_type type, const uint8_t *type1,
+		     uint32_t scramb_init, uint8_t *type5);
+
+#endif /* TETRA_BLK_ENC_H */
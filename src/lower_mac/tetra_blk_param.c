@@ -0,0 +1,104 @@
+/* TETRA lower MAC block parameters, Section 8.2 of EN 300 392-2 */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <osmocom/core/utils.h>
+
+#include <lower_mac/tetra_lower_mac.h>
+#include <lower_mac/tetra_interleave.h>
+
+/* try to aggregate all of the magic numbers somewhere central */
+static const struct tetra_blk_param tetra_blk_param[] = {
+	[TPSAP_T_SB1] = {
+		.name		= "SB1",
+		.type345_bits 	= 120,
+		.type2_bits	= 80,
+		.type1_bits	= 60,
+		.interleave_a	= 11,
+		.have_crc16	= 1,
+	},
+	[TPSAP_T_SB2] = {
+		.name		= "SB2",
+		.type345_bits	= 216,
+		.type2_bits	= 144,
+		.type1_bits	= 124,
+		.interleave_a	= 101,
+		.have_crc16	= 1,
+	},
+	[TPSAP_T_NDB] = {
+		.name		= "NDB",
+		.type345_bits	= 216,
+		.type2_bits	= 144,
+		.type1_bits	= 124,
+		.interleave_a	= 101,
+		.have_crc16	= 1,
+	},
+	[TPSAP_T_SCH_HU] = {
+		.name		= "SCH/HU",
+		.type345_bits	= 168,
+		.type2_bits	= 112,
+		.type1_bits	= 92,
+		.interleave_a	= 13,
+		.have_crc16	= 1,
+	},
+	[TPSAP_T_SCH_F] = {
+		.name		= "SCH/F",
+		.type345_bits	= 432,
+		.type2_bits	= 288,
+		.type1_bits	= 268,
+		.interleave_a	= 103,
+		.have_crc16	= 1,
+	},
+	[TPSAP_T_BBK] = {
+		.name		= "BBK",
+		.type345_bits	= 30,
+		.type2_bits	= 30,
+		.type1_bits	= 14,
+	},
+};
+
+
+const struct tetra_blk_param *tetra_get_blk_param(enum tp_sap_data_type type)
+{
+	if (type >= ARRAY_SIZE(tetra_blk_param))
+		return NULL;
+	return &tetra_blk_param[type];
+}
+
+/* block deinterleaving tables for tetra_perm_gather(), built on first use */
+static uint16_t deinterl_tbl[ARRAY_SIZE(tetra_blk_param)][TETRA_BLK_MAX_BITS];
+static uint8_t deinterl_tbl_valid[ARRAY_SIZE(tetra_blk_param)];
+
+const uint16_t *tetra_get_deinterl_tbl(enum tp_sap_data_type type)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+
+	if (!tbp || !tbp->interleave_a)
+		return NULL;
+
+	if (!deinterl_tbl_valid[type]) {
+		block_deinterl_table(tbp->type345_bits, tbp->interleave_a,
+				     deinterl_tbl[type]);
+		deinterl_tbl_valid[type] = 1;
+	}
+	return deinterl_tbl[type];
+}
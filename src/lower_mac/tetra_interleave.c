@@ -58,7 +58,18 @@ void block_deinterleave(uint32_t K, uint32_t a, const uint8_t *in, uint8_t *out)
 	}
 }
 
-/* EN 300 395-2 Section 5.5.3 Matrix interleaving (voice */
+/* Compute the gather table for block_deinterleave(): out[i] = in[tbl[i]] */
+void block_deinterl_table(uint32_t K, uint32_t a, uint16_t *tbl)
+{
+	int i;
+	for (i = 1; i <= K; i++)
+		tbl[i-1] = block_interl_func(K, a, i) - 1;
+}
+
+/* EN 300 395-2 Section 5.5.3 Matrix interleaving (voice) */
+
+/* The input is written line by line into a matrix of 'lines' x 'columns'
+ * and read out column by column */
 void matrix_interleave(uint32_t lines, uint32_t columns,
 			const uint8_t *in, uint8_t *out)
 {
@@ -66,7 +77,7 @@ void matrix_interleave(uint32_t lines, uint32_t columns,
 
 	for (i = 0; i < columns; i++) {
 		for (j = 0; j < lines; j++)
-			out[i*lines + columns] = in[j*columns + lines];
+			out[i*lines + j] = in[j*columns + i];
 	}
 }
 
@@ -77,6 +88,38 @@ void matrix_deinterleave(uint32_t lines, uint32_t columns,
 
 	for (i = 0; i < columns; i++) {
 		for (j = 0; j < lines; j++)
-			out[j*columns + lines] = in[i*lines + columns];
+			out[j*columns + i] = in[i*lines + j];
+	}
+}
+
+/* Compute the gather tables equivalent to matrix_interleave() and
+ * matrix_deinterleave(), each of them 'lines*columns' entries long */
+void matrix_interl_table(uint32_t lines, uint32_t columns, uint16_t *tbl)
+{
+	int i, j;
+
+	for (i = 0; i < columns; i++) {
+		for (j = 0; j < lines; j++)
+			tbl[i*lines + j] = j*columns + i;
 	}
 }
+
+void matrix_deinterl_table(uint32_t lines, uint32_t columns, uint16_t *tbl)
+{
+	int i, j;
+
+	for (i = 0; i < columns; i++) {
+		for (j = 0; j < lines; j++)
+			tbl[j*columns + i] = i*lines + j;
+	}
+}
+
+/* Apply a precomputed permutation table in a single pass */
+void tetra_perm_gather(const uint16_t *tbl, unsigned int len,
+			const uint8_t *in, uint8_t *out)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		out[i] = in[tbl[i]];
+}
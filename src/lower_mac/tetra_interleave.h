@@ -8,10 +8,17 @@
 
 void block_interleave(uint32_t K, uint32_t a, const uint8_t *in, uint8_t *out);
 void block_deinterleave(uint32_t K, uint32_t a, const uint8_t *in, uint8_t *out);
+void block_deinterl_table(uint32_t K, uint32_t a, uint16_t *tbl);
 
 void matrix_interleave(uint32_t lines, uint32_t columns,
 			const uint8_t *in, uint8_t *out);
 void matrix_deinterleave(uint32_t lines, uint32_t columns,
 			 const uint8_t *in, uint8_t *out);
+void matrix_interl_table(uint32_t lines, uint32_t columns, uint16_t *tbl);
+void matrix_deinterl_table(uint32_t lines, uint32_t columns, uint16_t *tbl);
+
+/* out[i] = in[tbl[i]] for a table computed by one of the above */
+void tetra_perm_gather(const uint16_t *tbl, unsigned int len,
+			const uint8_t *in, uint8_t *out);
 
 #endif /* TETRA_INTERLEAVE_H */
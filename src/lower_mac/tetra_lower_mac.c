@@ -33,96 +33,56 @@
 #include <phy/tetra_burst_sync.h>
 #include <lower_mac/crc_simple.h>
 #include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_scramb_cache.h>
+#include <lower_mac/tetra_scramb_search.h>
+#include <lower_mac/tetra_batch.h>
 #include <lower_mac/tetra_interleave.h>
 #include <lower_mac/tetra_conv_enc.h>
+#include <lower_mac/tetra_lower_mac.h>
 #include <tetra_prim.h>
+#include <tetra_kernel.h>
+#include <tetra_event.h>
 #include "tetra_upper_mac.h"
 #include <lower_mac/viterbi.h>
 
-struct tetra_blk_param {
-	const char *name;
-	uint16_t type345_bits;
-	uint16_t type2_bits;
-	uint16_t type1_bits;
-	uint16_t interleave_a;
-	uint8_t have_crc16;
-};
-
-/* try to aggregate all of the magic numbers somewhere central */
-static const struct tetra_blk_param tetra_blk_param[] = {
-	[TPSAP_T_SB1] = {
-		.name		= "SB1",
-		.type345_bits 	= 120,
-		.type2_bits	= 80,
-		.type1_bits	= 60,
-		.interleave_a	= 11,
-		.have_crc16	= 1,
-	},
-	[TPSAP_T_SB2] = {
-		.name		= "SB2",
-		.type345_bits	= 216,
-		.type2_bits	= 144,
-		.type1_bits	= 124,
-		.interleave_a	= 101,
-		.have_crc16	= 1,
-	},
-	[TPSAP_T_NDB] = {
-		.name		= "NDB",
-		.type345_bits	= 216,
-		.type2_bits	= 144,
-		.type1_bits	= 124,
-		.interleave_a	= 101,
-		.have_crc16	= 1,
-	},
-	[TPSAP_T_SCH_HU] = {
-		.name		= "SCH/HU",
-		.type345_bits	= 168,
-		.type2_bits	= 112,
-		.type1_bits	= 92,
-		.interleave_a	= 13,
-		.have_crc16	= 1,
-	},
-	[TPSAP_T_SCH_F] = {
-		.name		= "SCH/F",
-		.type345_bits	= 432,
-		.type2_bits	= 288,
-		.type1_bits	= 268,
-		.interleave_a	= 103,
-		.have_crc16	= 1,
-	},
-	[TPSAP_T_BBK] = {
-		.name		= "BBK",
-		.type345_bits	= 30,
-		.type2_bits	= 30,
-		.type1_bits	= 14,
-	},
-};
-
 struct tetra_cell_data {
 	uint16_t mcc;
 	uint16_t mnc;
 	uint8_t colour_code;
-	struct tetra_tdma_time time;
+	uint64_t slot;		/* TDMA time of the current block */
 
 	uint32_t scramb_init;
+	/* scramb_init has decoded a block with a good CRC: from a SYNC, from
+	 * the cache of known cells or found by the search */
+	int code_valid;
 };
 
 static struct tetra_cell_data _tcd, *tcd = &_tcd;
 
-int is_bsch(struct tetra_tdma_time *tm)
+int is_bsch(uint64_t slot)
 {
-	if (tm->fn == 18 && tm->tn == 4 - ((tm->mn+1)%4))
+	if (tetra_tdma_fn(slot) == 18 &&
+	    tetra_tdma_tn(slot) == 4 - ((tetra_tdma_mn(slot)+1)%4))
 		return 1;
 	return 0;
 }
 
-int is_bnch(struct tetra_tdma_time *tm)
+int is_bnch(uint64_t slot)
 {
-	if (tm->fn == 18 && tm->tn == 4 - ((tm->mn+3)%4))
+	if (tetra_tdma_fn(slot) == 18 &&
+	    tetra_tdma_tn(slot) == 4 - ((tetra_tdma_mn(slot)+3)%4))
 		return 1;
 	return 0;
 }
 
+/* wall clock time of the current burst from the input, 0 if unknown */
+static time_t input_time(void)
+{
+	if (!t_phy_state.clock.valid)
+		return 0;
+	return tetra_tdma_slot2ns(&t_phy_state.clock, t_phy_state.slot) / 1000000000ULL;
+}
+
 struct tetra_tmvsap_prim *tmvsap_prim_alloc(uint16_t prim, uint8_t op)
 {
 	struct tetra_tmvsap_prim *ttp;
@@ -136,18 +96,97 @@ struct tetra_tmvsap_prim *tmvsap_prim_alloc(uint16_t prim, uint8_t op)
 	return ttp;
 }
 
+/* deinterleave, depuncture and Viterbi decode the type-4 bits of an
+ * interleaved block into type-2 bits */
+static void decode_type4(const struct tetra_blk_param *tbp, enum tp_sap_data_type type,
+			 const uint8_t *type4, uint8_t *type2, const char *time_str)
+{
+	uint8_t type3dp[512*4];
+	uint8_t type3[512];
+
+	/* Run block deinterleaving: type-3 bits */
+	tetra_kern.gather(tetra_get_deinterl_tbl(type), tbp->type345_bits,
+			  type4, type3);
+	DEBUGP("%s %s type3: %s\n", tbp->name, time_str,
+		osmo_ubit_dump(type3, tbp->type345_bits));
+	/* De-puncture */
+	memset(type3dp, 0xff, sizeof(type3dp));
+	tetra_rcpc_depunct(TETRA_RCPC_PUNCT_2_3, type3, tbp->type345_bits, type3dp);
+	DEBUGP("%s %s type3dp: %s\n", tbp->name, time_str,
+		osmo_ubit_dump(type3dp, tbp->type2_bits*4));
+	viterbi_dec_sb1_wrapper(type3dp, type2, tbp->type2_bits);
+	DEBUGP("%s %s type2: %s\n", tbp->name, time_str,
+		osmo_ubit_dump(type2, tbp->type2_bits));
+}
+
+/* The same from soft bits, +127 a sure 0: the punctured bits are
+ * erasures, which the Viterbi decoder gives no weight */
+static void decode_type4_soft(const struct tetra_blk_param *tbp, enum tp_sap_data_type type,
+			      const int8_t *type4, uint8_t *type2)
+{
+	int8_t type3dp[512*4];
+	int8_t type3[512];
+
+	tetra_kern.gather(tetra_get_deinterl_tbl(type), tbp->type345_bits,
+			  (const uint8_t *) type4, (uint8_t *) type3);
+	memset(type3dp, 0, sizeof(type3dp));
+	tetra_rcpc_depunct(TETRA_RCPC_PUNCT_2_3, (const uint8_t *) type3,
+			   tbp->type345_bits, (uint8_t *) type3dp);
+	tetra_kern.viterbi_cch(type3dp, type2, tbp->type2_bits);
+}
+
+/* Before the first SYNC of a carrier the scrambling code is unknown: try
+ * the codes of the cells seen there before.  Returns the matching cache
+ * entry with its type-4 and type-2 bits, or NULL */
+static struct tetra_scramb_cache_entry *
+try_cached_codes(struct tetra_scramb_cache *sc, const struct tetra_blk_param *tbp,
+		 enum tp_sap_data_type type, const uint8_t *bits,
+		 uint8_t *type4, uint8_t *type2)
+{
+	const struct tetra_scramb_cache_entry *cand[TETRA_SCACHE_MAX_CAND];
+	uint8_t blk[TETRA_SCACHE_MAX_CAND][TETRA_BLK_MAX_BITS];
+	uint8_t *blkp[TETRA_SCACHE_MAX_CAND];
+	uint32_t lfsr_init[TETRA_SCACHE_MAX_CAND];
+	unsigned int i, num;
+
+	num = tetra_scramb_cache_candidates(sc, cand, TETRA_SCACHE_MAX_CAND);
+	if (!num)
+		return NULL;
+	sc->stats.tries++;
+
+	/* descramble with all candidates at once */
+	for (i = 0; i < num; i++) {
+		memcpy(blk[i], bits, tbp->type345_bits);
+		blkp[i] = blk[i];
+		lfsr_init[i] = cand[i]->scramb_init;
+	}
+	tetra_batch_scramb(tbp, blkp, lfsr_init, num);
+
+	for (i = 0; i < num; i++) {
+		decode_type4(tbp, type, blk[i], type2, "");
+		if (tetra_kern.crc16(0xffff, type2, tbp->type1_bits+16) == TETRA_CRC_OK) {
+			memcpy(type4, blk[i], tbp->type345_bits);
+			sc->stats.warm++;
+			return (struct tetra_scramb_cache_entry *) cand[i];
+		}
+	}
+	sc->stats.misses++;
+	return NULL;
+}
+
 /* incoming TP-SAP UNITDATA.ind  from PHY into lower MAC */
-void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits, unsigned int len, void *priv)
+void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits,
+		      const int8_t *soft, unsigned int len, void *priv)
 {
 	/* various intermediary buffers */
 	uint8_t type4[512];
-	uint8_t type3dp[512*4];
-	uint8_t type3[512];
 	uint8_t type2[512];
+	int decoded = 0;
 
-	const struct tetra_blk_param *tbp = &tetra_blk_param[type];
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
 	struct tetra_mac_state *tms = priv;
-	const char *time_str;
+	char time_str[TETRA_TDMA_DUMP_LEN];
+	uint16_t crc = 0;
 
 	/* TMV-SAP.UNITDATA.ind primitive which we will send to the upper MAC */
 	struct tetra_tmvsap_prim *ttp;
@@ -160,55 +199,104 @@ void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits, unsigned
 	msg = ttp->oph.msg;
 
 	/* update the cell time */
-	memcpy(&tcd->time, &t_phy_state.time, sizeof(tcd->time));
-	time_str = tetra_tdma_time_dump(&tcd->time);
+	tcd->slot = t_phy_state.slot;
+	tetra_tdma_slot_dump(tcd->slot, time_str);
 
-	if (type == TPSAP_T_SB2 && is_bnch(&tcd->time)) {
+	if (type == TPSAP_T_SB2 && is_bnch(tcd->slot)) {
 		tup->lchan = TETRA_LC_BNCH;
-		printf("BNCH FOLLOWS\n");
+		TPRINTF(TETRA_V_BLOCK, "BNCH FOLLOWS\n");
 	}
 
-	DEBUGP("%s %s type5: %s\n", tbp->name, tetra_tdma_time_dump(&tcd->time),
+	DEBUGP("%s %s type5: %s\n", tbp->name, time_str,
 		osmo_ubit_dump(bits, tbp->type345_bits));
 
+	/* no SYNC seen yet, see whether we know the cell from before */
+	if (type != TPSAP_T_SB1 && !tcd->code_valid && tms->scramb_cache &&
+	    tbp->have_crc16 && tbp->interleave_a) {
+		struct tetra_scramb_cache_entry *e;
+		time_t now = input_time();
+
+		e = try_cached_codes(tms->scramb_cache, tbp, type, bits, type4, type2);
+		if (e) {
+			tcd->mcc = e->mcc;
+			tcd->mnc = e->mnc;
+			tcd->colour_code = e->colour_code;
+			tcd->scramb_init = e->scramb_init;
+			tcd->code_valid = 1;
+			/* a rough TDMA time until the next SYNC, if the time of
+			 * the input is known */
+			if (now && e->last_seen &&
+			    now - e->last_seen < TETRA_SCACHE_PREDICT_AGE) {
+				tcd->slot = tetra_scramb_cache_predict_slot(e, now);
+				t_phy_state.slot = tcd->slot;
+			}
+			tetra_scramb_cache_update(tms->scramb_cache, e->mcc, e->mnc,
+						  e->colour_code, tcd->slot, now);
+			tup->scrambling_code = tcd->scramb_init;
+			decoded = 1;
+		}
+	}
+
+	/* still no code: collect blocks and search for it */
+	if (type != TPSAP_T_SB1 && !decoded && !tcd->code_valid && tms->scramb_search &&
+	    tbp->have_crc16 && tbp->interleave_a &&
+	    tms->scramb_search->stats.runs < tms->scramb_search->max_runs &&
+	    tetra_scramb_search_add_block(tms->scramb_search, type, bits) >=
+	    (int) tms->scramb_search->want_blk) {
+		uint16_t mcc, mnc;
+		uint8_t cc;
+
+		TPRINTF(TETRA_V_PDU, "SEARCHING SCRAMBLING CODE\n");
+		if (tetra_scramb_search_run(tms->scramb_search, &mcc, &mnc, &cc) > 0) {
+			TPRINTF(TETRA_V_PDU, "SCRAMBLING CODE FOUND: MCC %u MNC %u CC %u\n",
+				mcc, mnc, cc);
+			tcd->mcc = mcc;
+			tcd->mnc = mnc;
+			tcd->colour_code = cc;
+			tcd->scramb_init = tetra_scramb_get_init(mcc, mnc, cc);
+			tcd->code_valid = 1;
+			if (tms->scramb_cache)
+				tetra_scramb_cache_update(tms->scramb_cache, mcc, mnc, cc,
+							  tcd->slot, input_time());
+		}
+	}
+
 	/* De-scramble, pay special attention to SB1 pre-defined scrambling */
-	memcpy(type4, bits, tbp->type345_bits);
-	if (type == TPSAP_T_SB1) {
-		tetra_scramb_bits(SCRAMB_INIT, type4, tbp->type345_bits);
-		tup->scrambling_code = SCRAMB_INIT;
-	} else {
-		tetra_scramb_bits(tcd->scramb_init, type4, tbp->type345_bits);
-		tup->scrambling_code = tcd->scramb_init;
+	if (!decoded) {
+		memcpy(type4, bits, tbp->type345_bits);
+		if (type == TPSAP_T_SB1) {
+			tetra_kern.scramb(SCRAMB_INIT, type4, tbp->type345_bits);
+			tup->scrambling_code = SCRAMB_INIT;
+		} else {
+			tetra_kern.scramb(tcd->scramb_init, type4, tbp->type345_bits);
+			tup->scrambling_code = tcd->scramb_init;
+		}
 	}
 
 	DEBUGP("%s %s type4: %s\n", tbp->name, time_str,
 		osmo_ubit_dump(type4, tbp->type345_bits));
 
-	if (tbp->interleave_a) {
-		/* Run block deinterleaving: type-3 bits */
-		block_deinterleave(tbp->type345_bits, tbp->interleave_a, type4, type3);
-		DEBUGP("%s %s type3: %s\n", tbp->name, time_str,
-			osmo_ubit_dump(type3, tbp->type345_bits));
-		/* De-puncture */
-		memset(type3dp, 0xff, sizeof(type3dp));
-		tetra_rcpc_depunct(TETRA_RCPC_PUNCT_2_3, type3, tbp->type345_bits, type3dp);
-		DEBUGP("%s %s type3dp: %s\n", tbp->name, time_str,
-			osmo_ubit_dump(type3dp, tbp->type2_bits*4));
-		viterbi_dec_sb1_wrapper(type3dp, type2, tbp->type2_bits);
-		DEBUGP("%s %s type2: %s\n", tbp->name, time_str,
-			osmo_ubit_dump(type2, tbp->type2_bits));
-	}
+	if (tbp->interleave_a && !decoded && soft) {
+		int8_t soft4[512];
+		unsigned int i;
+
+		/* a scrambled bit turns the sign of its soft bit */
+		for (i = 0; i < tbp->type345_bits; i++)
+			soft4[i] = type4[i] != bits[i] ? -soft[i] : soft[i];
+		decode_type4_soft(tbp, type, soft4, type2);
+	} else if (tbp->interleave_a && !decoded)
+		decode_type4(tbp, type, type4, type2, time_str);
 
 	if (tbp->have_crc16) {
-		uint16_t crc = crc16_ccitt_bits(type2, tbp->type1_bits+16);
-		printf("CRC COMP: 0x%04x ", crc);
+		crc = tetra_kern.crc16(0xffff, type2, tbp->type1_bits+16);
+		TPRINTF(TETRA_V_BLOCK, "CRC COMP: 0x%04x ", crc);
 		if (crc == TETRA_CRC_OK) {
-			printf("OK\n");
+			TPRINTF(TETRA_V_BLOCK, "OK\n");
 			tup->crc_ok = 1;
-			printf("%s %s type1: %s\n", tbp->name, time_str,
+			TPRINTF(TETRA_V_DUMP, "%s %s type1: %s\n", tbp->name, time_str,
 				osmo_ubit_dump(type2, tbp->type1_bits));
 		} else
-			printf("WRONG\n");
+			TPRINTF(TETRA_V_BLOCK, "WRONG\n");
 	} else if (type == TPSAP_T_BBK) {
 		/* FIXME: RM3014-decode */
 		tup->crc_ok = 1;
@@ -221,26 +309,52 @@ void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits, unsigned
 	memcpy(msg->l1h, type2, tbp->type1_bits);
 
 	switch (type) {
-	case TPSAP_T_SB1:
-		printf("TMB-SAP SYNC CC %s(0x%02x) ", osmo_ubit_dump(type2+4, 6), bits_to_uint(type2+4, 6));
-		printf("TN %s(%u) ", osmo_ubit_dump(type2+10, 2), bits_to_uint(type2+10, 2));
-		printf("FN %s(%2u) ", osmo_ubit_dump(type2+12, 5), bits_to_uint(type2+12, 5));
-		printf("MN %s(%2u) ", osmo_ubit_dump(type2+17, 6), bits_to_uint(type2+17, 6));
-		printf("MCC %s(%u) ", osmo_ubit_dump(type2+31, 10), bits_to_uint(type2+31, 10));
-		printf("MNC %s(%u)\n", osmo_ubit_dump(type2+41, 14), bits_to_uint(type2+41, 14));
-		/* obtain information from SYNC PDU */
+	case TPSAP_T_SB1: {
+		struct tetra_tdma_time tm;
+
+		tup->lchan = TETRA_LC_BSCH;
+		/* a damaged SYNC must not replace the code or the time */
+		if (!tup->crc_ok)
+			break;
+
+		TPRINTF(TETRA_V_PDU, "TMB-SAP SYNC CC %s(0x%02x) ", osmo_ubit_dump(type2+4, 6), bits_to_uint(type2+4, 6));
+		TPRINTF(TETRA_V_PDU, "TN %s(%u) ", osmo_ubit_dump(type2+10, 2), bits_to_uint(type2+10, 2));
+		TPRINTF(TETRA_V_PDU, "FN %s(%2u) ", osmo_ubit_dump(type2+12, 5), bits_to_uint(type2+12, 5));
+		TPRINTF(TETRA_V_PDU, "MN %s(%2u) ", osmo_ubit_dump(type2+17, 6), bits_to_uint(type2+17, 6));
+		TPRINTF(TETRA_V_PDU, "MCC %s(%u) ", osmo_ubit_dump(type2+31, 10), bits_to_uint(type2+31, 10));
+		TPRINTF(TETRA_V_PDU, "MNC %s(%u)\n", osmo_ubit_dump(type2+41, 14), bits_to_uint(type2+41, 14));
+		/* obtain information from SYNC PDU, TN is coded as 0..3 */
 		tcd->colour_code = bits_to_uint(type2+4, 6);
-		tcd->time.tn = bits_to_uint(type2+10, 2);
-		tcd->time.fn = bits_to_uint(type2+12, 5);
-		tcd->time.mn = bits_to_uint(type2+17, 6);
+		tm.hn = tetra_tdma_hn(tcd->slot);
+		tm.tn = bits_to_uint(type2+10, 2) + 1;
+		tm.fn = bits_to_uint(type2+12, 5);
+		tm.mn = bits_to_uint(type2+17, 6);
+		tcd->slot = tetra_tdma_time2slot(&tm);
 		tcd->mcc = bits_to_uint(type2+31, 10);
 		tcd->mnc = bits_to_uint(type2+41, 14);
 		/* compute the scrambling code for the current cell */
 		tcd->scramb_init = tetra_scramb_get_init(tcd->mcc, tcd->mnc, tcd->colour_code);
+		tcd->code_valid = 1;
 		/* update the PHY layer time */
-		memcpy(&t_phy_state.time, &tcd->time, sizeof(t_phy_state.time));
-		tup->lchan = TETRA_LC_BSCH;
+		t_phy_state.slot = tcd->slot;
+		if (tms->scramb_cache)
+			tetra_scramb_cache_update(tms->scramb_cache, tcd->mcc, tcd->mnc,
+						  tcd->colour_code, tcd->slot, input_time());
+		if (tetra_event_active) {
+			struct tetra_ev_sync ev = {
+				.mcc		= tcd->mcc,
+				.mnc		= tcd->mnc,
+				.colour_code	= tcd->colour_code,
+				.tn		= tm.tn,
+				.fn		= tm.fn,
+				.mn		= tm.mn,
+			};
+
+			tetra_event_set_time(tcd->slot);
+			tetra_event_put(TETRA_EV_SYNC, &ev, sizeof(ev), NULL, 0);
+		}
 		break;
+	}
 	case TPSAP_T_SB2:
 	case TPSAP_T_NDB:
 		/* FIXME: do something */
@@ -256,7 +370,19 @@ void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits, unsigned
 		break;
 	}
 	/* send Rx time along with the TMV-UNITDATA.ind primitive */
-	memcpy(&tup->tdma_time, &tcd->time, sizeof(tup->tdma_time));
+	tup->tdma_slot = tcd->slot;
+
+	if (tetra_event_active) {
+		struct tetra_ev_block ev = {
+			.blk_type	= type,
+			.lchan		= tup->lchan,
+			.crc_ok		= tup->crc_ok,
+			.crc		= crc,
+			.num_bits	= tbp->type1_bits,
+		};
+
+		tetra_event_put(TETRA_EV_BLOCK, &ev, sizeof(ev), type2, tbp->type1_bits);
+	}
 
 	upper_mac_prim_recv(&ttp->oph, tms);
 }
@@ -0,0 +1,26 @@
+#ifndef TETRA_LOWER_MAC_H
+#define TETRA_LOWER_MAC_H
+
+#include <stdint.h>
+
+#include <phy/tetra_burst.h>
+
+/* largest type-3/4/5 block: SCH/F */
+#define TETRA_BLK_MAX_BITS	432
+
+/* sizes of the various bit types of each block carried over TP-SAP */
+struct tetra_blk_param {
+	const char *name;
+	uint16_t type345_bits;
+	uint16_t type2_bits;
+	uint16_t type1_bits;
+	uint16_t interleave_a;
+	uint8_t have_crc16;
+};
+
+const struct tetra_blk_param *tetra_get_blk_param(enum tp_sap_data_type type);
+
+/* type-4 to type-3 bit position table, NULL for non-interleaved blocks */
+const uint16_t *tetra_get_deinterl_tbl(enum tp_sap_data_type type);
+
+#endif /* TETRA_LOWER_MAC_H */
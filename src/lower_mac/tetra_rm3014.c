@@ -21,6 +21,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <tetra_common.h>
 #include <lower_mac/tetra_rm3014.h>
 
 /* Generator matrix from Section 8.2.3.2  */
@@ -67,7 +68,7 @@ void tetra_rm3014_init(void)
 		/* lower 16 bits from rm_30_14_gen */
 		val |= shift_bits_together(rm_30_14_gen[i], 16);
 		rm_30_14_rows[i] = val;
-		printf("rm_30_14_rows[%u] = 0x%08x\n", i, val);
+		DEBUGP("rm_30_14_rows[%u] = 0x%08x\n", i, val);
 	}
 }
 
@@ -85,6 +86,22 @@ uint32_t tetra_rm3014_compute(const uint16_t in)
 	return val;
 }
 
+/* Bitsliced variant of tetra_rm3014_compute(): bit n of in[i] is input bit i
+ * (MSB first) of word n, bit n of out[k] is output bit k (MSB first) */
+void tetra_rm3014_compute_bitsliced(const uint64_t *in, uint64_t *out)
+{
+	int i, k;
+
+	for (k = 0; k < 30; k++) {
+		uint64_t val = 0;
+		for (i = 0; i < 14; i++) {
+			if ((rm_30_14_rows[i] >> (30-1-k)) & 1)
+				val ^= in[i];
+		}
+		out[k] = val;
+	}
+}
+
 /**
  * This is a systematic code. We can remove the control bits
  * and then check for an error. Maybe correct it in the future.
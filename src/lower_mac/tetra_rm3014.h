@@ -5,6 +5,7 @@
 
 void tetra_rm3014_init(void);
 uint32_t tetra_rm3014_compute(const uint16_t in);
+void tetra_rm3014_compute_bitsliced(const uint64_t *in, uint64_t *out);
 
 /**
  * Decode @param inp to @param out and return if there was
@@ -21,6 +21,8 @@
  */
 
 #include <stdint.h>
+#include <string.h>
+
 #include <lower_mac/tetra_scramb.h>
 
 /* Tap macro for the standard XOR / Fibonacci form */
@@ -84,6 +86,38 @@ int tetra_scramb_bits(uint32_t lfsr_init, uint8_t *out, int len)
 	return 0;
 }
 
+/* Bitsliced variant of tetra_scramb_get_bits() for up to 64 LFSRs: bit n of
+ * ks[i] is the i-th scrambling bit of the LFSR started from lfsr_init[n].
+ *
+ * With x(k) being the k-th LFSR bit (x(0..31) the initial state, LSB first),
+ * every output bit is x(k+32) = XOR of x(k+32-tap) over all taps, so we only
+ * need a ring of the last 32 words. */
+void tetra_scramb_get_bits_bitsliced(const uint32_t *lfsr_init, unsigned int lanes,
+				     uint64_t *ks, int len)
+{
+	uint64_t x[32];
+	unsigned int l;
+	int i, k;
+
+	memset(x, 0, sizeof(x));
+	for (l = 0; l < lanes; l++) {
+		for (i = 0; i < 32; i++)
+			x[i] |= (uint64_t)((lfsr_init[l] >> i) & 1) << l;
+	}
+
+	for (k = 0; k < len; k++) {
+		/* taps: 32 26 23 22 16 12 11 10 8 7 5 4 2 1 */
+		uint64_t bit = x[(k+0) & 31] ^ x[(k+6) & 31] ^ x[(k+9) & 31] ^
+			       x[(k+10) & 31] ^ x[(k+16) & 31] ^ x[(k+20) & 31] ^
+			       x[(k+21) & 31] ^ x[(k+22) & 31] ^ x[(k+24) & 31] ^
+			       x[(k+25) & 31] ^ x[(k+27) & 31] ^ x[(k+28) & 31] ^
+			       x[(k+30) & 31] ^ x[(k+31) & 31];
+		/* x(k) is not needed anymore, x(k+32) takes its place */
+		x[k & 31] = bit;
+		ks[k] = bit;
+	}
+}
+
 uint32_t tetra_scramb_get_init(uint16_t mcc, uint16_t mnc, uint8_t colour)
 {
 	uint32_t scramb_init;
@@ -20,4 +20,8 @@ int tetra_scramb_get_bits(uint32_t lfsr_init, uint8_t *out, int len);
 /* XOR the bitstring at 'out/len' using the TETRA scrambling LFSR */
 int tetra_scramb_bits(uint32_t lfsr_init, uint8_t *out, int len);
 
+/* Scrambling sequence of up to 64 LFSRs at once, one bit per lane in ks[] */
+void tetra_scramb_get_bits_bitsliced(const uint32_t *lfsr_init, unsigned int lanes,
+				     uint64_t *ks, int len);
+
 #endif /* TETRA_SCRAMB_H */
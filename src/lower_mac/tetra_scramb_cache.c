@@ -0,0 +1,208 @@
+/* Persistent cache of known cells and their scrambling codes */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_scramb_cache.h>
+
+/* the file holds one cell per line:
+ * carrier mcc mnc colour_code hn mn fn tn last_seen hits */
+#define SCACHE_HDR	"# carrier mcc mnc cc hn mn fn tn last_seen hits\n"
+
+void tetra_scramb_cache_init(struct tetra_scramb_cache *sc, uint32_t carrier)
+{
+	memset(sc, 0, sizeof(*sc));
+	sc->carrier = carrier;
+}
+
+static struct tetra_scramb_cache_entry *
+entry_find(struct tetra_scramb_cache *sc, uint32_t carrier, uint32_t scramb_init)
+{
+	unsigned int i;
+
+	for (i = 0; i < sc->num; i++) {
+		if (sc->e[i].carrier == carrier && sc->e[i].scramb_init == scramb_init)
+			return &sc->e[i];
+	}
+	return NULL;
+}
+
+/* a new entry, replacing the one seen least recently if the cache is full */
+static struct tetra_scramb_cache_entry *entry_alloc(struct tetra_scramb_cache *sc)
+{
+	struct tetra_scramb_cache_entry *oldest;
+	unsigned int i;
+
+	if (sc->num < TETRA_SCACHE_MAX_ENTRIES)
+		return &sc->e[sc->num++];
+
+	oldest = &sc->e[0];
+	for (i = 1; i < sc->num; i++) {
+		if (sc->e[i].last_seen < oldest->last_seen)
+			oldest = &sc->e[i];
+	}
+	return oldest;
+}
+
+int tetra_scramb_cache_load(struct tetra_scramb_cache *sc, const char *path)
+{
+	char line[256];
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f)
+		return -errno;
+
+	while (fgets(line, sizeof(line), f)) {
+		struct tetra_scramb_cache_entry e, *ne;
+		struct tetra_tdma_time tm;
+		unsigned int mcc, mnc, cc, hn, mn, fn, tn;
+		long long last_seen;
+
+		if (line[0] == '#')
+			continue;
+		memset(&e, 0, sizeof(e));
+		if (sscanf(line, "%u %u %u %u %u %u %u %u %lld %u", &e.carrier,
+			   &mcc, &mnc, &cc, &hn, &mn, &fn, &tn, &last_seen, &e.hits) != 10)
+			continue;
+		if (mcc > 1023 || mnc > 16383 || cc > 63)
+			continue;
+		e.mcc = mcc;
+		e.mnc = mnc;
+		e.colour_code = cc;
+		e.scramb_init = tetra_scramb_get_init(mcc, mnc, cc);
+		tm.hn = hn;
+		tm.mn = mn;
+		tm.fn = fn;
+		tm.tn = tn;
+		e.slot = tetra_tdma_time2slot(&tm);
+		e.last_seen = last_seen;
+
+		ne = entry_find(sc, e.carrier, e.scramb_init);
+		if (!ne)
+			ne = entry_alloc(sc);
+		*ne = e;
+	}
+	fclose(f);
+
+	return 0;
+}
+
+int tetra_scramb_cache_save(struct tetra_scramb_cache *sc, const char *path)
+{
+	char tmp[512];
+	unsigned int i;
+	FILE *f;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= sizeof(tmp))
+		return -ENAMETOOLONG;
+	f = fopen(tmp, "w");
+	if (!f)
+		return -errno;
+
+	fputs(SCACHE_HDR, f);
+	for (i = 0; i < sc->num; i++) {
+		const struct tetra_scramb_cache_entry *e = &sc->e[i];
+		struct tetra_tdma_time tm;
+
+		tetra_tdma_slot2time(e->slot, &tm);
+		fprintf(f, "%u %u %u %u %u %u %u %u %lld %u\n", e->carrier,
+			e->mcc, e->mnc, e->colour_code, tm.hn, tm.mn,
+			tm.fn, tm.tn, (long long) e->last_seen, e->hits);
+	}
+	if (fclose(f) != 0 || rename(tmp, path) < 0) {
+		unlink(tmp);
+		return -EIO;
+	}
+	sc->dirty = 0;
+
+	return 0;
+}
+
+unsigned int tetra_scramb_cache_candidates(const struct tetra_scramb_cache *sc,
+					   const struct tetra_scramb_cache_entry **cand,
+					   unsigned int max)
+{
+	unsigned int i, j, num = 0;
+
+	for (i = 0; i < sc->num; i++) {
+		const struct tetra_scramb_cache_entry *e = &sc->e[i];
+
+		if (sc->carrier && e->carrier != sc->carrier)
+			continue;
+
+		/* insertion sort, most recently seen first */
+		for (j = num; j > 0 && cand[j-1]->last_seen < e->last_seen; j--) {
+			if (j < max)
+				cand[j] = cand[j-1];
+		}
+		if (j < max) {
+			cand[j] = e;
+			if (num < max)
+				num++;
+		}
+	}
+	return num;
+}
+
+struct tetra_scramb_cache_entry *
+tetra_scramb_cache_update(struct tetra_scramb_cache *sc, uint16_t mcc, uint16_t mnc,
+			  uint8_t colour, uint64_t slot, time_t seen)
+{
+	uint32_t scramb_init = tetra_scramb_get_init(mcc, mnc, colour);
+	struct tetra_scramb_cache_entry *e;
+
+	e = entry_find(sc, sc->carrier, scramb_init);
+	if (!e) {
+		e = entry_alloc(sc);
+		memset(e, 0, sizeof(*e));
+		e->carrier = sc->carrier;
+		e->mcc = mcc;
+		e->mnc = mnc;
+		e->colour_code = colour;
+		e->scramb_init = scramb_init;
+	}
+	/* a new entry without a time gets one, even if it is of no use */
+	if (seen || !e->hits) {
+		e->slot = slot;
+		e->last_seen = seen;
+	}
+	e->hits++;
+	sc->dirty = 1;
+
+	return e;
+}
+
+uint64_t tetra_scramb_cache_predict_slot(const struct tetra_scramb_cache_entry *e,
+					 time_t now)
+{
+	struct tetra_tdma_clock clk;
+
+	tetra_tdma_clock_set(&clk, e->slot, (uint64_t) e->last_seen * 1000000000ULL);
+	if (now < e->last_seen)
+		return e->slot;
+	return tetra_tdma_ns2slot(&clk, (uint64_t) now * 1000000000ULL);
+}
@@ -0,0 +1,71 @@
+#ifndef TETRA_SCRAMB_CACHE_H
+#define TETRA_SCRAMB_CACHE_H
+/* Persistent cache of known cells and their scrambling codes */
+
+#include <stdint.h>
+#include <time.h>
+
+#include <tetra_tdma.h>
+
+/* Until the first SYNC burst of a carrier is decoded, its normal bursts
+ * cannot be descrambled.  The cache remembers the cells seen on each
+ * carrier, so those bursts can be tried against the known codes right
+ * away.  A code is only used once a block decodes with a good CRC. */
+
+#define TETRA_SCACHE_MAX_ENTRIES	64
+/* maximum number of codes tried on one block */
+#define TETRA_SCACHE_MAX_CAND		8
+/* only entries seen this recently (s) give a usable TDMA time estimate */
+#define TETRA_SCACHE_PREDICT_AGE	3600
+
+struct tetra_scramb_cache_entry {
+	uint32_t carrier;	/* carrier key, e.g. the DL frequency in Hz */
+	uint16_t mcc;
+	uint16_t mnc;
+	uint8_t colour_code;
+	uint32_t scramb_init;
+	uint64_t slot;		/* last TDMA time seen */
+	time_t last_seen;	/* wall clock time of 'slot' */
+	unsigned int hits;	/* number of times the cell was confirmed */
+};
+
+struct tetra_scramb_cache_stats {
+	unsigned int tries;	/* blocks tried against cached codes */
+	unsigned int warm;	/* cached codes confirmed by a good CRC */
+	unsigned int misses;	/* blocks no cached code matched */
+};
+
+struct tetra_scramb_cache {
+	uint32_t carrier;	/* key of the carrier being received, 0 for any */
+	unsigned int num;
+	struct tetra_scramb_cache_entry e[TETRA_SCACHE_MAX_ENTRIES];
+	int dirty;
+	struct tetra_scramb_cache_stats stats;
+};
+
+void tetra_scramb_cache_init(struct tetra_scramb_cache *sc, uint32_t carrier);
+
+/* read entries from the file at 'path', -ENOENT if there is none */
+int tetra_scramb_cache_load(struct tetra_scramb_cache *sc, const char *path);
+
+/* atomically replace the file at 'path' */
+int tetra_scramb_cache_save(struct tetra_scramb_cache *sc, const char *path);
+
+/* fill 'cand' with up to 'max' entries of the current carrier (all
+ * entries if the carrier is 0), most recently seen first */
+unsigned int tetra_scramb_cache_candidates(const struct tetra_scramb_cache *sc,
+					   const struct tetra_scramb_cache_entry **cand,
+					   unsigned int max);
+
+/* the cell (mcc, mnc, colour) was seen on the current carrier at 'slot',
+ * at the time 'seen' of the input.  If that is not known (0), e.g. when
+ * replaying a recording, the TDMA time of the entry is left alone. */
+struct tetra_scramb_cache_entry *
+tetra_scramb_cache_update(struct tetra_scramb_cache *sc, uint16_t mcc, uint16_t mnc,
+			  uint8_t colour, uint64_t slot, time_t seen);
+
+/* estimate the TDMA time of 'e' at the time 'now' of the input */
+uint64_t tetra_scramb_cache_predict_slot(const struct tetra_scramb_cache_entry *e,
+					 time_t now);
+
+#endif /* TETRA_SCRAMB_CACHE_H */
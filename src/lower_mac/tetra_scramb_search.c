@@ -0,0 +1,561 @@
+/* Recovery of an unknown scrambling code from a few received blocks */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include <tetra_common.h>
+#include <tetra_kernel.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_conv_enc.h>
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/tetra_scramb_search.h>
+#include <lower_mac/viterbi.h>
+
+/* type-3 bits as a bit vector */
+#define V_WORDS		((TETRA_BLK_MAX_BITS + 63) / 64)
+/* parity checks are looked for within windows of this many type-3 bits */
+#define CHK_WINDOW	48
+#define CHK_POOL	1024
+/* candidates walked by one work item, log2 */
+#define CHUNK_BITS	16
+#define MAX_THREADS	64
+
+/* bits of MCC, MNC and colour code within the 30 bit cell identity */
+#define E_CC_MASK	0x3f
+#define E_MNC_MASK	(0x3fff << 6)
+#define E_MCC_MASK	(0x3ffU << 20)
+
+static uint32_t e_from_cell(uint16_t mcc, uint16_t mnc, uint8_t colour)
+{
+	return tetra_scramb_get_init(mcc, mnc, colour) >> 2;
+}
+
+void tetra_scramb_search_init(struct tetra_scramb_search *ss)
+{
+	memset(ss, 0, sizeof(*ss));
+	ss->mcc = -1;
+	ss->mnc = -1;
+	ss->want_blk = TETRA_SSEARCH_DEF_BLK;
+	ss->max_runs = TETRA_SSEARCH_DEF_RUNS;
+}
+
+int tetra_scramb_search_load_pairs(struct tetra_scramb_search *ss, const char *path)
+{
+	char line[256];
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f)
+		return -errno;
+
+	while (fgets(line, sizeof(line), f)) {
+		unsigned int mcc, mnc;
+
+		if (line[0] == '#')
+			continue;
+		if (sscanf(line, "%u %u", &mcc, &mnc) != 2 || mcc > 1023 || mnc > 16383)
+			continue;
+		if (ss->num_pairs >= TETRA_SSEARCH_MAX_PAIRS)
+			break;
+		ss->pairs[ss->num_pairs].mcc = mcc;
+		ss->pairs[ss->num_pairs].mnc = mnc;
+		ss->num_pairs++;
+	}
+	fclose(f);
+
+	return 0;
+}
+
+int tetra_scramb_search_add_block(struct tetra_scramb_search *ss,
+				  enum tp_sap_data_type type, const uint8_t *bits)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+
+	if (!tbp || !tbp->have_crc16 || !tbp->interleave_a || type == TPSAP_T_SB1 ||
+	    type > TPSAP_T_SCH_F)
+		return -EINVAL;
+
+	if (ss->num_blk < TETRA_SSEARCH_MAX_BLK) {
+		ss->blk_type[ss->num_blk] = type;
+		memcpy(ss->blk[ss->num_blk], bits, tbp->type345_bits);
+		ss->num_blk++;
+	}
+	return ss->num_blk;
+}
+
+/***********************************************************************
+ * parity checks
+ ***********************************************************************/
+
+struct chk_vec {
+	uint64_t v[V_WORDS];
+	unsigned int weight;
+};
+
+static int chk_vec_cmp(const void *a, const void *b)
+{
+	const struct chk_vec *ca = a, *cb = b;
+
+	return (int) ca->weight - (int) cb->weight;
+}
+
+/* 'len' (<= 64) bits of 'v' starting at bit 'pos' */
+static uint64_t vec_get(const uint64_t *v, unsigned int pos, unsigned int len)
+{
+	uint64_t r = 0;
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		r |= ((v[(pos+i) / 64] >> ((pos+i) % 64)) & 1) << i;
+	return r;
+}
+
+/* find the checks within type-3 bits [a, a+w): sets of positions whose
+ * sum is zero for every codeword.  Returns the new size of the pool */
+static unsigned int window_checks(const uint64_t (*gen)[V_WORDS], unsigned int num_in,
+				  unsigned int a, unsigned int w,
+				  struct chk_vec *pool, unsigned int num)
+{
+	uint64_t in_bits[64];	/* window bits of each input involved */
+	uint64_t piv_v[64], piv_t[64];
+	unsigned int num_inp = 0, num_piv = 0;
+	unsigned int i, p, k;
+
+	for (i = 0; i < num_in; i++) {
+		uint64_t b = vec_get(gen[i], a, w);
+		if (!b)
+			continue;
+		if (num_inp >= 64)
+			return num;
+		in_bits[num_inp++] = b;
+	}
+
+	/* eliminate the inputs position by position, a position which is a
+	 * combination of earlier ones gives a check */
+	for (p = 0; p < w; p++) {
+		uint64_t v = 0, t = 1ULL << p;
+
+		for (k = 0; k < num_inp; k++)
+			v |= ((in_bits[k] >> p) & 1) << k;
+
+		for (k = 0; k < num_piv; k++) {
+			if (v & piv_v[k] & -piv_v[k]) {
+				v ^= piv_v[k];
+				t ^= piv_t[k];
+			}
+		}
+		if (v) {
+			piv_v[num_piv] = v;
+			piv_t[num_piv] = t;
+			num_piv++;
+			continue;
+		}
+
+		if (__builtin_popcountll(t) > TETRA_SSEARCH_MAX_CHK_WEIGHT || num >= CHK_POOL)
+			continue;
+		memset(&pool[num], 0, sizeof(pool[num]));
+		for (k = 0; k < w; k++) {
+			if ((t >> k) & 1)
+				pool[num].v[(a+k) / 64] |= 1ULL << ((a+k) % 64);
+		}
+		pool[num].weight = __builtin_popcountll(t);
+		for (k = 0; k < num; k++) {
+			if (!memcmp(pool[k].v, pool[num].v, sizeof(pool[num].v)))
+				break;
+		}
+		if (k == num)
+			num++;
+	}
+	return num;
+}
+
+/* greedily pick the lightest linearly independent checks */
+static unsigned int select_checks(struct chk_vec *pool, unsigned int num,
+				  struct chk_vec *sel, unsigned int max)
+{
+	struct chk_vec piv[TETRA_SSEARCH_MAX_CHK];
+	unsigned int piv_bit[TETRA_SSEARCH_MAX_CHK];
+	unsigned int i, j, w, num_sel = 0;
+
+	qsort(pool, num, sizeof(*pool), chk_vec_cmp);
+
+	for (i = 0; i < num && num_sel < max; i++) {
+		struct chk_vec r = pool[i];
+		int zero = 1;
+
+		for (j = 0; j < num_sel; j++) {
+			if ((r.v[piv_bit[j] / 64] >> (piv_bit[j] % 64)) & 1) {
+				for (w = 0; w < V_WORDS; w++)
+					r.v[w] ^= piv[j].v[w];
+			}
+		}
+		for (w = 0; w < V_WORDS; w++) {
+			if (r.v[w]) {
+				piv_bit[num_sel] = w * 64 + __builtin_ctzll(r.v[w]);
+				zero = 0;
+				break;
+			}
+		}
+		if (zero)
+			continue;
+		piv[num_sel] = r;
+		sel[num_sel++] = pool[i];
+	}
+	return num_sel;
+}
+
+static int plan_build(struct tetra_ssearch_plan *plan, enum tp_sap_data_type type)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+	const uint16_t *tbl = tetra_get_deinterl_tbl(type);
+	uint64_t (*gen)[V_WORDS];
+	struct chk_vec *pool, sel[TETRA_SSEARCH_MAX_CHK];
+	uint8_t type2[TETRA_BLK_MAX_BITS], master[TETRA_BLK_MAX_BITS*4];
+	uint8_t type3[TETRA_BLK_MAX_BITS];
+	uint32_t unit[32];
+	uint64_t ks[TETRA_BLK_MAX_BITS];
+	unsigned int n3 = tbp->type345_bits;
+	/* the tail bits are always zero */
+	unsigned int num_in = tbp->type2_bits - 4;
+	unsigned int i, j, a, c, num = 0;
+
+	gen = calloc(num_in, sizeof(*gen));
+	pool = calloc(CHK_POOL, sizeof(*pool));
+	if (!gen || !pool) {
+		free(gen);
+		free(pool);
+		return -ENOMEM;
+	}
+
+	/* the type-3 bits generated by each type-2 bit */
+	for (i = 0; i < num_in; i++) {
+		struct conv_enc_state ces;
+
+		memset(type2, 0, sizeof(type2));
+		type2[i] = 1;
+		conv_enc_init(&ces);
+		conv_enc_input(&ces, type2, tbp->type2_bits, master);
+		get_punctured_rate(TETRA_RCPC_PUNCT_2_3, master, n3, type3);
+		for (j = 0; j < n3; j++) {
+			if (type3[j])
+				gen[i][j / 64] |= 1ULL << (j % 64);
+		}
+	}
+
+	/* the puncturing pattern repeats every three type-3 bits */
+	for (a = 0; a < n3; a += 3) {
+		unsigned int w = n3 - a < CHK_WINDOW ? n3 - a : CHK_WINDOW;
+		num = window_checks((const uint64_t (*)[V_WORDS]) gen, num_in, a, w,
+				    pool, num);
+	}
+	plan->num_chk = select_checks(pool, num, sel, TETRA_SSEARCH_MAX_CHK);
+	free(pool);
+	free(gen);
+
+	/* the scrambling sequence is linear in the LFSR start value, so
+	 * each check depends on a fixed set of the code bits */
+	for (i = 0; i < 32; i++)
+		unit[i] = 1U << i;
+	tetra_scramb_get_bits_bitsliced(unit, 32, ks, n3);
+
+	memset(plan->col, 0, sizeof(plan->col));
+	plan->cst = 0;
+	for (c = 0; c < plan->num_chk; c++) {
+		uint64_t m = 0;
+
+		plan->chk_len[c] = 0;
+		for (j = 0; j < n3; j++) {
+			if (!((sel[c].v[j / 64] >> (j % 64)) & 1))
+				continue;
+			/* type-3 bit j is type-4/5 bit tbl[j] */
+			plan->chk_pos[c][plan->chk_len[c]++] = tbl[j];
+			m ^= ks[tbl[j]];
+		}
+		for (i = 0; i < 30; i++)
+			plan->col[i] |= ((m >> (i+2)) & 1) << c;
+		if (__builtin_popcountll(m & SCRAMB_INIT) & 1)
+			plan->cst |= 1ULL << c;
+	}
+	plan->valid = 1;
+
+	return 0;
+}
+
+/* the checks of a received block violated with the code for e == 0 */
+static uint64_t plan_syndrome(const struct tetra_ssearch_plan *plan, const uint8_t *bits)
+{
+	uint64_t s = plan->cst;
+	unsigned int c, i;
+
+	for (c = 0; c < plan->num_chk; c++) {
+		uint8_t p = 0;
+		for (i = 0; i < plan->chk_len[c]; i++)
+			p ^= bits[plan->chk_pos[c][i]];
+		s ^= (uint64_t)(p & 1) << c;
+	}
+	return s;
+}
+
+/***********************************************************************
+ * the search
+ ***********************************************************************/
+
+struct search_job {
+	uint32_t e0;		/* fixed bits */
+	uint8_t num_free;
+	uint8_t free_bit[30];	/* positions of the bits to enumerate */
+	uint64_t first_chunk;
+};
+
+struct search {
+	struct tetra_scramb_search *ss;
+	unsigned int num_blk;
+	unsigned int max_fail;
+	uint64_t base[TETRA_SSEARCH_MAX_BLK];
+
+	struct search_job *job;
+	unsigned int num_jobs;
+	uint64_t num_chunks;
+	uint64_t next_chunk;
+
+	int done;
+	uint32_t result;
+	uint64_t candidates;
+	uint64_t survivors;
+};
+
+static void job_add(struct search *s, uint32_t e0, uint32_t free_mask)
+{
+	struct search_job *j = &s->job[s->num_jobs++];
+	unsigned int i, low;
+
+	j->e0 = e0 & ~free_mask;
+	j->num_free = 0;
+	for (i = 0; i < 30; i++) {
+		if ((free_mask >> i) & 1)
+			j->free_bit[j->num_free++] = i;
+	}
+	low = j->num_free < CHUNK_BITS ? j->num_free : CHUNK_BITS;
+	j->first_chunk = s->num_chunks;
+	s->num_chunks += 1ULL << (j->num_free - low);
+}
+
+/* Viterbi decode the blocks with code 'e'.  A block with bit errors the
+ * decoder cannot correct may fail its CRC, so two good CRCs are enough.
+ * Stops as soon as that cannot be reached anymore */
+static int verify(const struct tetra_scramb_search *ss, unsigned int num_blk, uint32_t e)
+{
+	uint32_t lfsr_init = (e << 2) | SCRAMB_INIT;
+	unsigned int need = num_blk < 2 ? num_blk : 2;
+	unsigned int b, bad = 0;
+
+	for (b = 0; b < num_blk; b++) {
+		enum tp_sap_data_type type = ss->blk_type[b];
+		const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+		uint8_t type4[TETRA_BLK_MAX_BITS], type3[TETRA_BLK_MAX_BITS];
+		uint8_t type3dp[TETRA_BLK_MAX_BITS*4], type2[TETRA_BLK_MAX_BITS];
+
+		memcpy(type4, ss->blk[b], tbp->type345_bits);
+		tetra_kern.scramb(lfsr_init, type4, tbp->type345_bits);
+		tetra_kern.gather(tetra_get_deinterl_tbl(type), tbp->type345_bits,
+				  type4, type3);
+		memset(type3dp, 0xff, sizeof(type3dp));
+		tetra_rcpc_depunct(TETRA_RCPC_PUNCT_2_3, type3, tbp->type345_bits, type3dp);
+		viterbi_dec_sb1_wrapper(type3dp, type2, tbp->type2_bits);
+		if (tetra_kern.crc16(0xffff, type2, tbp->type1_bits+16) == TETRA_CRC_OK) {
+			if (--need == 0)
+				return 1;
+		} else if (num_blk <= 2 || ++bad > num_blk - 2)
+			return 0;
+	}
+	return 0;
+}
+
+static void search_chunk(struct search *s, const struct search_job *j, uint64_t chunk)
+{
+	const struct tetra_scramb_search *ss = s->ss;
+	uint64_t col[30][TETRA_SSEARCH_MAX_BLK], syn[TETRA_SSEARCH_MAX_BLK];
+	unsigned int nb = s->num_blk, low, k, b;
+	uint64_t i, n, survivors = 0;
+	uint32_t e = j->e0;
+
+	low = j->num_free < CHUNK_BITS ? j->num_free : CHUNK_BITS;
+	for (k = 0; k < j->num_free; k++) {
+		for (b = 0; b < nb; b++)
+			col[k][b] = ss->plan[ss->blk_type[b]].col[j->free_bit[k]];
+	}
+
+	/* fold in the fixed bits of the job */
+	memcpy(syn, s->base, sizeof(syn));
+	for (k = 0; k < 30; k++) {
+		if (!((e >> k) & 1))
+			continue;
+		for (b = 0; b < nb; b++)
+			syn[b] ^= ss->plan[ss->blk_type[b]].col[k];
+	}
+
+	/* the high free bits are given by the chunk number */
+	for (k = low; k < j->num_free; k++) {
+		if (!((chunk >> (k - low)) & 1))
+			continue;
+		e |= 1U << j->free_bit[k];
+		for (b = 0; b < nb; b++)
+			syn[b] ^= col[k][b];
+	}
+
+	/* walk the low free bits in Gray code order: one bit flips per step */
+	n = 1ULL << low;
+	for (i = 0; i < n; i++) {
+		unsigned int fails = 0;
+
+		if (i) {
+			k = __builtin_ctzll(i);
+			e ^= 1U << j->free_bit[k];
+			for (b = 0; b < nb; b++)
+				syn[b] ^= col[k][b];
+		}
+		for (b = 0; b < nb; b++) {
+			fails += __builtin_popcountll(syn[b]);
+			if (fails > s->max_fail)
+				break;
+		}
+		if (b < nb)
+			continue;
+
+		survivors++;
+		if (verify(ss, nb, e)) {
+			uint32_t zero = 0;
+			__atomic_compare_exchange_n(&s->result, &zero, e | (1U << 31), 0,
+						    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+			__atomic_store_n(&s->done, 1, __ATOMIC_RELEASE);
+			break;
+		}
+	}
+	__atomic_fetch_add(&s->candidates, i < n ? i + 1 : n, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&s->survivors, survivors, __ATOMIC_RELAXED);
+}
+
+static void *search_thread(void *arg)
+{
+	struct search *s = arg;
+	unsigned int ji = 0;
+
+	while (!__atomic_load_n(&s->done, __ATOMIC_ACQUIRE)) {
+		uint64_t c = __atomic_fetch_add(&s->next_chunk, 1, __ATOMIC_RELAXED);
+
+		if (c >= s->num_chunks)
+			break;
+		/* chunks are handed out in order, so the job only moves on */
+		while (ji + 1 < s->num_jobs && s->job[ji+1].first_chunk <= c)
+			ji++;
+		search_chunk(s, &s->job[ji], c - s->job[ji].first_chunk);
+	}
+	return NULL;
+}
+
+int tetra_scramb_search_run(struct tetra_scramb_search *ss, uint16_t *mcc,
+			    uint16_t *mnc, uint8_t *colour)
+{
+	pthread_t thread[MAX_THREADS];
+	unsigned int num_threads = ss->num_threads, started = 0;
+	unsigned int b, i, total_chk = 0;
+	struct search s;
+	int rc;
+
+	if (!ss->num_blk)
+		return -EINVAL;
+
+	memset(&s, 0, sizeof(s));
+	s.ss = ss;
+	s.num_blk = ss->num_blk;
+	ss->num_blk = 0;
+	ss->stats.runs++;
+
+	for (b = 0; b < s.num_blk; b++) {
+		struct tetra_ssearch_plan *plan = &ss->plan[ss->blk_type[b]];
+
+		if (!plan->valid && (rc = plan_build(plan, ss->blk_type[b])) < 0)
+			return rc;
+		total_chk += plan->num_chk;
+	}
+	/* a wrong code violates half of the checks, the right one only those
+	 * hit by bit errors */
+	s.max_fail = total_chk / 4;
+
+	s.job = calloc(ss->num_pairs ? ss->num_pairs : 1, sizeof(*s.job));
+	if (!s.job)
+		return -ENOMEM;
+	if (ss->num_pairs) {
+		for (i = 0; i < ss->num_pairs; i++) {
+			if ((ss->mcc >= 0 && ss->pairs[i].mcc != ss->mcc) ||
+			    (ss->mnc >= 0 && ss->pairs[i].mnc != ss->mnc))
+				continue;
+			job_add(&s, e_from_cell(ss->pairs[i].mcc, ss->pairs[i].mnc, 0),
+				E_CC_MASK);
+		}
+	} else {
+		uint32_t free_mask = E_CC_MASK;
+
+		if (ss->mcc < 0)
+			free_mask |= E_MCC_MASK;
+		if (ss->mnc < 0)
+			free_mask |= E_MNC_MASK;
+		job_add(&s, e_from_cell(ss->mcc < 0 ? 0 : ss->mcc,
+					ss->mnc < 0 ? 0 : ss->mnc, 0), free_mask);
+	}
+
+	for (b = 0; b < s.num_blk; b++)
+		s.base[b] = plan_syndrome(&ss->plan[ss->blk_type[b]], ss->blk[b]);
+
+	if (!num_threads)
+		num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > MAX_THREADS)
+		num_threads = MAX_THREADS;
+	for (i = 0; i < num_threads; i++) {
+		if (pthread_create(&thread[i], NULL, search_thread, &s) != 0)
+			break;
+		started++;
+	}
+	if (!started)
+		search_thread(&s);
+	for (i = 0; i < started; i++)
+		pthread_join(thread[i], NULL);
+	free(s.job);
+
+	ss->stats.candidates += s.candidates;
+	ss->stats.survivors += s.survivors;
+	if (!s.result)
+		return 0;
+
+	ss->stats.found++;
+	*colour = s.result & E_CC_MASK;
+	*mnc = (s.result & E_MNC_MASK) >> 6;
+	*mcc = (s.result & E_MCC_MASK) >> 20;
+
+	return 1;
+}
@@ -0,0 +1,89 @@
+#ifndef TETRA_SCRAMB_SEARCH_H
+#define TETRA_SCRAMB_SEARCH_H
+/* Recovery of an unknown scrambling code from a few received blocks */
+
+#include <stdint.h>
+
+#include <lower_mac/tetra_lower_mac.h>
+
+/* Without a SYNC burst the scrambling code of a cell is unknown.  It only
+ * depends on the 30 bits of MCC, MNC and colour code, so it can be found
+ * by trying them all on a few blocks received from the cell.
+ *
+ * Each candidate is first tested against local parity checks of the
+ * punctured convolutional code.  Those are linear in the scrambling code,
+ * so walking the candidates in Gray code order costs one XOR and a
+ * popcount per block and candidate.  Only the few survivors are Viterbi
+ * decoded, and the first one to give a good CRC on two blocks (or all of
+ * them, if there are fewer) wins. */
+
+/* maximum number of blocks a search is run on */
+#define TETRA_SSEARCH_MAX_BLK		8
+/* number of blocks collected by default: a code is only taken on good
+ * CRCs of two blocks, a third one gives some margin for bit errors */
+#define TETRA_SSEARCH_DEF_BLK		4
+#define TETRA_SSEARCH_DEF_RUNS		3
+/* maximum number of MCC/MNC pairs known in advance */
+#define TETRA_SSEARCH_MAX_PAIRS		256
+/* maximum number of parity checks per block */
+#define TETRA_SSEARCH_MAX_CHK		64
+#define TETRA_SSEARCH_MAX_CHK_WEIGHT	32
+
+struct tetra_ssearch_pair {
+	uint16_t mcc;
+	uint16_t mnc;
+};
+
+/* parity checks of one block type and their dependency on the code */
+struct tetra_ssearch_plan {
+	int valid;
+	unsigned int num_chk;
+	uint8_t chk_len[TETRA_SSEARCH_MAX_CHK];
+	uint16_t chk_pos[TETRA_SSEARCH_MAX_CHK][TETRA_SSEARCH_MAX_CHK_WEIGHT];
+	uint64_t col[30];	/* checks flipped by each bit of MCC/MNC/CC */
+	uint64_t cst;		/* checks flipped by the fixed LFSR bits */
+};
+
+struct tetra_ssearch_stats {
+	unsigned int runs;		/* searches run */
+	unsigned int found;		/* searches which found the code */
+	uint64_t candidates;		/* codes tested against the parity checks */
+	uint64_t survivors;		/* codes which had to be Viterbi decoded */
+};
+
+struct tetra_scramb_search {
+	/* constraints, -1 if unknown */
+	int mcc;
+	int mnc;
+	/* if not empty, only these MCC/MNC pairs are tried */
+	unsigned int num_pairs;
+	struct tetra_ssearch_pair pairs[TETRA_SSEARCH_MAX_PAIRS];
+	unsigned int num_threads;	/* 0 for one per CPU */
+	unsigned int want_blk;		/* blocks to collect before searching */
+	unsigned int max_runs;		/* give up after this many searches */
+
+	/* blocks collected so far */
+	unsigned int num_blk;
+	enum tp_sap_data_type blk_type[TETRA_SSEARCH_MAX_BLK];
+	uint8_t blk[TETRA_SSEARCH_MAX_BLK][TETRA_BLK_MAX_BITS];
+
+	struct tetra_ssearch_plan plan[TPSAP_T_SCH_F+1];
+	struct tetra_ssearch_stats stats;
+};
+
+void tetra_scramb_search_init(struct tetra_scramb_search *ss);
+
+/* read "mcc mnc" pairs, one per line, from the file at 'path' */
+int tetra_scramb_search_load_pairs(struct tetra_scramb_search *ss, const char *path);
+
+/* keep the type-5 bits of a block for the next search.  Returns the number
+ * of blocks collected, -EINVAL for blocks without CRC or interleaving */
+int tetra_scramb_search_add_block(struct tetra_scramb_search *ss,
+				  enum tp_sap_data_type type, const uint8_t *bits);
+
+/* search the collected blocks for their code and forget them.  Returns 1
+ * and the cell identity if found, 0 if not and negative on error */
+int tetra_scramb_search_run(struct tetra_scramb_search *ss, uint16_t *mcc,
+			    uint16_t *mnc, uint8_t *colour);
+
+#endif /* TETRA_SCRAMB_SEARCH_H */
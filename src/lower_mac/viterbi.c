@@ -2,12 +2,16 @@
 #include <string.h>
 
 #include <lower_mac/viterbi_cch.h>
+#include <tetra_kernel.h>
 
 void viterbi_dec_sb1_wrapper(const uint8_t *in, uint8_t *out, unsigned int sym_count)
 {
-	int8_t vit_inp[864*4];
+	int8_t vit_inp[VITERBI_CCH_MAX_STEPS*4];
 	int i;
 
+	if (sym_count > VITERBI_CCH_MAX_STEPS)
+		return;
+
 	for (i = 0; i < sym_count*4; i++) {
 		switch (in[i]) {
 		case 0:
@@ -21,5 +25,5 @@ void viterbi_dec_sb1_wrapper(const uint8_t *in, uint8_t *out, unsigned int sym_c
 			break;
 		}
 	}
-	conv_cch_decode(vit_inp, out, sym_count);
+	tetra_kern.viterbi_cch(vit_inp, out, sym_count);
 }
@@ -32,7 +32,7 @@
  * G4 = 1 + D      + D3 + D4
  */
 
-static const uint8_t conv_cch_next_output[][2] = {
+const uint8_t conv_cch_next_output[16][2] = {
 	{  0, 15 }, { 11,  4 }, {  6,  9 }, { 13,  2 },
 	{  5, 10 }, { 14,  1 }, {  3, 12 }, {  8,  7 },
 	{ 15,  0 }, {  4, 11 }, {  9,  6 }, {  2, 13 },
@@ -64,3 +64,59 @@ int conv_cch_decode(int8_t *input, uint8_t *output, int n)
 
 	return osmo_conv_decode(&code, input, output);
 }
+
+/* Generic C soft-decision Viterbi decoder for the terminated (K=5, N=4)
+ * mother code: 'n' trellis steps, the last 4 input bits being the zero tail.
+ * Soft input is +127 for '0', -127 for '1' and 0 for erasures.
+ *
+ * The SIMD versions in tetra_kernel_x86.c use the very same arithmetic
+ * (16-bit metrics, normalized to state 0 after every step, ties resolved
+ * towards the lower predecessor) and thus produce identical output. */
+int viterbi_cch_decode(const int8_t *input, uint8_t *output, unsigned int n)
+{
+	int16_t metric[16], new[16];
+	uint16_t dec[VITERBI_CCH_MAX_STEPS];
+	unsigned int i, s;
+
+	if (n > VITERBI_CCH_MAX_STEPS)
+		return -1;
+
+	for (s = 0; s < 16; s++)
+		metric[s] = s ? VITERBI_CCH_M_INIT : 0;
+
+	for (i = 0; i < n; i++) {
+		const int8_t *r = input + i*4;
+		uint16_t d = 0;
+
+		for (s = 0; s < 16; s++) {
+			uint8_t o = conv_cch_next_output[s >> 1][s & 1];
+			int16_t bm = 0, m0, m1;
+			int j;
+
+			for (j = 0; j < 4; j++)
+				bm += (o >> (3-j)) & 1 ? -r[j] : r[j];
+
+			/* the predecessor (s>>1)+8 always emits the inverse */
+			m0 = metric[s >> 1] + bm;
+			m1 = metric[(s >> 1) + 8] - bm;
+			if (m1 > m0) {
+				new[s] = m1;
+				d |= 1 << s;
+			} else
+				new[s] = m0;
+		}
+		dec[i] = d;
+
+		for (s = 0; s < 16; s++)
+			metric[s] = new[s] - new[0];
+	}
+
+	/* trace back from the all-zero state reached by the tail bits */
+	s = 0;
+	for (i = n; i > 0; i--) {
+		output[i-1] = s & 1;
+		s = (s >> 1) + ((dec[i-1] >> s) & 1) * 8;
+	}
+
+	return 0;
+}
@@ -1,7 +1,17 @@
 #ifndef VITERBI_CCH_H
 #define VITERBI_CCH_H
 
+#include <stdint.h>
+
+/* largest block: SCH/F with 288 type-2 bits */
+#define VITERBI_CCH_MAX_STEPS	288
+/* start metric of all states but the zero state */
+#define VITERBI_CCH_M_INIT	(-8192)
+
+extern const uint8_t conv_cch_next_output[16][2];
+
 int conv_cch_encode(uint8_t *input, uint8_t *output, int n);
 int conv_cch_decode(int8_t *input, uint8_t *output, int n);
+int viterbi_cch_decode(const int8_t *input, uint8_t *output, unsigned int n);
 
 #endif /* VITERBI_CCH_H */
@@ -0,0 +1,260 @@
+/* Test program for the modulator and the channel simulator */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+
+#include "tetra_kernel.h"
+#include <tetra_common.h>
+#include <phy/tetra_burst.h>
+#include <phy/tetra_burst_sync.h>
+#include <phy/tetra_demod.h>
+#include <phy/tetra_gen.h>
+#include <phy/tetra_mod.h>
+#include <phy/tetra_chsim.h>
+#include <lower_mac/tetra_lower_mac.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/tetra_conv_enc.h>
+#include <lower_mac/viterbi.h>
+#include "testcheck.h"
+
+#define NUM_SYM		5000
+/* four multiframes */
+#define NUM_BURSTS	(4 * 72)
+#define NUM_SAMPLES	(NUM_BURSTS * TETRA_SYM_PER_TS * TETRA_MOD_SPS)
+
+void *tetra_tall_ctx;
+
+static uint8_t bits[NUM_BURSTS * TETRA_BITS_PER_TS];
+static float complex mod[NUM_SAMPLES];
+static float complex ch_out[TETRA_CHSIM_MAX_OUT(NUM_SAMPLES)];
+static float sym[TETRA_DEMOD_MAX_SYM(TETRA_CHSIM_MAX_OUT(NUM_SAMPLES))];
+static uint8_t rx_bits[2 * TETRA_DEMOD_MAX_SYM(TETRA_CHSIM_MAX_OUT(NUM_SAMPLES))];
+
+/* the modulator against the textbook sum over the symbols, fed in
+ * uneven pieces across its blocks */
+static void test_pulse(void)
+{
+	static const int step[4] = { 1, 3, -1, -3 };
+	static float complex s[NUM_SYM];
+	struct tetra_mod tm;
+	unsigned int i, n, pos, len;
+	float err = 0, power = 0;
+	int phase = 0;
+
+	for (i = 0; i < NUM_SYM; i++) {
+		bits[2*i] = rand() & 1;
+		bits[2*i+1] = rand() & 1;
+		phase += step[bits[2*i] * 2 + bits[2*i+1]];
+		s[i] = cexpf(I * phase * M_PI / 4);
+	}
+
+	tetra_mod_init(&tm);
+	for (pos = 0; pos < NUM_SYM; pos += len) {
+		len = 1 + rand() % 700;
+		if (len > NUM_SYM - pos)
+			len = NUM_SYM - pos;
+		tetra_mod_bits(&tm, bits + 2 * pos, len, mod + pos * TETRA_MOD_SPS);
+	}
+
+	for (n = 0; n < NUM_SYM * TETRA_MOD_SPS; n++) {
+		float t = (float) n / TETRA_MOD_SPS - TETRA_MOD_SPAN / 2;
+		float complex v = 0;
+		int m;
+
+		for (m = n / TETRA_MOD_SPS - TETRA_MOD_SPAN + 1; m <= (int) (n / TETRA_MOD_SPS); m++) {
+			if (m >= 0)
+				v += s[m] * tetra_rrc(t - m, TETRA_RRC_ALPHA);
+		}
+		if (cabsf(v - mod[n]) > err)
+			err = cabsf(v - mod[n]);
+		power += crealf(mod[n] * conjf(mod[n]));
+	}
+	power /= NUM_SYM * TETRA_MOD_SPS;
+
+	printf("max error %g, mean power %.3f\n", err, power);
+	check(err < 1e-5f && tm.symbols == NUM_SYM, "pulse shape");
+	check(fabsf(power - 1) < 0.05f, "unit power");
+}
+
+static void test_channel(void)
+{
+	struct tetra_chsim cs;
+	unsigned int i, n, deep = 0;
+	float power = 0, err = 0;
+
+	for (i = 0; i < NUM_SAMPLES; i++)
+		mod[i] = 1;
+
+	/* the delay of two samples */
+	tetra_chsim_init(&cs, TETRA_DEMOD_RATE, 1);
+	n = tetra_chsim_run(&cs, mod, 100, ch_out);
+	check(n == 100 && ch_out[1] == 0 && ch_out[2] == 1 && ch_out[99] == 1, "transparent");
+
+	tetra_chsim_init(&cs, TETRA_DEMOD_RATE, 1);
+	cs.snr_db = 10;
+	tetra_chsim_update(&cs);
+	n = tetra_chsim_run(&cs, mod, NUM_SAMPLES, ch_out);
+	for (i = 2; i < n; i++)
+		power += crealf((ch_out[i] - 1) * conjf(ch_out[i] - 1));
+	power /= n - 2;
+	printf("noise power %.4f\n", power);
+	check(fabsf(power - 0.1f) < 0.005f, "noise");
+
+	tetra_chsim_init(&cs, TETRA_DEMOD_RATE, 1);
+	cs.freq_hz = -300;
+	tetra_chsim_update(&cs);
+	n = tetra_chsim_run(&cs, mod, NUM_SAMPLES, ch_out);
+	for (i = 3; i < n; i++) {
+		float e = fabsf(cargf(ch_out[i] * conjf(ch_out[i-1])) - 2 * M_PI * -300 / TETRA_DEMOD_RATE);
+
+		if (e > err)
+			err = e;
+	}
+	check(err < 1e-4f, "frequency offset");
+
+	tetra_chsim_init(&cs, TETRA_DEMOD_RATE, 1);
+	cs.ppm = 500;
+	tetra_chsim_update(&cs);
+	n = tetra_chsim_run(&cs, mod, NUM_SAMPLES / 2, ch_out);
+	n += tetra_chsim_run(&cs, mod, NUM_SAMPLES / 2, ch_out);
+	printf("%u samples out of %u\n", n, NUM_SAMPLES);
+	check(abs((int) n - (int) lroundf(NUM_SAMPLES / 1.0005f)) <= 2, "clock error");
+
+	/* Rayleigh: power below a tenth of the mean a tenth of the time */
+	tetra_chsim_init(&cs, TETRA_DEMOD_RATE, 1);
+	cs.doppler_hz = 100;
+	tetra_chsim_update(&cs);
+	power = 0;
+	for (i = 0; i < 20; i++) {
+		unsigned int j;
+
+		n = tetra_chsim_run(&cs, mod, NUM_SAMPLES, ch_out);
+		for (j = 0; j < n; j++) {
+			float p = crealf(ch_out[j] * conjf(ch_out[j]));
+
+			power += p;
+			deep += p < 0.1f;
+		}
+	}
+	power /= 20.0f * NUM_SAMPLES;
+	printf("fading: mean power %.3f, %.3f of the time 10 dB down\n",
+	       power, (float) deep / (20.0f * NUM_SAMPLES));
+	check(fabsf(power - 1) < 0.15f && deep > 20 * NUM_SAMPLES / 20 &&
+	      deep < 20 * NUM_SAMPLES * 3 / 20, "fading");
+}
+
+static struct tetra_gen tg;
+static unsigned int rx_blocks, rx_crc_ok;
+
+/* instead of the lower MAC, only checks the CRC */
+void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits,
+		      const int8_t *soft, unsigned int len, void *priv)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+	uint8_t type4[512], type3[512], type3dp[512*4], type2[512];
+
+	if (!tbp->have_crc16)
+		return;
+
+	memcpy(type4, bits, tbp->type345_bits);
+	tetra_scramb_bits(type == TPSAP_T_SB1 ? SCRAMB_INIT :
+			  tetra_scramb_get_init(tg.mcc, tg.mnc, tg.colour_code),
+			  type4, tbp->type345_bits);
+	block_deinterleave(tbp->type345_bits, tbp->interleave_a, type4, type3);
+	memset(type3dp, 0xff, sizeof(type3dp));
+	tetra_rcpc_depunct(TETRA_RCPC_PUNCT_2_3, type3, tbp->type345_bits, type3dp);
+	viterbi_dec_sb1_wrapper(type3dp, type2, tbp->type2_bits);
+
+	rx_blocks++;
+	if (tetra_kern.crc16(0xffff, type2, tbp->type1_bits + 16) == TETRA_CRC_OK)
+		rx_crc_ok++;
+}
+
+/* generator, modulator, channel, demodulator and burst synchronizer,
+ * returns the blocks with a good CRC */
+static unsigned int run_chain(const char *name, float snr_db, float freq_hz, float ppm,
+			      float doppler_hz)
+{
+	struct tetra_mod tm;
+	struct tetra_chsim cs;
+	struct tetra_demod td;
+	struct tetra_rx_state trs;
+	unsigned int i, n, num_sym;
+
+	tetra_gen_init(&tg, 5);
+	for (i = 0; i < NUM_BURSTS; i++)
+		tetra_gen_burst(&tg, bits + i * TETRA_BITS_PER_TS);
+
+	tetra_mod_init(&tm);
+	tetra_mod_bits(&tm, bits, NUM_BURSTS * TETRA_SYM_PER_TS, mod);
+
+	tetra_chsim_init(&cs, TETRA_DEMOD_RATE, 3);
+	cs.snr_db = snr_db;
+	cs.freq_hz = freq_hz;
+	cs.ppm = ppm;
+	cs.doppler_hz = doppler_hz;
+	tetra_chsim_update(&cs);
+	n = tetra_chsim_run(&cs, mod, NUM_SAMPLES, ch_out);
+
+	tetra_demod_init(&td);
+	num_sym = tetra_demod_in(&td, ch_out, n, sym);
+	tetra_demod_slice(sym, num_sym, rx_bits);
+
+	rx_blocks = rx_crc_ok = 0;
+	memset(&trs, 0, sizeof(trs));
+	for (i = 0; i < 2 * num_sym; i += 128)
+		tetra_burst_sync_in(&trs, rx_bits + i, 2 * num_sym - i < 128 ? 2 * num_sym - i : 128);
+
+	printf("%s: %u of %u blocks with a good CRC\n", name, rx_crc_ok, rx_blocks);
+	return rx_crc_ok;
+}
+
+static void test_chain(void)
+{
+	/* after the SYNC burst in the first multiframe, which the
+	 * synchronizer locks on: the SCH/F of every burst and the SB1 and
+	 * SB2 of the three SYNC bursts, less one burst at the end */
+	const unsigned int max = (NUM_BURSTS - 72) - 3 + 2 * 3 - 1;
+	unsigned int clean, fading;
+
+	clean = run_chain("clean", 30, 500, 50, 0);
+	check(clean == max && clean == rx_blocks, "demodulated");
+	fading = run_chain("fading", 20, 500, 50, 20);
+	check(fading < clean, "fading costs blocks");
+}
+
+int main(int argc, char **argv)
+{
+	srand(42);
+	tetra_verbosity = TETRA_V_NONE;
+	tetra_kernel_init();
+
+	test_pulse();
+	test_channel();
+	test_chain();
+
+	check_exit();
+}
@@ -24,7 +24,11 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <osmocom/core/utils.h>
+
 #include <phy/tetra_burst.h>
+#include <tetra_common.h>
+#include <tetra_kernel.h>
 
 #define DQPSK4_BITS_PER_SYM	2
 
@@ -143,7 +147,7 @@ int32_t sum_up_phase(const uint8_t *bits, unsigned int sym_count)
 		sum_phase += bits2phase[sym_in];
 	}
 
-	printf("phase sum over %u symbols: %dpi/4, mod 8 = %dpi/4, wrap = %dpi/4\n",
+	TPRINTF(TETRA_V_DUMP, "phase sum over %u symbols: %dpi/4, mod 8 = %dpi/4, wrap = %dpi/4\n",
 		sym_count, sum_phase, sum_phase % 8, calc_phase_adj(sum_phase));
 	return sum_phase;
 }
@@ -266,69 +270,82 @@ int build_norm_c_d_burst(uint8_t *buf, const uint8_t *bkn1, const uint8_t *bb, c
 	return cur - buf;
 }
 
+static const struct {
+	enum tetra_train_seq type;
+	const uint8_t *bits;
+	unsigned int len;
+} train_seqs[] = {
+	{ TETRA_TRAIN_SYNC,	y_bits,	sizeof(y_bits) },
+	{ TETRA_TRAIN_NORM_1,	n_bits,	sizeof(n_bits) },
+	{ TETRA_TRAIN_NORM_2,	p_bits,	sizeof(p_bits) },
+	{ TETRA_TRAIN_NORM_3,	q_bits,	sizeof(q_bits) },
+	{ TETRA_TRAIN_EXT,	x_bits,	sizeof(x_bits) },
+};
+
 int tetra_find_train_seq(const uint8_t *in, unsigned int end_of_in,
 			 uint32_t mask_of_train_seq, unsigned int *offset)
 {
-	const uint8_t *cur;
-
-	for (cur = in; cur < in + end_of_in; cur++) {
-		int remain_len = (in + end_of_in) - cur;
-
-		if (mask_of_train_seq & (1 << TETRA_TRAIN_SYNC) &&
-		    remain_len >= sizeof(y_bits) &&
-		    !memcmp(cur, y_bits, sizeof(y_bits))) {
-			*offset = (cur - in);
-			return TETRA_TRAIN_SYNC;
-		}
-		if (mask_of_train_seq & (1 << TETRA_TRAIN_NORM_1) &&
-		    remain_len >= sizeof(n_bits) &&
-		    !memcmp(cur, n_bits, sizeof(n_bits))) {
-			*offset = (cur - in);
-			return TETRA_TRAIN_NORM_1;
-		}
-		if (mask_of_train_seq & (1 << TETRA_TRAIN_NORM_2) &&
-		    remain_len >= sizeof(p_bits) &&
-		    !memcmp(cur, p_bits, sizeof(p_bits))) {
-			*offset = (cur - in);
-			return TETRA_TRAIN_NORM_2;
-		}
-		if (mask_of_train_seq & (1 << TETRA_TRAIN_NORM_3) &&
-		    remain_len >= sizeof(q_bits) &&
-		    !memcmp(cur, q_bits, sizeof(q_bits))) {
-			*offset = (cur - in);
-			return TETRA_TRAIN_NORM_3;
-		}
-		if (mask_of_train_seq & (1 << TETRA_TRAIN_EXT) &&
-		    remain_len >= sizeof(x_bits) &&
-		    !memcmp(cur, x_bits, sizeof(x_bits))) {
-			*offset = (cur - in);
-			return TETRA_TRAIN_EXT;
+	unsigned int i, limit = end_of_in;
+	int found = -1;
+
+	/* No two training sequences start alike, so the earliest match
+	 * wins.  Once we have one, the others only need to be searched
+	 * in front of it. */
+	for (i = 0; i < ARRAY_SIZE(train_seqs); i++) {
+		unsigned int len = train_seqs[i].len;
+		unsigned int search_len;
+		int rc;
+
+		if (!(mask_of_train_seq & (1 << train_seqs[i].type)))
+			continue;
+		if (found < 0)
+			search_len = end_of_in;
+		else
+			search_len = limit + len - 1;
+		if (search_len > end_of_in)
+			search_len = end_of_in;
+
+		rc = tetra_kern.find_seq(in, search_len, train_seqs[i].bits, len);
+		if (rc >= 0) {
+			limit = rc;
+			*offset = rc;
+			found = train_seqs[i].type;
 		}
 	}
-	return -1;
+	return found;
 }
 
-void tetra_burst_rx_cb(const uint8_t *burst, unsigned int len, enum tetra_train_seq type, void *priv)
+/* the same parts of the soft bits, if there are any.  The broadcast
+ * block is not convolutionally coded and only ever needs hard bits. */
+#define SOFT(x)	(soft ? soft+(x) : NULL)
+
+void tetra_burst_rx_cb(const uint8_t *burst, const int8_t *soft, unsigned int len,
+		       enum tetra_train_seq type, void *priv)
 {
 	uint8_t bbk_buf[NDB_BBK_BITS];
 	uint8_t ndbf_buf[2*NDB_BLK_BITS];
+	int8_t ndbf_soft[2*NDB_BLK_BITS];
 
 	switch (type) {
 	case TETRA_TRAIN_SYNC:
 		/* Split SB1, SB2 and Broadcast Block */
 		/* send three parts of the burst via TP-SAP into lower MAC */
-		tp_sap_udata_ind(TPSAP_T_SB1, burst+SB_BLK1_OFFSET, SB_BLK1_BITS, priv);
-		tp_sap_udata_ind(TPSAP_T_BBK, burst+SB_BBK_OFFSET, SB_BBK_BITS, priv);
-		tp_sap_udata_ind(TPSAP_T_SB2, burst+SB_BLK2_OFFSET, SB_BLK2_BITS, priv);
+		tp_sap_udata_ind(TPSAP_T_SB1, burst+SB_BLK1_OFFSET, SOFT(SB_BLK1_OFFSET),
+				 SB_BLK1_BITS, priv);
+		tp_sap_udata_ind(TPSAP_T_BBK, burst+SB_BBK_OFFSET, NULL, SB_BBK_BITS, priv);
+		tp_sap_udata_ind(TPSAP_T_SB2, burst+SB_BLK2_OFFSET, SOFT(SB_BLK2_OFFSET),
+				 SB_BLK2_BITS, priv);
 		break;
 	case TETRA_TRAIN_NORM_2:
 		/* re-combine the broadcast block */
 		memcpy(bbk_buf, burst+NDB_BBK1_OFFSET, NDB_BBK1_BITS);
 		memcpy(bbk_buf+NDB_BBK1_BITS, burst+NDB_BBK2_OFFSET, NDB_BBK2_BITS);
 		/* send three parts of the burst via TP-SAP into lower MAC */
-		tp_sap_udata_ind(TPSAP_T_BBK, bbk_buf, NDB_BBK_BITS, priv);
-		tp_sap_udata_ind(TPSAP_T_NDB, burst+NDB_BLK1_OFFSET, NDB_BLK_BITS, priv);
-		tp_sap_udata_ind(TPSAP_T_NDB, burst+NDB_BLK2_OFFSET, NDB_BLK_BITS, priv);
+		tp_sap_udata_ind(TPSAP_T_BBK, bbk_buf, NULL, NDB_BBK_BITS, priv);
+		tp_sap_udata_ind(TPSAP_T_NDB, burst+NDB_BLK1_OFFSET, SOFT(NDB_BLK1_OFFSET),
+				 NDB_BLK_BITS, priv);
+		tp_sap_udata_ind(TPSAP_T_NDB, burst+NDB_BLK2_OFFSET, SOFT(NDB_BLK2_OFFSET),
+				 NDB_BLK_BITS, priv);
 		break;
 	case TETRA_TRAIN_NORM_1:
 		/* re-combine the broadcast block */
@@ -337,9 +354,14 @@ void tetra_burst_rx_cb(const uint8_t *burst, unsigned int len, enum tetra_train_
 		/* re-combine the two parts */
 		memcpy(ndbf_buf, burst+NDB_BLK1_OFFSET, NDB_BLK_BITS);
 		memcpy(ndbf_buf+NDB_BLK_BITS, burst+NDB_BLK2_OFFSET, NDB_BLK_BITS);
+		if (soft) {
+			memcpy(ndbf_soft, soft+NDB_BLK1_OFFSET, NDB_BLK_BITS);
+			memcpy(ndbf_soft+NDB_BLK_BITS, soft+NDB_BLK2_OFFSET, NDB_BLK_BITS);
+		}
 		/* send two parts of the burst via TP-SAP into lower MAC */
-		tp_sap_udata_ind(TPSAP_T_BBK, bbk_buf, NDB_BBK_BITS, priv);
-		tp_sap_udata_ind(TPSAP_T_SCH_F, ndbf_buf, 2*NDB_BLK_BITS, priv);
+		tp_sap_udata_ind(TPSAP_T_BBK, bbk_buf, NULL, NDB_BBK_BITS, priv);
+		tp_sap_udata_ind(TPSAP_T_SCH_F, ndbf_buf, soft ? ndbf_soft : NULL,
+				 2*NDB_BLK_BITS, priv);
 		break;
 	}
 }
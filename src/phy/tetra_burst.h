@@ -12,7 +12,9 @@ enum tp_sap_data_type {
 	TPSAP_T_SCH_F,
 };
 
-extern void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits, unsigned int len, void *priv);
+/* 'soft' are the soft bits of 'bits' (+127 a sure 0), or NULL */
+extern void tp_sap_udata_ind(enum tp_sap_data_type type, const uint8_t *bits,
+			     const int8_t *soft, unsigned int len, void *priv);
 
 /* 9.4.4.2.6 Synchronization continuous downlink burst */
 int build_sync_c_d_burst(uint8_t *buf, const uint8_t *sb, const uint8_t *bb, const uint8_t *bkn);
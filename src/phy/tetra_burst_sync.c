@@ -30,10 +30,10 @@
 #include <phy/tetra_burst.h>
 #include <tetra_tdma.h>
 #include <phy/tetra_burst_sync.h>
+#include <tetra_event.h>
 
-struct tetra_phy_state t_phy_state;
-
-void tetra_burst_rx_cb(const uint8_t *burst, unsigned int len, enum tetra_train_seq type, void *priv);
+void tetra_burst_rx_cb(const uint8_t *burst, const int8_t *soft, unsigned int len,
+		       enum tetra_train_seq type, void *priv);
 
 static void make_bitbuf_space(struct tetra_rx_state *trs, unsigned int len)
 {
@@ -44,6 +44,8 @@ static void make_bitbuf_space(struct tetra_rx_state *trs, unsigned int len)
 
 		DEBUGP("bitbuf left: %u, shrinking by %u\n", bitbuf_space, delta);
 		memmove(trs->bitbuf, trs->bitbuf + delta, trs->bits_in_buf - delta);
+		if (trs->have_soft)
+			memmove(trs->softbuf, trs->softbuf + delta, trs->bits_in_buf - delta);
 		trs->bits_in_buf -= delta;
 		trs->bitbuf_start_bitnum += delta;
 		bitbuf_space = sizeof(trs->bitbuf) - trs->bits_in_buf;
@@ -52,16 +54,27 @@ static void make_bitbuf_space(struct tetra_rx_state *trs, unsigned int len)
 
 /* input a raw bitstream into the tetra burst synchronizaer */
 int tetra_burst_sync_in(struct tetra_rx_state *trs, uint8_t *bits, unsigned int len)
+{
+	return tetra_burst_sync_in_soft(trs, bits, NULL, len);
+}
+
+int tetra_burst_sync_in_soft(struct tetra_rx_state *trs, uint8_t *bits,
+			     const int8_t *soft, unsigned int len)
 {
 	int rc;
 	unsigned int train_seq_offs;
+	const int8_t *burst_soft;
 
 	DEBUGP("burst_sync_in: %u bits, state %u\n", len, trs->state);
 
 	/* First: append the data to the bitbuf */
+	trs->have_soft = soft != NULL;
 	make_bitbuf_space(trs, len);
 	memcpy(trs->bitbuf + trs->bits_in_buf, bits, len);
+	if (soft)
+		memcpy(trs->softbuf + trs->bits_in_buf, soft, len);
 	trs->bits_in_buf += len;
+	burst_soft = soft ? trs->softbuf : NULL;
 
 	switch (trs->state) {
 	case RX_S_UNLOCKED:
@@ -76,7 +89,16 @@ int tetra_burst_sync_in(struct tetra_rx_state *trs, uint8_t *bits, unsigned int
 					  (1 << TETRA_TRAIN_SYNC), &train_seq_offs);
 		if (rc < 0)
 			return rc;
-		printf("found SYNC training sequence in bit #%u\n", train_seq_offs);
+		TPRINTF(TETRA_V_BLOCK, "found SYNC training sequence in bit #%u\n", train_seq_offs);
+		if (tetra_event_active) {
+			struct tetra_ev_burst ev = {
+				.train_seq	= TETRA_TRAIN_SYNC,
+				.locked		= 0,
+				.offset		= train_seq_offs,
+			};
+
+			tetra_event_put(TETRA_EV_BURST, &ev, sizeof(ev), NULL, 0);
+		}
 		trs->state = RX_S_KNOW_FSTART;
 		trs->next_frame_start_bitnum = trs->bitbuf_start_bitnum + train_seq_offs + 296;
 #if 0
@@ -98,6 +120,8 @@ int tetra_burst_sync_in(struct tetra_rx_state *trs, uint8_t *bits, unsigned int
 			int bits_remaining = trs->bits_in_buf - offset;
 
 			memmove(trs->bitbuf, trs->bitbuf+offset, bits_remaining);
+			if (soft)
+				memmove(trs->softbuf, trs->softbuf+offset, bits_remaining);
 			trs->bits_in_buf = bits_remaining;
 			trs->bitbuf_start_bitnum += offset;
 
@@ -110,18 +134,34 @@ int tetra_burst_sync_in(struct tetra_rx_state *trs, uint8_t *bits, unsigned int
 			return len;
 		} else {
 			/* we have successfully received (at least) one frame */
-			tetra_tdma_time_add_tn(&t_phy_state.time, 1);
-			printf("\nBURST");
+			t_phy_state.slot++;
+			if (t_phy_state.start_ns)
+				tetra_tdma_clock_set(&t_phy_state.clock, t_phy_state.slot,
+						     tetra_tdma_sample2ns(t_phy_state.start_ns,
+									  trs->bitbuf_start_bitnum,
+									  TETRA_BIT_RATE));
+			TPRINTF(TETRA_V_BLOCK, "\nBURST");
 			DEBUGP(": %s", osmo_ubit_dump(trs->bitbuf, TETRA_BITS_PER_TS));
-			printf("\n");
+			TPRINTF(TETRA_V_BLOCK, "\n");
 			rc = tetra_find_train_seq(trs->bitbuf, trs->bits_in_buf,
 						  (1 << TETRA_TRAIN_NORM_1)|
 						  (1 << TETRA_TRAIN_NORM_2)|
 						  (1 << TETRA_TRAIN_SYNC), &train_seq_offs);
+			if (tetra_event_active) {
+				struct tetra_ev_burst ev = {
+					.train_seq	= rc < 0 ? 0xff : rc,
+					.locked		= 1,
+					.offset		= rc < 0 ? 0 : train_seq_offs,
+				};
+
+				tetra_event_set_time(t_phy_state.slot);
+				tetra_event_put(TETRA_EV_BURST, &ev, sizeof(ev), NULL, 0);
+			}
 			switch (rc) {
 			case TETRA_TRAIN_SYNC:
 				if (train_seq_offs == 214)
-					tetra_burst_rx_cb(trs->bitbuf, TETRA_BITS_PER_TS, rc, trs->burst_cb_priv);
+					tetra_burst_rx_cb(trs->bitbuf, burst_soft, TETRA_BITS_PER_TS, rc,
+							  trs->burst_cb_priv);
 				else {
 					fprintf(stderr, "#### SYNC burst at offset %u?!?\n", train_seq_offs);
 					trs->state = RX_S_UNLOCKED;
@@ -131,7 +171,8 @@ int tetra_burst_sync_in(struct tetra_rx_state *trs, uint8_t *bits, unsigned int
 			case TETRA_TRAIN_NORM_2:
 			case TETRA_TRAIN_NORM_3:
 				if (train_seq_offs == 244)
-					tetra_burst_rx_cb(trs->bitbuf, TETRA_BITS_PER_TS, rc, trs->burst_cb_priv);
+					tetra_burst_rx_cb(trs->bitbuf, burst_soft, TETRA_BITS_PER_TS, rc,
+							  trs->burst_cb_priv);
 				else
 					fprintf(stderr, "#### SYNC burst at offset %u?!?\n", train_seq_offs);
 				break;
@@ -144,6 +185,8 @@ int tetra_burst_sync_in(struct tetra_rx_state *trs, uint8_t *bits, unsigned int
 			/* move remainder to start of buffer */
 			trs->bits_in_buf -= TETRA_BITS_PER_TS;
 			memmove(trs->bitbuf, trs->bitbuf+TETRA_BITS_PER_TS, trs->bits_in_buf);
+			if (soft)
+				memmove(trs->softbuf, trs->softbuf+TETRA_BITS_PER_TS, trs->bits_in_buf);
 			trs->bitbuf_start_bitnum += TETRA_BITS_PER_TS;
 			trs->next_frame_start_bitnum += TETRA_BITS_PER_TS;
 		}
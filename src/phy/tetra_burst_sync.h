@@ -13,6 +13,8 @@ struct tetra_rx_state {
 	enum rx_state state;
 	unsigned int bits_in_buf;		/* how many bits are currently in bitbuf */
 	uint8_t bitbuf[4096];
+	int8_t softbuf[4096];			/* soft bits alongside bitbuf, if given */
+	int have_soft;
 	unsigned int bitbuf_start_bitnum;	/* bit number at first element in bitbuf */
 	unsigned int next_frame_start_bitnum;	/* frame start expected at this bitnum */
 
@@ -23,4 +25,10 @@ struct tetra_rx_state {
 /* input a raw bitstream into the tetra burst synchronizaer */
 int tetra_burst_sync_in(struct tetra_rx_state *trs, uint8_t *bits, unsigned int len);
 
+/* the same with the soft bits of 'bits' (+127 a sure 0, -127 a sure 1),
+ * which are passed on to the lower MAC for the Viterbi decoder.  The
+ * training sequences are still found in the hard bits. */
+int tetra_burst_sync_in_soft(struct tetra_rx_state *trs, uint8_t *bits,
+			     const int8_t *soft, unsigned int len);
+
 #endif /* TETRA_BURST_SYNC_H */
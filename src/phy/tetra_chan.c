@@ -0,0 +1,289 @@
+/* Polyphase FFT channelizer: all TETRA carriers of a wideband capture */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <complex.h>
+
+#include <osmocom/core/talloc.h>
+
+#include <tetra_kernel.h>
+#include <phy/tetra_demod.h>
+#include <phy/tetra_chan.h>
+
+/* windowed sinc low pass, 'cutoff' in cycles per sample, DC gain 'gain' */
+static void lowpass(float *h, unsigned int len, float cutoff, float gain)
+{
+	float sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < len; i++) {
+		float x = i - (len - 1) / 2.0f;
+		float w = 2 * M_PI * i / (len - 1);
+
+		/* Blackman-Harris */
+		h[i] = 0.35875f - 0.48829f * cosf(w) + 0.14128f * cosf(2 * w)
+			- 0.01168f * cosf(3 * w);
+		if (fabsf(x) > 1e-6f)
+			h[i] *= sinf(2 * M_PI * cutoff * x) / (M_PI * x);
+		else
+			h[i] *= 2 * cutoff;
+		sum += h[i];
+	}
+	for (i = 0; i < len; i++)
+		h[i] *= gain / sum;
+}
+
+/* unnormalized inverse FFT, 'n' a power of two, tw[k] = exp(2j pi k / n) */
+static void fft_inv(float complex *x, const float complex *tw, unsigned int n)
+{
+	unsigned int i, j, k, len;
+
+	for (i = 1, j = 0; i < n; i++) {
+		unsigned int bit = n >> 1;
+		float complex t;
+
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if (i < j) {
+			t = x[i];
+			x[i] = x[j];
+			x[j] = t;
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1) {
+		unsigned int half = len / 2, step = n / len;
+
+		for (i = 0; i < n; i += len) {
+			for (k = 0; k < half; k++) {
+				float complex a = x[i+k];
+				float complex b = x[i+k+half] * tw[k*step];
+
+				x[i+k] = a + b;
+				x[i+k+half] = a - b;
+			}
+		}
+	}
+}
+
+struct tetra_chan *tetra_chan_alloc(void *ctx, unsigned int num_chan,
+				    tetra_chan_cb cb, void *priv)
+{
+	float proto[TETRA_RESAMP_L * TETRA_RESAMP_TAPS];
+	struct tetra_chan *ch;
+	unsigned int i, k;
+	float *h;
+
+	if (num_chan < 8 || num_chan > TETRA_CHAN_MAX || (num_chan & (num_chan - 1)))
+		return NULL;
+
+	ch = talloc_zero(ctx, struct tetra_chan);
+	if (!ch)
+		return NULL;
+	ch->num_chan = num_chan;
+	ch->decim = num_chan / TETRA_CHAN_OVERSAMPLE;
+	ch->rate = num_chan * TETRA_CHAN_SPACING;
+	ch->num_taps = num_chan * TETRA_CHAN_TAPS;
+	ch->cb = cb;
+	ch->cb_priv = priv;
+
+	ch->taps = talloc_zero_array(ch, float, ch->num_taps);
+	ch->buf = talloc_zero_array(ch, float complex, ch->num_taps - 1 + TETRA_CHAN_BLK);
+	ch->fold = talloc_zero_array(ch, float complex, num_chan);
+	ch->fft = talloc_zero_array(ch, float complex, num_chan);
+	ch->tw = talloc_zero_array(ch, float complex, num_chan / 2);
+	ch->out = talloc_zero_array(ch, struct tetra_chan_out, num_chan);
+	h = talloc_zero_array(ch, float, ch->num_taps);
+	if (!ch->taps || !ch->buf || !ch->fold || !ch->fft || !ch->tw || !ch->out || !h) {
+		talloc_free(ch);
+		return NULL;
+	}
+
+	/* passes +-20 kHz around the centre of a channel, which holds a
+	 * carrier up to 6.25 kHz off, and stops before 50 kS/s aliases */
+	lowpass(h, ch->num_taps, 2.0f / num_chan, 1);
+	for (i = 0; i < ch->num_taps; i++)
+		ch->taps[i] = h[ch->num_taps - 1 - i];
+	talloc_free(h);
+
+	for (i = 0; i < num_chan / 2; i++)
+		ch->tw[i] = cexpf(I * 2 * M_PI * i / num_chan);
+
+	/* 18 kHz at 18 * 50 kS/s.  Whatever aliases back into 36 kS/s is
+	 * outside the 12.15 kHz of the signal */
+	lowpass(proto, TETRA_RESAMP_L * TETRA_RESAMP_TAPS,
+		(float) TETRA_DEMOD_RATE / 2 / (TETRA_CHAN_RATE * TETRA_RESAMP_L),
+		TETRA_RESAMP_L);
+	for (i = 0; i < TETRA_RESAMP_L; i++) {
+		for (k = 0; k < TETRA_RESAMP_TAPS; k++)
+			ch->resamp_taps[i][k] = proto[i + k * TETRA_RESAMP_L];
+	}
+
+	ch->next = ch->num_taps - 1;
+	ch->t_mod = ch->next % num_chan;
+
+	return ch;
+}
+
+int tetra_chan_add(struct tetra_chan *ch, int32_t offset_hz)
+{
+	struct tetra_chan_out *o;
+	int32_t bin, rest;
+
+	if (ch->num_out >= ch->num_chan)
+		return -ENOSPC;
+	/* the whole carrier has to be inside the input */
+	if (abs(offset_hz) + 2 * TETRA_CHAN_SPACING > ch->rate / 2)
+		return -EINVAL;
+
+	bin = lroundf((float) offset_hz / TETRA_CHAN_SPACING);
+	rest = offset_hz - bin * TETRA_CHAN_SPACING;
+
+	o = &ch->out[ch->num_out];
+	memset(o, 0, sizeof(*o));
+	o->offset_hz = offset_hz;
+	o->bin = (bin + ch->num_chan) % ch->num_chan;
+	o->active = 1;
+	o->nco = 1;
+	o->nco_step = cexpf(-I * 2 * M_PI * rest / TETRA_CHAN_RATE);
+	o->num_in = o->pos = TETRA_RESAMP_TAPS - 1;
+
+	return ch->num_out++;
+}
+
+/* one channel sample for all carriers, the newest input at ch->next */
+static void channelize(struct tetra_chan *ch)
+{
+	const float complex *w = ch->buf + ch->next + 1 - ch->num_taps;
+	unsigned int n = ch->num_chan, i;
+
+	memset(ch->fold, 0, n * sizeof(*ch->fold));
+	for (i = 0; i < ch->num_taps; i += n)
+		tetra_kern.mac_cf((const float *) (w + i), ch->taps + i,
+				  (float *) ch->fold, n);
+
+	/* fold[] is reversed.  Rotating by the time of the newest sample
+	 * keeps the phase of the channels continuous when the FFTs are
+	 * less than num_chan samples apart */
+	for (i = 0; i < n; i++)
+		ch->fft[i] = ch->fold[n - 1 - (i + ch->t_mod) % n];
+	fft_inv(ch->fft, ch->tw, n);
+
+	for (i = 0; i < ch->num_out; i++) {
+		struct tetra_chan_out *o = &ch->out[i];
+		float complex v = ch->fft[o->bin];
+
+		o->pwr += crealf(v * conjf(v));
+		o->pwr_n++;
+		if (!o->active)
+			continue;
+		o->in[o->num_in++] = v * o->nco;
+		o->nco *= o->nco_step;
+	}
+
+	if (ch->bin_pwr) {
+		for (i = 0; i < n; i++)
+			ch->bin_pwr[i] += crealf(ch->fft[i] * conjf(ch->fft[i]));
+		ch->bin_pwr_n++;
+	}
+
+	ch->stats.ffts++;
+}
+
+static void resample(struct tetra_chan *ch, unsigned int idx)
+{
+	struct tetra_chan_out *o = &ch->out[idx];
+	float complex out[TETRA_CHAN_OUT_MAX];
+	unsigned int num = 0, keep;
+
+	while (o->pos < o->num_in) {
+		const float *h = ch->resamp_taps[o->phase];
+		const float complex *x = o->in + o->pos;
+		float complex v = 0;
+		unsigned int k;
+
+		for (k = 0; k < TETRA_RESAMP_TAPS; k++)
+			v += h[k] * x[-(int) k];
+		out[num++] = v;
+
+		o->phase += TETRA_RESAMP_M;
+		o->pos += o->phase / TETRA_RESAMP_L;
+		o->phase %= TETRA_RESAMP_L;
+	}
+
+	keep = o->num_in + TETRA_RESAMP_TAPS - 1 - o->pos;
+	memmove(o->in, o->in + o->num_in - keep, keep * sizeof(*o->in));
+	o->pos -= o->num_in - keep;
+	o->num_in = keep;
+	/* keep the oscillator on the unit circle */
+	o->nco /= cabsf(o->nco);
+
+	ch->stats.out += num;
+	if (num && ch->cb)
+		ch->cb(idx, out, num, ch->cb_priv);
+}
+
+int tetra_chan_measure(struct tetra_chan *ch)
+{
+	if (!ch->bin_pwr)
+		ch->bin_pwr = talloc_zero_array(ch, float, ch->num_chan);
+
+	return ch->bin_pwr ? 0 : -ENOMEM;
+}
+
+void tetra_chan_in(struct tetra_chan *ch, const float complex *in, unsigned int n)
+{
+	unsigned int i;
+
+	ch->stats.samples += n;
+
+	while (n) {
+		unsigned int len = ch->num_taps - 1 + TETRA_CHAN_BLK - ch->fill;
+		unsigned int start;
+
+		if (len > n)
+			len = n;
+		memcpy(ch->buf + ch->fill, in, len * sizeof(*in));
+		ch->fill += len;
+		in += len;
+		n -= len;
+
+		while (ch->next < ch->fill) {
+			channelize(ch);
+			ch->next += ch->decim;
+			ch->t_mod = (ch->t_mod + ch->decim) % ch->num_chan;
+		}
+		for (i = 0; i < ch->num_out; i++) {
+			if (ch->out[i].active)
+				resample(ch, i);
+		}
+
+		/* keep what the next FFT needs */
+		start = ch->next + 1 - ch->num_taps;
+		memmove(ch->buf, ch->buf + start, (ch->fill - start) * sizeof(*ch->buf));
+		ch->fill -= start;
+		ch->next -= start;
+	}
+}
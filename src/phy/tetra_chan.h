@@ -0,0 +1,115 @@
+#ifndef TETRA_CHAN_H
+#define TETRA_CHAN_H
+/* Polyphase FFT channelizer: all TETRA carriers of a wideband capture */
+
+#include <stdint.h>
+#include <complex.h>
+
+/* The input is complex baseband at num_chan * 12.5 kHz, num_chan being a
+ * power of two, e.g. 128 channels at 1.6 MS/s.  A polyphase filter bank
+ * with one FFT per 'num_chan / 4' input samples splits it into num_chan
+ * channels at 50 kS/s, centred on multiples of 12.5 kHz off the centre
+ * frequency.  Every carrier, whatever its offset from the 25 kHz raster,
+ * is then at most 6.25 kHz off the centre of one of them.  Each carrier
+ * asked for is shifted by that remainder and resampled by 18/25 to the
+ * 36 kS/s of the demodulator. */
+
+#define TETRA_CHAN_SPACING	12500
+/* oversampled by four: the channels overlap, but each carrier is
+ * completely inside the one nearest to it */
+#define TETRA_CHAN_OVERSAMPLE	4
+#define TETRA_CHAN_RATE		(TETRA_CHAN_OVERSAMPLE * TETRA_CHAN_SPACING)
+#define TETRA_CHAN_MAX		1024
+/* prototype filter taps per channel */
+#define TETRA_CHAN_TAPS		12
+/* input samples buffered per channelizer run */
+#define TETRA_CHAN_BLK		4096
+
+/* rational resampler to TETRA_DEMOD_RATE */
+#define TETRA_RESAMP_L		18
+#define TETRA_RESAMP_M		25
+#define TETRA_RESAMP_TAPS	36	/* per phase */
+/* channel samples per channelizer run, with at least 8 channels */
+#define TETRA_RESAMP_BLK	(TETRA_CHAN_BLK / 2 + 1)
+
+/* output samples of one call to the callback, at most */
+#define TETRA_CHAN_OUT_MAX	(TETRA_RESAMP_BLK * TETRA_RESAMP_L / TETRA_RESAMP_M + 4)
+
+/* one carrier picked from the channels */
+struct tetra_chan_out {
+	int32_t offset_hz;	/* from the centre of the input */
+	unsigned int bin;
+	/* resampled and passed to the callback, set by default */
+	int active;
+	/* channel power since it was last reset, even if not active */
+	float pwr;
+	unsigned int pwr_n;
+	/* shift by the remainder to the centre of the channel */
+	float complex nco;
+	float complex nco_step;
+
+	/* channel samples at 50 kS/s, resampler history first */
+	float complex in[TETRA_RESAMP_TAPS - 1 + TETRA_RESAMP_BLK];
+	unsigned int num_in;
+	unsigned int pos;	/* newest input of the next output */
+	unsigned int phase;	/* of the next output, 0 .. L-1 */
+};
+
+struct tetra_chan_stats {
+	uint64_t samples;	/* input samples */
+	uint64_t ffts;
+	uint64_t out;		/* output samples of all carriers */
+};
+
+/* 'samples' of carrier 'idx' at TETRA_DEMOD_RATE */
+typedef void (*tetra_chan_cb)(unsigned int idx, const float complex *samples,
+			      unsigned int n, void *priv);
+
+struct tetra_chan {
+	unsigned int num_chan;
+	unsigned int decim;
+	uint32_t rate;
+
+	/* prototype filter, time reversed, num_chan * TETRA_CHAN_TAPS */
+	float *taps;
+	unsigned int num_taps;
+	/* input, the last num_taps-1 samples first */
+	float complex *buf;
+	unsigned int fill;
+	unsigned int next;	/* newest input sample of the next FFT */
+	unsigned int t_mod;	/* its absolute index modulo num_chan */
+	/* polyphase sums, FFT buffer and twiddles */
+	float complex *fold;
+	float complex *fft;
+	float complex *tw;
+
+	float resamp_taps[TETRA_RESAMP_L][TETRA_RESAMP_TAPS];
+
+	/* power of every channel since it was last reset, NULL unless
+	 * asked for by tetra_chan_measure() */
+	float *bin_pwr;
+	unsigned int bin_pwr_n;
+
+	unsigned int num_out;
+	struct tetra_chan_out *out;
+
+	tetra_chan_cb cb;
+	void *cb_priv;
+
+	struct tetra_chan_stats stats;
+};
+
+/* NULL if num_chan is no power of two between 8 and TETRA_CHAN_MAX */
+struct tetra_chan *tetra_chan_alloc(void *ctx, unsigned int num_chan,
+				    tetra_chan_cb cb, void *priv);
+
+/* Pick the carrier at 'offset_hz' from the centre.  Returns its index
+ * for the callback, -EINVAL if it is outside the input band. */
+int tetra_chan_add(struct tetra_chan *ch, int32_t offset_hz);
+
+/* sum up the power of all channels in bin_pwr[] from now on */
+int tetra_chan_measure(struct tetra_chan *ch);
+
+void tetra_chan_in(struct tetra_chan *ch, const float complex *in, unsigned int n);
+
+#endif /* TETRA_CHAN_H */
@@ -0,0 +1,162 @@
+/* Simulated radio channel between modulator and demodulator */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+
+#include <phy/tetra_chsim.h>
+
+/* xorshift64* */
+static uint64_t rng_next(struct tetra_chsim *cs)
+{
+	cs->rng ^= cs->rng >> 12;
+	cs->rng ^= cs->rng << 25;
+	cs->rng ^= cs->rng >> 27;
+	return cs->rng * 0x2545f4914f6cdd1dULL;
+}
+
+/* uniform in (0, 1] */
+static float rng_unit(struct tetra_chsim *cs)
+{
+	return ((rng_next(cs) >> 40) + 1) * (1.0f / 16777216.0f);
+}
+
+/* two independent standard normal values, Box-Muller */
+static float complex gauss2(struct tetra_chsim *cs)
+{
+	float r = sqrtf(-2 * logf(rng_unit(cs)));
+
+	return r * cexpf(I * 2 * M_PI * rng_unit(cs));
+}
+
+void tetra_chsim_init(struct tetra_chsim *cs, float rate, uint64_t seed)
+{
+	unsigned int k, n;
+
+	memset(cs, 0, sizeof(*cs));
+	cs->rate = rate;
+	cs->snr_db = INFINITY;
+	/* xorshift must not start at 0 */
+	cs->rng = seed ? seed : 1;
+
+	/* random phases of the sinusoids and of their angles of arrival */
+	cs->fade_theta = (2 * rng_unit(cs) - 1) * M_PI;
+	for (k = 0; k < 2; k++) {
+		for (n = 0; n < TETRA_CHSIM_SINES; n++)
+			cs->fade[k][n] = cexpf(I * (2 * rng_unit(cs) - 1) * M_PI);
+	}
+
+	tetra_chsim_update(cs);
+}
+
+void tetra_chsim_update(struct tetra_chsim *cs)
+{
+	unsigned int n;
+	float ppm = cs->ppm;
+
+	if (ppm > TETRA_CHSIM_MAX_PPM)
+		ppm = TETRA_CHSIM_MAX_PPM;
+	if (ppm < -TETRA_CHSIM_MAX_PPM)
+		ppm = -TETRA_CHSIM_MAX_PPM;
+
+	/* unit signal power */
+	cs->sigma = isinf(cs->snr_db) ? 0 : sqrtf(powf(10, -cs->snr_db / 10) / 2);
+	cs->step = 1 + ppm * 1e-6f;
+	cs->nco_step = 2 * M_PI * cs->freq_hz / cs->rate;
+
+	for (n = 0; n < TETRA_CHSIM_SINES; n++) {
+		float alpha = (2 * M_PI * (n + 1) - M_PI + cs->fade_theta) / (4 * TETRA_CHSIM_SINES);
+		float w = 2 * M_PI * cs->doppler_hz / cs->rate;
+
+		cs->fade_rot[0][n] = cexpf(I * w * cosf(alpha));
+		cs->fade_rot[1][n] = cexpf(I * w * sinf(alpha));
+	}
+}
+
+/* unit mean power */
+static float complex fading(struct tetra_chsim *cs)
+{
+	float g[2] = { 0, 0 };
+	unsigned int k, n;
+
+	for (k = 0; k < 2; k++) {
+		for (n = 0; n < TETRA_CHSIM_SINES; n++) {
+			g[k] += crealf(cs->fade[k][n]);
+			cs->fade[k][n] *= cs->fade_rot[k][n];
+		}
+	}
+	return (g[0] + I * g[1]) * (1 / sqrtf(TETRA_CHSIM_SINES));
+}
+
+/* cubic Lagrange interpolation at mu between y[1] and y[2], as in the
+ * demodulator */
+static float complex interp(const float complex *y, float mu)
+{
+	float cm1 = -mu * (mu - 1) * (mu - 2) / 6;
+	float c0 = (mu + 1) * (mu - 1) * (mu - 2) / 2;
+	float c1 = -(mu + 1) * mu * (mu - 2) / 2;
+	float c2 = (mu + 1) * mu * (mu - 1) / 6;
+
+	return cm1 * y[0] + c0 * y[1] + c1 * y[2] + c2 * y[3];
+}
+
+unsigned int tetra_chsim_run(struct tetra_chsim *cs, const float complex *in,
+			     unsigned int n, float complex *out)
+{
+	unsigned int i, k, num = 0;
+
+	for (i = 0; i < n; i++) {
+		float complex v = in[i];
+
+		if (cs->doppler_hz != 0)
+			v *= fading(cs);
+		if (cs->nco_step != 0) {
+			v *= cexpf(I * cs->nco);
+			cs->nco = remainder(cs->nco + cs->nco_step, 2 * M_PI);
+		}
+
+		memmove(cs->hist, cs->hist + 1, 3 * sizeof(*cs->hist));
+		cs->hist[3] = v;
+
+		while (cs->mu < 1) {
+			v = interp(cs->hist, cs->mu);
+			if (cs->sigma > 0)
+				v += cs->sigma * gauss2(cs);
+			out[num++] = v;
+			cs->mu += cs->step;
+		}
+		cs->mu -= 1;
+	}
+
+	/* the phasors would slowly drift off the unit circle */
+	if (cs->doppler_hz != 0) {
+		for (k = 0; k < 2; k++) {
+			for (i = 0; i < TETRA_CHSIM_SINES; i++)
+				cs->fade[k][i] /= cabsf(cs->fade[k][i]);
+		}
+	}
+
+	cs->stats.samples_in += n;
+	cs->stats.samples_out += num;
+
+	return num;
+}
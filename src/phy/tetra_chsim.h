@@ -0,0 +1,67 @@
+#ifndef TETRA_CHSIM_H
+#define TETRA_CHSIM_H
+/* Simulated radio channel between modulator and demodulator */
+
+#include <stdint.h>
+#include <complex.h>
+
+/* In this order: flat Rayleigh fading, a frequency offset, a sample clock
+ * error, which makes the symbol timing drift, and white Gaussian noise.
+ * The fading is the sum of sinusoids model of Zheng and Xiao, each
+ * sinusoid a rotating phasor; the clock error resamples the input with
+ * cubic interpolation. */
+
+/* sinusoids per quadrature component of the fading */
+#define TETRA_CHSIM_SINES	8
+/* largest clock error in ppm */
+#define TETRA_CHSIM_MAX_PPM	1000.0f
+
+/* upper bound of the samples returned for 'n' input samples */
+#define TETRA_CHSIM_MAX_OUT(n)	((n) + (n) / 512 + 4)
+
+struct tetra_chsim_stats {
+	uint64_t samples_in;
+	uint64_t samples_out;
+};
+
+struct tetra_chsim {
+	/* set these after tetra_chsim_init(), then call
+	 * tetra_chsim_update() */
+	float rate;		/* sample rate */
+	float snr_db;		/* signal to noise ratio per sample, INFINITY for none */
+	float freq_hz;		/* frequency offset */
+	float ppm;		/* sample clock error */
+	float doppler_hz;	/* maximum Doppler shift, 0 for no fading */
+
+	/* derived by tetra_chsim_update() */
+	float sigma;
+	float step;		/* input samples per output sample */
+	double nco_step;
+	float complex fade_rot[2][TETRA_CHSIM_SINES];
+
+	double nco;
+	float fade_theta;
+	float complex fade[2][TETRA_CHSIM_SINES];
+	uint64_t rng;
+
+	/* resampler: the next output is at hist[1] + mu, zeros before the
+	 * first input */
+	float complex hist[4];
+	float mu;
+
+	struct tetra_chsim_stats stats;
+};
+
+/* a transparent channel, but for a delay of two samples, 'seed' selects
+ * the noise and the fading */
+void tetra_chsim_init(struct tetra_chsim *cs, float rate, uint64_t seed);
+
+/* apply the parameters set in 'cs' */
+void tetra_chsim_update(struct tetra_chsim *cs);
+
+/* Send 'n' samples through the channel, which returns at most
+ * TETRA_CHSIM_MAX_OUT(n) at 'out', their number */
+unsigned int tetra_chsim_run(struct tetra_chsim *cs, const float complex *in,
+			     unsigned int n, float complex *out);
+
+#endif /* TETRA_CHSIM_H */
@@ -0,0 +1,172 @@
+/* pi/4-DQPSK demodulator for complex baseband input */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+
+#include <tetra_kernel.h>
+#include <phy/tetra_demod.h>
+
+/* loop parameters, the timing ones as in the GNU Radio demodulator */
+#define GAIN_MU			0.05f
+#define GAIN_OMEGA		(0.25f * GAIN_MU * GAIN_MU)
+#define OMEGA_LIMIT		0.005f		/* relative */
+#define GAIN_FREQ		0.02f
+#define MAX_FREQ_HZ		2000.0f
+
+float tetra_rrc(float t, float alpha)
+{
+	float x = 4 * alpha * t;
+
+	if (fabsf(t) < 1e-6f)
+		return 1 - alpha + 4 * alpha / M_PI;
+	if (fabsf(fabsf(x) - 1) < 1e-6f)
+		return alpha / M_SQRT2 * ((1 + 2 / M_PI) * sinf(M_PI / (4 * alpha)) +
+					  (1 - 2 / M_PI) * cosf(M_PI / (4 * alpha)));
+
+	return (sinf(M_PI * t * (1 - alpha)) + x * cosf(M_PI * t * (1 + alpha))) /
+		(M_PI * t * (1 - x * x));
+}
+
+void tetra_demod_init(struct tetra_demod *td)
+{
+	unsigned int i;
+
+	memset(td, 0, sizeof(*td));
+
+	/* scaled for unity gain at the symbol instants after the transmit
+	 * filter */
+	for (i = 0; i < TETRA_RRC_TAPS; i++)
+		td->taps[i] = tetra_rrc(((float) i - (TETRA_RRC_TAPS - 1) / 2) / TETRA_DEMOD_SPS,
+					TETRA_RRC_ALPHA) / TETRA_DEMOD_SPS;
+
+	td->idx = TETRA_DEMOD_HIST;
+	td->omega = TETRA_DEMOD_SPS;
+	td->gain_mu = GAIN_MU;
+	td->gain_omega = GAIN_OMEGA;
+	td->gain_freq = GAIN_FREQ;
+	td->power = 1;
+	td->last = 1;
+}
+
+/* cubic Lagrange interpolation at mu (0 <= mu < 1) between y[i] and y[i+1] */
+static float complex interp(const float complex *y, int i, float mu)
+{
+	float cm1 = -mu * (mu - 1) * (mu - 2) / 6;
+	float c0 = (mu + 1) * (mu - 1) * (mu - 2) / 2;
+	float c1 = -(mu + 1) * mu * (mu - 2) / 2;
+	float c2 = (mu + 1) * mu * (mu - 1) / 6;
+
+	return cm1 * y[i-1] + c0 * y[i] + c1 * y[i+1] + c2 * y[i+2];
+}
+
+/* also keeps NaN from garbage input out of the loops */
+static float clampf(float v, float lim)
+{
+	if (v > lim)
+		return lim;
+	if (v < -lim)
+		return -lim;
+	return isnan(v) ? 0 : v;
+}
+
+static unsigned int demod_block(struct tetra_demod *td, const float complex *in,
+				unsigned int n, float *sym)
+{
+	const float max_freq = 2 * M_PI * MAX_FREQ_HZ / TETRA_DEMOD_RATE;
+	const int end = TETRA_DEMOD_HIST + n;
+	unsigned int num = 0;
+
+	memcpy(td->in + TETRA_RRC_TAPS - 1, in, n * sizeof(*in));
+	tetra_kern.fir_cf((const float *) td->in, td->taps, TETRA_RRC_TAPS,
+			  (float *) (td->y + TETRA_DEMOD_HIST), n);
+	memmove(td->in, td->in + n, (TETRA_RRC_TAPS - 1) * sizeof(*in));
+
+	while (td->idx + 2 < end) {
+		float half = td->omega / 2;
+		float mid_mu = td->mu - half, mid_idx = floorf(mid_mu);
+		float complex cur, mid;
+		float s, err, step;
+
+		cur = interp(td->y, td->idx, td->mu) * cexpf(-I * td->phase);
+		mid = interp(td->y, td->idx + (int) mid_idx, mid_mu - mid_idx) *
+			cexpf(-I * (td->phase - td->freq * half));
+
+		/* differential phase in units of pi/4 */
+		s = cargf(cur * conjf(td->last)) * (4 / M_PI);
+		sym[num++] = s;
+
+		/* the residual rotation against the nearest of +-pi/4, +-3pi/4 */
+		err = s - (2 * floorf(s / 2) + 1);
+		td->freq = clampf(td->freq + td->gain_freq * err * (M_PI / 4) / td->omega,
+				  max_freq);
+
+		/* Gardner: positive if the symbols are sampled late */
+		td->power = 0.99f * td->power + 0.01f * crealf(cur * conjf(cur));
+		if (!isfinite(td->power))
+			td->power = 1;
+		err = clampf(crealf((cur - td->last) * conjf(mid)) / (td->power + 1e-20f), 1);
+		td->omega = TETRA_DEMOD_SPS +
+			clampf(td->omega - TETRA_DEMOD_SPS - td->gain_omega * err,
+			       OMEGA_LIMIT * TETRA_DEMOD_SPS);
+		step = td->omega - td->gain_mu * err;
+
+		td->mu += step;
+		td->idx += floorf(td->mu);
+		td->mu -= floorf(td->mu);
+		td->phase = remainderf(td->phase + td->freq * step, 2 * M_PI);
+		td->last = cur;
+	}
+
+	memmove(td->y, td->y + n, TETRA_DEMOD_HIST * sizeof(*td->y));
+	td->idx -= n;
+
+	return num;
+}
+
+unsigned int tetra_demod_in(struct tetra_demod *td, const float complex *in,
+			    unsigned int n, float *sym)
+{
+	unsigned int num = 0;
+
+	while (n) {
+		unsigned int len = n > TETRA_DEMOD_BLK ? TETRA_DEMOD_BLK : n;
+
+		num += demod_block(td, in, len, sym + num);
+		in += len;
+		n -= len;
+		td->stats.samples += len;
+	}
+	td->stats.symbols += num;
+
+	return num;
+}
+
+void tetra_demod_slice(const float *sym, unsigned int n, uint8_t *bits)
+{
+	tetra_kern.slice(sym, n, bits);
+}
+
+float tetra_demod_freq_hz(const struct tetra_demod *td)
+{
+	return td->freq * TETRA_DEMOD_RATE / (2 * M_PI);
+}
@@ -0,0 +1,83 @@
+#ifndef TETRA_DEMOD_H
+#define TETRA_DEMOD_H
+/* pi/4-DQPSK demodulator for complex baseband input */
+
+#include <stdint.h>
+#include <complex.h>
+
+/* The input is complex baseband at two samples per symbol (36 kS/s),
+ * already mixed down to the carrier and channel filtered.  It runs
+ * through a root raised cosine matched filter, a Gardner timing loop with
+ * cubic interpolation and a decision directed frequency loop.  The output
+ * is the phase difference between consecutive symbols in units of pi/4,
+ * just like that of the GNU Radio demodulator: nominally -3, -1, +1 or +3. */
+
+#define TETRA_SYM_RATE		18000
+#define TETRA_DEMOD_SPS		2
+#define TETRA_DEMOD_RATE	(TETRA_SYM_RATE * TETRA_DEMOD_SPS)
+
+/* roll-off of the TETRA transmit filter (EN 300 392-2, 5.5.2) */
+#define TETRA_RRC_ALPHA		0.35f
+/* 11 symbols of the matched filter */
+#define TETRA_RRC_TAPS		(11 * TETRA_DEMOD_SPS + 1)
+
+/* samples filtered at a time */
+#define TETRA_DEMOD_BLK		256
+/* filtered samples kept for the interpolator */
+#define TETRA_DEMOD_HIST	4
+
+/* upper bound of the symbols returned for 'n' input samples */
+#define TETRA_DEMOD_MAX_SYM(n)	((n) / TETRA_DEMOD_SPS + 2)
+
+struct tetra_demod_stats {
+	uint64_t samples;
+	uint64_t symbols;
+};
+
+struct tetra_demod {
+	float taps[TETRA_RRC_TAPS];
+
+	/* matched filter input, the last TETRA_RRC_TAPS-1 samples of the
+	 * previous block first */
+	float complex in[TETRA_RRC_TAPS - 1 + TETRA_DEMOD_BLK];
+	/* matched filter output, TETRA_DEMOD_HIST samples of history first */
+	float complex y[TETRA_DEMOD_HIST + TETRA_DEMOD_BLK];
+
+	/* timing: the next symbol is at y[idx] + mu, omega samples per symbol */
+	int idx;
+	float mu;
+	float omega;
+	float gain_mu;
+	float gain_omega;
+
+	/* frequency: NCO phase and step in rad per sample */
+	float phase;
+	float freq;
+	float gain_freq;
+
+	/* mean symbol power, normalizes the timing error */
+	float power;
+	float complex last;
+
+	struct tetra_demod_stats stats;
+};
+
+/* value of the unit energy root raised cosine pulse at time 't' (in
+ * symbols) */
+float tetra_rrc(float t, float alpha);
+
+void tetra_demod_init(struct tetra_demod *td);
+
+/* Demodulate 'n' samples into at most TETRA_DEMOD_MAX_SYM(n) soft
+ * symbols at 'sym'.  Returns the number of symbols. */
+unsigned int tetra_demod_in(struct tetra_demod *td, const float complex *in,
+			    unsigned int n, float *sym);
+
+/* hard decision on 'n' soft symbols into 2*n unpacked bits, the
+ * tetra_slice_bits() kernel, the same as float_to_bits */
+void tetra_demod_slice(const float *sym, unsigned int n, uint8_t *bits);
+
+/* frequency offset the loop has settled on */
+float tetra_demod_freq_hz(const struct tetra_demod *td);
+
+#endif /* TETRA_DEMOD_H */
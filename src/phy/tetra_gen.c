@@ -0,0 +1,328 @@
+/* Synthetic downlink of one cell, for load and regression tests */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include <osmocom/core/utils.h>
+
+#include <tetra_common.h>
+#include <tetra_tdma.h>
+#include <tetra_mac_pdu.h>
+#include <tetra_llc_pdu.h>
+#include <tetra_mle_pdu.h>
+#include <tetra_cmce_pdu.h>
+#include <phy/tetra_burst.h>
+#include <phy/tetra_gen.h>
+#include <lower_mac/tetra_blk_enc.h>
+#include <lower_mac/tetra_rm3014.h>
+#include <lower_mac/tetra_scramb.h>
+
+#define SCHF_BITS	268
+
+/* xorshift64* */
+static uint64_t rng_next(struct tetra_gen *tg)
+{
+	tg->rng ^= tg->rng >> 12;
+	tg->rng ^= tg->rng << 25;
+	tg->rng ^= tg->rng >> 27;
+	return tg->rng * 0x2545f4914f6cdd1dULL;
+}
+
+/* uniform in (0, 1] */
+static double rng_unit(struct tetra_gen *tg)
+{
+	return ((rng_next(tg) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static uint32_t rng_below(struct tetra_gen *tg, uint32_t n)
+{
+	return (rng_next(tg) >> 32) % n;
+}
+
+/* error free bits before the next error, geometrically distributed */
+static uint64_t err_gap(struct tetra_gen *tg)
+{
+	double gap;
+
+	if (tg->ber <= 0)
+		return UINT64_MAX;
+	if (tg->ber >= 1)
+		return 0;
+	gap = floor(log(rng_unit(tg)) / log1p(-tg->ber));
+	return gap < 1e18 ? (uint64_t) gap : UINT64_MAX;
+}
+
+void tetra_gen_init(struct tetra_gen *tg, uint64_t seed)
+{
+	memset(tg, 0, sizeof(*tg));
+	tg->mcc = TETRA_GEN_MCC;
+	tg->mnc = TETRA_GEN_MNC;
+	tg->colour_code = TETRA_GEN_CC;
+	tg->la = TETRA_GEN_LA;
+	tg->freq_band = TETRA_GEN_BAND;
+	tg->main_carrier = TETRA_GEN_CARRIER;
+	tg->bs_service_details = BS_SERVDET_REG_RQD | BS_SERVDET_SYS_W_SERV |
+				 BS_SERVDET_VOICE_SERV;
+	tg->load = TETRA_GEN_LOAD;
+	tg->ssi_base = TETRA_GEN_SSI_BASE;
+	tg->num_ssi = TETRA_GEN_NUM_SSI;
+	/* xorshift must not start at 0 */
+	tg->rng = seed ? seed : 1;
+	tg->next_err = UINT64_MAX;
+
+	tetra_rm3014_init();
+}
+
+/* Table 21.73 SYNC PDU and 18.4.2.1 D-MLE-SYNC */
+static void build_sync(const struct tetra_gen *tg, uint8_t *bits)
+{
+	uint8_t *cur = bits;
+
+#define PUT(val, len) do { uint_to_bits(val, len, cur); cur += len; } while (0)
+	PUT(0, 4);		/* system code: ETS 300 392-2 ed. 1 */
+	PUT(tg->colour_code, 6);
+	PUT(tetra_tdma_tn(tg->slot) - 1, 2);
+	PUT(tetra_tdma_fn(tg->slot), 5);
+	PUT(tetra_tdma_mn(tg->slot), 6);
+	PUT(0, 2);		/* sharing mode: continuous transmission */
+	PUT(0, 3);		/* TS reserved frames */
+	PUT(0, 1);		/* U-plane DTX */
+	PUT(0, 1);		/* frame 18 extension */
+	PUT(0, 1);		/* reserved */
+	PUT(tg->mcc, 10);
+	PUT(tg->mnc, 14);
+	PUT(0, 2);		/* neighbour cell broadcast */
+	PUT(0, 2);		/* cell service level */
+	PUT(0, 1);		/* late entry information */
+}
+
+static void build_sysinfo(const struct tetra_gen *tg, uint8_t *bits)
+{
+	struct tetra_si_decoded sid;
+
+	memset(&sid, 0, sizeof(sid));
+	sid.main_carrier = tg->main_carrier;
+	sid.freq_band = tg->freq_band;
+	sid.ms_txpwr_max_cell = 1;
+	sid.hyperframe_number = tetra_tdma_hn(tg->slot);
+	sid.option_field = TETRA_MAC_OPT_FIELD_EVEN_MULTIFRAME;
+	sid.frame_bitmap = 0xfffff;
+	sid.mle_si.la = tg->la;
+	sid.mle_si.subscr_class = 0xffff;
+	sid.mle_si.bs_service_details = tg->bs_service_details;
+
+	macpdu_encode_sysinfo(&sid, bits);
+}
+
+static void build_aach(const struct tetra_gen *tg, uint8_t *bits)
+{
+	struct tetra_acc_ass_decoded aad;
+	int f18 = tetra_tdma_fn(tg->slot) == 18;
+
+	memset(&aad, 0, sizeof(aad));
+	if (f18 || tetra_tdma_tn(tg->slot) == 1) {
+		/* common control, random access open to everybody */
+		aad.hdr = f18 ? TETRA_ACC_ASS_ULCO : TETRA_ACC_ASS_DLCC_ULCO;
+		aad.access[0].base_frame_len = TETRA_ACC_BFL_4;
+		aad.access[1].base_frame_len = TETRA_ACC_BFL_4;
+	} else {
+		/* nothing allocated */
+		aad.hdr = TETRA_ACC_ASS_DLF1_ULF1;
+		aad.dl_usage = TETRA_DL_US_UNALLOC;
+		aad.ul_usage = TETRA_UL_US_UNALLOC;
+	}
+	macpdu_encode_access_assign(&aad, bits, f18);
+}
+
+/* a CMCE PDU for 'ssi', returns its length */
+static unsigned int build_cmce(struct tetra_gen *tg, uint32_t ssi, uint8_t *bits)
+{
+	uint8_t *cur = bits;
+
+	PUT(TMLE_PDISC_CMCE, 3);
+	switch (rng_below(tg, 4)) {
+	case 0:
+		/* 14.7.1.12 */
+		PUT(TCMCE_PDU_T_D_SETUP, 5);
+		PUT(tg->call_id++ & 0x3fff, 14);
+		PUT(3, 4);		/* call time-out: 1 min */
+		PUT(0, 1);		/* hook method: no hook signalling */
+		PUT(0, 1);		/* simplex */
+		PUT(0, 8);		/* basic service: speech, group call */
+		PUT(0, 2);		/* transmission granted */
+		PUT(0, 1);		/* transmission request permission */
+		PUT(0, 4);		/* call priority */
+		PUT(0, 1);		/* no optional elements */
+		break;
+	case 1:
+		/* 14.7.1.9 */
+		PUT(TCMCE_PDU_T_D_RELEASE, 5);
+		PUT(tg->call_id & 0x3fff, 14);
+		PUT(0, 5);		/* disconnect cause: unknown */
+		PUT(0, 1);
+		break;
+	case 2:
+		/* 14.7.1.11, a pre-coded status */
+		PUT(TCMCE_PDU_T_D_STATUS, 5);
+		PUT(1, 2);		/* calling party: SSI */
+		PUT(ssi, 24);
+		PUT(rng_below(tg, 0x10000), 16);
+		PUT(0, 1);
+		break;
+	default:
+		/* 14.7.1.10, 64 bits of user defined data 4 */
+		PUT(TCMCE_PDU_T_D_SDS_DATA, 5);
+		PUT(1, 2);
+		PUT(tg->ssi_base + rng_below(tg, tg->num_ssi), 24);
+		PUT(3, 2);		/* short data type identifier */
+		PUT(64, 11);
+		PUT(rng_next(tg), 32);
+		PUT(rng_next(tg), 32);
+		PUT(0, 1);
+		break;
+	}
+	return cur - bits;
+}
+#undef PUT
+
+/* MAC-RESOURCE with a CMCE PDU in a BL-DATA or BL-UDATA, filling the
+ * rest of the SCH/F with fill bits */
+static void build_resource(struct tetra_gen *tg, uint8_t *bits)
+{
+	struct tetra_resrc_decoded rsd;
+	struct tetra_llc_pdu lpp;
+	uint8_t sdu[SCHF_BITS], llc[SCHF_BITS];
+	unsigned int sdu_len, llc_len, hdr_len;
+	uint32_t ssi = tg->ssi_base + rng_below(tg, tg->num_ssi);
+
+	sdu_len = build_cmce(tg, ssi, sdu);
+
+	memset(&lpp, 0, sizeof(lpp));
+	if (bits_to_uint(sdu + 3, 5) == TCMCE_PDU_T_D_SDS_DATA ||
+	    bits_to_uint(sdu + 3, 5) == TCMCE_PDU_T_D_STATUS)
+		lpp.pdu_type = TLLC_PDUT_DEC_BL_UDATA;
+	else {
+		lpp.pdu_type = TLLC_PDUT_DEC_BL_DATA;
+		lpp.ns = tg->llc_ns;
+		tg->llc_ns ^= 1;
+	}
+	llc_len = tetra_llc_pdu_encode(&lpp, sdu, sdu_len, llc);
+
+	memset(&rsd, 0, sizeof(rsd));
+	rsd.addr.type = ADDR_TYPE_SSI;
+	rsd.addr.ssi = ssi;
+	/* the header does not depend on the length */
+	rsd.macpdu_length = 1;
+	hdr_len = macpdu_encode_resource(&rsd, 0, bits);
+	rsd.macpdu_length = (hdr_len + llc_len + 7) / 8;
+	macpdu_encode_resource(&rsd, hdr_len + llc_len < SCHF_BITS, bits);
+
+	memcpy(bits + hdr_len, llc, llc_len);
+	/* fill bits: a 1, then 0s */
+	memset(bits + hdr_len + llc_len, 0, SCHF_BITS - hdr_len - llc_len);
+	if (hdr_len + llc_len < SCHF_BITS)
+		bits[hdr_len + llc_len] = 1;
+}
+
+static void build_null(uint8_t *bits)
+{
+	struct tetra_resrc_decoded rsd;
+	int len;
+
+	memset(&rsd, 0, sizeof(rsd));
+	rsd.addr.type = ADDR_TYPE_NULL;
+	rsd.macpdu_length = 2;
+	len = macpdu_encode_resource(&rsd, 1, bits);
+	memset(bits + len, 0, SCHF_BITS - len);
+	bits[len] = 1;
+}
+
+static void add_errors(struct tetra_gen *tg, uint8_t *bits, unsigned int n)
+{
+	uint64_t pos = 0;
+
+	if (tg->next_err == UINT64_MAX)
+		tg->next_err = err_gap(tg);
+
+	while (tg->next_err < n - pos) {
+		pos += tg->next_err;
+		bits[pos++] ^= 1;
+		tg->stats.bit_errors++;
+		tg->next_err = err_gap(tg);
+	}
+	if (tg->next_err != UINT64_MAX)
+		tg->next_err -= n - pos;
+}
+
+void tetra_gen_burst(struct tetra_gen *tg, uint8_t *burst)
+{
+	uint32_t scramb_init = tetra_scramb_get_init(tg->mcc, tg->mnc, tg->colour_code);
+	uint32_t mn = tetra_tdma_mn(tg->slot);
+	uint32_t fn = tetra_tdma_fn(tg->slot);
+	uint32_t tn = tetra_tdma_tn(tg->slot);
+	uint8_t type1[SCHF_BITS], type5[432];
+	uint8_t aach[14], bb_type5[30];
+
+	build_aach(tg, aach);
+	tetra_blk_encode(TPSAP_T_BBK, aach, scramb_init, bb_type5);
+
+	if (fn == 18 && tn == 4 - ((mn + 3) % 4)) {
+		/* BSCH and BNCH, see is_bnch() */
+		uint8_t sb_type5[120];
+
+		build_sync(tg, type1);
+		tetra_blk_encode(TPSAP_T_SB1, type1, SCRAMB_INIT, sb_type5);
+		build_sysinfo(tg, type1);
+		tetra_blk_encode(TPSAP_T_SB2, type1, scramb_init, type5);
+		build_sync_c_d_burst(burst, sb_type5, bb_type5, type5);
+		tg->stats.sync++;
+	} else if (tn == 1 && tg->load > 0 && rng_unit(tg) <= tg->load) {
+		build_resource(tg, type1);
+		tetra_blk_encode(TPSAP_T_SCH_F, type1, scramb_init, type5);
+		build_norm_c_d_burst(burst, type5, bb_type5, type5 + 216, 0);
+		tg->stats.cmce++;
+	} else {
+		/* always the same, only coded once per cell */
+		if (!tg->null_valid || tg->null_scramb != scramb_init) {
+			build_null(type1);
+			tetra_blk_encode(TPSAP_T_SCH_F, type1, scramb_init, tg->null_type5);
+			tg->null_scramb = scramb_init;
+			tg->null_valid = 1;
+		}
+		build_norm_c_d_burst(burst, tg->null_type5, bb_type5,
+				     tg->null_type5 + 216, 0);
+		tg->stats.null++;
+	}
+
+	add_errors(tg, burst, TETRA_BITS_PER_TS);
+	tg->slot++;
+	tg->stats.bursts++;
+}
+
+void tetra_gen_symbols(const uint8_t *bits, unsigned int n, float *sym)
+{
+	static const float step[4] = { 1, 3, -1, -3 };
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		sym[i] = step[(bits[2*i] & 1) << 1 | (bits[2*i+1] & 1)];
+}
@@ -0,0 +1,84 @@
+#ifndef TETRA_GEN_H
+#define TETRA_GEN_H
+/* Synthetic downlink of one cell, for load and regression tests */
+
+#include <stdint.h>
+
+#include <tetra_common.h>
+
+/* The main carrier of a cell, burst by burst: in frame 18 of every
+ * multiframe a synchronization burst with SYNC (BSCH) and SYSINFO
+ * (BNCH), in all other slots a full slot SCH/F.  On timeslot 1, the
+ * MCCH, some of these carry MAC-RESOURCE PDUs with a basic link LLC PDU
+ * and a CMCE PDU to one of a range of SSIs, the rest and the other
+ * timeslots carry Null PDUs.  Every burst has an ACCESS-ASSIGN PDU in
+ * its broadcast block.  Bit errors are added at a given rate.
+ *
+ * The cell parameters may be changed at any time, they apply from the
+ * next burst on. */
+
+/* defaults, those of testpdu.c */
+#define TETRA_GEN_MCC		262
+#define TETRA_GEN_MNC		42
+#define TETRA_GEN_CC		1
+#define TETRA_GEN_LA		1
+/* 392.775 MHz */
+#define TETRA_GEN_BAND		3
+#define TETRA_GEN_CARRIER	((392775 - 300000) / 25)
+/* fraction of the MCCH slots with a CMCE PDU */
+#define TETRA_GEN_LOAD		0.25f
+#define TETRA_GEN_SSI_BASE	1000
+#define TETRA_GEN_NUM_SSI	100
+
+struct tetra_gen_stats {
+	uint64_t bursts;
+	uint64_t sync;		/* synchronization bursts */
+	uint64_t cmce;		/* MAC-RESOURCE PDUs with a CMCE PDU */
+	uint64_t null;		/* Null PDUs */
+	uint64_t bit_errors;
+};
+
+struct tetra_gen {
+	/* cell */
+	uint16_t mcc;
+	uint16_t mnc;
+	uint8_t colour_code;
+	uint16_t la;
+	uint8_t freq_band;
+	uint16_t main_carrier;
+	uint16_t bs_service_details;
+
+	/* signalling load */
+	float load;
+	uint32_t ssi_base;
+	uint32_t num_ssi;
+
+	double ber;		/* bit error rate */
+
+	uint64_t slot;		/* TDMA time of the next burst */
+
+	uint64_t rng;
+	uint64_t next_err;	/* error free bits before the next error */
+	uint8_t llc_ns;
+	uint16_t call_id;
+
+	/* the Null PDU SCH/F, coded with 'null_scramb' */
+	uint8_t null_type5[432];
+	uint32_t null_scramb;
+	int null_valid;
+
+	struct tetra_gen_stats stats;
+};
+
+/* defaults, starting at TN 1 of FN 1 of MN 1 of hyperframe 0, 'seed'
+ * selects the random traffic and bit errors */
+void tetra_gen_init(struct tetra_gen *tg, uint64_t seed);
+
+/* the TETRA_BITS_PER_TS bits of the next burst into 'burst' */
+void tetra_gen_burst(struct tetra_gen *tg, uint8_t *burst);
+
+/* dibits to pi/4-DQPSK symbols, the phase step in units of pi/4, the
+ * reverse of tetra_slice_bits(): 00: +1, 01: +3, 10: -1, 11: -3 */
+void tetra_gen_symbols(const uint8_t *bits, unsigned int n, float *sym);
+
+#endif /* TETRA_GEN_H */
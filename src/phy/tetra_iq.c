@@ -0,0 +1,229 @@
+/* IQ recordings in the formats of common SDR tools */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/utils.h>
+
+#include <tetra_kernel.h>
+#include <phy/tetra_iq.h>
+
+const struct value_string tetra_iq_fmt_names[] = {
+	{ TETRA_IQ_CU8,		"cu8" },
+	{ TETRA_IQ_CS8,		"cs8" },
+	{ TETRA_IQ_CS16,	"cs16" },
+	{ TETRA_IQ_CF32,	"cf32" },
+	{ 0, NULL }
+};
+
+int tetra_iq_fmt_parse(const char *name)
+{
+	int fmt = get_string_value(tetra_iq_fmt_names, name);
+
+	return fmt < 0 ? -EINVAL : fmt;
+}
+
+struct tetra_iq *tetra_iq_open(void *ctx, const char *path, enum tetra_iq_fmt fmt,
+			       int dc_block)
+{
+	struct tetra_iq *iq;
+	struct stat st;
+	void *map;
+
+	iq = talloc_zero(ctx, struct tetra_iq);
+	if (!iq) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	iq->fmt = fmt;
+	iq->size = tetra_iq_sample_size(fmt);
+	iq->dc_block = dc_block;
+
+	switch (fmt) {
+	case TETRA_IQ_CU8:
+		iq->bias = 127.5f;
+		iq->scale = 1 / 128.0f;
+		break;
+	case TETRA_IQ_CS8:
+		iq->scale = 1 / 128.0f;
+		break;
+	case TETRA_IQ_CS16:
+		iq->scale = 1 / 32768.0f;
+		break;
+	case TETRA_IQ_CF32:
+		iq->scale = 1;
+		break;
+	}
+
+	iq->fd = open(path, O_RDONLY);
+	if (iq->fd < 0) {
+		talloc_free(iq);
+		return NULL;
+	}
+
+	if (fstat(iq->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, iq->fd, 0);
+		if (map != MAP_FAILED) {
+			madvise(map, st.st_size, MADV_SEQUENTIAL);
+			iq->map = map;
+			iq->map_len = st.st_size;
+			return iq;
+		}
+	}
+
+	/* not a regular file, read() it */
+	iq->raw = talloc_size(iq, TETRA_IQ_BLK * iq->size);
+	if (!iq->raw) {
+		close(iq->fd);
+		talloc_free(iq);
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	return iq;
+}
+
+/* the next samples of the input, at least one unless it has ended */
+static int next_raw(struct tetra_iq *iq, const uint8_t **src)
+{
+	unsigned int n;
+	int rc;
+
+	if (iq->map) {
+		n = (iq->map_len - iq->pos) / iq->size;
+		if (n > TETRA_IQ_BLK)
+			n = TETRA_IQ_BLK;
+		*src = iq->map + iq->pos;
+		iq->pos += n * iq->size;
+		return n;
+	}
+
+	/* what was returned last time is done with */
+	memmove(iq->raw, iq->raw + iq->pos, iq->raw_len - iq->pos);
+	iq->raw_len -= iq->pos;
+	iq->pos = 0;
+
+	/* whole blocks, as from a file, so that the output does not
+	 * depend on how the writer splits it */
+	rc = tetra_read_full(iq->fd, iq->raw + iq->raw_len, TETRA_IQ_BLK * iq->size - iq->raw_len);
+	if (rc < 0)
+		return rc;
+	iq->raw_len += rc;
+
+	n = iq->raw_len / iq->size;
+	*src = iq->raw;
+	iq->pos = n * iq->size;
+	return n;
+}
+
+static void convert(struct tetra_iq *iq, const uint8_t *src, unsigned int n)
+{
+	float off[2], sum[2] = { 0, 0 };
+	int i;
+
+	off[0] = iq->bias + iq->dc[0];
+	off[1] = iq->bias + iq->dc[1];
+	tetra_kern.cvt_iq(iq->fmt, src, (float *) iq->buf, n, off, iq->scale, sum);
+	if (!iq->dc_block)
+		return;
+
+	/* the mean of the block is what is left of the offset, the very
+	 * first block is taken as it is */
+	for (i = 0; i < 2; i++)
+		iq->dc[i] += (iq->dc_valid ? TETRA_IQ_DC_ALPHA : 1) * sum[i] / n / iq->scale;
+	if (!iq->dc_valid) {
+		iq->dc_valid = 1;
+		convert(iq, src, n);
+	}
+}
+
+int tetra_iq_read(struct tetra_iq *iq, const float complex **out)
+{
+	const uint8_t *src;
+	int n;
+
+	n = next_raw(iq, &src);
+	if (n <= 0)
+		return n;
+
+	/* complex float without DC removal needs no conversion */
+	if (iq->fmt == TETRA_IQ_CF32 && !iq->dc_block)
+		*out = (const float complex *) src;
+	else {
+		convert(iq, src, n);
+		*out = iq->buf;
+	}
+	iq->stats.samples += n;
+
+	return n;
+}
+
+void tetra_iq_close(struct tetra_iq *iq)
+{
+	if (iq->map)
+		munmap((void *) iq->map, iq->map_len);
+	close(iq->fd);
+	talloc_free(iq);
+}
+
+static long clip(float v, long lo, long hi)
+{
+	if (isnan(v))
+		return 0;
+	if (v < lo)
+		return lo;
+	if (v > hi)
+		return hi;
+	return lroundf(v);
+}
+
+/* the inverse of the scale and bias in tetra_iq_open() */
+void tetra_iq_pack(enum tetra_iq_fmt fmt, const float complex *in, unsigned int n,
+		   void *out)
+{
+	const float *x = (const float *) in;
+	unsigned int i;
+
+	for (i = 0; i < 2 * n; i++) {
+		switch (fmt) {
+		case TETRA_IQ_CU8:
+			((uint8_t *) out)[i] = clip(x[i] * 128 + 127.5f, 0, 255);
+			break;
+		case TETRA_IQ_CS8:
+			((int8_t *) out)[i] = clip(x[i] * 128, -128, 127);
+			break;
+		case TETRA_IQ_CS16:
+			((int16_t *) out)[i] = clip(x[i] * 32768, -32768, 32767);
+			break;
+		case TETRA_IQ_CF32:
+			((float *) out)[i] = x[i];
+			break;
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef TETRA_IQ_H
+#define TETRA_IQ_H
+/* IQ recordings in the formats of common SDR tools */
+
+#include <stdint.h>
+#include <complex.h>
+
+#include <osmocom/core/utils.h>
+
+#include <tetra_common.h>
+
+/* A recording in a regular file is mapped into memory and converted
+ * straight from the mapping, a pipe or FIFO is read into a buffer
+ * first, a whole block at a time.  8 bit recordings are a quarter of
+ * the size of complex float ones, so replaying them costs a quarter of
+ * the disk bandwidth. */
+
+/* complex samples returned per tetra_iq_read() */
+#define TETRA_IQ_BLK		4096
+/* DC offset removal: fraction of the mean of a block that the
+ * estimate moves by */
+#define TETRA_IQ_DC_ALPHA	0.1f
+
+extern const struct value_string tetra_iq_fmt_names[];
+
+struct tetra_iq_stats {
+	uint64_t samples;
+};
+
+struct tetra_iq {
+	enum tetra_iq_fmt fmt;
+	unsigned int size;	/* bytes per sample */
+	int fd;
+
+	/* regular file */
+	const uint8_t *map;
+	size_t map_len;
+	size_t pos;
+
+	/* pipe */
+	uint8_t *raw;
+	unsigned int raw_len;
+
+	/* conversion, and DC offset in input units */
+	float bias;
+	float scale;
+	int dc_block;
+	int dc_valid;
+	float dc[2];
+
+	float complex buf[TETRA_IQ_BLK];
+
+	struct tetra_iq_stats stats;
+};
+
+/* "cu8", "cs8", "cs16" or "cf32", -EINVAL if unknown */
+int tetra_iq_fmt_parse(const char *name);
+
+/* NULL with errno set if 'path' cannot be opened */
+struct tetra_iq *tetra_iq_open(void *ctx, const char *path, enum tetra_iq_fmt fmt,
+			       int dc_block);
+
+/* Up to TETRA_IQ_BLK samples at *out, valid until the next call.
+ * Returns their number, 0 at the end of the input, or -errno. */
+int tetra_iq_read(struct tetra_iq *iq, const float complex **out);
+
+void tetra_iq_close(struct tetra_iq *iq);
+
+/* The other way round, for writing recordings: 'n' samples at 'in' into
+ * 'fmt' at 'out', full scale at 1.0, clipped */
+void tetra_iq_pack(enum tetra_iq_fmt fmt, const float complex *in, unsigned int n,
+		   void *out);
+
+#endif /* TETRA_IQ_H */
@@ -0,0 +1,89 @@
+/* pi/4-DQPSK modulator, complex baseband for the demodulator */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+
+#include <tetra_kernel.h>
+#include <phy/tetra_mod.h>
+
+/* the constellation, at multiples of pi/4 */
+static const float complex const_pt[8] = {
+	1, M_SQRT1_2 + M_SQRT1_2 * I, I, -M_SQRT1_2 + M_SQRT1_2 * I,
+	-1, -M_SQRT1_2 - M_SQRT1_2 * I, -I, M_SQRT1_2 - M_SQRT1_2 * I,
+};
+
+void tetra_mod_init(struct tetra_mod *tm)
+{
+	unsigned int p, k;
+
+	memset(tm, 0, sizeof(*tm));
+
+	/* sample p of symbol i is the sum of sym[i-j] * h(j + p/SPS - SPAN/2)
+	 * over j, and tetra_fir_cf() runs from the oldest symbol on */
+	for (p = 0; p < TETRA_MOD_SPS; p++) {
+		for (k = 0; k < TETRA_MOD_SPAN; k++) {
+			float t = (float) (TETRA_MOD_SPAN - 1 - k) + (float) p / TETRA_MOD_SPS -
+				  TETRA_MOD_SPAN / 2;
+
+			tm->taps[p][k] = tetra_rrc(t, TETRA_RRC_ALPHA);
+		}
+	}
+}
+
+static void mod_block(struct tetra_mod *tm, const uint8_t *bits, unsigned int n,
+		      float complex *out)
+{
+	/* 00: +1, 01: +3, 10: -1, 11: -3 */
+	static const unsigned int step[4] = { 1, 3, 7, 5 };
+	float complex *sym = tm->sym + TETRA_MOD_SPAN - 1;
+	unsigned int i, p;
+
+	for (i = 0; i < n; i++) {
+		tm->phase = (tm->phase + step[(bits[2*i] & 1) << 1 | (bits[2*i+1] & 1)]) & 7;
+		sym[i] = const_pt[tm->phase];
+	}
+
+	for (p = 0; p < TETRA_MOD_SPS; p++)
+		tetra_kern.fir_cf((const float *) tm->sym, tm->taps[p], TETRA_MOD_SPAN,
+				  (float *) tm->branch[p], n);
+	for (i = 0; i < n; i++) {
+		for (p = 0; p < TETRA_MOD_SPS; p++)
+			out[i * TETRA_MOD_SPS + p] = tm->branch[p][i];
+	}
+
+	memmove(tm->sym, tm->sym + n, (TETRA_MOD_SPAN - 1) * sizeof(*sym));
+	tm->symbols += n;
+}
+
+void tetra_mod_bits(struct tetra_mod *tm, const uint8_t *bits, unsigned int n,
+		    float complex *out)
+{
+	while (n) {
+		unsigned int len = n > TETRA_MOD_BLK ? TETRA_MOD_BLK : n;
+
+		mod_block(tm, bits, len, out);
+		bits += 2 * len;
+		out += len * TETRA_MOD_SPS;
+		n -= len;
+	}
+}
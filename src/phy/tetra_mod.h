@@ -0,0 +1,43 @@
+#ifndef TETRA_MOD_H
+#define TETRA_MOD_H
+/* pi/4-DQPSK modulator, complex baseband for the demodulator */
+
+#include <stdint.h>
+#include <complex.h>
+
+#include <phy/tetra_demod.h>
+
+/* The output is at the input rate of the demodulator, two samples per
+ * symbol.  The root raised cosine transmit filter is split into one
+ * branch per output sample of a symbol, each of which runs over the
+ * symbols with the tetra_fir_cf() kernel.  The pulse has unit energy, so
+ * the output has unit mean power. */
+
+#define TETRA_MOD_SPS		TETRA_DEMOD_SPS
+/* length of the transmit filter in symbols, the output is delayed by
+ * half of it */
+#define TETRA_MOD_SPAN		12
+/* symbols filtered at a time */
+#define TETRA_MOD_BLK		256
+
+struct tetra_mod {
+	/* the branches, reversed for tetra_fir_cf() */
+	float taps[TETRA_MOD_SPS][TETRA_MOD_SPAN];
+	/* symbols, the last TETRA_MOD_SPAN-1 of the previous block first */
+	float complex sym[TETRA_MOD_SPAN - 1 + TETRA_MOD_BLK];
+	float complex branch[TETRA_MOD_SPS][TETRA_MOD_BLK];
+
+	/* of the last symbol, in units of pi/4 */
+	unsigned int phase;
+
+	uint64_t symbols;
+};
+
+void tetra_mod_init(struct tetra_mod *tm);
+
+/* Modulate 'n' symbols, the 2*n unpacked bits at 'bits', into
+ * n*TETRA_MOD_SPS samples at 'out' */
+void tetra_mod_bits(struct tetra_mod *tm, const uint8_t *bits, unsigned int n,
+		    float complex *out);
+
+#endif /* TETRA_MOD_H */
@@ -0,0 +1,210 @@
+/* Energy and SYNC pre-scan of the carriers of a channelizer */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <osmocom/core/talloc.h>
+
+#include <tetra_common.h>
+#include <tetra_kernel.h>
+#include <phy/tetra_prescan.h>
+
+/* 9.4.4.3.4 Synchronization training sequence, as in tetra_burst.c.
+ * Searching for it here keeps the lower MAC, which tetra_burst.o
+ * calls into, out of programs that only channelize. */
+static const uint8_t y_bits[38] = { 1,1, 0,0, 0,0, 0,1, 1,0, 0,1, 1,1, 0,0, 1,1, 1,0, 1,0, 0,1, 1,1, 0,0, 0,0, 0,1, 1,0, 0,1, 1,1 };
+#define SYNC_BITS	sizeof(y_bits)
+
+struct tetra_prescan *tetra_prescan_alloc(void *ctx, struct tetra_chan *ch,
+					  tetra_prescan_cb start, tetra_prescan_cb stop,
+					  void *priv)
+{
+	struct tetra_prescan *ps;
+	unsigned int i;
+
+	if (tetra_chan_measure(ch) < 0)
+		return NULL;
+
+	ps = talloc_zero(ctx, struct tetra_prescan);
+	if (!ps)
+		return NULL;
+	ps->c = talloc_zero_array(ps, struct tetra_prescan_carrier, ch->num_chan);
+	if (!ps->c) {
+		talloc_free(ps);
+		return NULL;
+	}
+
+	ps->ch = ch;
+	ps->thresh_db = TETRA_PRESCAN_THRESH_DB;
+	ps->hold = TETRA_PRESCAN_HOLD;
+	ps->backoff = TETRA_PRESCAN_BACKOFF;
+	ps->probe_len = TETRA_PRESCAN_PROBE_BITS;
+	ps->start = start;
+	ps->stop = stop;
+	ps->cb_priv = priv;
+
+	for (i = 0; i < ch->num_out; i++)
+		ch->out[i].active = 0;
+
+	return ps;
+}
+
+static int cmp_float(const void *a, const void *b)
+{
+	float fa = *(const float *) a, fb = *(const float *) b;
+
+	return fa < fb ? -1 : fa > fb;
+}
+
+static float to_db(float pwr)
+{
+	return 10 * log10f(pwr + 1e-30f);
+}
+
+static void set_state(struct tetra_prescan *ps, unsigned int idx,
+		      enum tetra_prescan_state state)
+{
+	struct tetra_prescan_carrier *c = &ps->c[idx];
+
+	switch (state) {
+	case TETRA_PRESCAN_IDLE:
+		if (c->state == TETRA_PRESCAN_LIVE) {
+			ps->stats.stops++;
+			if (ps->stop)
+				ps->stop(idx, ps->cb_priv);
+		} else
+			c->backoff = ps->backoff;
+		break;
+	case TETRA_PRESCAN_PROBE:
+		tetra_demod_init(&c->demod);
+		c->probe_bits = 0;
+		c->num_bits = 0;
+		ps->stats.probes++;
+		break;
+	case TETRA_PRESCAN_LIVE:
+		ps->stats.syncs++;
+		if (ps->start)
+			ps->start(idx, ps->cb_priv);
+		break;
+	}
+
+	c->state = state;
+	c->quiet = 0;
+	ps->ch->out[idx].active = state != TETRA_PRESCAN_IDLE;
+}
+
+void tetra_prescan_update(struct tetra_prescan *ps)
+{
+	struct tetra_chan *ch = ps->ch;
+	float sorted[TETRA_CHAN_MAX];
+	unsigned int i;
+
+	if (ch->bin_pwr_n < TETRA_PRESCAN_WIN)
+		return;
+
+	/* the lower quartile of all channels, most of a band being idle */
+	memcpy(sorted, ch->bin_pwr, ch->num_chan * sizeof(*sorted));
+	qsort(sorted, ch->num_chan, sizeof(*sorted), cmp_float);
+	ps->floor_db = to_db(sorted[ch->num_chan / 4] / ch->bin_pwr_n);
+	memset(ch->bin_pwr, 0, ch->num_chan * sizeof(*ch->bin_pwr));
+	ch->bin_pwr_n = 0;
+
+	for (i = 0; i < ch->num_out; i++) {
+		struct tetra_chan_out *o = &ch->out[i];
+		struct tetra_prescan_carrier *c = &ps->c[i];
+		int above;
+
+		c->power_db = o->pwr_n ? to_db(o->pwr / o->pwr_n) : -300;
+		o->pwr = 0;
+		o->pwr_n = 0;
+		above = c->power_db > ps->floor_db + ps->thresh_db;
+
+		switch (c->state) {
+		case TETRA_PRESCAN_IDLE:
+			if (c->backoff)
+				c->backoff--;
+			else if (above)
+				set_state(ps, i, TETRA_PRESCAN_PROBE);
+			break;
+		case TETRA_PRESCAN_PROBE:
+			/* ends in tetra_prescan_in() */
+			break;
+		case TETRA_PRESCAN_LIVE:
+			if (above)
+				c->quiet = 0;
+			else if (++c->quiet >= ps->hold)
+				set_state(ps, i, TETRA_PRESCAN_IDLE);
+			break;
+		}
+	}
+}
+
+static void probe(struct tetra_prescan *ps, unsigned int idx,
+		  const float complex *samples, unsigned int n)
+{
+	struct tetra_prescan_carrier *c = &ps->c[idx];
+	float sym[TETRA_DEMOD_MAX_SYM(TETRA_CHAN_OUT_MAX)];
+	unsigned int num;
+
+	while (n) {
+		unsigned int len = n > TETRA_CHAN_OUT_MAX ? TETRA_CHAN_OUT_MAX : n;
+
+		num = tetra_demod_in(&c->demod, samples, len, sym);
+		tetra_demod_slice(sym, num, c->bits + c->num_bits);
+		c->num_bits += 2 * num;
+		c->probe_bits += 2 * num;
+		samples += len;
+		n -= len;
+
+		if (tetra_kern.find_seq(c->bits, c->num_bits, y_bits, SYNC_BITS) >= 0) {
+			set_state(ps, idx, TETRA_PRESCAN_LIVE);
+			return;
+		}
+		if (c->probe_bits >= ps->probe_len) {
+			set_state(ps, idx, TETRA_PRESCAN_IDLE);
+			return;
+		}
+
+		/* a sequence may start in what we have got so far */
+		if (c->num_bits >= SYNC_BITS) {
+			memmove(c->bits, c->bits + c->num_bits - (SYNC_BITS - 1), SYNC_BITS - 1);
+			c->num_bits = SYNC_BITS - 1;
+		}
+	}
+}
+
+int tetra_prescan_in(struct tetra_prescan *ps, unsigned int idx,
+		     const float complex *samples, unsigned int n)
+{
+	switch (ps->c[idx].state) {
+	case TETRA_PRESCAN_LIVE:
+		return 1;
+	case TETRA_PRESCAN_PROBE:
+		probe(ps, idx, samples, n);
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
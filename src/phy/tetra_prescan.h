@@ -0,0 +1,95 @@
+#ifndef TETRA_PRESCAN_H
+#define TETRA_PRESCAN_H
+/* Energy and SYNC pre-scan of the carriers of a channelizer */
+
+#include <stdint.h>
+#include <complex.h>
+
+#include <tetra_common.h>
+#include <phy/tetra_demod.h>
+#include <phy/tetra_chan.h>
+
+/* Most carriers of a band are quiet most of the time.  Only their power
+ * is measured, at the output of the channelizer, and nothing is
+ * resampled or demodulated for them.  A carrier which rises above the
+ * noise floor of the band is probed: demodulated for a little over one
+ * multiframe and searched for the SYNC training sequence.  If it is
+ * found, the decoder of the carrier is started, and stopped again once
+ * the carrier has gone quiet for a while.  A carrier without SYNC (an
+ * uplink, or not TETRA at all) is left alone for a while before it is
+ * probed again. */
+
+/* power measurement interval, 20 ms of channel samples */
+#define TETRA_PRESCAN_WIN		(TETRA_CHAN_RATE / 50)
+/* carrier power over the noise floor of the band */
+#define TETRA_PRESCAN_THRESH_DB		10
+/* intervals below the threshold before a decoder is stopped (5 s) */
+#define TETRA_PRESCAN_HOLD		250
+/* intervals before a carrier without SYNC is probed again (30 s) */
+#define TETRA_PRESCAN_BACKOFF		1500
+/* bits demodulated in one probe: a multiframe and a bit */
+#define TETRA_PRESCAN_PROBE_BITS	(TETRA_BITS_PER_TS * 4 * 19)
+
+/* the last bits of a probe, searched for SYNC */
+#define TETRA_PRESCAN_BITS		(2 * TETRA_DEMOD_MAX_SYM(TETRA_CHAN_OUT_MAX) + 64)
+
+enum tetra_prescan_state {
+	TETRA_PRESCAN_IDLE,
+	TETRA_PRESCAN_PROBE,
+	TETRA_PRESCAN_LIVE,
+};
+
+struct tetra_prescan_carrier {
+	enum tetra_prescan_state state;
+	float power_db;		/* of the last interval */
+	unsigned int quiet;	/* intervals below the threshold */
+	unsigned int backoff;	/* intervals before the next probe */
+
+	/* while probing */
+	unsigned int probe_bits;
+	unsigned int num_bits;
+	uint8_t bits[TETRA_PRESCAN_BITS];
+	struct tetra_demod demod;
+};
+
+struct tetra_prescan_stats {
+	unsigned int probes;
+	unsigned int syncs;	/* probes which found SYNC */
+	unsigned int stops;
+};
+
+/* decoder of carrier 'idx' of the channelizer */
+typedef void (*tetra_prescan_cb)(unsigned int idx, void *priv);
+
+struct tetra_prescan {
+	struct tetra_chan *ch;
+	float thresh_db;
+	unsigned int hold;
+	unsigned int backoff;
+	unsigned int probe_len;	/* bits */
+
+	float floor_db;		/* noise floor of the band */
+	struct tetra_prescan_carrier *c;
+
+	tetra_prescan_cb start;
+	tetra_prescan_cb stop;
+	void *cb_priv;
+
+	struct tetra_prescan_stats stats;
+};
+
+/* Take over the carriers added to 'ch' so far.  They are all made
+ * inactive, until they are found live. */
+struct tetra_prescan *tetra_prescan_alloc(void *ctx, struct tetra_chan *ch,
+					  tetra_prescan_cb start, tetra_prescan_cb stop,
+					  void *priv);
+
+/* after each tetra_chan_in() */
+void tetra_prescan_update(struct tetra_prescan *ps);
+
+/* Samples passed to the channelizer callback.  Returns 1 if they are
+ * for the decoder of a live carrier, 0 if they were used for probing. */
+int tetra_prescan_in(struct tetra_prescan *ps, unsigned int idx,
+		     const float complex *samples, unsigned int n);
+
+#endif /* TETRA_PRESCAN_H */
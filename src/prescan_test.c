@@ -0,0 +1,201 @@
+/* Test program for the energy and SYNC pre-scan */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/utils.h>
+
+#include "tetra_kernel.h"
+#include <phy/tetra_prescan.h>
+#include "testcheck.h"
+
+/* 800 kS/s, 400 samples for every 9 symbols */
+#define NUM_CHAN	64
+#define RATE		(NUM_CHAN * TETRA_CHAN_SPACING)
+#define PERIOD		400
+#define PULSE_SYM	13
+#define NUM_SAMPLES	(RATE / 2)
+#define NUM_SYM		(NUM_SAMPLES / PERIOD * 9)
+
+void *tetra_tall_ctx;
+
+/* SYNC training sequence */
+static const uint8_t y_bits[38] = { 1,1, 0,0, 0,0, 0,1, 1,0, 0,1, 1,1, 0,0, 1,1, 1,0,
+				    1,0, 0,1, 1,1, 0,0, 0,0, 0,1, 1,0, 0,1, 1,1 };
+
+struct carrier {
+	int32_t offset_hz;
+	int with_sync;
+	unsigned int num_sym;	/* transmitted, then silence */
+	float complex sym[NUM_SYM];
+	/* passed on to the decoder */
+	unsigned int num_out;
+	unsigned int starts, stops;
+};
+
+static struct carrier carriers[] = {
+	/* a base station, switched off after 0.3 s */
+	{ .offset_hz = 100000, .with_sync = 1, .num_sym = NUM_SYM * 3 / 5 },
+	/* busy, but no SYNC */
+	{ .offset_hz = -150000, .num_sym = NUM_SYM },
+	/* quiet */
+	{ .offset_hz = 250000 },
+};
+
+static float complex wide[NUM_SAMPLES];
+static float pulse[PERIOD][PULSE_SYM];
+
+static float gauss(void)
+{
+	float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+	float u2 = rand() / (RAND_MAX + 1.0f);
+
+	return sqrtf(-2 * logf(u1)) * cosf(2 * M_PI * u2);
+}
+
+static void modulate(void)
+{
+	static const int phase_step[4] = { 1, 3, -1, -3 };
+	unsigned int i, j, k, n;
+
+	/* the pulse shape repeats every PERIOD samples */
+	for (n = 0; n < PERIOD; n++) {
+		float t = (float) n * TETRA_SYM_RATE / RATE;
+
+		for (k = 0; k < PULSE_SYM; k++)
+			pulse[n][k] = tetra_rrc(t - (floorf(t) - 6 + k), TETRA_RRC_ALPHA);
+	}
+
+	for (j = 0; j < ARRAY_SIZE(carriers); j++) {
+		struct carrier *c = &carriers[j];
+		int phase = 0;
+
+		for (i = 0; i < c->num_sym; i++) {
+			unsigned int b0 = rand() & 1, b1 = rand() & 1;
+			/* a SYNC training sequence in every fourth timeslot */
+			unsigned int pos = i % (4 * TETRA_SYM_PER_TS) - 107;
+
+			if (c->with_sync && pos < 19) {
+				b0 = y_bits[2*pos];
+				b1 = y_bits[2*pos+1];
+			}
+			phase = (phase + phase_step[b0 * 2 + b1]) & 7;
+			c->sym[i] = cexpf(I * phase * M_PI / 4);
+		}
+	}
+
+	for (n = 0; n < NUM_SAMPLES; n++) {
+		unsigned int m0 = n / PERIOD * 9 + (n % PERIOD) * 9 / PERIOD;
+		float complex v = 0;
+
+		for (j = 0; j < ARRAY_SIZE(carriers); j++) {
+			struct carrier *c = &carriers[j];
+			float complex s = 0;
+
+			for (k = 0; k < PULSE_SYM; k++) {
+				int m = m0 - 6 + k;
+
+				if (m >= 0 && m < c->num_sym)
+					s += c->sym[m] * pulse[n % PERIOD][k];
+			}
+			v += s * cexpf(I * 2 * M_PI * remainderf((float) c->offset_hz * n / RATE, 1));
+		}
+		wide[n] = v + 0.01f * (gauss() + I * gauss());
+	}
+}
+
+static struct tetra_prescan *ps;
+
+static void chan_cb(unsigned int idx, const float complex *samples,
+		    unsigned int n, void *priv)
+{
+	if (tetra_prescan_in(ps, idx, samples, n))
+		carriers[idx].num_out += n;
+}
+
+static void start_cb(unsigned int idx, void *priv)
+{
+	carriers[idx].starts++;
+}
+
+static void stop_cb(unsigned int idx, void *priv)
+{
+	carriers[idx].stops++;
+}
+
+int main(int argc, char **argv)
+{
+	struct tetra_chan *ch;
+	unsigned int i, pos, probed_sync = 0;
+
+	srand(42);
+	tetra_kernel_init();
+
+	modulate();
+
+	ch = tetra_chan_alloc(NULL, NUM_CHAN, chan_cb, NULL);
+	for (i = 0; i < ARRAY_SIZE(carriers); i++)
+		tetra_chan_add(ch, carriers[i].offset_hz);
+	ps = tetra_prescan_alloc(NULL, ch, start_cb, stop_cb, NULL);
+	ps->hold = 5;
+	ps->probe_len = 4 * TETRA_BITS_PER_TS * 4;
+
+	check(!ch->out[0].active && !ch->out[1].active && !ch->out[2].active,
+	      "inactive before the first scan");
+
+	for (pos = 0; pos < NUM_SAMPLES; ) {
+		unsigned int len = 1 + rand() % 9000;
+
+		if (len > NUM_SAMPLES - pos)
+			len = NUM_SAMPLES - pos;
+		tetra_chan_in(ch, wide + pos, len);
+		tetra_prescan_update(ps);
+		pos += len;
+
+		if (ps->c[0].state == TETRA_PRESCAN_LIVE)
+			probed_sync = 1;
+	}
+
+	printf("floor %.1f dB, carriers %.1f / %.1f / %.1f dB\n", ps->floor_db,
+	       ps->c[0].power_db, ps->c[1].power_db, ps->c[2].power_db);
+
+	check(probed_sync && carriers[0].starts == 1 && carriers[0].stops == 1 &&
+	      carriers[0].num_out > TETRA_DEMOD_RATE / 10, "base station found and lost");
+	check(carriers[1].starts == 0 && carriers[1].num_out == 0 &&
+	      ps->c[1].state == TETRA_PRESCAN_IDLE && ps->c[1].backoff > 0,
+	      "busy carrier without SYNC");
+	check(carriers[2].starts == 0 && ps->c[2].state == TETRA_PRESCAN_IDLE &&
+	      ps->c[2].power_db < ps->floor_db + ps->thresh_db, "quiet carrier");
+	check(!ch->out[0].active && !ch->out[1].active && !ch->out[2].active,
+	      "nothing resampled when idle");
+	check(ps->stats.probes == 2 && ps->stats.syncs == 1 && ps->stats.stops == 1,
+	      "statistics");
+
+	talloc_free(ps);
+	talloc_free(ch);
+
+	check_exit();
+}
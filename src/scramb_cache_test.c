@@ -0,0 +1,186 @@
+/* Test program for the cache of known cells */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <osmocom/core/utils.h>
+
+#include "tetra_tdma.h"
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_scramb_cache.h>
+#include "testcheck.h"
+
+#define CARRIER		392775000
+#define T0		1700000000
+
+static uint64_t slot_at(uint16_t hn, uint32_t mn, uint32_t fn, uint32_t tn)
+{
+	struct tetra_tdma_time tm = { .hn = hn, .mn = mn, .fn = fn, .tn = tn };
+
+	return tetra_tdma_time2slot(&tm);
+}
+
+/* three cells on our carrier and one on another, seen in this order */
+static void fill(struct tetra_scramb_cache *sc)
+{
+	tetra_scramb_cache_init(sc, CARRIER + 25000);
+	tetra_scramb_cache_update(sc, 262, 1, 1, slot_at(7, 1, 1, 1), T0 + 400);
+	sc->carrier = CARRIER;
+	tetra_scramb_cache_update(sc, 262, 42, 1, slot_at(1, 2, 3, 4), T0 + 100);
+	tetra_scramb_cache_update(sc, 262, 42, 2, slot_at(2, 60, 18, 4), T0 + 300);
+	tetra_scramb_cache_update(sc, 901, 9999, 63, slot_at(65535, 5, 6, 1), T0 + 200);
+}
+
+static void test_candidates(void)
+{
+	const struct tetra_scramb_cache_entry *cand[TETRA_SCACHE_MAX_CAND];
+	struct tetra_scramb_cache sc;
+	unsigned int num;
+
+	fill(&sc);
+	num = tetra_scramb_cache_candidates(&sc, cand, ARRAY_SIZE(cand));
+	check(num == 3 && cand[0]->colour_code == 2 && cand[1]->mcc == 901 &&
+	      cand[2]->colour_code == 1 && cand[2]->mnc == 42,
+	      "candidates of the carrier, most recent first");
+
+	num = tetra_scramb_cache_candidates(&sc, cand, 2);
+	check(num == 2 && cand[0]->colour_code == 2 && cand[1]->mcc == 901,
+	      "at most 'max' candidates");
+
+	sc.carrier = 0;
+	num = tetra_scramb_cache_candidates(&sc, cand, ARRAY_SIZE(cand));
+	check(num == 4 && cand[0]->carrier == CARRIER + 25000 && cand[0]->mnc == 1,
+	      "all carriers");
+}
+
+static void test_update(void)
+{
+	struct tetra_scramb_cache sc;
+	struct tetra_scramb_cache_entry *e;
+	uint64_t slot = slot_at(1, 2, 3, 4);
+
+	fill(&sc);
+	e = tetra_scramb_cache_update(&sc, 262, 42, 1, slot + 1000, 0);
+	check(sc.num == 4 && e->hits == 2 && e->slot == slot && e->last_seen == T0 + 100 &&
+	      e->scramb_init == tetra_scramb_get_init(262, 42, 1),
+	      "no input time leaves the TDMA time alone");
+
+	e = tetra_scramb_cache_update(&sc, 262, 42, 1, slot + 1000, T0 + 500);
+	check(e->hits == 3 && e->slot == slot + 1000 && e->last_seen == T0 + 500,
+	      "update with the input time");
+
+	e = tetra_scramb_cache_update(&sc, 262, 43, 1, slot, 0);
+	check(sc.num == 5 && e->hits == 1 && e->last_seen == 0, "new entry without a time");
+}
+
+static void test_full(void)
+{
+	struct tetra_scramb_cache sc;
+	unsigned int i;
+
+	tetra_scramb_cache_init(&sc, CARRIER);
+	for (i = 0; i < TETRA_SCACHE_MAX_ENTRIES; i++)
+		tetra_scramb_cache_update(&sc, 262, i, 1, 0, T0 + 1000 - i);
+	tetra_scramb_cache_update(&sc, 262, 1000, 1, 0, T0 + 2000);
+	for (i = 0; i < sc.num; i++) {
+		if (sc.e[i].mnc == TETRA_SCACHE_MAX_ENTRIES - 1)
+			break;
+	}
+	check(sc.num == TETRA_SCACHE_MAX_ENTRIES && i == sc.num &&
+	      sc.e[TETRA_SCACHE_MAX_ENTRIES - 1].mnc == 1000,
+	      "the least recently seen cell is replaced");
+}
+
+static void test_save_load(const char *path)
+{
+	struct tetra_scramb_cache sc, sc2;
+	unsigned int i;
+	int same = 1;
+	FILE *f;
+
+	fill(&sc);
+	check(sc.dirty && tetra_scramb_cache_save(&sc, path) == 0 && !sc.dirty, "save");
+
+	tetra_scramb_cache_init(&sc2, CARRIER);
+	check(tetra_scramb_cache_load(&sc2, path) == 0 && sc2.num == sc.num, "load");
+	for (i = 0; i < sc.num; i++) {
+		const struct tetra_scramb_cache_entry *a = &sc.e[i], *b = &sc2.e[i];
+
+		same &= a->carrier == b->carrier && a->mcc == b->mcc && a->mnc == b->mnc &&
+			a->colour_code == b->colour_code && a->scramb_init == b->scramb_init &&
+			a->slot == b->slot && a->last_seen == b->last_seen && a->hits == b->hits;
+	}
+	check(same, "round trip");
+
+	/* nonsense is skipped, and known cells are not duplicated */
+	f = fopen(path, "a");
+	fprintf(f, "garbage\n%u 1024 1 1 0 1 1 1 0 1\n%u 262 42 1 9 1 1 1 %u 7\n",
+		CARRIER, CARRIER, T0 + 900);
+	fclose(f);
+	tetra_scramb_cache_init(&sc2, CARRIER);
+	check(tetra_scramb_cache_load(&sc2, path) == 0 && sc2.num == sc.num &&
+	      sc2.e[1].hits == 7 && sc2.e[1].slot == slot_at(9, 1, 1, 1),
+	      "bad lines and duplicates");
+
+	unlink(path);
+	check(tetra_scramb_cache_load(&sc2, path) == -ENOENT, "missing file");
+}
+
+static void test_predict(void)
+{
+	struct tetra_scramb_cache_entry e;
+
+	memset(&e, 0, sizeof(e));
+	e.slot = slot_at(3, 60, 18, 3);
+	e.last_seen = T0;
+
+	/* a slot is 85/6 ms, 17 s are 1200 slots */
+	check(tetra_scramb_cache_predict_slot(&e, T0) == e.slot &&
+	      tetra_scramb_cache_predict_slot(&e, T0 + 17) == e.slot + 1200 &&
+	      tetra_scramb_cache_predict_slot(&e, T0 + 3400) == e.slot + 240000,
+	      "TDMA time predicted");
+	check(tetra_scramb_cache_predict_slot(&e, T0 - 5) == e.slot, "no going back");
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/scramb_cache_test.XXXXXX";
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		exit(1);
+	}
+	close(fd);
+
+	test_candidates();
+	test_update();
+	test_full();
+	test_save_load(path);
+	test_predict();
+
+	check_exit();
+}
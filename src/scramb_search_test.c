@@ -0,0 +1,186 @@
+/* Test program for the scrambling code search */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "tetra_common.h"
+#include "tetra_kernel.h"
+#include <lower_mac/crc_simple.h>
+#include <lower_mac/tetra_conv_enc.h>
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_scramb_search.h>
+#include <phy/tetra_burst.h>
+#include "testcheck.h"
+
+#define MCC	262
+#define MNC	1234
+#define CC	42
+
+/* random type-1 bits, coded and scrambled for the given cell, with
+ * 'errors' bits flipped */
+static void make_block(enum tp_sap_data_type type, uint32_t scramb_init,
+		       unsigned int errors, uint8_t *type5)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+	uint8_t type2[TETRA_BLK_MAX_BITS], master[TETRA_BLK_MAX_BITS*4];
+	uint8_t type3[TETRA_BLK_MAX_BITS];
+	struct conv_enc_state ces;
+	uint16_t crc;
+	unsigned int i;
+
+	memset(type2, 0, sizeof(type2));
+	for (i = 0; i < tbp->type1_bits; i++)
+		type2[i] = rand() & 1;
+	crc = ~crc16_ccitt_bits(type2, tbp->type1_bits);
+	for (i = 0; i < 16; i++)
+		type2[tbp->type1_bits + i] = (crc >> (15 - i)) & 1;
+
+	conv_enc_init(&ces);
+	conv_enc_input(&ces, type2, tbp->type2_bits, master);
+	get_punctured_rate(TETRA_RCPC_PUNCT_2_3, master, tbp->type345_bits, type3);
+	block_interleave(tbp->type345_bits, tbp->interleave_a, type3, type5);
+	tetra_scramb_bits(scramb_init, type5, tbp->type345_bits);
+
+	for (i = 0; i < errors; i++)
+		type5[rand() % tbp->type345_bits] ^= 1;
+}
+
+static void add_blocks(struct tetra_scramb_search *ss, enum tp_sap_data_type type,
+		       unsigned int num, unsigned int errors)
+{
+	uint8_t type5[TETRA_BLK_MAX_BITS];
+	unsigned int i;
+
+	for (i = 0; i < num; i++) {
+		make_block(type, tetra_scramb_get_init(MCC, MNC, CC), errors, type5);
+		tetra_scramb_search_add_block(ss, type, type5);
+	}
+}
+
+static int found(int rc, uint16_t mcc, uint16_t mnc, uint8_t cc)
+{
+	return rc == 1 && mcc == MCC && mnc == MNC && cc == CC;
+}
+
+/* through the lower MAC: a SYNC with a bad CRC must neither stop the
+ * search nor move the TDMA time */
+static void test_damaged_sync(void)
+{
+	struct tetra_scramb_search ss;
+	struct tetra_mac_state tms;
+	uint8_t type5[TETRA_BLK_MAX_BITS];
+	const uint64_t slot = 123456;
+	unsigned int i;
+
+	memset(&tms, 0, sizeof(tms));
+	tetra_mac_state_init(&tms);
+	tetra_scramb_search_init(&ss);
+	ss.mcc = MCC;
+	ss.mnc = MNC;
+	tms.scramb_search = &ss;
+
+	t_phy_state.slot = slot;
+	make_block(TPSAP_T_SB1, SCRAMB_INIT, 40, type5);
+	tp_sap_udata_ind(TPSAP_T_SB1, type5, NULL, 120, &tms);
+	check(t_phy_state.slot == slot, "damaged SYNC keeps the TDMA time");
+
+	for (i = 0; i < ss.want_blk; i++) {
+		make_block(TPSAP_T_NDB, tetra_scramb_get_init(MCC, MNC, CC), 0, type5);
+		tp_sap_udata_ind(TPSAP_T_NDB, type5, NULL, 216, &tms);
+	}
+	check(ss.stats.runs == 1 && ss.stats.found == 1, "search after a damaged SYNC");
+
+	/* once found, neither another damaged SYNC nor more blocks start
+	 * a new search */
+	make_block(TPSAP_T_SB1, SCRAMB_INIT, 40, type5);
+	tp_sap_udata_ind(TPSAP_T_SB1, type5, NULL, 120, &tms);
+	for (i = 0; i < ss.want_blk; i++) {
+		make_block(TPSAP_T_NDB, tetra_scramb_get_init(MCC, MNC, CC), 0, type5);
+		tp_sap_udata_ind(TPSAP_T_NDB, type5, NULL, 216, &tms);
+	}
+	check(ss.stats.runs == 1 && ss.num_blk == 0, "code kept");
+}
+
+int main(int argc, char **argv)
+{
+	struct tetra_scramb_search ss;
+	uint8_t type5[TETRA_BLK_MAX_BITS];
+	char path[64];
+	uint16_t mcc, mnc;
+	uint8_t cc;
+	FILE *f;
+	int rc;
+
+	tetra_kernel_init();
+	tetra_verbosity = TETRA_V_NONE;
+
+	test_damaged_sync();
+
+	tetra_scramb_search_init(&ss);
+	memset(type5, 0, sizeof(type5));
+	check(tetra_scramb_search_add_block(&ss, TPSAP_T_SB1, type5) < 0 &&
+	      tetra_scramb_search_add_block(&ss, TPSAP_T_BBK, type5) < 0 &&
+	      tetra_scramb_search_run(&ss, &mcc, &mnc, &cc) < 0, "unsuitable blocks");
+
+	/* MCC and MNC known: only the colour code */
+	ss.mcc = MCC;
+	ss.mnc = MNC;
+	add_blocks(&ss, TPSAP_T_NDB, 2, 0);
+	rc = tetra_scramb_search_run(&ss, &mcc, &mnc, &cc);
+	check(found(rc, mcc, mnc, cc), "colour code");
+	check(ss.plan[TPSAP_T_NDB].num_chk == TETRA_SSEARCH_MAX_CHK, "SCH/HD parity checks");
+
+	/* MCC known, with bit errors and mixed block types */
+	ss.mnc = -1;
+	ss.num_threads = 2;
+	add_blocks(&ss, TPSAP_T_NDB, 2, 3);
+	add_blocks(&ss, TPSAP_T_SCH_F, 2, 5);
+	rc = tetra_scramb_search_run(&ss, &mcc, &mnc, &cc);
+	check(found(rc, mcc, mnc, cc), "MNC and colour code");
+	check(ss.stats.survivors < 16, "few candidates decoded");
+
+	/* the list of known networks */
+	snprintf(path, sizeof(path), "/tmp/scramb-search-test-%u", getpid());
+	f = fopen(path, "w");
+	fprintf(f, "# mcc mnc\n262 1\n262 2\n%u %u\n901 9999\n", MCC, MNC);
+	fclose(f);
+	ss.mcc = -1;
+	check(tetra_scramb_search_load_pairs(&ss, path) == 0 && ss.num_pairs == 4,
+	      "load pairs");
+	unlink(path);
+	add_blocks(&ss, TPSAP_T_SB2, 3, 2);
+	rc = tetra_scramb_search_run(&ss, &mcc, &mnc, &cc);
+	check(found(rc, mcc, mnc, cc), "known networks");
+
+	/* a cell which is not in the list */
+	ss.num_pairs = 2;
+	add_blocks(&ss, TPSAP_T_NDB, 3, 0);
+	rc = tetra_scramb_search_run(&ss, &mcc, &mnc, &cc);
+	check(rc == 0 && ss.num_blk == 0, "unknown network");
+
+	check(ss.stats.runs == 4 && ss.stats.found == 3, "statistics");
+
+	check_exit();
+}
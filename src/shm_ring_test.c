@@ -0,0 +1,127 @@
+/* Test program for the shared memory block ring */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "tetra_shm.h"
+#include "testcheck.h"
+
+#define NUM_SLOTS	64
+
+static uint8_t bits[268];
+
+static void publish(struct tetra_shm *wr, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		uint32_t ts = tetra_shm_get_hdr(wr)->head;
+
+		bits[0] = ts & 1;
+		tetra_shm_publish(wr, ts, ts % 4, 1, 1, 1, 1, 0x1234, bits, sizeof(bits));
+	}
+}
+
+/* read everything available, return the number of records read */
+static unsigned int drain(struct tetra_shm *rd, uint32_t *last_ts)
+{
+	const struct tetra_shm_rec *rec;
+	unsigned int n = 0;
+
+	while ((rec = tetra_shm_peek(rd))) {
+		uint32_t ts = rec->ts;
+		int ok = rec->num_bits == sizeof(bits) && (rec->bits[0] >> 7) == (ts & 1);
+
+		if (tetra_shm_consume(rd, rec) == 0) {
+			if (!ok || (n && ts != *last_ts + 1))
+				check(0, "record in order");
+			*last_ts = ts;
+			n++;
+		}
+	}
+	return n;
+}
+
+int main(int argc, char **argv)
+{
+	struct tetra_shm *wr, *rd1, *rd2;
+	const struct tetra_shm_hdr *hdr;
+	char name[64];
+	uint32_t last1 = 0, last2 = 0;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(bits); i++)
+		bits[i] = rand() & 1;
+
+	snprintf(name, sizeof(name), "/tetra-shm-test-%u", getpid());
+	wr = tetra_shm_create(NULL, name, NUM_SLOTS);
+	check(wr != NULL, "create");
+	if (!wr)
+		exit(1);
+	check(sizeof(struct tetra_shm_rec) == 64, "record size");
+
+	publish(wr, 10);
+	rd1 = tetra_shm_attach(NULL, name);
+	rd2 = tetra_shm_attach(NULL, name);
+	check(rd1 && rd2, "attach");
+	if (!rd1 || !rd2)
+		exit(1);
+	check(tetra_shm_peek(rd1) == NULL, "readers start at the newest record");
+
+	/* a reader keeping up loses nothing */
+	publish(wr, NUM_SLOTS / 2);
+	check(drain(rd1, &last1) == NUM_SLOTS / 2 && tetra_shm_lost(rd1) == 0,
+		"reader keeping up");
+
+	/* the writer overruns the second reader */
+	publish(wr, 3 * NUM_SLOTS);
+	check(drain(rd1, &last1) < 3 * NUM_SLOTS, "first reader overrun");
+	check(drain(rd2, &last2) == NUM_SLOTS - 1, "second reader gets the newest records");
+	check(last1 == last2 && last2 == 10 + NUM_SLOTS / 2 + 3 * NUM_SLOTS - 1,
+		"readers end at the head");
+	check(tetra_shm_lost(rd2) == NUM_SLOTS / 2 + 3 * NUM_SLOTS - (NUM_SLOTS - 1),
+		"lost records counted");
+
+	/* a record overwritten while being read is detected */
+	publish(wr, 1);
+	{
+		const struct tetra_shm_rec *rec = tetra_shm_peek(rd1);
+
+		publish(wr, NUM_SLOTS);
+		check(rec && tetra_shm_consume(rd1, rec) < 0, "overwrite during read");
+	}
+
+	hdr = tetra_shm_get_hdr(wr);
+	check(hdr->reader[0].pid == getpid() && hdr->reader[1].lost == tetra_shm_lost(rd2),
+		"reader table");
+	tetra_shm_close(rd1);
+	check(hdr->reader[0].pid == 0, "reader slot released");
+
+	tetra_shm_close(rd2);
+	tetra_shm_close(wr);
+	shm_unlink(name);
+
+	check_exit();
+}
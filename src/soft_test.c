@@ -0,0 +1,230 @@
+/* Test program for soft decisions from the demodulator to the Viterbi decoder */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <math.h>
+#include <complex.h>
+
+#include "tetra_kernel.h"
+#include <tetra_common.h>
+#include <tetra_event.h>
+#include <phy/tetra_burst.h>
+#include <phy/tetra_burst_sync.h>
+#include <phy/tetra_demod.h>
+#include <phy/tetra_gen.h>
+#include <phy/tetra_mod.h>
+#include <phy/tetra_chsim.h>
+#include <lower_mac/tetra_lower_mac.h>
+#include "testcheck.h"
+
+/* four multiframes */
+#define NUM_BURSTS	(4 * 72)
+#define NUM_SAMPLES	(NUM_BURSTS * TETRA_SYM_PER_TS * TETRA_MOD_SPS)
+/* as tetra-rx feeds the burst synchronizer */
+#define SYM_CHUNK	256
+/* in units of pi/4, a symbol error rate of about 1 in 10 */
+#define NOISE_SIGMA	0.6f
+
+void *tetra_tall_ctx;
+
+static uint8_t bits[NUM_BURSTS * TETRA_BITS_PER_TS];
+static float complex mod[NUM_SAMPLES];
+static float complex ch_out[TETRA_CHSIM_MAX_OUT(NUM_SAMPLES)];
+static float sym[TETRA_DEMOD_MAX_SYM(TETRA_CHSIM_MAX_OUT(NUM_SAMPLES))];
+static unsigned int num_sym;
+
+static void make_bursts(void)
+{
+	struct tetra_gen tg;
+	unsigned int i;
+
+	tetra_gen_init(&tg, 5);
+	for (i = 0; i < NUM_BURSTS; i++)
+		tetra_gen_burst(&tg, bits + i * TETRA_BITS_PER_TS);
+}
+
+/* the output of the demodulator for a channel of 'snr_db' */
+static void demod_symbols(float snr_db)
+{
+	struct tetra_mod tm;
+	struct tetra_chsim cs;
+	struct tetra_demod td;
+	unsigned int n;
+
+	make_bursts();
+	tetra_mod_init(&tm);
+	tetra_mod_bits(&tm, bits, NUM_BURSTS * TETRA_SYM_PER_TS, mod);
+
+	tetra_chsim_init(&cs, TETRA_DEMOD_RATE, 3);
+	cs.snr_db = snr_db;
+	cs.freq_hz = 300;
+	tetra_chsim_update(&cs);
+	n = tetra_chsim_run(&cs, mod, NUM_SAMPLES, ch_out);
+
+	tetra_demod_init(&td);
+	num_sym = tetra_demod_in(&td, ch_out, n, sym);
+}
+
+static float gauss(void)
+{
+	float u1 = (rand() + 1.0f) / (RAND_MAX + 1.0f);
+	float u2 = (float) rand() / RAND_MAX;
+
+	return sqrtf(-2 * logf(u1)) * cosf(2 * M_PI * u2);
+}
+
+/* The ideal symbols with Gaussian noise of 'sigma' in units of pi/4.  The
+ * burst synchronizer needs an exact match of the training sequences, at
+ * this noise it would lose its lock all the time: they stay clean. */
+static void noisy_symbols(float sigma)
+{
+	unsigned int i, j, train, train_len, offs;
+	float *s;
+
+	make_bursts();
+	tetra_gen_symbols(bits, NUM_BURSTS * TETRA_SYM_PER_TS, sym);
+	num_sym = NUM_BURSTS * TETRA_SYM_PER_TS;
+
+	srand(7);
+	for (i = 0; i < NUM_BURSTS; i++) {
+		s = sym + i * TETRA_SYM_PER_TS;
+		if (tetra_find_train_seq(bits + i * TETRA_BITS_PER_TS, TETRA_BITS_PER_TS,
+					 1 << TETRA_TRAIN_SYNC, &offs) == TETRA_TRAIN_SYNC &&
+		    offs == 214) {
+			train = 214;
+			train_len = 38;
+		} else {
+			train = 244;
+			train_len = 22;
+		}
+		for (j = 0; j < TETRA_SYM_PER_TS; j++) {
+			if (2*j < train || 2*j >= train + train_len)
+				s[j] += sigma * gauss();
+		}
+	}
+}
+
+struct blk_count {
+	unsigned int blocks, crc_ok;
+};
+
+/* the symbols through the burst synchronizer, the lower and the upper MAC
+ * like tetra-rx -y [-Y] does, counting the coded blocks with a good CRC
+ * in the event stream */
+static struct blk_count receive(const char *path, int soft)
+{
+	struct blk_count cnt = { 0, 0 };
+	struct tetra_mac_state tms;
+	struct tetra_rx_state trs;
+	struct tetra_ev_file_hdr fh;
+	struct tetra_ev_hdr eh;
+	static uint8_t payload[65536];
+	uint8_t hard_bits[2*SYM_CHUNK];
+	int8_t soft_bits[2*SYM_CHUNK];
+	unsigned int i, num;
+	int synced = 0;
+	FILE *f;
+
+	memset(&tms, 0, sizeof(tms));
+	tetra_mac_state_init(&tms);
+	memset(&trs, 0, sizeof(trs));
+	trs.burst_cb_priv = &tms;
+
+	tetra_event_open(path, 0);
+	for (i = 0; i < num_sym; i += num) {
+		num = num_sym - i > SYM_CHUNK ? SYM_CHUNK : num_sym - i;
+		tetra_kern.slice(sym + i, num, hard_bits);
+		if (soft) {
+			tetra_kern.slice_soft(sym + i, num, soft_bits);
+			tetra_burst_sync_in_soft(&trs, hard_bits, soft_bits, 2*num);
+		} else
+			tetra_burst_sync_in(&trs, hard_bits, 2*num);
+	}
+	tetra_event_close();
+
+	f = fopen(path, "rb");
+	if (!f || tetra_event_read_hdr(f, &fh) < 0)
+		return cnt;
+	while (tetra_event_read(f, &fh, &eh, payload) > 0) {
+		const struct tetra_ev_block *ev = (const void *) payload;
+
+		if (eh.type != TETRA_EV_BLOCK || !tetra_event_valid(&eh, payload))
+			continue;
+		/* the scrambling code is only known after the first SYNC */
+		if (ev->blk_type == TPSAP_T_SB1 && ev->crc_ok)
+			synced = 1;
+		/* the convolutionally coded ones */
+		if (!synced || (ev->blk_type != TPSAP_T_SB1 && ev->blk_type != TPSAP_T_SB2 &&
+				ev->blk_type != TPSAP_T_SCH_F))
+			continue;
+		cnt.blocks++;
+		cnt.crc_ok += ev->crc_ok;
+	}
+	fclose(f);
+
+	return cnt;
+}
+
+static void run(const char *path, const char *name, struct blk_count *soft,
+		struct blk_count *hard)
+{
+	*soft = receive(path, 1);
+	*hard = receive(path, 0);
+	printf("%s: %u of %u blocks with soft, %u of %u with hard decisions\n",
+	       name, soft->crc_ok, soft->blocks, hard->crc_ok, hard->blocks);
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/soft_test.XXXXXX";
+	struct blk_count soft, hard;
+	int fd;
+
+	tetra_verbosity = TETRA_V_NONE;
+	tetra_kernel_init();
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		exit(1);
+	}
+	close(fd);
+
+	demod_symbols(30);
+	run(path, "clean", &soft, &hard);
+	check(soft.blocks > 0 && soft.crc_ok == soft.blocks && hard.crc_ok == soft.crc_ok,
+	      "clean channel");
+
+	/* where the hard decisions lose about a quarter of the blocks, the soft
+	 * ones have to keep at least 5 of 6, with the same bursts found */
+	noisy_symbols(NOISE_SIGMA);
+	run(path, "noisy", &soft, &hard);
+	check(soft.blocks > NUM_BURSTS / 3 && hard.blocks == soft.blocks, "same bursts");
+	check(6 * soft.crc_ok >= 5 * soft.blocks, "soft decisions decode");
+	check(hard.crc_ok + soft.blocks / 16 <= soft.crc_ok, "soft better than hard decisions");
+
+	unlink(path);
+
+	check_exit();
+}
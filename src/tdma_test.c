@@ -0,0 +1,150 @@
+/* Test program for the TDMA slot counter */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <osmocom/core/msgb.h>
+#include <osmocom/core/talloc.h>
+
+#include "tetra_common.h"
+#include "tetra_tdma.h"
+#include "tetra_mac_pdu.h"
+#include "tetra_prim.h"
+#include "tetra_upper_mac.h"
+#include "testcheck.h"
+
+void *tetra_tall_ctx;
+
+static int time_is(uint64_t slot, uint16_t hn, uint32_t mn, uint32_t fn, uint32_t tn)
+{
+	struct tetra_tdma_time tm;
+
+	tetra_tdma_slot2time(slot, &tm);
+	return tm.hn == hn && tm.mn == mn && tm.fn == fn && tm.tn == tn;
+}
+
+/* a SYSINFO received in 'slot', with the hyperframe number or the CCK ID */
+static void send_sysinfo(struct tetra_mac_state *tms, uint64_t slot, int cck, uint16_t val)
+{
+	struct tetra_tmvsap_prim *ttp;
+	struct tetra_si_decoded sid;
+	uint8_t bits[124];
+
+	memset(&sid, 0, sizeof(sid));
+	sid.cck_valid_no_hf = cck;
+	if (cck)
+		sid.cck_id = val;
+	else
+		sid.hyperframe_number = val;
+	macpdu_encode_sysinfo(&sid, bits);
+
+	ttp = talloc_zero(NULL, struct tetra_tmvsap_prim);
+	ttp->oph.msg = msgb_alloc(412, "tdma_test");
+	ttp->oph.sap = TETRA_SAP_TMV;
+	ttp->oph.primitive = PRIM_TMV_UNITDATA;
+	ttp->oph.operation = PRIM_OP_INDICATION;
+	ttp->u.unitdata.lchan = TETRA_LC_BNCH;
+	ttp->u.unitdata.crc_ok = 1;
+	ttp->u.unitdata.tdma_slot = slot;
+	ttp->oph.msg->l1h = msgb_put(ttp->oph.msg, sizeof(bits));
+	memcpy(ttp->oph.msg->l1h, bits, sizeof(bits));
+
+	t_phy_state.slot = slot;
+	upper_mac_prim_recv(&ttp->oph, tms);
+}
+
+/* only a SYSINFO with a hyperframe number sets the hyperframe */
+static void test_sysinfo(void)
+{
+	struct tetra_mac_state tms;
+	uint64_t slot = 5 * TETRA_SLOTS_PER_HN + 1234;
+
+	memset(&tms, 0, sizeof(tms));
+	tetra_mac_state_init(&tms);
+
+	send_sysinfo(&tms, slot, 1, 0x1234);
+	check(t_phy_state.slot == slot, "SYSINFO with CCK ID");
+	send_sysinfo(&tms, slot, 0, 42);
+	check(t_phy_state.slot == tetra_tdma_slot_set_hn(slot, 42) &&
+	      tetra_tdma_hn(t_phy_state.slot) == 42, "SYSINFO with hyperframe");
+}
+
+int main(int argc, char **argv)
+{
+	struct tetra_tdma_time tm = { .hn = 7, .mn = 60, .fn = 18, .tn = 4 };
+	struct tetra_tdma_clock clk;
+	char buf[TETRA_TDMA_DUMP_LEN];
+	uint64_t slot, s;
+	int ok = 1;
+
+	tetra_verbosity = TETRA_V_NONE;
+
+	check(time_is(0, 0, 1, 1, 1), "slot 0");
+
+	/* every field wraps at its own bound */
+	slot = tetra_tdma_time2slot(&tm);
+	check(time_is(slot, 7, 60, 18, 4) && time_is(slot + 1, 8, 1, 1, 1), "hyperframe wrap");
+	tm.mn = 5;
+	tm.tn = 4;
+	slot = tetra_tdma_time2slot(&tm);
+	check(time_is(slot + 1, 7, 6, 1, 1), "multiframe wrap");
+	tm.fn = 3;
+	slot = tetra_tdma_time2slot(&tm);
+	check(time_is(slot + 1, 7, 5, 4, 1), "frame wrap");
+
+	/* round trip over more than a hyperframe */
+	for (s = 1000; s < 1000 + 2 * TETRA_SLOTS_PER_HN; s++) {
+		tetra_tdma_slot2time(s, &tm);
+		if (tetra_tdma_time2slot(&tm) != s)
+			ok = 0;
+	}
+	check(ok, "round trip");
+
+	tm.hn = 1;
+	tm.mn = 0;
+	tm.fn = 30;
+	tm.tn = 9;
+	check(time_is(tetra_tdma_time2slot(&tm), 1, 1, 18, 4), "clamped fields");
+
+	check(time_is(tetra_tdma_slot_set_hn(slot, 42), 42, 5, 3, 4), "set hyperframe");
+
+	slot = 123456789;
+	check(tetra_tdma_gsmtap_fn2slot(tetra_tdma_slot2gsmtap_fn(slot),
+					tetra_tdma_tn(slot)) == slot, "GSMTAP frame number");
+
+	check(!strcmp(tetra_tdma_slot_dump(TETRA_SLOTS_PER_MN + 5, buf), "02/02/2"), "dump");
+
+	/* 6 slots take 85 ms */
+	tetra_tdma_clock_set(&clk, 1000, 5000000000ULL);
+	check(tetra_tdma_slot2ns(&clk, 1006) == 5085000000ULL &&
+	      tetra_tdma_slot2ns(&clk, 994) == 4915000000ULL, "slot to wall clock");
+	check(tetra_tdma_ns2slot(&clk, 5085000000ULL) == 1006 &&
+	      tetra_tdma_ns2slot(&clk, 5084999999ULL) == 1005 &&
+	      tetra_tdma_ns2slot(&clk, 4999999999ULL) == 999, "wall clock to slot");
+	check(tetra_tdma_sample2ns(1000, 36000 * 3 + 18000, TETRA_BIT_RATE) ==
+	      1000 + 3500000000ULL, "sample time");
+
+	test_sysinfo();
+
+	check_exit();
+}
@@ -0,0 +1,40 @@
+/* Checks shared by the test programs */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "testcheck.h"
+
+unsigned int check_num_err;
+
+void check(int cond, const char *what)
+{
+	printf("%s: %s\n", what, cond ? "OK" : "FAILED");
+	if (!cond)
+		check_num_err++;
+}
+
+void check_exit(void)
+{
+	printf("\ntotal number of errors: %u\n", check_num_err);
+
+	exit(check_num_err ? 1 : 0);
+}
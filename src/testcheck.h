@@ -0,0 +1,13 @@
+#ifndef TESTCHECK_H
+#define TESTCHECK_H
+
+/* checks of the test programs, each one prints its result */
+
+extern unsigned int check_num_err;
+
+void check(int cond, const char *what);
+
+/* print the number of failed checks, exit with 1 if there were any */
+void check_exit(void) __attribute__((noreturn));
+
+#endif /* TESTCHECK_H */
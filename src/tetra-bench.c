@@ -0,0 +1,410 @@
+/* Microbenchmarks of the receiver primitives, one JSON object per line */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <osmocom/core/utils.h>
+
+#include "tetra_common.h"
+#include "tetra_kernel.h"
+#include "tetra_mac_pdu.h"
+#include <phy/tetra_burst.h>
+#include <phy/tetra_gen.h>
+#include <lower_mac/crc_simple.h>
+#include <lower_mac/tch_reordering.h>
+#include <lower_mac/tetra_blk_enc.h>
+#include <lower_mac/tetra_conv_enc.h>
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/tetra_lower_mac.h>
+#include <lower_mac/tetra_rm3014.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/viterbi_cch.h>
+
+void *tetra_tall_ctx;
+
+#define MAX_BENCH	64
+/* calls per repetition at most */
+#define MAX_ITER	(1 << 24)
+
+struct bench {
+	const char *name;
+	const char *blk;	/* block type, or what else the input is */
+	enum tp_sap_data_type type;
+	unsigned int bits;	/* processed per call */
+	void (*run)(const struct bench *b);
+};
+
+/* input of the primitives, a valid block of each type at each stage */
+static struct {
+	uint8_t type1[TETRA_BLK_MAX_BITS];
+	uint8_t type2[TETRA_BLK_MAX_BITS];
+	uint8_t type3[TETRA_BLK_MAX_BITS];
+	uint8_t type3dp[TETRA_BLK_MAX_BITS*4];
+	int8_t soft[TETRA_BLK_MAX_BITS*4];
+	uint8_t type4[TETRA_BLK_MAX_BITS];
+	uint8_t type5[TETRA_BLK_MAX_BITS];
+} blk[TPSAP_T_SCH_F + 1];
+
+static uint8_t bursts[2 * TETRA_BITS_PER_TS];
+static uint8_t acelp[2 * TETRA_ACELP_FRAME_BITS];
+static uint8_t out[TETRA_BLK_MAX_BITS*4];
+static uint32_t scramb_init;
+static unsigned int seq;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run_find_train_seq(const struct bench *b)
+{
+	unsigned int offs;
+
+	tetra_find_train_seq(bursts, b->bits, (1 << TETRA_TRAIN_NORM_1) |
+			     (1 << TETRA_TRAIN_NORM_2) | (1 << TETRA_TRAIN_SYNC), &offs);
+}
+
+static void run_scramb(const struct bench *b)
+{
+	tetra_scramb_bits(scramb_init, blk[b->type].type5, b->bits);
+}
+
+static void run_deinterleave(const struct bench *b)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(b->type);
+
+	block_deinterleave(b->bits, tbp->interleave_a, blk[b->type].type4, out);
+}
+
+static void run_gather(const struct bench *b)
+{
+	tetra_kern.gather(tetra_get_deinterl_tbl(b->type), b->bits, blk[b->type].type4, out);
+}
+
+static void run_depunct(const struct bench *b)
+{
+	tetra_rcpc_depunct(TETRA_RCPC_PUNCT_2_3, blk[b->type].type3, b->bits, out);
+}
+
+static void run_conv_cch_decode(const struct bench *b)
+{
+	conv_cch_decode(blk[b->type].soft, out, b->bits);
+}
+
+static void run_viterbi_cch(const struct bench *b)
+{
+	tetra_kern.viterbi_cch(blk[b->type].soft, out, b->bits);
+}
+
+static void run_crc16_ccitt_bits(const struct bench *b)
+{
+	crc16_ccitt_bits(blk[b->type].type2, b->bits);
+}
+
+static void run_crc16(const struct bench *b)
+{
+	tetra_kern.crc16(0xffff, blk[b->type].type2, b->bits);
+}
+
+static void run_rm3014(const struct bench *b)
+{
+	tetra_rm3014_compute(seq++ & 0x3fff);
+}
+
+static void run_acelp(const struct bench *b)
+{
+	tetra_acelp_type2_to_codec(acelp, out);
+}
+
+static void run_decode_resource(const struct bench *b)
+{
+	struct tetra_resrc_decoded rsd;
+
+	memset(&rsd, 0, sizeof(rsd));
+	macpdu_decode_resource(&rsd, blk[b->type].type1);
+}
+
+static void run_decode_sysinfo(const struct bench *b)
+{
+	struct tetra_si_decoded sid;
+
+	macpdu_decode_sysinfo(&sid, blk[b->type].type1);
+}
+
+static void run_decode_access_assign(const struct bench *b)
+{
+	struct tetra_acc_ass_decoded aad;
+
+	macpdu_decode_access_assign(&aad, blk[b->type].type1, 0);
+}
+
+/* the blocks of a synthetic cell at every coding stage */
+static void make_input(void)
+{
+	struct tetra_gen tg;
+	struct tetra_resrc_decoded rsd;
+	struct tetra_si_decoded sid;
+	struct tetra_acc_ass_decoded aad;
+	enum tp_sap_data_type type;
+	unsigned int i;
+
+	tetra_gen_init(&tg, 1);
+	tetra_gen_burst(&tg, bursts);
+	tetra_gen_burst(&tg, bursts + TETRA_BITS_PER_TS);
+	scramb_init = tetra_scramb_get_init(tg.mcc, tg.mnc, tg.colour_code);
+
+	for (i = 0; i < sizeof(acelp); i++)
+		acelp[i] = rand() & 1;
+
+	for (type = TPSAP_T_SB1; type <= TPSAP_T_SCH_F; type++) {
+		const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+		uint8_t master[TETRA_BLK_MAX_BITS*4];
+		struct conv_enc_state ces;
+
+		for (i = 0; i < tbp->type1_bits; i++)
+			blk[type].type1[i] = rand() & 1;
+		tetra_blk_encode(type, blk[type].type1, scramb_init, blk[type].type5);
+		memcpy(blk[type].type4, blk[type].type5, tbp->type345_bits);
+		tetra_scramb_bits(scramb_init, blk[type].type4, tbp->type345_bits);
+		if (!tbp->interleave_a)
+			continue;
+
+		memcpy(blk[type].type2, blk[type].type1, tbp->type1_bits);
+		uint_to_bits(~crc16_ccitt_bits(blk[type].type2, tbp->type1_bits), 16,
+			     blk[type].type2 + tbp->type1_bits);
+		memset(blk[type].type2 + tbp->type1_bits + 16, 0,
+		       tbp->type2_bits - tbp->type1_bits - 16);
+		conv_enc_init(&ces);
+		conv_enc_input(&ces, blk[type].type2, tbp->type2_bits, master);
+		get_punctured_rate(TETRA_RCPC_PUNCT_2_3, master, tbp->type345_bits,
+				   blk[type].type3);
+		memset(blk[type].type3dp, 0xff, sizeof(blk[type].type3dp));
+		tetra_rcpc_depunct(TETRA_RCPC_PUNCT_2_3, blk[type].type3, tbp->type345_bits,
+				   blk[type].type3dp);
+		/* as viterbi_dec_sb1_wrapper() */
+		for (i = 0; i < tbp->type2_bits * 4; i++) {
+			uint8_t v = blk[type].type3dp[i];
+
+			blk[type].soft[i] = v == 0xff ? 0 : (v ? -127 : 127);
+		}
+	}
+
+	/* real PDUs for the parsers */
+	memset(&rsd, 0, sizeof(rsd));
+	rsd.addr.type = ADDR_TYPE_SSI;
+	rsd.addr.ssi = 4711;
+	rsd.macpdu_length = 20;
+	rsd.chan_alloc_pres = 1;
+	rsd.cad.type = TMAC_ALLOC_T_REPLACE;
+	rsd.cad.timeslot = 0x4;
+	rsd.cad.ul_dl = 3;
+	rsd.cad.carrier_nr = tg.main_carrier;
+	macpdu_encode_resource(&rsd, 1, blk[TPSAP_T_SCH_F].type1);
+
+	memset(&sid, 0, sizeof(sid));
+	sid.main_carrier = tg.main_carrier;
+	sid.freq_band = tg.freq_band;
+	sid.mle_si.la = tg.la;
+	sid.mle_si.bs_service_details = tg.bs_service_details;
+	macpdu_encode_sysinfo(&sid, blk[TPSAP_T_SB2].type1);
+
+	memset(&aad, 0, sizeof(aad));
+	aad.hdr = TETRA_ACC_ASS_DLCC_ULCO;
+	aad.access[0].base_frame_len = TETRA_ACC_BFL_4;
+	aad.access[1].base_frame_len = TETRA_ACC_BFL_4;
+	macpdu_encode_access_assign(&aad, blk[TPSAP_T_BBK].type1, 0);
+}
+
+static struct bench benches[MAX_BENCH];
+static unsigned int num_benches;
+
+static void add(const char *name, enum tp_sap_data_type type, const char *blk,
+		unsigned int bits, void (*run)(const struct bench *b))
+{
+	struct bench *b = &benches[num_benches++];
+
+	b->name = name;
+	b->type = type;
+	b->blk = blk ? blk : tetra_get_blk_param(type)->name;
+	b->bits = bits;
+	b->run = run;
+}
+
+static void add_benches(void)
+{
+	enum tp_sap_data_type type;
+
+	add("tetra_find_train_seq", 0, "burst", 2 * TETRA_BITS_PER_TS, run_find_train_seq);
+
+	for (type = TPSAP_T_SB1; type <= TPSAP_T_SCH_F; type++) {
+		const struct tetra_blk_param *tbp = tetra_get_blk_param(type);
+
+		add("tetra_scramb_bits", type, NULL, tbp->type345_bits, run_scramb);
+		if (!tbp->interleave_a) {
+			add("tetra_rm3014_compute", type, NULL, tbp->type1_bits, run_rm3014);
+			continue;
+		}
+		add("block_deinterleave", type, NULL, tbp->type345_bits, run_deinterleave);
+		add("tetra_kern.gather", type, NULL, tbp->type345_bits, run_gather);
+		add("tetra_rcpc_depunct", type, NULL, tbp->type345_bits, run_depunct);
+		add("conv_cch_decode", type, NULL, tbp->type2_bits, run_conv_cch_decode);
+		add("tetra_kern.viterbi_cch", type, NULL, tbp->type2_bits, run_viterbi_cch);
+		add("crc16_ccitt_bits", type, NULL, tbp->type1_bits + 16, run_crc16_ccitt_bits);
+		add("tetra_kern.crc16", type, NULL, tbp->type1_bits + 16, run_crc16);
+	}
+
+	add("tetra_acelp_type2_to_codec", 0, "TCH", 2 * TETRA_ACELP_FRAME_BITS, run_acelp);
+	add("macpdu_decode_resource", TPSAP_T_SCH_F, NULL, 268, run_decode_resource);
+	add("macpdu_decode_sysinfo", TPSAP_T_SB2, NULL, 124, run_decode_sysinfo);
+	add("macpdu_decode_access_assign", TPSAP_T_BBK, NULL, 14, run_decode_access_assign);
+}
+
+/* ns per call */
+static double run_rep(const struct bench *b, unsigned long iter)
+{
+	double t0 = now_ns();
+	unsigned long i;
+
+	for (i = 0; i < iter; i++)
+		b->run(b);
+	return (now_ns() - t0) / iter;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *) a, y = *(const double *) b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* nearest rank */
+static double percentile(const double *sorted, unsigned int n, unsigned int p)
+{
+	unsigned int rank = (p * n + 99) / 100;
+
+	return sorted[rank ? rank - 1 : 0];
+}
+
+static void print_help(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options]\n", prog);
+	fprintf(stderr, "  -r <num>   measured repetitions of each benchmark (default 25)\n");
+	fprintf(stderr, "  -w <num>   repetitions before, not measured (default 3)\n");
+	fprintf(stderr, "  -T <ms>    duration of a repetition (default 2)\n");
+	fprintf(stderr, "  -f <str>   only benchmarks whose name or block type contain <str>\n");
+	fprintf(stderr, "  -t         a text table instead of JSON\n");
+	fprintf(stderr, "The kernels are those of tetra_kernel_init(), the TETRA_KERNEL\n");
+	fprintf(stderr, "environment variable selects an ISA level, e.g. TETRA_KERNEL=scalar\n");
+}
+
+int main(int argc, char **argv)
+{
+	static double ns[1000];
+	unsigned int reps = 25, warmup = 3, i, r;
+	double target_ms = 2;
+	const char *filter = NULL;
+	int opt, text = 0;
+	enum tetra_kernel_isa isa;
+
+	while ((opt = getopt(argc, argv, "r:w:T:f:th")) != -1) {
+		switch (opt) {
+		case 'r':
+			reps = atoi(optarg);
+			break;
+		case 'w':
+			warmup = atoi(optarg);
+			break;
+		case 'T':
+			target_ms = atof(optarg);
+			break;
+		case 'f':
+			filter = optarg;
+			break;
+		case 't':
+			text = 1;
+			break;
+		default:
+			print_help(argv[0]);
+			exit(2);
+		}
+	}
+	if (reps < 1 || reps > ARRAY_SIZE(ns) || target_ms <= 0) {
+		print_help(argv[0]);
+		exit(2);
+	}
+
+	tetra_verbosity = TETRA_V_NONE;
+	srand(42);
+	isa = tetra_kernel_init();
+	tetra_rm3014_init();
+	make_input();
+	add_benches();
+
+	if (text)
+		printf("%-28s %-6s %5s %10s %10s %10s %8s %12s\n", "benchmark", "block", "bits",
+		       "p50 ns", "p90 ns", "p99 ns", "ns/bit", "blocks/s");
+	else
+		printf("{\"isa\":\"%s\",\"reps\":%u,\"warmup\":%u,\"rep_ms\":%g}\n",
+		       tetra_kernel_isa_name(isa), reps, warmup, target_ms);
+
+	for (i = 0; i < num_benches; i++) {
+		const struct bench *b = &benches[i];
+		unsigned long iter = 1;
+		double mean = 0, p50;
+
+		if (filter && !strstr(b->name, filter) && !strstr(b->blk, filter))
+			continue;
+
+		/* enough calls for a repetition to take target_ms */
+		while (iter < MAX_ITER && run_rep(b, iter) * iter < target_ms * 1e6)
+			iter *= 2;
+
+		for (r = 0; r < warmup; r++)
+			run_rep(b, iter);
+		for (r = 0; r < reps; r++) {
+			ns[r] = run_rep(b, iter);
+			mean += ns[r] / reps;
+		}
+		qsort(ns, reps, sizeof(*ns), cmp_double);
+		p50 = percentile(ns, reps, 50);
+
+		if (text) {
+			printf("%-28s %-6s %5u %10.1f %10.1f %10.1f %8.3f %12.0f\n", b->name,
+			       b->blk, b->bits, p50, percentile(ns, reps, 90),
+			       percentile(ns, reps, 99), p50 / b->bits, 1e9 / p50);
+			continue;
+		}
+		printf("{\"bench\":\"%s\",\"blk\":\"%s\",\"bits\":%u,\"iter\":%lu,"
+		       "\"ns_min\":%.2f,\"ns_p50\":%.2f,\"ns_p90\":%.2f,\"ns_p99\":%.2f,"
+		       "\"ns_max\":%.2f,\"ns_mean\":%.2f,\"ns_per_bit\":%.4f,\"blocks_per_s\":%.0f}\n",
+		       b->name, b->blk, b->bits, iter, ns[0], p50, percentile(ns, reps, 90),
+		       percentile(ns, reps, 99), ns[reps - 1], mean, p50 / b->bits, 1e9 / p50);
+		fflush(stdout);
+	}
+
+	exit(0);
+}
@@ -0,0 +1,278 @@
+/* Split a wideband capture into one baseband file per TETRA carrier */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Every carrier is written as complex float baseband at 36 kS/s, which
+ * is what "tetra-rx -i" reads.  The output files may be FIFOs created in
+ * advance, with one tetra-rx reading each of them.  Or, with -x, a
+ * decoder command is started for each carrier with SYNC found by the
+ * pre-scan, and fed through a pipe until the carrier goes quiet. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <complex.h>
+
+#include <osmocom/core/talloc.h>
+
+#include "tetra_kernel.h"
+#include <phy/tetra_chan.h>
+#include <phy/tetra_prescan.h>
+#include <phy/tetra_iq.h>
+
+void *tetra_tall_ctx;
+
+static struct tetra_prescan *prescan;
+static const char *decoder_cmd;
+
+static int64_t out_freq[TETRA_CHAN_MAX];
+static int out_fd[TETRA_CHAN_MAX];
+static FILE *out_pipe[TETRA_CHAN_MAX];
+
+static void print_help(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options] <file_with_iq> [carrier Hz]...\n", prog);
+	fprintf(stderr, "  -F <fmt>    cu8, cs8, cs16 or cf32 input samples (default cf32)\n");
+	fprintf(stderr, "  -D          remove the DC offset of the input\n");
+	fprintf(stderr, "  -n <num>    number of channels, the input is at <num> * 12.5 kS/s\n"
+			"              (default 128, i.e. 1.6 MS/s)\n");
+	fprintf(stderr, "  -f <Hz>     centre frequency of the input, the carriers are then\n"
+			"              absolute frequencies instead of offsets from it\n");
+	fprintf(stderr, "  -a          all carriers on the 25 kHz raster\n");
+	fprintf(stderr, "  -o <prefix> write each carrier to <prefix><Hz>.cf32 (default \"chan-\")\n");
+	fprintf(stderr, "  -P          pre-scan: only pass on carriers with SYNC, while they last\n");
+	fprintf(stderr, "  -t <dB>     pre-scan threshold over the noise floor (default %u)\n",
+		TETRA_PRESCAN_THRESH_DB);
+	fprintf(stderr, "  -x <cmd>    with -P: run <cmd> for each carrier found and feed it\n"
+			"              the samples on stdin, with $TETRA_CARRIER set to the\n"
+			"              carrier, e.g. 'tetra-rx -i -w $TETRA_CARRIER.pcapng /dev/stdin'\n");
+}
+
+static void chan_cb(unsigned int idx, const float complex *samples,
+		    unsigned int n, void *priv)
+{
+	if (prescan && !tetra_prescan_in(prescan, idx, samples, n))
+		return;
+	if (out_fd[idx] < 0)
+		return;
+
+	if (write(out_fd[idx], samples, n * sizeof(*samples)) < 0) {
+		if (errno != EPIPE) {
+			perror("write");
+			exit(1);
+		}
+		fprintf(stderr, "%lld Hz: decoder has gone\n", (long long) out_freq[idx]);
+		out_fd[idx] = -1;
+	}
+}
+
+static void decoder_start(unsigned int idx, void *priv)
+{
+	char env[32];
+
+	fprintf(stderr, "%lld Hz: SYNC found\n", (long long) out_freq[idx]);
+	if (!decoder_cmd)
+		return;
+
+	snprintf(env, sizeof(env), "%lld", (long long) out_freq[idx]);
+	setenv("TETRA_CARRIER", env, 1);
+	out_pipe[idx] = popen(decoder_cmd, "w");
+	if (!out_pipe[idx]) {
+		perror("popen");
+		return;
+	}
+	out_fd[idx] = fileno(out_pipe[idx]);
+}
+
+static void decoder_stop(unsigned int idx, void *priv)
+{
+	fprintf(stderr, "%lld Hz: gone quiet\n", (long long) out_freq[idx]);
+	if (!out_pipe[idx])
+		return;
+
+	pclose(out_pipe[idx]);
+	out_pipe[idx] = NULL;
+	out_fd[idx] = -1;
+}
+
+static int add_carrier(struct tetra_chan *ch, const char *prefix, int64_t centre,
+		       int64_t freq)
+{
+	char path[256];
+	int idx;
+
+	idx = tetra_chan_add(ch, freq - centre);
+	if (idx < 0)
+		return idx;
+	out_freq[idx] = freq;
+	out_fd[idx] = -1;
+	if (decoder_cmd) {
+		fprintf(stderr, "%lld Hz: channel %u\n", (long long) freq, ch->out[idx].bin);
+		return idx;
+	}
+
+	snprintf(path, sizeof(path), "%s%lld.cf32", prefix, (long long) freq);
+	out_fd[idx] = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+	if (out_fd[idx] < 0) {
+		perror(path);
+		exit(1);
+	}
+	fprintf(stderr, "%lld Hz: channel %u, to %s\n", (long long) freq,
+		ch->out[idx].bin, path);
+
+	return idx;
+}
+
+int main(int argc, char **argv)
+{
+	const char *prefix = "chan-";
+	unsigned int num_chan = 128;
+	int64_t centre = 0;
+	int all = 0, use_prescan = 0, opt, i;
+	int iq_fmt = TETRA_IQ_CF32, dc_block = 0;
+	float thresh_db = TETRA_PRESCAN_THRESH_DB;
+	struct tetra_chan *ch;
+	struct tetra_iq *iq;
+
+	while ((opt = getopt(argc, argv, "F:Dn:f:ao:Pt:x:h")) != -1) {
+		switch (opt) {
+		case 'F':
+			iq_fmt = tetra_iq_fmt_parse(optarg);
+			if (iq_fmt < 0) {
+				fprintf(stderr, "unknown sample format %s\n", optarg);
+				exit(1);
+			}
+			break;
+		case 'D':
+			dc_block = 1;
+			break;
+		case 'n':
+			num_chan = atoi(optarg);
+			break;
+		case 'f':
+			centre = strtoll(optarg, NULL, 10);
+			break;
+		case 'a':
+			all = 1;
+			break;
+		case 'o':
+			prefix = optarg;
+			break;
+		case 'P':
+			use_prescan = 1;
+			break;
+		case 't':
+			thresh_db = atof(optarg);
+			break;
+		case 'x':
+			decoder_cmd = optarg;
+			break;
+		default:
+			print_help(argv[0]);
+			exit(1);
+		}
+	}
+
+	if (argc <= optind || (argc == optind + 1 && !all) || (decoder_cmd && !use_prescan)) {
+		print_help(argv[0]);
+		exit(1);
+	}
+
+	tetra_kernel_init();
+
+	ch = tetra_chan_alloc(tetra_tall_ctx, num_chan, chan_cb, NULL);
+	if (!ch) {
+		fprintf(stderr, "number of channels must be a power of two "
+			"between 8 and %u\n", TETRA_CHAN_MAX);
+		exit(1);
+	}
+
+	for (i = optind + 1; i < argc; i++) {
+		int64_t freq = strtoll(argv[i], NULL, 10);
+
+		if (add_carrier(ch, prefix, centre, freq) < 0) {
+			fprintf(stderr, "%s Hz is outside the %u Hz wide input\n",
+				argv[i], ch->rate);
+			exit(1);
+		}
+	}
+	if (all) {
+		/* multiples of 25 kHz, as far as they fit */
+		int64_t f0 = (centre + TETRA_CHAN_SPACING) / (2 * TETRA_CHAN_SPACING) *
+			(2 * TETRA_CHAN_SPACING);
+		int64_t f;
+
+		for (f = f0 - ch->rate / 2; f <= f0 + ch->rate / 2; f += 2 * TETRA_CHAN_SPACING)
+			add_carrier(ch, prefix, centre, f);
+	}
+
+	if (use_prescan) {
+		prescan = tetra_prescan_alloc(tetra_tall_ctx, ch, decoder_start,
+					      decoder_stop, NULL);
+		if (!prescan)
+			exit(1);
+		prescan->thresh_db = thresh_db;
+		/* a decoder gone away must not kill us */
+		signal(SIGPIPE, SIG_IGN);
+	}
+
+	iq = tetra_iq_open(tetra_tall_ctx, argv[optind], iq_fmt, dc_block);
+	if (!iq) {
+		perror("open");
+		exit(2);
+	}
+
+	while (1) {
+		const float complex *in;
+		int len;
+
+		len = tetra_iq_read(iq, &in);
+		if (len < 0) {
+			errno = -len;
+			perror("read");
+			exit(1);
+		} else if (len == 0)
+			break;
+
+		tetra_chan_in(ch, in, len);
+		if (prescan)
+			tetra_prescan_update(prescan);
+	}
+	tetra_iq_close(iq);
+
+	fprintf(stderr, "channelizer: %llu samples, %llu FFTs, %llu samples out "
+		"on %u carriers\n", (unsigned long long) ch->stats.samples,
+		(unsigned long long) ch->stats.ffts, (unsigned long long) ch->stats.out,
+		ch->num_out);
+	if (prescan)
+		fprintf(stderr, "pre-scan: %u probes, %u found SYNC, %u went quiet\n",
+			prescan->stats.probes, prescan->stats.syncs, prescan->stats.stops);
+
+	for (i = 0; i < ch->num_out; i++) {
+		if (out_pipe[i])
+			pclose(out_pipe[i]);
+	}
+
+	exit(0);
+}
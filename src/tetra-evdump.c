@@ -0,0 +1,287 @@
+/* Render a binary tetra-rx event stream as text or JSON */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <osmocom/core/utils.h>
+
+#include "tetra_common.h"
+#include "tetra_event.h"
+#include "tetra_mle_pdu.h"
+#include "tetra_mm_pdu.h"
+#include "tetra_cmce_pdu.h"
+#include "tetra_sndcp_pdu.h"
+#include <phy/tetra_burst.h>
+#include <lower_mac/tetra_lower_mac.h>
+
+void *tetra_tall_ctx;
+
+static int json;
+static unsigned int ev_version;
+
+static const char *train_seq_name(uint8_t ts)
+{
+	static const char *names[] = { "NORM_1", "NORM_2", "NORM_3", "SYNC", "EXT" };
+
+	if (ts < ARRAY_SIZE(names))
+		return names[ts];
+	return "NONE";
+}
+
+static const char *tl_sdu_type_name(uint8_t pdisc, uint32_t pdu_type)
+{
+	switch (pdisc) {
+	case TMLE_PDISC_MM:
+		return tetra_get_mm_pdut_name(pdu_type, 0);
+	case TMLE_PDISC_CMCE:
+		return tetra_get_cmce_pdut_name(pdu_type, 0);
+	case TMLE_PDISC_SNDCP:
+		return tetra_get_sndcp_pdut_name(pdu_type, 0);
+	case TMLE_PDISC_MLE:
+		return tetra_get_mle_pdut_name(pdu_type, 0);
+	default:
+		return "";
+	}
+}
+
+/* the TDMA time of a record, see tetra_event_set_time() */
+static const char *ts_dump(uint32_t ts)
+{
+	static char buf[TETRA_TDMA_DUMP_LEN];
+
+	return tetra_tdma_slot_dump(tetra_event_ts2slot(ev_version, ts), buf);
+}
+
+static void print_hex(const uint8_t *data, unsigned int num_bits)
+{
+	unsigned int i;
+
+	for (i = 0; i < (num_bits + 7) / 8; i++)
+		printf("%02x", data[i]);
+}
+
+static void render_burst(const struct tetra_ev_hdr *eh, const struct tetra_ev_burst *ev)
+{
+	if (json)
+		printf("\"train_seq\":\"%s\",\"locked\":%u,\"offset\":%u",
+			train_seq_name(ev->train_seq), ev->locked, ev->offset);
+	else
+		printf("%s%s at bit %u", ev->locked ? "" : "found ",
+			train_seq_name(ev->train_seq), ev->offset);
+}
+
+static void render_block(const struct tetra_ev_hdr *eh, const struct tetra_ev_block *ev)
+{
+	const struct tetra_blk_param *tbp = tetra_get_blk_param(ev->blk_type);
+	const char *name = tbp ? tbp->name : "?";
+
+	if (json) {
+		printf("\"blk\":\"%s\",\"lchan\":\"%s\",\"crc_ok\":%u,\"crc\":%u,"
+			"\"num_bits\":%u,\"bits\":\"", name,
+			tetra_get_lchan_name(ev->lchan), ev->crc_ok, ev->crc,
+			ev->num_bits);
+		print_hex((const uint8_t *) (ev + 1), ev->num_bits);
+		printf("\"");
+	} else {
+		printf("%s %s CRC=%u(0x%04x) ", name, tetra_get_lchan_name(ev->lchan),
+			ev->crc_ok, ev->crc);
+		print_hex((const uint8_t *) (ev + 1), ev->num_bits);
+	}
+}
+
+static void render_sync(const struct tetra_ev_hdr *eh, const struct tetra_ev_sync *ev)
+{
+	if (json)
+		printf("\"mcc\":%u,\"mnc\":%u,\"cc\":%u,\"tn\":%u,\"fn\":%u,\"mn\":%u",
+			ev->mcc, ev->mnc, ev->colour_code, ev->tn, ev->fn, ev->mn);
+	else
+		printf("CC 0x%02x TN %u FN %2u MN %2u MCC %u MNC %u",
+			ev->colour_code, ev->tn, ev->fn, ev->mn, ev->mcc, ev->mnc);
+}
+
+static void render_sysinfo(const struct tetra_ev_hdr *eh, const struct tetra_ev_sysinfo *ev)
+{
+	int i;
+
+	if (json) {
+		printf("\"dl_freq\":%u,\"ul_freq\":%u,\"service_details\":%u,\"%s\":%u",
+			ev->dl_freq, ev->ul_freq, ev->service_details,
+			ev->cck_valid ? "cck_id" : "hyperframe", ev->hf_or_cck);
+		return;
+	}
+
+	printf("DL %u Hz, UL %u Hz, service_details 0x%04x %s %u",
+		ev->dl_freq, ev->ul_freq, ev->service_details,
+		ev->cck_valid ? "CCK ID" : "Hyperframe", ev->hf_or_cck);
+	for (i = 0; i < 12; i++) {
+		if (ev->service_details & (1 << i))
+			printf(" [%s]", tetra_get_bs_serv_det_name(1 << i));
+	}
+}
+
+static void render_pdu(const struct tetra_ev_hdr *eh, const struct tetra_ev_pdu *ev)
+{
+	const char *type_name = "";
+
+	switch (ev->proto) {
+	case TETRA_EV_P_LLC:
+		type_name = tetra_get_llc_pdut_dec_name(ev->pdu_type);
+		break;
+	case TETRA_EV_P_TL_SDU:
+		type_name = tl_sdu_type_name(ev->pdu_type, ev->aux);
+		break;
+	}
+
+	if (json) {
+		printf("\"proto\":\"%s\",\"pdu_type\":%u,\"addr\":%u,\"aux\":%u",
+			tetra_get_ev_proto_name(ev->proto), ev->pdu_type,
+			ev->addr, ev->aux);
+		if (ev->proto == TETRA_EV_P_TL_SDU)
+			printf(",\"pdisc\":\"%s\",\"name\":\"%s\"",
+				tetra_get_mle_pdisc_name(ev->pdu_type), type_name);
+		else if (ev->proto == TETRA_EV_P_LLC)
+			printf(",\"name\":\"%s\"", type_name);
+		printf(",\"num_bits\":%u,\"bits\":\"", ev->num_bits);
+		print_hex((const uint8_t *) (ev + 1), ev->num_bits);
+		printf("\"");
+		return;
+	}
+
+	printf("%s ", tetra_get_ev_proto_name(ev->proto));
+	switch (ev->proto) {
+	case TETRA_EV_P_MAC_RESOURCE:
+		printf("Encr=%u, Length=%u Addr=%u", ev->pdu_type, ev->aux, ev->addr);
+		break;
+	case TETRA_EV_P_MAC_FRAG:
+		printf("%s", ev->aux ? "END" : "FRAG");
+		break;
+	case TETRA_EV_P_LLC:
+		printf("(%s,%u,%u) Addr=%u ", type_name, ev->aux >> 8, ev->aux & 0xff,
+			ev->addr);
+		print_hex((const uint8_t *) (ev + 1), ev->num_bits);
+		break;
+	case TETRA_EV_P_TL_SDU:
+		printf("(%s) %s Addr=%u ", tetra_get_mle_pdisc_name(ev->pdu_type),
+			type_name, ev->addr);
+		print_hex((const uint8_t *) (ev + 1), ev->num_bits);
+		break;
+	}
+}
+
+static void render_defrag(const struct tetra_ev_hdr *eh, const struct tetra_ev_defrag *ev)
+{
+	if (json)
+		printf("\"kind\":\"%s\",\"addr\":%u,\"ns\":%u,\"ss\":%u",
+			tetra_get_ev_defrag_name(ev->kind), ev->addr, ev->ns, ev->ss);
+	else
+		printf("%s Addr=%u N(S)=%u S(S)=%u",
+			tetra_get_ev_defrag_name(ev->kind), ev->addr, ev->ns, ev->ss);
+}
+
+static void render(const struct tetra_ev_hdr *eh, const uint8_t *payload)
+{
+	if (!tetra_event_valid(eh, payload))
+		return;
+
+	if (json)
+		printf("{\"ts\":%u,\"time\":\"%s\",\"type\":\"%s\",", eh->ts,
+			ts_dump(eh->ts), tetra_get_ev_type_name(eh->type));
+	else
+		printf("%10u %s %-7s ", eh->ts, ts_dump(eh->ts),
+			tetra_get_ev_type_name(eh->type));
+
+	switch (eh->type) {
+	case TETRA_EV_BURST:
+		render_burst(eh, (const void *) payload);
+		break;
+	case TETRA_EV_BLOCK:
+		render_block(eh, (const void *) payload);
+		break;
+	case TETRA_EV_SYNC:
+		render_sync(eh, (const void *) payload);
+		break;
+	case TETRA_EV_SYSINFO:
+		render_sysinfo(eh, (const void *) payload);
+		break;
+	case TETRA_EV_PDU:
+		render_pdu(eh, (const void *) payload);
+		break;
+	case TETRA_EV_DEFRAG:
+		render_defrag(eh, (const void *) payload);
+		break;
+	}
+
+	printf(json ? "}\n" : "\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct tetra_ev_file_hdr fh;
+	struct tetra_ev_hdr eh;
+	uint8_t payload[65536];
+	FILE *f;
+	int opt, rc;
+
+	while ((opt = getopt(argc, argv, "jh")) != -1) {
+		switch (opt) {
+		case 'j':
+			json = 1;
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-j] <event_file>\n", argv[0]);
+			exit(1);
+		}
+	}
+
+	if (argc <= optind) {
+		fprintf(stderr, "Usage: %s [-j] <event_file>\n", argv[0]);
+		exit(1);
+	}
+
+	f = fopen(argv[optind], "rb");
+	if (!f) {
+		perror("open");
+		exit(2);
+	}
+
+	rc = tetra_event_read_hdr(f, &fh);
+	if (rc == -EINVAL) {
+		fprintf(stderr, "%s: not a TETRA event file\n", argv[optind]);
+		exit(1);
+	}
+	if (rc < 0) {
+		fprintf(stderr, "%s: unsupported version %u\n", argv[optind], fh.version);
+		exit(1);
+	}
+	ev_version = fh.version;
+
+	while ((rc = tetra_event_read(f, &fh, &eh, payload)) > 0)
+		render(&eh, payload);
+	if (rc < 0)
+		fprintf(stderr, "truncated record\n");
+
+	fclose(f);
+	exit(0);
+}
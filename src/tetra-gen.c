@@ -0,0 +1,189 @@
+/* Generate the downlink of a synthetic TETRA cell */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "tetra_common.h"
+#include "tetra_kernel.h"
+#include <phy/tetra_demod.h>
+#include <phy/tetra_gen.h>
+
+void *tetra_tall_ctx;
+
+/* bursts generated per write() */
+#define GEN_BLK		64
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+
+	while (len) {
+		ssize_t rc = write(fd, p, len);
+
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		p += rc;
+		len -= rc;
+	}
+	return 0;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void print_help(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options] [<outfile>]\n", prog);
+	fprintf(stderr, "  -m <mcc>   MCC of the cell (default %u)\n", TETRA_GEN_MCC);
+	fprintf(stderr, "  -n <mnc>   MNC of the cell (default %u)\n", TETRA_GEN_MNC);
+	fprintf(stderr, "  -c <cc>    colour code of the cell (default %u)\n", TETRA_GEN_CC);
+	fprintf(stderr, "  -l <la>    location area of the cell (default %u)\n", TETRA_GEN_LA);
+	fprintf(stderr, "  -d <sec>   seconds of downlink to generate (default 3600)\n");
+	fprintf(stderr, "  -L <load>  fraction of MCCH slots with a CMCE PDU (default %.2f)\n",
+		TETRA_GEN_LOAD);
+	fprintf(stderr, "  -e <ber>   bit error rate (default 0)\n");
+	fprintf(stderr, "  -r <seed>  seed of the payloads and bit errors\n");
+	fprintf(stderr, "  -y         write float symbols as for tetra-rx -y, not bits\n");
+	fprintf(stderr, "outfile defaults to stdout, \"-\" is stdout too\n");
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t bits[GEN_BLK * TETRA_BITS_PER_TS];
+	static float sym[GEN_BLK * TETRA_SYM_PER_TS];
+	struct tetra_gen tg;
+	double seconds = 3600, ber = 0, load = TETRA_GEN_LOAD, t0, t;
+	unsigned long long seed = 1;
+	uint64_t num, i;
+	int fd = 1, opt, opt_sym = 0;
+	unsigned int mcc = TETRA_GEN_MCC, mnc = TETRA_GEN_MNC;
+	unsigned int cc = TETRA_GEN_CC, la = TETRA_GEN_LA;
+
+	while ((opt = getopt(argc, argv, "m:n:c:l:d:L:e:r:yh")) != -1) {
+		switch (opt) {
+		case 'm':
+			mcc = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			mnc = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			cc = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			la = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			seconds = atof(optarg);
+			break;
+		case 'L':
+			load = atof(optarg);
+			break;
+		case 'e':
+			ber = atof(optarg);
+			break;
+		case 'r':
+			seed = strtoull(optarg, NULL, 0);
+			break;
+		case 'y':
+			opt_sym = 1;
+			break;
+		default:
+			print_help(argv[0]);
+			exit(2);
+		}
+	}
+
+	if (mcc > 0x3ff || mnc > 0x3fff || cc > 0x3f || la > 0x3fff ||
+	    seconds < 0 || load < 0 || load > 1 || ber < 0 || ber > 1) {
+		print_help(argv[0]);
+		exit(2);
+	}
+
+	if (argc > optind && strcmp(argv[optind], "-")) {
+		fd = creat(argv[optind], 0660);
+		if (fd < 0) {
+			perror("open outfile");
+			exit(1);
+		}
+	}
+
+	/* nothing on stdout but the output */
+	tetra_verbosity = TETRA_V_NONE;
+	tetra_kernel_init();
+	tetra_gen_init(&tg, seed);
+	tg.mcc = mcc;
+	tg.mnc = mnc;
+	tg.colour_code = cc;
+	tg.la = la;
+	tg.load = load;
+	tg.ber = ber;
+
+	num = seconds * TETRA_SYM_RATE / TETRA_SYM_PER_TS;
+	t0 = now();
+
+	for (i = 0; i < num; ) {
+		unsigned int n = num - i < GEN_BLK ? num - i : GEN_BLK;
+		unsigned int j;
+		int rc;
+
+		for (j = 0; j < n; j++)
+			tetra_gen_burst(&tg, bits + j * TETRA_BITS_PER_TS);
+
+		if (opt_sym) {
+			tetra_gen_symbols(bits, n * TETRA_SYM_PER_TS, sym);
+			rc = write_all(fd, sym, n * TETRA_SYM_PER_TS * sizeof(*sym));
+		} else
+			rc = write_all(fd, bits, n * TETRA_BITS_PER_TS);
+		if (rc < 0) {
+			errno = -rc;
+			perror("write");
+			exit(1);
+		}
+		i += n;
+	}
+
+	t = now() - t0;
+	seconds = (double) num * TETRA_SYM_PER_TS / TETRA_SYM_RATE;
+	fprintf(stderr, "%llu bursts (%.1f s of downlink) in %.2f s, %.0fx real time\n",
+		(unsigned long long) tg.stats.bursts, seconds, t, t > 0 ? seconds / t : 0);
+	fprintf(stderr, "%llu sync, %llu CMCE, %llu null bursts, %llu bit errors\n",
+		(unsigned long long) tg.stats.sync, (unsigned long long) tg.stats.cmce,
+		(unsigned long long) tg.stats.null, (unsigned long long) tg.stats.bit_errors);
+
+	exit(0);
+}
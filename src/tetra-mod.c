@@ -0,0 +1,192 @@
+/* Modulate unpacked bits into IQ samples, through a simulated channel */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <complex.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "tetra_common.h"
+#include "tetra_kernel.h"
+#include <phy/tetra_mod.h>
+#include <phy/tetra_chsim.h>
+#include <phy/tetra_iq.h>
+
+void *tetra_tall_ctx;
+
+/* symbols read at a time */
+#define SYM_BLK		4096
+#define SAMPLE_BLK	(SYM_BLK * TETRA_MOD_SPS)
+
+/* default scale of the samples, full scale is 1.0 and the signal has
+ * unit mean power */
+#define DEFAULT_GAIN	0.25f
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+
+	while (len) {
+		ssize_t rc = write(fd, p, len);
+
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		p += rc;
+		len -= rc;
+	}
+	return 0;
+}
+
+static void print_help(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options] [<infile> [<outfile>]]\n", prog);
+	fprintf(stderr, "Modulates a file with one bit per byte, e.g. from tetra-gen, into\n");
+	fprintf(stderr, "complex baseband at 36 kS/s, the input of tetra-rx -i\n");
+	fprintf(stderr, "  -F <fmt>   cu8, cs8, cs16 or cf32 samples (default cf32)\n");
+	fprintf(stderr, "  -g <gain>  scale of the samples, full scale is 1.0 (default %.2f)\n",
+		DEFAULT_GAIN);
+	fprintf(stderr, "  -s <dB>    add white noise, signal to noise ratio per sample\n");
+	fprintf(stderr, "  -f <Hz>    frequency offset\n");
+	fprintf(stderr, "  -p <ppm>   sample clock error, the symbol timing drifts\n");
+	fprintf(stderr, "  -D <Hz>    Rayleigh fading with this maximum Doppler shift\n");
+	fprintf(stderr, "  -r <seed>  seed of the noise and the fading\n");
+	fprintf(stderr, "infile and outfile default to stdin and stdout, \"-\" is either\n");
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t bits[2*SYM_BLK];
+	static float complex mod[SAMPLE_BLK];
+	static float complex out[TETRA_CHSIM_MAX_OUT(SAMPLE_BLK)];
+	static float complex raw[TETRA_CHSIM_MAX_OUT(SAMPLE_BLK)];
+	struct tetra_mod tm;
+	struct tetra_chsim cs;
+	int fd = 0, fd_out = 1, opt, fmt = TETRA_IQ_CF32;
+	float gain = DEFAULT_GAIN, snr_db = INFINITY, freq_hz = 0, ppm = 0, doppler_hz = 0;
+	unsigned long long seed = 1;
+
+	while ((opt = getopt(argc, argv, "F:g:s:f:p:D:r:h")) != -1) {
+		switch (opt) {
+		case 'F':
+			fmt = tetra_iq_fmt_parse(optarg);
+			if (fmt < 0) {
+				fprintf(stderr, "unknown sample format %s\n", optarg);
+				exit(2);
+			}
+			break;
+		case 'g':
+			gain = atof(optarg);
+			break;
+		case 's':
+			snr_db = atof(optarg);
+			break;
+		case 'f':
+			freq_hz = atof(optarg);
+			break;
+		case 'p':
+			ppm = atof(optarg);
+			break;
+		case 'D':
+			doppler_hz = atof(optarg);
+			break;
+		case 'r':
+			seed = strtoull(optarg, NULL, 0);
+			break;
+		default:
+			print_help(argv[0]);
+			exit(2);
+		}
+	}
+
+	if (fabsf(ppm) > TETRA_CHSIM_MAX_PPM) {
+		fprintf(stderr, "clock error beyond %.0f ppm\n", TETRA_CHSIM_MAX_PPM);
+		exit(2);
+	}
+
+	if (argc > optind && strcmp(argv[optind], "-")) {
+		fd = open(argv[optind], O_RDONLY);
+		if (fd < 0) {
+			perror("open infile");
+			exit(1);
+		}
+	}
+	if (argc > optind + 1 && strcmp(argv[optind+1], "-")) {
+		fd_out = creat(argv[optind+1], 0660);
+		if (fd_out < 0) {
+			perror("open outfile");
+			exit(1);
+		}
+	}
+
+	tetra_kernel_init();
+	tetra_mod_init(&tm);
+	tetra_chsim_init(&cs, TETRA_DEMOD_RATE, seed);
+	cs.snr_db = snr_db;
+	cs.freq_hz = freq_hz;
+	cs.ppm = ppm;
+	cs.doppler_hz = doppler_hz;
+	tetra_chsim_update(&cs);
+
+	while (1) {
+		unsigned int i, num;
+		int len, rc;
+
+		/* a lone bit at the end is dropped */
+		len = tetra_read_full(fd, bits, sizeof(bits));
+		if (len < 0) {
+			errno = -len;
+			perror("read");
+			exit(1);
+		}
+		if (len < 2)
+			break;
+
+		tetra_mod_bits(&tm, bits, len / 2, mod);
+		num = tetra_chsim_run(&cs, mod, len / 2 * TETRA_MOD_SPS, out);
+		for (i = 0; i < num; i++)
+			out[i] *= gain;
+		tetra_iq_pack(fmt, out, num, raw);
+
+		rc = write_all(fd_out, raw, num * tetra_iq_sample_size(fmt));
+		if (rc < 0) {
+			errno = -rc;
+			perror("write");
+			exit(1);
+		}
+		if (len < sizeof(bits))
+			break;
+	}
+
+	fprintf(stderr, "%llu symbols, %llu samples\n", (unsigned long long) tm.symbols,
+		(unsigned long long) cs.stats.samples_out);
+
+	exit(0);
+}
@@ -22,6 +22,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <time.h>
 
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -32,36 +34,278 @@
 #include "tetra_common.h"
 #include <phy/tetra_burst.h>
 #include <phy/tetra_burst_sync.h>
+#include <phy/tetra_demod.h>
+#include <phy/tetra_iq.h>
 #include "tetra_gsmtap.h"
+#include "tetra_kernel.h"
+#include "tetra_egress.h"
+#include "tetra_event.h"
+#include "tetra_filter.h"
+#include "tetra_shm.h"
+#include <lower_mac/tetra_scramb_cache.h>
+#include <lower_mac/tetra_scramb_search.h>
 
 void *tetra_tall_ctx;
 
+/* symbols read at a time with -y */
+#define SYM_BLK		4096
+/* symbols passed to the burst synchronizer at a time, it handles at
+ * most one burst per call */
+#define SYM_CHUNK	64
+
+/* slice symbols and feed the bits into the burst synchronizer, with
+ * their soft values for the Viterbi decoder if 'soft' */
+static void sync_sym(struct tetra_rx_state *trs, const float *sym, unsigned int n, int soft)
+{
+	uint8_t bits[2*SYM_CHUNK];
+	int8_t soft_bits[2*SYM_CHUNK];
+	unsigned int i, num;
+
+	for (i = 0; i < n; i += num) {
+		num = n - i > SYM_CHUNK ? SYM_CHUNK : n - i;
+		tetra_kern.slice(sym + i, num, bits);
+		if (soft) {
+			tetra_kern.slice_soft(sym + i, num, soft_bits);
+			tetra_burst_sync_in_soft(trs, bits, soft_bits, 2*num);
+		} else
+			tetra_burst_sync_in(trs, bits, 2*num);
+	}
+}
+
+static void print_help(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options] <file_with_1_byte_per_bit>\n", prog);
+	fprintf(stderr, "  -i         the input is complex baseband at 36 kS/s, demodulate it\n");
+	fprintf(stderr, "  -F <fmt>   with -i: cu8, cs8, cs16 or cf32 samples (default cf32)\n");
+	fprintf(stderr, "  -D         with -i: remove the DC offset of the input\n");
+	fprintf(stderr, "  -y         the input is float symbols from the demodulator, slice them\n");
+	fprintf(stderr, "  -Y         with -i or -y: soft decisions for the Viterbi decoder\n");
+	fprintf(stderr, "  -t <dev>   write SNDCP IP packets to tun device <dev>\n");
+	fprintf(stderr, "  -q <num>   number of tun queues (one per NSAPI)\n");
+	fprintf(stderr, "  -p <file>  write SNDCP IP packets to pcap file <file>\n");
+	fprintf(stderr, "  -w <file>  write GSMTAP to pcapng file <file> instead of UDP\n");
+	fprintf(stderr, "  -W <MiB>   start a new pcapng file every <MiB> MiB\n");
+	fprintf(stderr, "  -e <file>  write binary decoder events to <file>\n");
+	fprintf(stderr, "  -S <name>  publish MAC blocks to shared memory ring <name>, e.g. /tetra\n");
+	fprintf(stderr, "  -k <file>  cache of known cells, for a quick start before the first SYNC\n");
+	fprintf(stderr, "  -f <Hz>    frequency of the carrier, selects its cells in the cache\n");
+	fprintf(stderr, "  -T <time>  UNIX time of the first input bit, for the pcapng timestamps\n"
+			"             and the cache, the time of starting for a pipe or FIFO\n");
+	fprintf(stderr, "  -B         search the scrambling code if there is no SYNC\n");
+	fprintf(stderr, "  -C <mcc>[,<mnc>] only search the codes of this MCC (and MNC)\n");
+	fprintf(stderr, "  -L <file>  only search the \"mcc mnc\" pairs listed in <file>\n");
+	fprintf(stderr, "  -v <level> text output: 0 none, 1 PDUs, 2 blocks, 3 bit dumps (default)\n");
+	fprintf(stderr, "filter, each option takes a comma separated list:\n");
+	fprintf(stderr, "  -s <ssi>   SSIs or SSI ranges, e.g. 1000-1999,2342\n");
+	fprintf(stderr, "  -a <type>  MAC address types\n");
+	fprintf(stderr, "  -d <pdisc> MLE protocol discriminators, e.g. CMCE,SNDCP\n");
+	fprintf(stderr, "  -c <type>  CMCE PDU types\n");
+	fprintf(stderr, "  -m <type>  MM PDU types\n");
+}
+
 int main(int argc, char **argv)
 {
-	int fd;
+	int fd, opt;
 	struct tetra_rx_state *trs;
+	struct tetra_demod *demod = NULL;
+	struct tetra_iq *iq = NULL;
+	int iq_fmt = TETRA_IQ_CF32, dc_block = 0;
+	int symbols = 0, soft = 0;
 	struct tetra_mac_state *tms;
+	const char *tun_dev = NULL, *pcap_file = NULL, *gsmtap_file = NULL;
+	const char *event_file = NULL, *shm_name = NULL, *cache_file = NULL;
+	uint32_t carrier = 0;
+	struct tetra_scramb_cache scache;
+	struct tetra_scramb_search *ssearch = NULL;
+	unsigned int tun_queues = 1;
+	uint64_t gsmtap_rotate = 0;
+	struct tetra_filter filter;
+	struct stat st;
 
-	if (argc < 2) {
-		fprintf(stderr, "Usage: %s <file_with_1_byte_per_bit>\n", argv[0]);
+	memset(&filter, 0, sizeof(filter));
+
+	while ((opt = getopt(argc, argv, "iF:DyYt:q:p:w:W:e:S:k:f:T:BC:L:v:s:a:d:c:m:h")) != -1) {
+		switch (opt) {
+		case 'i':
+			demod = talloc_zero(tetra_tall_ctx, struct tetra_demod);
+			tetra_demod_init(demod);
+			break;
+		case 'F':
+			iq_fmt = tetra_iq_fmt_parse(optarg);
+			if (iq_fmt < 0) {
+				fprintf(stderr, "unknown sample format %s\n", optarg);
+				exit(1);
+			}
+			break;
+		case 'D':
+			dc_block = 1;
+			break;
+		case 'y':
+			symbols = 1;
+			break;
+		case 'Y':
+			soft = 1;
+			break;
+		case 't':
+			tun_dev = optarg;
+			break;
+		case 'q':
+			tun_queues = atoi(optarg);
+			break;
+		case 'p':
+			pcap_file = optarg;
+			break;
+		case 'w':
+			gsmtap_file = optarg;
+			break;
+		case 'W':
+			gsmtap_rotate = strtoull(optarg, NULL, 10) << 20;
+			break;
+		case 'e':
+			event_file = optarg;
+			break;
+		case 'S':
+			shm_name = optarg;
+			break;
+		case 'k':
+			cache_file = optarg;
+			break;
+		case 'f':
+			carrier = strtoul(optarg, NULL, 10);
+			break;
+		case 'T':
+			t_phy_state.start_ns = strtod(optarg, NULL) * 1e9;
+			break;
+		case 'B':
+		case 'C':
+		case 'L':
+			if (!ssearch) {
+				ssearch = talloc_zero(tetra_tall_ctx, struct tetra_scramb_search);
+				tetra_scramb_search_init(ssearch);
+			}
+			if (opt == 'C') {
+				char *end;
+
+				ssearch->mcc = strtoul(optarg, &end, 10);
+				if (*end == ',')
+					ssearch->mnc = strtoul(end + 1, NULL, 10);
+			} else if (opt == 'L' &&
+				   tetra_scramb_search_load_pairs(ssearch, optarg) < 0) {
+				fprintf(stderr, "cannot read %s\n", optarg);
+				exit(1);
+			}
+			break;
+		case 'v':
+			tetra_verbosity = atoi(optarg);
+			break;
+		case 's':
+		case 'a':
+		case 'c':
+		case 'm':
+			if (tetra_filter_add(&filter, opt, optarg) < 0) {
+				fprintf(stderr, "invalid filter -%c %s\n", opt, optarg);
+				exit(1);
+			}
+			break;
+		case 'd':
+			if (tetra_filter_add(&filter, 'p', optarg) < 0) {
+				fprintf(stderr, "invalid filter -%c %s\n", opt, optarg);
+				exit(1);
+			}
+			break;
+		default:
+			print_help(argv[0]);
+			exit(1);
+		}
+	}
+
+	if (argc <= optind) {
+		print_help(argv[0]);
 		exit(1);
 	}
 
-	fd = open(argv[1], O_RDONLY);
+	if (demod) {
+		iq = tetra_iq_open(tetra_tall_ctx, argv[optind], iq_fmt, dc_block);
+		fd = iq ? iq->fd : -1;
+	} else
+		fd = open(argv[optind], O_RDONLY);
 	if (fd < 0) {
 		perror("open");
 		exit(2);
 	}
+	/* a recording only has a time if it is given, live input is now */
+	if (!t_phy_state.start_ns && fstat(fd, &st) == 0 && !S_ISREG(st.st_mode)) {
+		struct timespec ts;
+
+		clock_gettime(CLOCK_REALTIME, &ts);
+		t_phy_state.start_ns = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	}
 
-	tetra_gsmtap_init("localhost", 0);
+	tetra_kernel_init();
+	if (event_file && tetra_event_open(event_file, 0) < 0) {
+		fprintf(stderr, "cannot open %s\n", event_file);
+		exit(1);
+	}
+	/* GSMTAP goes either to a file or to localhost */
+	if (!gsmtap_file)
+		tetra_gsmtap_init("localhost", 0);
+	else if (tetra_gsmtap_file_init(gsmtap_file, gsmtap_rotate) < 0) {
+		fprintf(stderr, "cannot open %s\n", gsmtap_file);
+		exit(1);
+	}
 
 	tms = talloc_zero(tetra_tall_ctx, struct tetra_mac_state);
 	tetra_mac_state_init(tms);
+	if (tetra_filter_active(&filter))
+		tms->filter = &filter;
+	if (cache_file) {
+		tetra_scramb_cache_init(&scache, carrier);
+		if (tetra_scramb_cache_load(&scache, cache_file) < 0 && errno != ENOENT) {
+			fprintf(stderr, "cannot read %s\n", cache_file);
+			exit(1);
+		}
+		tms->scramb_cache = &scache;
+	}
+	tms->scramb_search = ssearch;
+	if (shm_name) {
+		tms->shm = tetra_shm_create(tetra_tall_ctx, shm_name, 0);
+		if (!tms->shm) {
+			fprintf(stderr, "cannot create shared memory ring %s\n", shm_name);
+			exit(1);
+		}
+	}
+
+	if (tun_dev)
+		tms->egress = tetra_egress_alloc(tetra_tall_ctx, TETRA_EGRESS_TUN,
+						 tun_dev, tun_queues);
+	else if (pcap_file)
+		tms->egress = tetra_egress_alloc(tetra_tall_ctx, TETRA_EGRESS_PCAP,
+						 pcap_file, 1);
+	if ((tun_dev || pcap_file) && !tms->egress)
+		exit(1);
 
 	trs = talloc_zero(tetra_tall_ctx, struct tetra_rx_state);
 	trs->burst_cb_priv = tms;
 
-	while (1) {
+	while (symbols && !demod) {
+		static float sym[SYM_BLK];
+		int len;
+
+		/* a partial symbol at the end is dropped */
+		len = tetra_read_full(fd, sym, sizeof(sym));
+		if (len < 0) {
+			errno = -len;
+			perror("read");
+			exit(1);
+		}
+		sync_sym(trs, sym, len / sizeof(*sym), soft);
+		if (len < sizeof(sym)) {
+			TPRINTF(TETRA_V_PDU, "EOF");
+			break;
+		}
+	}
+
+	while (!symbols && !demod) {
 		uint8_t buf[64];
 		int len;
 
@@ -70,14 +314,100 @@ int main(int argc, char **argv)
 			perror("read");
 			exit(1);
 		} else if (len == 0) {
-			printf("EOF");
+			TPRINTF(TETRA_V_PDU, "EOF");
 			break;
 		}
 		tetra_burst_sync_in(trs, buf, len);
 	}
 
+	while (demod) {
+		float sym[TETRA_DEMOD_MAX_SYM(TETRA_DEMOD_BLK)];
+		const float complex *in;
+		unsigned int num;
+		int len, i;
+
+		len = tetra_iq_read(iq, &in);
+		if (len < 0) {
+			errno = -len;
+			perror("read");
+			exit(1);
+		} else if (len == 0) {
+			TPRINTF(TETRA_V_PDU, "EOF");
+			break;
+		}
+
+		for (i = 0; i < len; i += TETRA_DEMOD_BLK) {
+			num = tetra_demod_in(demod, in + i,
+					     len - i > TETRA_DEMOD_BLK ? TETRA_DEMOD_BLK : len - i, sym);
+			sync_sym(trs, sym, num, soft);
+		}
+	}
+
+	{
+		struct tetra_gsmtap_stats st;
+
+		tetra_gsmtap_exit(&st);
+		fprintf(stderr, "GSMTAP: %u queued, %u sent in %u calls, "
+			"%u dropped, %u too long, %u send errors, "
+			"%u written to %u files, %u write errors\n",
+			st.queued, st.sent, st.syscalls, st.dropped,
+			st.too_long, st.send_err, st.written, st.files,
+			st.write_err);
+	}
+
+	fprintf(stderr, "LLC defrag: %u completed, %u missed, %u repeated, "
+		"%u timed out, %u evicted, %u overflow, %u bad FCS\n",
+		tms->llcs.rx.stats.completed, tms->llcs.rx.stats.missed,
+		tms->llcs.rx.stats.dup,
+		tms->llcs.rx.stats.timed_out, tms->llcs.rx.stats.evicted,
+		tms->llcs.rx.stats.overflow, tms->llcs.rx.stats.fcs_err);
+	tllc_defrag_flush(&tms->llcs);
+
+	if (tms->scramb_cache) {
+		fprintf(stderr, "cell cache: %u blocks tried, %u warm starts, %u misses\n",
+			scache.stats.tries, scache.stats.warm, scache.stats.misses);
+		if (scache.dirty && tetra_scramb_cache_save(&scache, cache_file) < 0)
+			fprintf(stderr, "cannot write %s\n", cache_file);
+	}
+
+	if (demod)
+		fprintf(stderr, "demodulator: %llu samples, %llu symbols, %.0f Hz offset\n",
+			(unsigned long long) demod->stats.samples,
+			(unsigned long long) demod->stats.symbols,
+			tetra_demod_freq_hz(demod));
+
+	if (ssearch)
+		fprintf(stderr, "code search: %u/%u searches found the code, "
+			"%llu candidates, %llu decoded\n",
+			ssearch->stats.found, ssearch->stats.runs,
+			(unsigned long long) ssearch->stats.candidates,
+			(unsigned long long) ssearch->stats.survivors);
+
+	if (tms->filter)
+		fprintf(stderr, "filter: %u/%u addresses passed, %u/%u TL-SDUs passed\n",
+			filter.stats.addr_pass,
+			filter.stats.addr_pass + filter.stats.addr_drop,
+			filter.stats.sdu_pass,
+			filter.stats.sdu_pass + filter.stats.sdu_drop);
+
+	if (tms->egress) {
+		struct tetra_egress_stats st;
+
+		tetra_egress_free(tms->egress, &st);
+		fprintf(stderr, "egress: %u queued, %u written in %u calls, "
+			"%u dropped, %u too long, %u write errors\n",
+			st.queued, st.written, st.batches, st.dropped,
+			st.too_long, st.write_err);
+	}
+
+	tetra_event_close();
+	if (iq)
+		tetra_iq_close(iq);
+	if (tms->shm)
+		tetra_shm_close(tms->shm);
 	talloc_free(trs);
 	talloc_free(tms);
+	talloc_free(ssearch);
 
 	exit(0);
 }
@@ -0,0 +1,428 @@
+/* Throughput and latency of the whole receive pipeline, from the bits
+ * of the burst synchronizer to the upper MAC, one JSON object per line */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Every instance is a process of its own, as each tetra-rx behind
+ * tetra-chan is: the decoder keeps its TDMA time in globals.  The input
+ * is read or generated before the instances are started, so that only
+ * the decoding is timed.  Output goes nowhere, unless GSMTAP is sent
+ * with -g. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <osmocom/core/talloc.h>
+#include <osmocom/core/utils.h>
+
+#include "tetra_common.h"
+#include "tetra_gsmtap.h"
+#include "tetra_kernel.h"
+#include "tetra_tdma.h"
+#include <phy/tetra_burst_sync.h>
+#include <phy/tetra_demod.h>
+#include <phy/tetra_gen.h>
+
+void *tetra_tall_ctx;
+
+#define MAX_INST	256
+
+/* what an instance reports, through a pipe, in one write() */
+struct inst_result {
+	uint64_t bursts;	/* passed on to the lower MAC */
+	double wall_ns;
+	double cpu_ns;		/* user and system */
+	long maxrss_kb;
+	double lat_ns[5];	/* p50, p90, p99, p99.9 and max per burst */
+};
+
+static const unsigned int lat_pct[4] = { 500, 900, 990, 999 };
+
+static uint8_t *input;
+static int8_t *input_soft;
+static unsigned long input_bits;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double tv_ns(const struct timeval *tv)
+{
+	return tv->tv_sec * 1e9 + tv->tv_usec * 1e3;
+}
+
+static int cmp_float(const void *a, const void *b)
+{
+	float x = *(const float *) a, y = *(const float *) b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* nearest rank, 'p' in 1/1000 */
+static float percentile(const float *sorted, unsigned long n, unsigned int p)
+{
+	unsigned long rank = (p * n + 999) / 1000;
+
+	return sorted[rank ? rank - 1 : 0];
+}
+
+/* the whole input 'passes' times, a burst at a time, as a decoder
+ * behind a demodulator gets it */
+static void run_inst(unsigned int passes, int soft, int gsmtap, struct inst_result *res)
+{
+	struct tetra_mac_state *tms;
+	struct tetra_rx_state *trs;
+	struct rusage ru;
+	unsigned long max_bursts, pos;
+	unsigned int p;
+	float *lat;
+	double t0;
+
+	max_bursts = input_bits / TETRA_BITS_PER_TS * passes + passes;
+	lat = talloc_array(tetra_tall_ctx, float, max_bursts);
+	if (!lat) {
+		fprintf(stderr, "cannot allocate %lu latencies\n", max_bursts);
+		exit(1);
+	}
+
+	if (gsmtap)
+		tetra_gsmtap_init("localhost", 0);
+	tms = talloc_zero(tetra_tall_ctx, struct tetra_mac_state);
+	tetra_mac_state_init(tms);
+	trs = talloc_zero(tetra_tall_ctx, struct tetra_rx_state);
+	trs->burst_cb_priv = tms;
+
+	memset(res, 0, sizeof(*res));
+	t0 = now_ns();
+
+	for (p = 0; p < passes; p++) {
+		for (pos = 0; pos < input_bits; pos += TETRA_BITS_PER_TS) {
+			unsigned int len = input_bits - pos < TETRA_BITS_PER_TS ?
+						input_bits - pos : TETRA_BITS_PER_TS;
+			unsigned int start = trs->bitbuf_start_bitnum;
+			int locked = trs->state != RX_S_UNLOCKED;
+			double t = now_ns();
+
+			if (soft)
+				tetra_burst_sync_in_soft(trs, input + pos, input_soft + pos, len);
+			else
+				tetra_burst_sync_in(trs, input + pos, len);
+
+			/* once locked, the buffer only moves on with a burst */
+			if (locked && trs->bitbuf_start_bitnum != start &&
+			    res->bursts < max_bursts)
+				lat[res->bursts++] = now_ns() - t;
+		}
+	}
+
+	res->wall_ns = now_ns() - t0;
+	if (gsmtap)
+		tetra_gsmtap_exit(NULL);
+	tllc_defrag_flush(&tms->llcs);
+
+	getrusage(RUSAGE_SELF, &ru);
+	res->cpu_ns = tv_ns(&ru.ru_utime) + tv_ns(&ru.ru_stime);
+	res->maxrss_kb = ru.ru_maxrss;
+
+	if (res->bursts) {
+		qsort(lat, res->bursts, sizeof(*lat), cmp_float);
+		for (p = 0; p < ARRAY_SIZE(lat_pct); p++)
+			res->lat_ns[p] = percentile(lat, res->bursts, lat_pct[p]);
+		res->lat_ns[4] = lat[res->bursts - 1];
+	}
+}
+
+/* 'num' instances at once, started together.  Returns the results of
+ * all of them, or -errno. */
+static int run_n(unsigned int num, unsigned int passes, int soft, int gsmtap,
+		 struct inst_result *res)
+{
+	int go[2], done[2];
+	unsigned int i, got = 0;
+	int rc = 0;
+
+	if (pipe(go) < 0 || pipe(done) < 0)
+		return -errno;
+
+	for (i = 0; i < num; i++) {
+		pid_t pid = fork();
+
+		if (pid < 0) {
+			rc = -errno;
+			break;
+		}
+		if (pid == 0) {
+			struct inst_result r;
+			char c;
+
+			close(go[1]);
+			close(done[0]);
+			/* until the parent closes its end */
+			while (read(go[0], &c, 1) < 0 && errno == EINTR)
+				;
+			run_inst(passes, soft, gsmtap, &r);
+			/* less than PIPE_BUF, not mixed up with the others */
+			_exit(write(done[1], &r, sizeof(r)) == sizeof(r) ? 0 : 1);
+		}
+	}
+	close(go[0]);
+	close(go[1]);
+	close(done[1]);
+
+	while (got < i) {
+		ssize_t len = read(done[0], &res[got], sizeof(*res));
+
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len != sizeof(*res))
+			break;
+		got++;
+	}
+	close(done[0]);
+	while (wait(NULL) > 0 || errno == EINTR)
+		;
+
+	if (rc < 0)
+		return rc;
+	return got == num ? 0 : -EIO;
+}
+
+static int load_input(const char *path)
+{
+	struct stat st;
+	int fd, rc = 0;
+	size_t have = 0;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -errno;
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+		close(fd);
+		return -EINVAL;
+	}
+
+	input = talloc_size(tetra_tall_ctx, st.st_size);
+	if (!input) {
+		close(fd);
+		return -ENOMEM;
+	}
+	while (have < st.st_size) {
+		ssize_t len = read(fd, input + have, st.st_size - have);
+
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0) {
+			rc = len < 0 ? -errno : -EIO;
+			break;
+		}
+		have += len;
+	}
+	close(fd);
+	input_bits = have;
+
+	return rc;
+}
+
+static void gen_input(double seconds, double ber)
+{
+	struct tetra_gen tg;
+	unsigned long i, num = seconds * TETRA_SYM_RATE / TETRA_SYM_PER_TS;
+
+	input_bits = num * TETRA_BITS_PER_TS;
+	input = talloc_size(tetra_tall_ctx, input_bits);
+	if (!input) {
+		fprintf(stderr, "cannot allocate %lu bits\n", input_bits);
+		exit(1);
+	}
+
+	tetra_gen_init(&tg, 1);
+	tg.ber = ber;
+	for (i = 0; i < num; i++)
+		tetra_gen_burst(&tg, input + i * TETRA_BITS_PER_TS);
+}
+
+/* as the slicer would give them, a sure 0 or 1 */
+static void make_soft(void)
+{
+	unsigned long i;
+
+	input_soft = talloc_size(tetra_tall_ctx, input_bits);
+	if (!input_soft) {
+		fprintf(stderr, "cannot allocate %lu soft bits\n", input_bits);
+		exit(1);
+	}
+	for (i = 0; i < input_bits; i++)
+		input_soft[i] = input[i] ? -127 : 127;
+}
+
+static void print_help(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options] [<file_with_1_byte_per_bit>]\n", prog);
+	fprintf(stderr, "  -d <s>     without a file: seconds of a synthetic cell (default 60)\n");
+	fprintf(stderr, "  -e <ber>   without a file: bit error rate of the synthetic cell\n");
+	fprintf(stderr, "  -l <num>   passes over the input by each instance (default 1)\n");
+	fprintf(stderr, "  -j <num>   1, 2, ... <num> instances at once, one process each\n"
+			"             (default 1)\n");
+	fprintf(stderr, "  -Y         soft decisions for the Viterbi decoder\n");
+	fprintf(stderr, "  -g         send GSMTAP to localhost, as tetra-rx does\n");
+	fprintf(stderr, "  -t         a text table instead of JSON\n");
+	fprintf(stderr, "The latency percentiles and RSS are those of the worst instance,\n");
+	fprintf(stderr, "the real-time factor that of the slowest one.  TETRA_KERNEL\n");
+	fprintf(stderr, "selects the kernels, as for tetra-bench.\n");
+}
+
+int main(int argc, char **argv)
+{
+	static struct inst_result res[MAX_INST];
+	unsigned int passes = 1, max_inst = 1, n, i, j;
+	double seconds = 60, ber = 0, air_s, rate1 = 0;
+	const char *path = NULL;
+	int opt, soft = 0, gsmtap = 0, text = 0, rc;
+	enum tetra_kernel_isa isa;
+
+	while ((opt = getopt(argc, argv, "d:e:l:j:Ygth")) != -1) {
+		switch (opt) {
+		case 'd':
+			seconds = atof(optarg);
+			break;
+		case 'e':
+			ber = atof(optarg);
+			break;
+		case 'l':
+			passes = atoi(optarg);
+			break;
+		case 'j':
+			max_inst = atoi(optarg);
+			break;
+		case 'Y':
+			soft = 1;
+			break;
+		case 'g':
+			gsmtap = 1;
+			break;
+		case 't':
+			text = 1;
+			break;
+		default:
+			print_help(argv[0]);
+			exit(2);
+		}
+	}
+	if (seconds <= 0 || ber < 0 || ber > 1 || passes < 1 ||
+	    max_inst < 1 || max_inst > MAX_INST) {
+		print_help(argv[0]);
+		exit(2);
+	}
+	if (argc > optind)
+		path = argv[optind];
+
+	tetra_verbosity = TETRA_V_NONE;
+	isa = tetra_kernel_init();
+
+	if (path) {
+		rc = load_input(path);
+		if (rc < 0) {
+			errno = -rc;
+			perror(path);
+			exit(1);
+		}
+	} else
+		gen_input(seconds, ber);
+	if (soft)
+		make_soft();
+	air_s = (double) input_bits * passes / TETRA_BIT_RATE;
+
+	if (text)
+		printf("%4s %10s %8s %8s %12s %12s %9s %9s %9s %9s %8s %7s\n", "inst",
+		       "bursts", "wall s", "RTF", "bursts/s", "per cpu s", "p50 us",
+		       "p99 us", "p99.9 us", "max us", "RSS kB", "scaling");
+	else
+		printf("{\"isa\":\"%s\",\"input\":\"%s\",\"bits\":%lu,\"air_s\":%.2f,"
+		       "\"passes\":%u,\"soft\":%d,\"gsmtap\":%d,\"cpus\":%ld}\n",
+		       tetra_kernel_isa_name(isa), path ? path : "synthetic", input_bits,
+		       air_s / passes, passes, soft, gsmtap, sysconf(_SC_NPROCESSORS_ONLN));
+	fflush(stdout);
+
+	for (n = 1; n <= max_inst; n++) {
+		struct inst_result worst;
+		uint64_t bursts = 0;
+		double cpu_ns = 0, rtf, rate;
+
+		rc = run_n(n, passes, soft, gsmtap, res);
+		if (rc < 0) {
+			errno = -rc;
+			perror("instances");
+			exit(1);
+		}
+
+		/* the slowest instance, and the worst of each figure */
+		memset(&worst, 0, sizeof(worst));
+		for (i = 0; i < n; i++) {
+			bursts += res[i].bursts;
+			cpu_ns += res[i].cpu_ns;
+			if (res[i].wall_ns > worst.wall_ns)
+				worst.wall_ns = res[i].wall_ns;
+			if (res[i].maxrss_kb > worst.maxrss_kb)
+				worst.maxrss_kb = res[i].maxrss_kb;
+			for (j = 0; j < ARRAY_SIZE(worst.lat_ns); j++)
+				if (res[i].lat_ns[j] > worst.lat_ns[j])
+					worst.lat_ns[j] = res[i].lat_ns[j];
+		}
+		rtf = air_s * 1e9 / worst.wall_ns;
+		rate = bursts * 1e9 / worst.wall_ns;
+		if (n == 1)
+			rate1 = rate;
+
+		if (text) {
+			printf("%4u %10llu %8.2f %8.1f %12.0f %12.0f %9.1f %9.1f %9.1f %9.1f "
+			       "%8ld %7.2f\n", n, (unsigned long long) bursts, worst.wall_ns / 1e9,
+			       rtf, rate, cpu_ns > 0 ? bursts * 1e9 / cpu_ns : 0,
+			       worst.lat_ns[0] / 1e3, worst.lat_ns[2] / 1e3,
+			       worst.lat_ns[3] / 1e3, worst.lat_ns[4] / 1e3,
+			       worst.maxrss_kb, rate1 > 0 ? rate / (n * rate1) : 0);
+		} else {
+			printf("{\"instances\":%u,\"bursts\":%llu,\"wall_s\":%.3f,\"cpu_s\":%.3f,"
+			       "\"rtf\":%.1f,\"bursts_per_s\":%.0f,\"bursts_per_cpu_s\":%.0f,"
+			       "\"lat_ns_p50\":%.0f,\"lat_ns_p90\":%.0f,\"lat_ns_p99\":%.0f,"
+			       "\"lat_ns_p999\":%.0f,\"lat_ns_max\":%.0f,\"maxrss_kb\":%ld,"
+			       "\"scaling\":%.3f}\n", n, (unsigned long long) bursts,
+			       worst.wall_ns / 1e9, cpu_ns / 1e9, rtf, rate,
+			       cpu_ns > 0 ? bursts * 1e9 / cpu_ns : 0,
+			       worst.lat_ns[0], worst.lat_ns[1], worst.lat_ns[2],
+			       worst.lat_ns[3], worst.lat_ns[4], worst.maxrss_kb,
+			       rate1 > 0 ? rate / (n * rate1) : 0);
+		}
+		fflush(stdout);
+	}
+
+	exit(0);
+}
@@ -21,6 +21,9 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
 
 #include <osmocom/core/utils.h>
 #include <osmocom/core/bits.h>
@@ -28,16 +31,191 @@
 #include "tetra_common.h"
 #include "tetra_prim.h"
 
+int tetra_verbosity = TETRA_V_DUMP;
+
+struct tetra_phy_state t_phy_state;
+
+/* pack eight unpacked bits (MSB first) into one byte */
+static inline uint8_t ubit8_to_uint(const uint8_t *bits)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	uint64_t w;
+
+	memcpy(&w, bits, sizeof(w));
+	w &= 0x0101010101010101ULL;
+	/* bit 8*k (the k-th input bit) lands in bit 63-k, without any carries */
+	return (w * 0x8040201008040201ULL) >> 56;
+#else
+	uint8_t ret = 0;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		ret = (ret << 1) | (bits[i] & 1);
+	return ret;
+#endif
+}
+
 uint32_t bits_to_uint(const uint8_t *bits, unsigned int len)
 {
 	uint32_t ret = 0;
 
+	/* whole bytes first, never reading beyond bits[len-1] */
+	for (; len >= 8; len -= 8, bits += 8)
+		ret = (ret << 8) | ubit8_to_uint(bits);
+
 	while (len--)
 		ret = (ret << 1) | (*bits++ & 1);
 
 	return ret;
 }
 
+void uint_to_bits(uint32_t val, unsigned int len, uint8_t *bits)
+{
+	while (len--)
+		*bits++ = (val >> len) & 1;
+}
+
+/* return the offset of the first exact occurrence of 'seq' in 'in', or -1 */
+int tetra_find_seq(const uint8_t *in, unsigned int len,
+		   const uint8_t *seq, unsigned int seq_len)
+{
+	unsigned int i;
+
+	for (i = 0; i + seq_len <= len; i++) {
+		if (!memcmp(in + i, seq, seq_len))
+			return i;
+	}
+	return -1;
+}
+
+void tetra_fir_cf(const float *in, const float *taps, unsigned int ntaps,
+		  float *out, unsigned int n)
+{
+	unsigned int i, k;
+
+	for (i = 0; i < n; i++) {
+		float re = 0, im = 0;
+
+		for (k = 0; k < ntaps; k++) {
+			re += taps[k] * in[2*(i+k)];
+			im += taps[k] * in[2*(i+k)+1];
+		}
+		out[2*i] = re;
+		out[2*i+1] = im;
+	}
+}
+
+void tetra_mac_cf(const float *in, const float *taps, float *acc, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		acc[2*i] += taps[i] * in[2*i];
+		acc[2*i+1] += taps[i] * in[2*i+1];
+	}
+}
+
+void tetra_slice_bits(const float *sym, unsigned int n, uint8_t *bits)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		float s = sym[i];
+
+		/* NaN ends up as -1 */
+		bits[2*i] = !(s > 0);
+		bits[2*i+1] = s > 2 || s < -2;
+	}
+}
+
+static int8_t soft_clamp(float v)
+{
+	v *= TETRA_SOFT_SCALE;
+	if (v > 127)
+		v = 127;
+	if (v < -127)
+		v = -127;
+	return lrintf(v);
+}
+
+void tetra_slice_soft(const float *sym, unsigned int n, int8_t *soft)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		float s = isnan(sym[i]) ? 0 : sym[i];
+		float a = fabsf(s);
+		/* the first bit flips at 0 and at +-4, where the phase wraps */
+		float d0 = a < 4 - a ? a : 4 - a;
+
+		soft[2*i] = soft_clamp(signbit(s) ? -d0 : d0);
+		soft[2*i+1] = soft_clamp(2 - a);
+	}
+}
+
+unsigned int tetra_iq_sample_size(enum tetra_iq_fmt fmt)
+{
+	switch (fmt) {
+	case TETRA_IQ_CU8:
+	case TETRA_IQ_CS8:
+		return 2;
+	case TETRA_IQ_CS16:
+		return 4;
+	case TETRA_IQ_CF32:
+		return 8;
+	}
+	return 0;
+}
+
+void tetra_cvt_iq(enum tetra_iq_fmt fmt, const void *in, float *out, unsigned int n,
+		  const float *off, float scale, float *sum)
+{
+	const uint8_t *u8 = in;
+	const int8_t *s8 = in;
+	const int16_t *s16 = in;
+	const float *f32 = in;
+	unsigned int i;
+
+	for (i = 0; i < 2*n; i++) {
+		float x;
+
+		switch (fmt) {
+		case TETRA_IQ_CU8:
+			x = u8[i];
+			break;
+		case TETRA_IQ_CS8:
+			x = s8[i];
+			break;
+		case TETRA_IQ_CS16:
+			x = s16[i];
+			break;
+		default:
+			x = f32[i];
+			break;
+		}
+		out[i] = (x - off[i & 1]) * scale;
+		sum[i & 1] += out[i];
+	}
+}
+
+int tetra_read_full(int fd, void *buf, size_t len)
+{
+	size_t have = 0;
+
+	while (have < len) {
+		ssize_t rc = read(fd, (uint8_t *) buf + have, len - have);
+
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		} else if (rc == 0)
+			break;
+		have += rc;
+	}
+	return have;
+}
+
 static inline uint32_t tetra_band_base_hz(uint8_t band)
 {
 	return (band * 100000000);
@@ -128,4 +306,5 @@ const char *tetra_get_sap_name(uint8_t sap)
 void tetra_mac_state_init(struct tetra_mac_state *tms)
 {
 	INIT_LLIST_HEAD(&tms->voice_channels);
+	tllc_defrag_init(&tms->llcs);
 }
@@ -2,7 +2,9 @@
 #define TETRA_COMMON_H
 
 #include <stdint.h>
+#include <stdio.h>
 #include "tetra_mac_pdu.h"
+#include "tetra_llc_pdu.h"
 #include <osmocom/core/linuxlist.h>
 
 #ifdef DEBUG
@@ -11,6 +13,27 @@
 #define DEBUGP(x, args...)	do { } while(0)
 #endif
 
+/* verbosity of the text output on stdout */
+enum tetra_verbosity_level {
+	TETRA_V_NONE,		/* nothing */
+	TETRA_V_PDU,		/* decoded PDUs and system information */
+	TETRA_V_BLOCK,		/* every burst and MAC block */
+	TETRA_V_DUMP,		/* bit dumps of blocks and SDUs */
+};
+
+/* prints above this level are compiled out */
+#ifndef TETRA_MAX_VERBOSITY
+#define TETRA_MAX_VERBOSITY	TETRA_V_DUMP
+#endif
+
+extern int tetra_verbosity;
+
+#define TPRINTF(level, x, args...)					\
+	do {								\
+		if ((level) <= TETRA_MAX_VERBOSITY && (level) <= tetra_verbosity) \
+			printf(x, ## args);				\
+	} while (0)
+
 #define TETRA_SYM_PER_TS	255
 #define TETRA_BITS_PER_TS	(TETRA_SYM_PER_TS*2)
 
@@ -35,19 +58,82 @@ enum tetra_log_chan {
 };
 
 uint32_t bits_to_uint(const uint8_t *bits, unsigned int len);
+/* the reverse, the lowest 'len' bits of 'val', MSB first */
+void uint_to_bits(uint32_t val, unsigned int len, uint8_t *bits);
+
+/* find the first exact occurrence of a bit sequence, -1 if there is none */
+int tetra_find_seq(const uint8_t *in, unsigned int len,
+		   const uint8_t *seq, unsigned int seq_len);
+
+/* complex FIR with real taps over interleaved I/Q floats:
+ * out[i] = sum(taps[k] * in[i+k]), 'in' holding n + ntaps - 1 samples */
+void tetra_fir_cf(const float *in, const float *taps, unsigned int ntaps,
+		  float *out, unsigned int n);
+
+/* complex multiply-accumulate with real weights: acc[i] += taps[i] * in[i] */
+void tetra_mac_cf(const float *in, const float *taps, float *acc, unsigned int n);
+
+/* pi/4-DQPSK symbols, the phase step in units of pi/4, to dibits:
+ * -3: 11, -1: 10, +1: 00, +3: 01, the decision thresholds at 0 and +-2 */
+void tetra_slice_bits(const float *sym, unsigned int n, uint8_t *bits);
+
+/* soft dibits for viterbi_cch_decode(): +127 a sure 0, -127 a sure 1, 0
+ * no idea, TETRA_SOFT_SCALE per pi/4 of distance from the threshold */
+#define TETRA_SOFT_SCALE	64
+void tetra_slice_soft(const float *sym, unsigned int n, int8_t *soft);
+
+/* sample formats of IQ recordings, interleaved I/Q */
+enum tetra_iq_fmt {
+	TETRA_IQ_CU8,		/* rtl_sdr */
+	TETRA_IQ_CS8,		/* hackrf_transfer */
+	TETRA_IQ_CS16,
+	TETRA_IQ_CF32,		/* gr_complex */
+};
+
+/* bytes per complex sample */
+unsigned int tetra_iq_sample_size(enum tetra_iq_fmt fmt);
+
+/* IQ samples to interleaved floats, n complex samples:
+ * out[2i+j] = (in[2i+j] - off[j]) * scale, sum[j] += out[2i+j] */
+void tetra_cvt_iq(enum tetra_iq_fmt fmt, const void *in, float *out, unsigned int n,
+		  const float *off, float scale, float *sum);
+
+/* 'len' bytes from 'fd' unless the input ends first, the same from a pipe
+ * as from a file.  Returns the number read, or -errno */
+int tetra_read_full(int fd, void *buf, size_t len);
 
 #include "tetra_tdma.h"
 struct tetra_phy_state {
-	struct tetra_tdma_time time;
+	uint64_t slot;		/* TDMA time of the current burst */
+	uint64_t start_ns;	/* wall clock time of the first input bit, 0 if unknown */
+	struct tetra_tdma_clock clock;	/* valid if start_ns is known */
 };
 extern struct tetra_phy_state t_phy_state;
 
+struct tetra_egress;
+struct tetra_filter;
+struct tetra_shm;
+struct tetra_scramb_cache;
+struct tetra_scramb_search;
+
 struct tetra_mac_state {
 	struct llist_head voice_channels;
 	struct {
 		int is_traffic;
+		uint32_t ts;	/* low 32 bits of the TDMA slot counter */
+		int filtered;	/* rejected by the filter, no GSMTAP */
+		int sdu_passed;	/* the TL-SDU passed the filter at its start */
 	} cur_burst;
+	/* per timeslot: the fragmented MAC PDU being received passed the
+	 * filter, so do its MAC-FRAG / MAC-END / SUPPL continuations */
+	uint8_t frag_pass[TETRA_TN_PER_FN];	/* by TN - 1 */
     struct tetra_si_decoded last_sid;
+	struct tllc_state llcs;
+	struct tetra_egress *egress;	/* SNDCP packet sink, may be NULL */
+	struct tetra_filter *filter;	/* subscriber / PDU filter, may be NULL */
+	struct tetra_shm *shm;		/* shared memory block ring, may be NULL */
+	struct tetra_scramb_cache *scramb_cache; /* known cells, may be NULL */
+	struct tetra_scramb_search *scramb_search; /* code recovery, may be NULL */
 };
 
 void tetra_mac_state_init(struct tetra_mac_state *tms);
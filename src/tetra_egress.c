@@ -0,0 +1,309 @@
+/* Queued egress of SNDCP packets to tun or pcap */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+
+#include <osmocom/core/bits.h>
+#include <osmocom/core/talloc.h>
+
+#include "tetra_egress.h"
+#include "tuntap.h"
+
+#define PCAP_MAGIC		0xa1b2c3d4
+#define PCAP_LINKTYPE_RAW	101
+
+struct pcap_file_hdr {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct pcap_rec_hdr {
+	uint32_t ts_sec;
+	uint32_t ts_usec;
+	uint32_t incl_len;
+	uint32_t orig_len;
+};
+
+struct egress_pkt {
+	struct pcap_rec_hdr rec;	/* only used by the pcap sink */
+	uint16_t len;
+	uint8_t nsapi;
+	uint8_t data[TETRA_EGRESS_MAX_PKT];
+};
+
+struct tetra_egress {
+	enum tetra_egress_type type;
+	int fd[TETRA_EGRESS_MAX_TUNQ];
+	unsigned int num_fd;
+
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int running;
+
+	/* single producer (decoder), single consumer (writer thread).
+	 * Slots between tail and head belong to the writer */
+	unsigned int head, tail;
+	struct egress_pkt q[TETRA_EGRESS_QUEUE_LEN];
+
+	struct tetra_egress_stats stats;
+};
+
+#define Q_IDX(x)	((x) & (TETRA_EGRESS_QUEUE_LEN-1))
+
+static int write_tun(struct tetra_egress *eg, unsigned int tail, unsigned int n)
+{
+	unsigned int i;
+	int err = 0;
+
+	/* a tun write is always exactly one packet, so batching is done by
+	 * spreading the NSAPIs over the queues of a multi-queue device */
+	for (i = 0; i < n; i++) {
+		struct egress_pkt *pkt = &eg->q[Q_IDX(tail + i)];
+
+		if (write(eg->fd[pkt->nsapi % eg->num_fd], pkt->data, pkt->len) != pkt->len)
+			err++;
+	}
+
+	return err;
+}
+
+static int write_pcap(struct tetra_egress *eg, unsigned int tail, unsigned int n)
+{
+	struct iovec iov[TETRA_EGRESS_BATCH*2], *cur = iov;
+	unsigned int i, cnt = n*2;
+	ssize_t rc;
+
+	for (i = 0; i < n; i++) {
+		struct egress_pkt *pkt = &eg->q[Q_IDX(tail + i)];
+
+		iov[i*2].iov_base = &pkt->rec;
+		iov[i*2].iov_len = sizeof(pkt->rec);
+		iov[i*2+1].iov_base = pkt->data;
+		iov[i*2+1].iov_len = pkt->len;
+	}
+
+	/* resume a short write where it stopped */
+	while (cnt) {
+		rc = writev(eg->fd[0], cur, cnt);
+		if (rc < 0 && errno == EINTR)
+			continue;
+		if (rc <= 0)
+			break;
+		for (; cnt && (size_t)rc >= cur->iov_len; cur++, cnt--)
+			rc -= cur->iov_len;
+		if (cnt) {
+			cur->iov_base = (uint8_t *)cur->iov_base + rc;
+			cur->iov_len -= rc;
+		}
+	}
+
+	/* packets not written completely are lost */
+	return (cnt + 1) / 2;
+}
+
+static void *egress_thread(void *priv)
+{
+	struct tetra_egress *eg = priv;
+
+	pthread_mutex_lock(&eg->lock);
+	while (1) {
+		unsigned int tail = eg->tail, n;
+		int err;
+
+		n = eg->head - tail;
+		if (n == 0) {
+			if (!eg->running)
+				break;
+			pthread_cond_wait(&eg->cond, &eg->lock);
+			continue;
+		}
+		if (n > TETRA_EGRESS_BATCH)
+			n = TETRA_EGRESS_BATCH;
+		pthread_mutex_unlock(&eg->lock);
+
+		if (eg->type == TETRA_EGRESS_TUN)
+			err = write_tun(eg, tail, n);
+		else
+			err = write_pcap(eg, tail, n);
+
+		pthread_mutex_lock(&eg->lock);
+		eg->stats.written += n - err;
+		eg->stats.write_err += err;
+		eg->stats.batches += eg->type == TETRA_EGRESS_TUN ? n : 1;
+		eg->tail = tail + n;
+	}
+	pthread_mutex_unlock(&eg->lock);
+
+	return NULL;
+}
+
+int tetra_egress_put(struct tetra_egress *eg, uint8_t nsapi,
+		     const uint8_t *bits, unsigned int len)
+{
+	struct egress_pkt *pkt;
+	unsigned int head;
+	struct timeval tv;
+
+	pthread_mutex_lock(&eg->lock);
+	if (len / 8 > TETRA_EGRESS_MAX_PKT) {
+		eg->stats.too_long++;
+		pthread_mutex_unlock(&eg->lock);
+		return -EMSGSIZE;
+	}
+	head = eg->head;
+	if (head - eg->tail >= TETRA_EGRESS_QUEUE_LEN) {
+		eg->stats.dropped++;
+		pthread_mutex_unlock(&eg->lock);
+		return -ENOSPC;
+	}
+	pthread_mutex_unlock(&eg->lock);
+
+	/* the slot at head is not visible to the writer until head moves */
+	pkt = &eg->q[Q_IDX(head)];
+	pkt->nsapi = nsapi;
+	pkt->len = osmo_ubit2pbit(pkt->data, bits, len & ~7);
+	if (eg->type == TETRA_EGRESS_PCAP) {
+		gettimeofday(&tv, NULL);
+		pkt->rec.ts_sec = tv.tv_sec;
+		pkt->rec.ts_usec = tv.tv_usec;
+		pkt->rec.incl_len = pkt->rec.orig_len = pkt->len;
+	}
+
+	pthread_mutex_lock(&eg->lock);
+	eg->head = head + 1;
+	eg->stats.queued++;
+	pthread_cond_signal(&eg->cond);
+	pthread_mutex_unlock(&eg->lock);
+
+	return 0;
+}
+
+static int open_pcap(struct tetra_egress *eg, const char *name)
+{
+	struct pcap_file_hdr fh = {
+		.magic		= PCAP_MAGIC,
+		.version_major	= 2,
+		.version_minor	= 4,
+		.snaplen	= TETRA_EGRESS_MAX_PKT,
+		.linktype	= PCAP_LINKTYPE_RAW,
+	};
+	int fd;
+
+	fd = open(name, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if (fd < 0)
+		return -errno;
+	if (write(fd, &fh, sizeof(fh)) != sizeof(fh)) {
+		close(fd);
+		return -EIO;
+	}
+	eg->fd[0] = fd;
+	eg->num_fd = 1;
+
+	return 0;
+}
+
+struct tetra_egress *tetra_egress_alloc(void *ctx, enum tetra_egress_type type,
+					const char *name, unsigned int num_queues)
+{
+	struct tetra_egress *eg;
+	int rc;
+
+	eg = talloc_zero(ctx, struct tetra_egress);
+	if (!eg)
+		return NULL;
+	eg->type = type;
+
+	switch (type) {
+	case TETRA_EGRESS_TUN:
+		if (num_queues < 1)
+			num_queues = 1;
+		if (num_queues > TETRA_EGRESS_MAX_TUNQ)
+			num_queues = TETRA_EGRESS_MAX_TUNQ;
+		rc = tun_alloc_mq(name, num_queues, eg->fd);
+		if (rc > 0)
+			eg->num_fd = rc;
+		break;
+	case TETRA_EGRESS_PCAP:
+		rc = open_pcap(eg, name);
+		break;
+	default:
+		rc = -EINVAL;
+		break;
+	}
+	if (rc < 0) {
+		fprintf(stderr, "cannot open egress %s: %s\n", name, strerror(-rc));
+		talloc_free(eg);
+		return NULL;
+	}
+
+	pthread_mutex_init(&eg->lock, NULL);
+	pthread_cond_init(&eg->cond, NULL);
+	eg->running = 1;
+	if (pthread_create(&eg->thread, NULL, egress_thread, eg)) {
+		unsigned int i;
+
+		for (i = 0; i < eg->num_fd; i++)
+			close(eg->fd[i]);
+		talloc_free(eg);
+		return NULL;
+	}
+
+	return eg;
+}
+
+void tetra_egress_free(struct tetra_egress *eg, struct tetra_egress_stats *st)
+{
+	unsigned int i;
+
+	pthread_mutex_lock(&eg->lock);
+	eg->running = 0;
+	pthread_cond_signal(&eg->cond);
+	pthread_mutex_unlock(&eg->lock);
+	pthread_join(eg->thread, NULL);
+
+	if (st)
+		*st = eg->stats;
+	for (i = 0; i < eg->num_fd; i++)
+		close(eg->fd[i]);
+	pthread_cond_destroy(&eg->cond);
+	pthread_mutex_destroy(&eg->lock);
+	talloc_free(eg);
+}
+
+void tetra_egress_get_stats(struct tetra_egress *eg, struct tetra_egress_stats *st)
+{
+	pthread_mutex_lock(&eg->lock);
+	*st = eg->stats;
+	pthread_mutex_unlock(&eg->lock);
+}
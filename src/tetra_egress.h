@@ -0,0 +1,53 @@
+#ifndef TETRA_EGRESS_H
+#define TETRA_EGRESS_H
+
+#include <stdint.h>
+
+/* Egress of the IP packets carried in SNDCP N-PDUs.
+ *
+ * Packets are copied into a bounded queue by the decoder and written by a
+ * separate thread, so a slow tun reader or disk never stalls burst
+ * decoding.  If the queue is full, the new packet is dropped. */
+
+enum tetra_egress_type {
+	TETRA_EGRESS_TUN,	/* tun device, one queue per NSAPI */
+	TETRA_EGRESS_PCAP,	/* pcap file with raw IP (LINKTYPE_RAW) */
+};
+
+/* maximum number of packets in the queue, must be a power of two */
+#define TETRA_EGRESS_QUEUE_LEN	256
+/* maximum number of packets written at once */
+#define TETRA_EGRESS_BATCH	32
+/* maximum size of a packet */
+#define TETRA_EGRESS_MAX_PKT	2048
+/* maximum number of tun queues */
+#define TETRA_EGRESS_MAX_TUNQ	16
+
+struct tetra_egress_stats {
+	unsigned int queued;	/* packets accepted into the queue */
+	unsigned int written;	/* packets written to the sink */
+	unsigned int batches;	/* number of write system calls */
+	unsigned int dropped;	/* packets dropped as the queue was full */
+	unsigned int too_long;	/* packets longer than TETRA_EGRESS_MAX_PKT */
+	unsigned int write_err;	/* packets lost due to write errors */
+};
+
+struct tetra_egress;
+
+/* 'name' is the tun device name or the pcap file name, 'num_queues' is
+ * the number of tun queues (ignored for pcap) */
+struct tetra_egress *tetra_egress_alloc(void *ctx, enum tetra_egress_type type,
+					const char *name, unsigned int num_queues);
+
+/* drain the queue, stop the writer and free everything.  The final
+ * statistics are returned in 'st' unless it is NULL */
+void tetra_egress_free(struct tetra_egress *eg, struct tetra_egress_stats *st);
+
+/* queue the packet in the unpacked bits 'bits' for NSAPI 'nsapi'.  Never
+ * blocks, returns -ENOSPC if the queue is full */
+int tetra_egress_put(struct tetra_egress *eg, uint8_t nsapi,
+		     const uint8_t *bits, unsigned int len);
+
+void tetra_egress_get_stats(struct tetra_egress *eg, struct tetra_egress_stats *st);
+
+#endif /* TETRA_EGRESS_H */
@@ -0,0 +1,261 @@
+/* Binary decoder event stream */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include <osmocom/core/utils.h>
+#include <osmocom/core/bits.h>
+#include <osmocom/core/talloc.h>
+
+#include "tetra_event.h"
+
+#define EV_DEFAULT_BUF	(64*1024)
+
+int tetra_event_active;
+
+static struct {
+	int fd;
+	uint8_t *buf;
+	unsigned int buf_size;
+	unsigned int buf_len;
+	uint32_t ts;
+} ev_sink = { .fd = -1 };
+
+static int ev_flush(void)
+{
+	unsigned int done = 0;
+
+	while (done < ev_sink.buf_len) {
+		ssize_t rc = write(ev_sink.fd, ev_sink.buf + done, ev_sink.buf_len - done);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			ev_sink.buf_len = 0;
+			return -errno;
+		}
+		done += rc;
+	}
+	ev_sink.buf_len = 0;
+
+	return 0;
+}
+
+int tetra_event_open(const char *path, unsigned int buf_size)
+{
+	struct tetra_ev_file_hdr fh = {
+		.magic		= TETRA_EV_MAGIC,
+		.version	= TETRA_EV_VERSION,
+		.hdr_len	= sizeof(struct tetra_ev_hdr),
+	};
+
+	if (ev_sink.fd >= 0)
+		return -EBUSY;
+	if (!buf_size)
+		buf_size = EV_DEFAULT_BUF;
+	/* a buffer always holds at least one maximum size record */
+	if (buf_size < sizeof(struct tetra_ev_hdr) + TETRA_EV_MAX_PAYLOAD)
+		buf_size = sizeof(struct tetra_ev_hdr) + TETRA_EV_MAX_PAYLOAD;
+
+	ev_sink.buf = talloc_size(NULL, buf_size);
+	if (!ev_sink.buf)
+		return -ENOMEM;
+	ev_sink.fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if (ev_sink.fd < 0) {
+		talloc_free(ev_sink.buf);
+		ev_sink.buf = NULL;
+		return -errno;
+	}
+	ev_sink.buf_size = buf_size;
+	memcpy(ev_sink.buf, &fh, sizeof(fh));
+	ev_sink.buf_len = sizeof(fh);
+	tetra_event_active = 1;
+
+	return 0;
+}
+
+void tetra_event_close(void)
+{
+	if (ev_sink.fd < 0)
+		return;
+
+	ev_flush();
+	close(ev_sink.fd);
+	talloc_free(ev_sink.buf);
+	ev_sink.fd = -1;
+	ev_sink.buf = NULL;
+	tetra_event_active = 0;
+}
+
+void tetra_event_set_time(uint64_t slot)
+{
+	ev_sink.ts = slot;
+}
+
+int tetra_event_put(enum tetra_ev_type type, const void *payload, unsigned int len,
+		    const uint8_t *bits, unsigned int num_bits)
+{
+	struct tetra_ev_hdr *eh;
+	unsigned int total = len + (num_bits + 7) / 8;
+	uint8_t *cur;
+
+	if (!tetra_event_active)
+		return 0;
+	if (total > TETRA_EV_MAX_PAYLOAD)
+		return -EMSGSIZE;
+	if (ev_sink.buf_len + sizeof(*eh) + total > ev_sink.buf_size) {
+		int rc = ev_flush();
+		if (rc < 0)
+			return rc;
+	}
+
+	cur = ev_sink.buf + ev_sink.buf_len;
+	eh = (struct tetra_ev_hdr *) cur;
+	eh->type = type;
+	eh->flags = 0;
+	eh->len = total;
+	eh->ts = ev_sink.ts;
+	cur += sizeof(*eh);
+	memcpy(cur, payload, len);
+	if (num_bits)
+		osmo_ubit2pbit(cur + len, bits, num_bits);
+	ev_sink.buf_len += sizeof(*eh) + total;
+
+	return 0;
+}
+
+void tetra_event_defrag(enum tetra_ev_defrag_kind kind, uint32_t addr,
+			uint8_t ns, uint8_t ss)
+{
+	struct tetra_ev_defrag ev = {
+		.kind	= kind,
+		.ns	= ns,
+		.ss	= ss,
+		.addr	= addr,
+	};
+
+	tetra_event_put(TETRA_EV_DEFRAG, &ev, sizeof(ev), NULL, 0);
+}
+
+int tetra_event_read_hdr(FILE *f, struct tetra_ev_file_hdr *fh)
+{
+	if (fread(fh, sizeof(*fh), 1, f) != 1 || fh->magic != TETRA_EV_MAGIC)
+		return -EINVAL;
+	if (fh->version > TETRA_EV_VERSION || fh->hdr_len < sizeof(struct tetra_ev_hdr))
+		return -EPROTONOSUPPORT;
+	return 0;
+}
+
+int tetra_event_read(FILE *f, const struct tetra_ev_file_hdr *fh,
+		     struct tetra_ev_hdr *eh, uint8_t *payload)
+{
+	if (fread(eh, sizeof(*eh), 1, f) != 1)
+		return 0;
+	/* skip header fields added by later versions */
+	if (fh->hdr_len > sizeof(*eh) &&
+	    fread(payload, fh->hdr_len - sizeof(*eh), 1, f) != 1)
+		return -EIO;
+	if (eh->len && fread(payload, eh->len, 1, f) != 1)
+		return -EIO;
+	return 1;
+}
+
+/* minimum payload length of each record type */
+static const unsigned int ev_min_len[] = {
+	[TETRA_EV_BURST]	= sizeof(struct tetra_ev_burst),
+	[TETRA_EV_BLOCK]	= sizeof(struct tetra_ev_block),
+	[TETRA_EV_SYNC]		= sizeof(struct tetra_ev_sync),
+	[TETRA_EV_SYSINFO]	= sizeof(struct tetra_ev_sysinfo),
+	[TETRA_EV_PDU]		= sizeof(struct tetra_ev_pdu),
+	[TETRA_EV_DEFRAG]	= sizeof(struct tetra_ev_defrag),
+};
+
+int tetra_event_valid(const struct tetra_ev_hdr *eh, const uint8_t *payload)
+{
+	unsigned int min_len;
+
+	if (eh->type >= ARRAY_SIZE(ev_min_len) || !ev_min_len[eh->type])
+		return 0;
+	min_len = ev_min_len[eh->type];
+	if (eh->len < min_len)
+		return 0;
+	if (eh->type == TETRA_EV_BLOCK)
+		min_len += (((const struct tetra_ev_block *) payload)->num_bits + 7) / 8;
+	if (eh->type == TETRA_EV_PDU)
+		min_len += (((const struct tetra_ev_pdu *) payload)->num_bits + 7) / 8;
+	return eh->len >= min_len;
+}
+
+uint64_t tetra_event_ts2slot(uint16_t version, uint32_t ts)
+{
+	if (version >= 2)
+		return ts;
+	/* before the first SYNC there was no valid time */
+	return ts >= 76 ? ts - 76 : 0;
+}
+
+static const struct value_string ev_type_names[] = {
+	{ TETRA_EV_BURST,	"BURST" },
+	{ TETRA_EV_BLOCK,	"BLOCK" },
+	{ TETRA_EV_SYNC,	"SYNC" },
+	{ TETRA_EV_SYSINFO,	"SYSINFO" },
+	{ TETRA_EV_PDU,		"PDU" },
+	{ TETRA_EV_DEFRAG,	"DEFRAG" },
+	{ 0, NULL }
+};
+
+const char *tetra_get_ev_type_name(uint8_t type)
+{
+	return get_value_string(ev_type_names, type);
+}
+
+static const struct value_string ev_proto_names[] = {
+	{ TETRA_EV_P_MAC_RESOURCE,	"MAC-RESOURCE" },
+	{ TETRA_EV_P_MAC_SUPPL,		"MAC-D-BLCK" },
+	{ TETRA_EV_P_MAC_FRAG,		"MAC-FRAG/END" },
+	{ TETRA_EV_P_LLC,		"TM-SDU" },
+	{ TETRA_EV_P_TL_SDU,		"TL-SDU" },
+	{ 0, NULL }
+};
+
+const char *tetra_get_ev_proto_name(uint8_t proto)
+{
+	return get_value_string(ev_proto_names, proto);
+}
+
+static const struct value_string ev_defrag_names[] = {
+	{ TETRA_EV_DF_APPEND,	"APPEND" },
+	{ TETRA_EV_DF_MISS,	"MISS" },
+	{ TETRA_EV_DF_REMOVE,	"REMOVE" },
+	{ TETRA_EV_DF_EVICT,	"EVICT" },
+	{ TETRA_EV_DF_OVERFLOW,	"OVERFLOW" },
+	{ TETRA_EV_DF_FCS_BAD,	"FCS BAD" },
+	{ TETRA_EV_DF_TIMEOUT,	"TIMEOUT" },
+	{ TETRA_EV_DF_DUP,	"DUP" },
+	{ 0, NULL }
+};
+
+const char *tetra_get_ev_defrag_name(uint8_t kind)
+{
+	return get_value_string(ev_defrag_names, kind);
+}
@@ -0,0 +1,155 @@
+#ifndef TETRA_EVENT_H
+#define TETRA_EVENT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Binary decoder event stream.
+ *
+ * A file starts with a struct tetra_ev_file_hdr, followed by records
+ * consisting of a struct tetra_ev_hdr and 'len' bytes of payload.  All
+ * integers are in host byte order, the magic tells the reader which one
+ * that was.  Records of unknown type can be skipped by their length, new
+ * fields are only ever appended to the end of a payload. */
+
+#define TETRA_EV_MAGIC		0x54455631	/* "TEV1" */
+#define TETRA_EV_VERSION	2
+
+struct tetra_ev_file_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_len;	/* sizeof(struct tetra_ev_hdr) */
+} __attribute__((packed));
+
+enum tetra_ev_type {
+	TETRA_EV_BURST		= 1,	/* struct tetra_ev_burst */
+	TETRA_EV_BLOCK		= 2,	/* struct tetra_ev_block + type-1 bits */
+	TETRA_EV_SYNC		= 3,	/* struct tetra_ev_sync */
+	TETRA_EV_SYSINFO	= 4,	/* struct tetra_ev_sysinfo */
+	TETRA_EV_PDU		= 5,	/* struct tetra_ev_pdu + PDU bits */
+	TETRA_EV_DEFRAG		= 6,	/* struct tetra_ev_defrag */
+};
+
+struct tetra_ev_hdr {
+	uint8_t type;		/* enum tetra_ev_type */
+	uint8_t flags;		/* reserved, 0 */
+	uint16_t len;		/* length of the payload in bytes */
+	uint32_t ts;		/* low 32 bits of the TDMA slot counter */
+} __attribute__((packed));
+
+struct tetra_ev_burst {
+	uint8_t train_seq;	/* enum tetra_train_seq, 0xff if not found */
+	uint8_t locked;		/* burst synchronizer was locked before */
+	uint16_t offset;	/* bit offset of the training sequence */
+} __attribute__((packed));
+
+/* the type-1 bits follow packed, MSB first */
+struct tetra_ev_block {
+	uint8_t blk_type;	/* enum tp_sap_data_type */
+	uint8_t lchan;		/* enum tetra_log_chan */
+	uint8_t crc_ok;
+	uint8_t reserved;
+	uint16_t crc;		/* computed CRC, 0 for blocks without CRC */
+	uint16_t num_bits;
+} __attribute__((packed));
+
+struct tetra_ev_sync {
+	uint16_t mcc;
+	uint16_t mnc;
+	uint8_t colour_code;
+	uint8_t tn;
+	uint8_t fn;
+	uint8_t mn;
+} __attribute__((packed));
+
+struct tetra_ev_sysinfo {
+	uint32_t dl_freq;	/* Hz */
+	uint32_t ul_freq;	/* Hz */
+	uint16_t service_details;
+	uint16_t hf_or_cck;	/* hyperframe number or CCK ID */
+	uint8_t cck_valid;	/* hf_or_cck is a CCK ID */
+	uint8_t reserved[3];
+} __attribute__((packed));
+
+enum tetra_ev_proto {
+	TETRA_EV_P_MAC_RESOURCE	= 1,	/* pdu_type: encryption mode, aux: length */
+	TETRA_EV_P_MAC_SUPPL	= 2,
+	TETRA_EV_P_MAC_FRAG	= 3,	/* aux: 1 for MAC-END */
+	TETRA_EV_P_LLC		= 4,	/* pdu_type: enum tllc_pdut_dec, aux: N(S)<<8 | S(S) */
+	TETRA_EV_P_TL_SDU	= 5,	/* pdu_type: MLE pdisc, aux: PDU type in the pdisc */
+};
+
+/* the bits of the PDU follow packed, MSB first */
+struct tetra_ev_pdu {
+	uint8_t proto;		/* enum tetra_ev_proto */
+	uint8_t pdu_type;
+	uint16_t num_bits;
+	uint32_t addr;		/* SSI, or (1 << 24) | event label */
+	uint32_t aux;
+} __attribute__((packed));
+
+enum tetra_ev_defrag_kind {
+	TETRA_EV_DF_APPEND,
+	TETRA_EV_DF_MISS,
+	TETRA_EV_DF_REMOVE,
+	TETRA_EV_DF_EVICT,
+	TETRA_EV_DF_OVERFLOW,
+	TETRA_EV_DF_FCS_BAD,
+	TETRA_EV_DF_TIMEOUT,
+	TETRA_EV_DF_DUP,
+};
+
+struct tetra_ev_defrag {
+	uint8_t kind;		/* enum tetra_ev_defrag_kind */
+	uint8_t ns;
+	uint8_t ss;
+	uint8_t reserved;
+	uint32_t addr;
+} __attribute__((packed));
+
+/* maximum payload of a single record */
+#define TETRA_EV_MAX_PAYLOAD	1024
+
+/* 0 if no event file is open, so callers can skip building events */
+extern int tetra_event_active;
+
+/* start writing events to 'path', buffering 'buf_size' bytes (0 for the
+ * default of 64 KiB) between write() calls */
+int tetra_event_open(const char *path, unsigned int buf_size);
+
+/* write what is buffered and close the file */
+void tetra_event_close(void);
+
+/* set the TDMA time of the following records */
+void tetra_event_set_time(uint64_t slot);
+
+/* append a record, followed by 'num_bits' unpacked bits packed MSB first */
+int tetra_event_put(enum tetra_ev_type type, const void *payload, unsigned int len,
+		    const uint8_t *bits, unsigned int num_bits);
+
+void tetra_event_defrag(enum tetra_ev_defrag_kind kind, uint32_t addr,
+			uint8_t ns, uint8_t ss);
+
+/* read and check the file header, -EINVAL if 'f' is no event file and
+ * -EPROTONOSUPPORT for versions newer than this reader */
+int tetra_event_read_hdr(FILE *f, struct tetra_ev_file_hdr *fh);
+
+/* read the next record into 'eh' and 'payload', which holds up to 65535
+ * bytes.  Returns 1 for a record, 0 at the end of the file, or -EIO if
+ * the file ends within a record */
+int tetra_event_read(FILE *f, const struct tetra_ev_file_hdr *fh,
+		     struct tetra_ev_hdr *eh, uint8_t *payload);
+
+/* 1 if the payload of a known record type is long enough for its bits */
+int tetra_event_valid(const struct tetra_ev_hdr *eh, const uint8_t *payload);
+
+/* the TDMA slot counter of the timestamp of a record in a file of
+ * 'version'.  Version 1 counted frames as (HN * 60 + MN) * 18 + FN with
+ * MN and FN from 1 and TN from 0, which puts it 76 timeslots ahead. */
+uint64_t tetra_event_ts2slot(uint16_t version, uint32_t ts);
+
+const char *tetra_get_ev_type_name(uint8_t type);
+const char *tetra_get_ev_proto_name(uint8_t proto);
+const char *tetra_get_ev_defrag_name(uint8_t kind);
+
+#endif /* TETRA_EVENT_H */
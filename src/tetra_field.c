@@ -0,0 +1,150 @@
+/* Table driven PDU field decoder */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "tetra_common.h"
+#include "tetra_field.h"
+
+static int field_present(const struct tetra_field_desc *fd, const uint32_t *vals)
+{
+	uint32_t v;
+
+	if (fd->cond == TF_C_ALWAYS)
+		return 1;
+
+	v = vals[fd->cond_idx];
+	switch (fd->cond) {
+	case TF_C_EQ:
+		return v == fd->cond_val;
+	case TF_C_NE:
+		return v != fd->cond_val;
+	case TF_C_IN:
+		return v < 32 && ((1 << v) & fd->cond_val);
+	}
+	return 0;
+}
+
+static void field_store(void *out, const struct tetra_field_desc *fd, uint32_t v)
+{
+	uint8_t *p = (uint8_t *)out + fd->offset;
+
+	switch (fd->size) {
+	case 1: {
+		uint8_t u8 = v;
+		memcpy(p, &u8, 1);
+		break;
+	}
+	case 2: {
+		uint16_t u16 = v;
+		memcpy(p, &u16, 2);
+		break;
+	}
+	case 4:
+		memcpy(p, &v, 4);
+		break;
+	}
+}
+
+static uint32_t field_load(const void *in, const struct tetra_field_desc *fd)
+{
+	const uint8_t *p = (const uint8_t *)in + fd->offset;
+	uint8_t u8;
+	uint16_t u16;
+	uint32_t u32 = 0;
+
+	switch (fd->size) {
+	case 1:
+		memcpy(&u8, p, 1);
+		return u8;
+	case 2:
+		memcpy(&u16, p, 2);
+		return u16;
+	case 4:
+		memcpy(&u32, p, 4);
+		break;
+	}
+	return u32;
+}
+
+int tetra_field_decode(const struct tetra_field_desc *desc, unsigned int num,
+		       const uint8_t *bits, void *out, uint32_t *vals)
+{
+	uint32_t _vals[TF_MAX_FIELDS];
+	const uint8_t *cur = bits;
+	unsigned int i;
+
+	if (num > TF_MAX_FIELDS)
+		return -EINVAL;
+	if (!vals)
+		vals = _vals;
+
+	for (i = 0; i < num; i++) {
+		const struct tetra_field_desc *fd = &desc[i];
+
+		vals[i] = 0;
+		if (!field_present(fd, vals))
+			continue;
+
+		vals[i] = bits_to_uint(cur, fd->bits);
+		cur += fd->bits;
+
+		if (fd->offset != TF_NO_STORE)
+			field_store(out, fd, vals[i]);
+	}
+
+	return cur - bits;
+}
+
+int tetra_field_encode(const struct tetra_field_desc *desc, unsigned int num,
+		       const void *in, const uint32_t *vals, uint8_t *bits)
+{
+	uint32_t cur_vals[TF_MAX_FIELDS];
+	uint8_t *cur = bits;
+	unsigned int i;
+
+	if (num > TF_MAX_FIELDS)
+		return -EINVAL;
+
+	for (i = 0; i < num; i++) {
+		const struct tetra_field_desc *fd = &desc[i];
+		uint32_t v;
+
+		cur_vals[i] = 0;
+		if (!field_present(fd, cur_vals))
+			continue;
+
+		if (fd->offset != TF_NO_STORE)
+			v = field_load(in, fd);
+		else
+			v = vals ? vals[i] : 0;
+		if (fd->bits < 32)
+			v &= (1U << fd->bits) - 1;
+		/* conditions see the value as it will be decoded */
+		cur_vals[i] = v;
+
+		uint_to_bits(v, fd->bits, cur);
+		cur += fd->bits;
+	}
+
+	return cur - bits;
+}
@@ -0,0 +1,66 @@
+#ifndef TETRA_FIELD_H
+#define TETRA_FIELD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Table driven decoding (and encoding) of the bit fields of an air
+ * interface PDU.
+ *
+ * A PDU is described as an array of struct tetra_field_desc, decoded in
+ * order.  A field may be conditional on the value of an earlier field of
+ * the same table (referenced by its index); fields which are not present
+ * count as value 0 for the conditions of later fields, which makes nested
+ * optional elements work without further ado. */
+
+enum tetra_field_cond {
+	TF_C_ALWAYS,
+	TF_C_EQ,	/* present if field[cond_idx] == cond_val */
+	TF_C_NE,	/* present if field[cond_idx] != cond_val */
+	TF_C_IN,	/* present if (1 << field[cond_idx]) & cond_val */
+};
+
+#define TF_NO_STORE	0xffff
+
+struct tetra_field_desc {
+	uint8_t bits;		/* width of the field, 0..32 */
+	uint8_t cond;		/* enum tetra_field_cond */
+	uint8_t cond_idx;	/* index of the controlling field */
+	uint32_t cond_val;
+	uint16_t offset;	/* of the member in the decoded struct */
+	uint8_t size;		/* of the member: 1, 2 or 4 bytes */
+};
+
+#define _TF_MEMB(type, memb) \
+	.offset = offsetof(type, memb), .size = sizeof(((type *)0)->memb)
+
+/* unconditional field, stored in 'memb' */
+#define TF(type, memb, _bits) \
+	{ .bits = _bits, _TF_MEMB(type, memb) }
+/* conditional field, stored in 'memb' */
+#define TF_IF(type, memb, _bits, _cond, idx, val) \
+	{ .bits = _bits, .cond = _cond, .cond_idx = idx, .cond_val = val, \
+	  _TF_MEMB(type, memb) }
+/* field which is only decoded to be skipped or used in conditions */
+#define TF_SKIP(_bits) \
+	{ .bits = _bits, .offset = TF_NO_STORE }
+#define TF_SKIP_IF(_bits, _cond, idx, val) \
+	{ .bits = _bits, .cond = _cond, .cond_idx = idx, .cond_val = val, \
+	  .offset = TF_NO_STORE }
+
+#define TF_MAX_FIELDS	64
+
+/* Decode 'num' fields described by 'desc' from the unpacked bits at 'bits'
+ * into the struct at 'out'.  The value of every field (0 if not present)
+ * is returned in 'vals' unless it is NULL.  Returns the number of bits
+ * consumed. */
+int tetra_field_decode(const struct tetra_field_desc *desc, unsigned int num,
+		       const uint8_t *bits, void *out, uint32_t *vals);
+
+/* The reverse: encode the fields present in the struct at 'in' into
+ * unpacked bits.  Fields which are not stored take their value from
+ * 'vals', or 0 if it is NULL.  Returns the number of bits written. */
+int tetra_field_encode(const struct tetra_field_desc *desc, unsigned int num,
+		       const void *in, const uint32_t *vals, uint8_t *bits);
+
+#endif /* TETRA_FIELD_H */
@@ -0,0 +1,233 @@
+/* Subscriber / PDU filter of the upper MAC */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+#include "tetra_common.h"
+#include "tetra_filter.h"
+#include "tetra_mle_pdu.h"
+
+/* parse one number, or a range "lo-hi" if 'hi' is not NULL */
+static int parse_num(const char *tok, uint32_t *lo, uint32_t *hi)
+{
+	char *end;
+
+	*lo = strtoul(tok, &end, 0);
+	if (end == tok)
+		return -EINVAL;
+	if (hi) {
+		*hi = *lo;
+		if (*end == '-') {
+			tok = end + 1;
+			*hi = strtoul(tok, &end, 0);
+			if (end == tok || *hi < *lo)
+				return -EINVAL;
+		}
+	}
+	return *end == '\0' ? 0 : -EINVAL;
+}
+
+static int parse_pdisc(const char *tok, uint32_t *val)
+{
+	unsigned int i;
+
+	for (i = 0; i < 8; i++) {
+		if (!strcasecmp(tok, tetra_get_mle_pdisc_name(i))) {
+			*val = i;
+			return 0;
+		}
+	}
+	return parse_num(tok, val, NULL);
+}
+
+static int add_one(struct tetra_filter *flt, char what, const char *tok)
+{
+	uint32_t lo, hi;
+	int rc;
+
+	switch (what) {
+	case 's':
+		if (flt->num_ssi >= TETRA_FILTER_MAX_SSI)
+			return -ENOSPC;
+		rc = parse_num(tok, &lo, &hi);
+		if (rc < 0 || hi > 0xffffff)
+			return -EINVAL;
+		flt->ssi[flt->num_ssi].lo = lo;
+		flt->ssi[flt->num_ssi].hi = hi;
+		flt->num_ssi++;
+		return 0;
+	case 'a':
+		rc = parse_num(tok, &lo, NULL);
+		if (rc < 0 || lo > 7)
+			return -EINVAL;
+		flt->addr_types |= 1 << lo;
+		return 0;
+	case 'p':
+		rc = parse_pdisc(tok, &lo);
+		if (rc < 0 || lo > 7)
+			return -EINVAL;
+		flt->mle_pdisc |= 1 << lo;
+		return 0;
+	case 'c':
+		rc = parse_num(tok, &lo, NULL);
+		if (rc < 0 || lo > 31)
+			return -EINVAL;
+		flt->cmce_pdut |= 1 << lo;
+		return 0;
+	case 'm':
+		rc = parse_num(tok, &lo, NULL);
+		if (rc < 0 || lo > 15)
+			return -EINVAL;
+		flt->mm_pdut |= 1 << lo;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+int tetra_filter_add(struct tetra_filter *flt, char what, const char *arg)
+{
+	char buf[256], *tok, *save;
+	int rc;
+
+	if (strlen(arg) >= sizeof(buf))
+		return -EINVAL;
+	strcpy(buf, arg);
+
+	for (tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+		rc = add_one(flt, what, tok);
+		if (rc < 0)
+			return rc;
+	}
+	return 0;
+}
+
+int tetra_filter_active(const struct tetra_filter *flt)
+{
+	return flt->num_ssi || flt->addr_types || flt->mle_pdisc ||
+	       flt->cmce_pdut || flt->mm_pdut;
+}
+
+static int ssi_match(const struct tetra_filter *flt, uint32_t ssi)
+{
+	unsigned int i;
+
+	for (i = 0; i < flt->num_ssi; i++) {
+		if (ssi >= flt->ssi[i].lo && ssi <= flt->ssi[i].hi)
+			return 1;
+	}
+	return 0;
+}
+
+static int label_match(const struct tetra_filter *flt, uint16_t label)
+{
+	unsigned int i;
+
+	for (i = 0; i < flt->num_label; i++) {
+		if (flt->label[i] == label)
+			return 1;
+	}
+	return 0;
+}
+
+static void label_add(struct tetra_filter *flt, uint16_t label)
+{
+	if (label_match(flt, label))
+		return;
+	flt->label[flt->next_label] = label;
+	flt->next_label = (flt->next_label + 1) % TETRA_FILTER_MAX_LABELS;
+	if (flt->num_label < TETRA_FILTER_MAX_LABELS)
+		flt->num_label++;
+}
+
+static int addr_match(struct tetra_filter *flt, const struct tetra_addr *addr)
+{
+	if (flt->addr_types && !(flt->addr_types & (1 << addr->type)))
+		return 0;
+	if (!flt->num_ssi)
+		return 1;
+
+	switch (addr->type) {
+	case ADDR_TYPE_EVENT_LABEL:
+		return label_match(flt, addr->event_label);
+	case ADDR_TYPE_SSI_EVENT:
+	case ADDR_TYPE_SMI_EVENT:
+		if (!ssi_match(flt, addr->ssi))
+			return 0;
+		/* later PDUs of this MS may only carry the label */
+		label_add(flt, addr->event_label);
+		return 1;
+	default:
+		return ssi_match(flt, addr->ssi);
+	}
+}
+
+int tetra_filter_addr(struct tetra_filter *flt, const struct tetra_addr *addr)
+{
+	if (addr_match(flt, addr)) {
+		flt->stats.addr_pass++;
+		return 1;
+	}
+	flt->stats.addr_drop++;
+	return 0;
+}
+
+static int sdu_match(const struct tetra_filter *flt, const uint8_t *bits, unsigned int len)
+{
+	uint8_t pdisc;
+
+	if (!flt->mle_pdisc && !flt->cmce_pdut && !flt->mm_pdut)
+		return 1;
+	if (len < 3)
+		return 0;
+
+	pdisc = bits_to_uint(bits, 3);
+	if (flt->mle_pdisc && !(flt->mle_pdisc & (1 << pdisc)))
+		return 0;
+
+	switch (pdisc) {
+	case TMLE_PDISC_CMCE:
+		if (flt->cmce_pdut)
+			return len >= 3+5 && (flt->cmce_pdut & (1 << bits_to_uint(bits+3, 5)));
+		break;
+	case TMLE_PDISC_MM:
+		if (flt->mm_pdut)
+			return len >= 3+4 && (flt->mm_pdut & (1 << bits_to_uint(bits+3, 4)));
+		break;
+	}
+
+	/* without a PDU type filter of its own, a pdisc only passes if it
+	 * was selected explicitly */
+	return !!flt->mle_pdisc;
+}
+
+int tetra_filter_sdu(struct tetra_filter *flt, const uint8_t *bits, unsigned int len)
+{
+	if (sdu_match(flt, bits, len)) {
+		flt->stats.sdu_pass++;
+		return 1;
+	}
+	flt->stats.sdu_drop++;
+	return 0;
+}
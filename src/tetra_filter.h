@@ -0,0 +1,62 @@
+#ifndef TETRA_FILTER_H
+#define TETRA_FILTER_H
+
+#include <stdint.h>
+
+#include "tetra_mac_pdu.h"
+
+/* Subscriber / PDU filter of the upper MAC.
+ *
+ * The address stage runs right after the MAC-RESOURCE header has been
+ * decoded: blocks for other subscribers are not LLC-parsed, defragmented
+ * or sent to GSMTAP.  The SDU stage runs on each complete TL-SDU and
+ * selects by MLE protocol discriminator and CMCE / MM PDU type.  Every
+ * criterion left empty matches everything. */
+
+#define TETRA_FILTER_MAX_SSI	32
+/* event labels remembered for SSIs which passed the filter */
+#define TETRA_FILTER_MAX_LABELS	16
+
+struct tetra_filter_stats {
+	unsigned int addr_pass;
+	unsigned int addr_drop;
+	unsigned int sdu_pass;
+	unsigned int sdu_drop;
+};
+
+struct tetra_filter {
+	unsigned int num_ssi;
+	struct {
+		uint32_t lo, hi;
+	} ssi[TETRA_FILTER_MAX_SSI];
+	uint32_t addr_types;	/* bit mask of enum tetra_addr_type */
+	uint32_t mle_pdisc;	/* bit mask of enum tetra_mle_pdisc */
+	uint32_t cmce_pdut;	/* bit mask of enum tetra_cmce_pdu_type_d */
+	uint32_t mm_pdut;	/* bit mask of enum tetra_mm_pdu_type_d */
+
+	/* event labels assigned to matching SSIs, they address the same MS */
+	uint16_t label[TETRA_FILTER_MAX_LABELS];
+	unsigned int num_label, next_label;
+
+	struct tetra_filter_stats stats;
+};
+
+/* add the criteria in 'arg' to the filter.  'what' is one of
+ *  's': SSI ranges, e.g. "1000-1999,2342"
+ *  'a': address types, by number
+ *  'p': MLE protocol discriminators, by name or number
+ *  'c': CMCE PDU types, by number
+ *  'm': MM PDU types, by number
+ * returns -EINVAL for malformed arguments */
+int tetra_filter_add(struct tetra_filter *flt, char what, const char *arg);
+
+/* is the filter configured at all? */
+int tetra_filter_active(const struct tetra_filter *flt);
+
+/* 1 if the MAC PDU addressed to 'addr' is to be decoded further */
+int tetra_filter_addr(struct tetra_filter *flt, const struct tetra_addr *addr);
+
+/* 1 if the TL-SDU of 'len' bits is to be decoded further */
+int tetra_filter_sdu(struct tetra_filter *flt, const uint8_t *bits, unsigned int len);
+
+#endif /* TETRA_FILTER_H */
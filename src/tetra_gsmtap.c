@@ -1,18 +1,27 @@
 
+#define _GNU_SOURCE
 #include <stdint.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
+#include <osmocom/core/utils.h>
 #include <osmocom/core/msgb.h>
 #include <osmocom/core/gsmtap.h>
 #include <osmocom/core/gsmtap_util.h>
 #include <osmocom/core/bits.h>
+#include <osmocom/core/talloc.h>
 #include <netinet/in.h>
 
 #include "tetra_common.h"
 #include "tetra_tdma.h"
+#include "tetra_gsmtap.h"
 
 static struct gsmtap_inst *g_gti = NULL;
 
@@ -28,13 +37,13 @@ static const uint8_t lchan2gsmtap[] = {
 };
 
 
-struct msgb *tetra_gsmtap_makemsg(struct tetra_tdma_time *tm, enum tetra_log_chan lchan,
+struct msgb *tetra_gsmtap_makemsg(uint64_t tdma_slot, enum tetra_log_chan lchan,
 				  uint8_t ts, uint8_t ss, int8_t signal_dbm,
 				  uint8_t snr, const ubit_t *bitdata, unsigned int bitlen)
 {
 	struct msgb *msg;
 	struct gsmtap_hdr *gh;
-	uint32_t fn = tetra_tdma_time2fn(tm);
+	uint32_t fn = tetra_tdma_slot2gsmtap_fn(tdma_slot);
 	unsigned int packed_len = osmo_pbit_bytesize(bitlen);
 	uint8_t *dst;
 
@@ -65,8 +74,499 @@ int tetra_gsmtap_sendmsg(struct msgb *msg)
 {
 	if (g_gti)
 		return gsmtap_sendmsg(g_gti, msg);
+
+	/* no sink, nobody else frees it */
+	msgb_free(msg);
+	return 0;
+}
+
+/* Batched output.  Messages are formatted from per-lchan header templates
+ * into a preallocated ring and published to a sender thread once per TDMA
+ * frame or when a batch is full.  If the input stalls, the sender publishes
+ * what is left itself after GSMTAP_FLUSH_MS.  It transmits everything
+ * published with sendmmsg() and/or appends it to a pcapng file. */
+
+#define GSMTAP_RING_LEN		1024	/* power of two */
+#define GSMTAP_BATCH		64
+#define GSMTAP_MAX_DATA		64	/* bytes, enough for 432 bits */
+#define GSMTAP_FLUSH_TS		4	/* publish at least once per frame */
+#define GSMTAP_FLUSH_MS		100	/* or after this long without input */
+
+struct gsmtap_slot {
+	struct gsmtap_hdr hdr;
+	uint8_t data[GSMTAP_MAX_DATA];
+	uint16_t data_len;
+	uint32_t tdma_ts;	/* low 32 bits of the TDMA slot counter */
+	uint64_t ns;		/* wall clock time from the input, 0 if unknown */
+};
+
+#define GSMTAP_FILE_BUF		(1024*1024)
+
+/* pcapng file sink, only used from the sender thread once running */
+struct gsmtap_file {
+	char *path;
+	int fd;
+	unsigned int seq;	/* number of the current file */
+	uint64_t rotate;	/* start a new file after this many bytes, 0: never */
+	uint64_t size;		/* bytes in the current file */
+	uint8_t *buf;
+	unsigned int buf_len;
+	unsigned int buf_msgs;	/* messages in buf */
+	unsigned int written;	/* messages written, not yet in the stats */
+	unsigned int lost;	/* messages lost, not yet in the stats */
+	/* TDMA time and wall clock of the first message */
+	int have_t0;
+	uint32_t ts0;
+	uint64_t t0_ns;
+	uint16_t ip_id;
+};
+
+static struct {
+	int fd;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int running;
+
+	/* slots [tail, pub) belong to the sender, [pub, head) are filled
+	 * but not yet published, the rest belongs to the producer.  head is
+	 * only written by the producer, pub under the lock by both */
+	unsigned int head, pub, tail;
+	uint32_t pub_ts;	/* TDMA time of the last publication */
+
+	struct gsmtap_hdr tmpl[ARRAY_SIZE(lchan2gsmtap)];
+	struct tetra_gsmtap_stats stats;
+	struct gsmtap_file *file;
+	struct gsmtap_slot ring[GSMTAP_RING_LEN];
+} g_batch = {
+	.fd = -1,
+};
+
+#define RING_IDX(x)	((x) & (GSMTAP_RING_LEN-1))
+
+static void batch_publish(void)
+{
+	if (__atomic_load_n(&g_batch.pub, __ATOMIC_RELAXED) == g_batch.head)
+		return;
+
+	pthread_mutex_lock(&g_batch.lock);
+	__atomic_store_n(&g_batch.pub, g_batch.head, __ATOMIC_RELAXED);
+	pthread_cond_signal(&g_batch.cond);
+	pthread_mutex_unlock(&g_batch.lock);
+}
+
+static unsigned int batch_send(unsigned int tail, unsigned int n)
+{
+	struct mmsghdr mmsg[GSMTAP_BATCH];
+	struct iovec iov[GSMTAP_BATCH][2];
+	unsigned int i, sent = 0;
+	int rc;
+
+	memset(mmsg, 0, sizeof(mmsg[0]) * n);
+	for (i = 0; i < n; i++) {
+		struct gsmtap_slot *slot = &g_batch.ring[RING_IDX(tail + i)];
+
+		iov[i][0].iov_base = &slot->hdr;
+		iov[i][0].iov_len = sizeof(slot->hdr);
+		iov[i][1].iov_base = slot->data;
+		iov[i][1].iov_len = slot->data_len;
+		mmsg[i].msg_hdr.msg_iov = iov[i];
+		mmsg[i].msg_hdr.msg_iovlen = 2;
+	}
+
+	while (sent < n) {
+		rc = sendmmsg(g_batch.fd, mmsg + sent, n - sent, 0);
+		if (rc <= 0)
+			break;
+		sent += rc;
+	}
+
+	return sent;
+}
+
+/* pcapng, draft-ietf-opsawg-pcapng */
+#define PCAPNG_SHB		0x0A0D0D0A
+#define PCAPNG_IDB		0x00000001
+#define PCAPNG_EPB		0x00000006
+#define PCAPNG_BO_MAGIC		0x1A2B3C4D
+#define PCAPNG_LINKTYPE_RAW	101
+#define PCAPNG_OPT_TSRESOL	9
+
+/* GSMTAP is framed as IPv4/UDP from and to 127.0.0.1 */
+#define GSMTAP_IP_HDR_LEN	(20 + 8)
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+	memcpy(p, &v, 2);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+	memcpy(p, &v, 4);
+}
+
+/* write out the buffer, its messages are counted as written or lost */
+static int file_flush(struct gsmtap_file *gf)
+{
+	unsigned int done = 0;
+	ssize_t rc;
+	int err = 0;
+
+	while (done < gf->buf_len) {
+		rc = write(gf->fd, gf->buf + done, gf->buf_len - done);
+		if (rc < 0 && errno == EINTR)
+			continue;
+		if (rc <= 0) {
+			err = rc < 0 ? -errno : -EIO;
+			break;
+		}
+		done += rc;
+	}
+	gf->size += done;
+
+	if (err) {
+		if (!gf->lost)
+			fprintf(stderr, "GSMTAP: cannot write %s: %s\n", gf->path,
+				strerror(-err));
+		gf->lost += gf->buf_msgs;
+	} else
+		gf->written += gf->buf_msgs;
+	gf->buf_len = 0;
+	gf->buf_msgs = 0;
+
+	return err;
+}
+
+/* open the next file and write section header and interface description */
+static int file_open_next(struct gsmtap_file *gf)
+{
+	uint8_t *p;
+	char *name;
+
+	if (gf->fd >= 0) {
+		/* a failure is counted, the next file may work */
+		file_flush(gf);
+		close(gf->fd);
+		gf->fd = -1;
+		gf->seq++;
+	}
+
+	if (gf->rotate)
+		name = talloc_asprintf(NULL, "%s.%u", gf->path, gf->seq);
 	else
+		name = talloc_strdup(NULL, gf->path);
+	gf->fd = open(name, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	talloc_free(name);
+	if (gf->fd < 0)
+		return -errno;
+	gf->size = 0;
+
+	/* section header block */
+	p = gf->buf + gf->buf_len;
+	put_u32(p, PCAPNG_SHB);
+	put_u32(p+4, 28);
+	put_u32(p+8, PCAPNG_BO_MAGIC);
+	put_u16(p+12, 1);
+	put_u16(p+14, 0);
+	put_u32(p+16, 0xffffffff);	/* section length unknown */
+	put_u32(p+20, 0xffffffff);
+	put_u32(p+24, 28);
+	p += 28;
+
+	/* interface description block, nanosecond timestamps */
+	put_u32(p, PCAPNG_IDB);
+	put_u32(p+4, 32);
+	put_u16(p+8, PCAPNG_LINKTYPE_RAW);
+	put_u16(p+10, 0);
+	put_u32(p+12, 0);		/* no snaplen */
+	put_u16(p+16, PCAPNG_OPT_TSRESOL);
+	put_u16(p+18, 1);
+	put_u32(p+20, 9);		/* 10^-9, padded */
+	put_u32(p+24, 0);		/* opt_endofopt */
+	put_u32(p+28, 32);
+	p += 32;
+
+	gf->buf_len = p - gf->buf;
+
+	return 0;
+}
+
+static uint16_t ip_csum(const uint8_t *hdr)
+{
+	uint32_t sum = 0;
+	int i;
+
+	for (i = 0; i < 20; i += 2)
+		sum += (hdr[i] << 8) | hdr[i+1];
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum;
+}
+
+static int file_add(struct gsmtap_file *gf, const struct gsmtap_slot *slot)
+{
+	unsigned int pkt_len = GSMTAP_IP_HDR_LEN + sizeof(slot->hdr) + slot->data_len;
+	unsigned int blk_len = 28 + ((pkt_len + 3) & ~3) + 4;
+	uint64_t ts_ns;
+	uint16_t csum;
+	uint8_t *p;
+
+	if (slot->ns)
+		ts_ns = slot->ns;
+	else {
+		if (!gf->have_t0) {
+			struct timespec tp;
+
+			clock_gettime(CLOCK_REALTIME, &tp);
+			gf->t0_ns = tp.tv_sec * 1000000000ULL + tp.tv_nsec;
+			gf->ts0 = slot->tdma_ts;
+			gf->have_t0 = 1;
+		}
+		ts_ns = gf->t0_ns + (int64_t)(int32_t)(slot->tdma_ts - gf->ts0) *
+					TETRA_SLOT_NS_NUM / TETRA_SLOT_NS_DEN;
+	}
+
+	/* a failed flush empties the buffer all the same */
+	if (gf->buf_len + blk_len > GSMTAP_FILE_BUF)
+		file_flush(gf);
+	if (gf->rotate && gf->size + gf->buf_len + blk_len > gf->rotate &&
+	    gf->size + gf->buf_len > 28 + 32) {
+		if (file_open_next(gf) < 0)
+			return -EIO;
+	}
+
+	/* enhanced packet block */
+	p = gf->buf + gf->buf_len;
+	memset(p, 0, blk_len);
+	put_u32(p, PCAPNG_EPB);
+	put_u32(p+4, blk_len);
+	put_u32(p+8, 0);
+	put_u32(p+12, ts_ns >> 32);
+	put_u32(p+16, ts_ns);
+	put_u32(p+20, pkt_len);
+	put_u32(p+24, pkt_len);
+	put_u32(p+blk_len-4, blk_len);
+	p += 28;
+
+	/* IPv4 */
+	p[0] = 0x45;
+	p[2] = pkt_len >> 8;
+	p[3] = pkt_len;
+	p[4] = gf->ip_id >> 8;
+	p[5] = gf->ip_id++;
+	p[8] = 64;
+	p[9] = 17;
+	p[12] = p[16] = 127;
+	p[15] = p[19] = 1;
+	csum = ip_csum(p);
+	p[10] = csum >> 8;
+	p[11] = csum;
+	p += 20;
+
+	/* UDP, no checksum */
+	p[0] = p[2] = GSMTAP_UDP_PORT >> 8;
+	p[1] = p[3] = GSMTAP_UDP_PORT & 0xff;
+	p[4] = (pkt_len - 20) >> 8;
+	p[5] = (pkt_len - 20);
+	p += 8;
+
+	memcpy(p, &slot->hdr, sizeof(slot->hdr));
+	memcpy(p + sizeof(slot->hdr), slot->data, slot->data_len);
+
+	gf->buf_len += blk_len;
+	gf->buf_msgs++;
+
+	return 0;
+}
+
+static void batch_write_file(unsigned int tail, unsigned int n)
+{
+	struct gsmtap_file *gf = g_batch.file;
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		if (gf->fd < 0 || file_add(gf, &g_batch.ring[RING_IDX(tail + i)]) < 0)
+			gf->lost++;
+	}
+}
+
+/* with g_batch.lock held */
+static void file_stats(struct gsmtap_file *gf)
+{
+	g_batch.stats.written += gf->written;
+	g_batch.stats.write_err += gf->lost;
+	g_batch.stats.files = gf->seq + 1;
+	gf->written = 0;
+	gf->lost = 0;
+}
+
+static void *gsmtap_thread(void *priv)
+{
+	pthread_mutex_lock(&g_batch.lock);
+	while (1) {
+		unsigned int tail = g_batch.tail, n, sent = 0;
+
+		n = g_batch.pub - tail;
+		if (n == 0) {
+			struct timespec tp;
+
+			if (!g_batch.running)
+				break;
+			clock_gettime(CLOCK_MONOTONIC, &tp);
+			tp.tv_nsec += GSMTAP_FLUSH_MS * 1000000;
+			if (tp.tv_nsec >= 1000000000) {
+				tp.tv_sec++;
+				tp.tv_nsec -= 1000000000;
+			}
+			/* nothing published for a while, take what is there */
+			if (pthread_cond_timedwait(&g_batch.cond, &g_batch.lock, &tp) == ETIMEDOUT)
+				__atomic_store_n(&g_batch.pub, __atomic_load_n(&g_batch.head,
+						 __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+			continue;
+		}
+		if (n > GSMTAP_BATCH)
+			n = GSMTAP_BATCH;
+		pthread_mutex_unlock(&g_batch.lock);
+
+		if (g_batch.fd >= 0)
+			sent = batch_send(tail, n);
+		if (g_batch.file)
+			batch_write_file(tail, n);
+
+		pthread_mutex_lock(&g_batch.lock);
+		if (g_batch.fd >= 0) {
+			g_batch.stats.sent += sent;
+			g_batch.stats.send_err += n - sent;
+			g_batch.stats.syscalls++;
+		}
+		if (g_batch.file)
+			file_stats(g_batch.file);
+		__atomic_store_n(&g_batch.tail, tail + n, __ATOMIC_RELEASE);
+	}
+	if (g_batch.file) {
+		if (g_batch.file->fd >= 0)
+			file_flush(g_batch.file);
+		file_stats(g_batch.file);
+	}
+	pthread_mutex_unlock(&g_batch.lock);
+
+	return NULL;
+}
+
+int tetra_gsmtap_enqueue(uint64_t tdma_slot, enum tetra_log_chan lchan,
+			 uint8_t ts, uint8_t ss, int8_t signal_dbm,
+			 uint8_t snr, const ubit_t *bitdata, unsigned int bitlen)
+{
+	struct gsmtap_slot *slot;
+	uint32_t fn = tetra_tdma_slot2gsmtap_fn(tdma_slot);
+	uint32_t now = tdma_slot;
+
+	if (!g_batch.running) {
+		struct msgb *msg;
+
+		msg = tetra_gsmtap_makemsg(tdma_slot, lchan, ts, ss, signal_dbm,
+					   snr, bitdata, bitlen);
+		if (!msg)
+			return -ENOMEM;
+		return tetra_gsmtap_sendmsg(msg);
+	}
+
+	if (lchan >= ARRAY_SIZE(lchan2gsmtap) ||
+	    osmo_pbit_bytesize(bitlen) > GSMTAP_MAX_DATA) {
+		g_batch.stats.too_long++;
+		return -EINVAL;
+	}
+
+	/* publish what we have once per TDMA frame */
+	if (now - g_batch.pub_ts >= GSMTAP_FLUSH_TS) {
+		batch_publish();
+		g_batch.pub_ts = now;
+	}
+
+	if (g_batch.head - __atomic_load_n(&g_batch.tail, __ATOMIC_ACQUIRE)
+							>= GSMTAP_RING_LEN) {
+		g_batch.stats.dropped++;
+		return -ENOSPC;
+	}
+
+	slot = &g_batch.ring[RING_IDX(g_batch.head)];
+	slot->hdr = g_batch.tmpl[lchan];
+	slot->hdr.timeslot = ts;
+	slot->hdr.sub_slot = ss;
+	slot->hdr.snr_db = snr;
+	slot->hdr.signal_dbm = signal_dbm;
+	slot->hdr.frame_number = htonl(fn);
+	slot->data_len = osmo_ubit2pbit(slot->data, bitdata, bitlen);
+	slot->tdma_ts = now;
+	slot->ns = t_phy_state.clock.valid ?
+			tetra_tdma_slot2ns(&t_phy_state.clock, tdma_slot) : 0;
+
+	/* the slot is filled before the sender can see it */
+	__atomic_store_n(&g_batch.head, g_batch.head + 1, __ATOMIC_RELEASE);
+	g_batch.stats.queued++;
+	if (g_batch.head - __atomic_load_n(&g_batch.pub, __ATOMIC_RELAXED) >= GSMTAP_BATCH)
+		batch_publish();
+
+	return 0;
+}
+
+void tetra_gsmtap_flush(void)
+{
+	if (g_batch.running)
+		batch_publish();
+}
+
+static int batch_start(void)
+{
+	pthread_condattr_t attr;
+	unsigned int i;
+
+	if (g_batch.running)
 		return 0;
+
+	for (i = 0; i < ARRAY_SIZE(lchan2gsmtap); i++) {
+		struct gsmtap_hdr *gh = &g_batch.tmpl[i];
+
+		memset(gh, 0, sizeof(*gh));
+		gh->version = GSMTAP_VERSION;
+		gh->hdr_len = sizeof(*gh)/4;
+		gh->type = GSMTAP_TYPE_TETRA_I1;
+		gh->sub_type = lchan2gsmtap[i];
+	}
+
+	pthread_mutex_init(&g_batch.lock, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&g_batch.cond, &attr);
+	pthread_condattr_destroy(&attr);
+	g_batch.running = 1;
+	if (pthread_create(&g_batch.thread, NULL, gsmtap_thread, NULL)) {
+		g_batch.running = 0;
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+void tetra_gsmtap_exit(struct tetra_gsmtap_stats *st)
+{
+	if (g_batch.running) {
+		batch_publish();
+		pthread_mutex_lock(&g_batch.lock);
+		g_batch.running = 0;
+		pthread_cond_signal(&g_batch.cond);
+		pthread_mutex_unlock(&g_batch.lock);
+		pthread_join(g_batch.thread, NULL);
+	}
+	if (g_batch.file) {
+		if (g_batch.file->fd >= 0)
+			close(g_batch.file->fd);
+		talloc_free(g_batch.file);
+		g_batch.file = NULL;
+	}
+	if (st)
+		*st = g_batch.stats;
 }
 
 int tetra_gsmtap_init(const char *host, uint16_t port)
@@ -76,5 +576,36 @@ int tetra_gsmtap_init(const char *host, uint16_t port)
 		return -EINVAL;
 	gsmtap_source_add_sink(g_gti);
 
+	if (gsmtap_inst_fd(g_gti) >= 0) {
+		g_batch.fd = gsmtap_inst_fd(g_gti);
+		return batch_start();
+	}
+
 	return 0;
 }
+
+int tetra_gsmtap_file_init(const char *path, uint64_t rotate_bytes)
+{
+	struct gsmtap_file *gf;
+	int rc;
+
+	if (g_batch.file)
+		return -EBUSY;
+
+	gf = talloc_zero(NULL, struct gsmtap_file);
+	if (!gf)
+		return -ENOMEM;
+	gf->path = talloc_strdup(gf, path);
+	gf->buf = talloc_size(gf, GSMTAP_FILE_BUF);
+	gf->rotate = rotate_bytes;
+	gf->fd = -1;
+
+	rc = file_open_next(gf);
+	if (rc < 0) {
+		talloc_free(gf);
+		return rc;
+	}
+	g_batch.file = gf;
+
+	return batch_start();
+}
@@ -2,12 +2,44 @@
 #define TETRA_GSMTAP_H
 #include "tetra_common.h"
 
-struct msgb *tetra_gsmtap_makemsg(struct tetra_tdma_time *tm, enum tetra_log_chan lchan,
+struct msgb *tetra_gsmtap_makemsg(uint64_t tdma_slot, enum tetra_log_chan lchan,
 				  uint8_t ts, uint8_t ss, int8_t signal_dbm,
 				  uint8_t snr, const uint8_t *data, unsigned int len);
 
 int tetra_gsmtap_sendmsg(struct msgb *msg);
 
+struct tetra_gsmtap_stats {
+	unsigned int queued;	/* messages accepted */
+	unsigned int sent;	/* messages sent */
+	unsigned int syscalls;	/* number of sendmmsg() batches */
+	unsigned int dropped;	/* messages dropped as the ring was full */
+	unsigned int too_long;	/* messages which did not fit a ring slot */
+	unsigned int send_err;	/* messages lost due to send errors */
+	unsigned int written;	/* messages written to the pcapng file */
+	unsigned int write_err;	/* messages lost due to write errors */
+	unsigned int files;	/* number of pcapng files */
+};
+
+/* format a GSMTAP message and queue it for batched transmission.  Falls
+ * back to tetra_gsmtap_makemsg() / tetra_gsmtap_sendmsg() if the sender
+ * thread is not running */
+int tetra_gsmtap_enqueue(uint64_t tdma_slot, enum tetra_log_chan lchan,
+			 uint8_t ts, uint8_t ss, int8_t signal_dbm,
+			 uint8_t snr, const uint8_t *data, unsigned int len);
+
+/* hand all queued messages to the sender thread */
+void tetra_gsmtap_flush(void);
+
 int tetra_gsmtap_init(const char *host, uint16_t port);
 
+/* also write all messages to the pcapng file 'path', framed as UDP/IPv4
+ * with timestamps derived from the TDMA time, anchored at the start time
+ * of the input if known (see struct tetra_phy_state).  If 'rotate_bytes'
+ * is not 0, files named <path>.0, <path>.1, ... of at most that size are
+ * written.  Has to be called before the first message is queued */
+int tetra_gsmtap_file_init(const char *path, uint64_t rotate_bytes);
+
+/* send everything queued and stop the sender thread */
+void tetra_gsmtap_exit(struct tetra_gsmtap_stats *st);
+
 #endif
@@ -0,0 +1,451 @@
+/* Runtime selection of CPU specific kernels */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <strings.h>
+#include <math.h>
+
+#include <osmocom/core/utils.h>
+
+#include <tetra_kernel.h>
+#include <tetra_common.h>
+#include <lower_mac/crc_simple.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/tetra_interleave.h>
+#include <lower_mac/viterbi_cch.h>
+
+static const struct tetra_kernels kernels_c = {
+	.viterbi_cch	= viterbi_cch_decode,
+	.find_seq	= tetra_find_seq,
+	.crc16		= crc16_itut_bits,
+	.scramb		= tetra_scramb_bits,
+	.gather		= tetra_perm_gather,
+	.fir_cf		= tetra_fir_cf,
+	.mac_cf		= tetra_mac_cf,
+	.slice		= tetra_slice_bits,
+	.slice_soft	= tetra_slice_soft,
+	.cvt_iq		= tetra_cvt_iq,
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_KERNELS
+/* in tetra_kernel_x86.c, members left NULL fall back to the next lower ISA */
+extern const struct tetra_kernels tetra_kernels_sse2;
+extern const struct tetra_kernels tetra_kernels_avx2;
+extern const struct tetra_kernels tetra_kernels_avx512;
+void tetra_kernel_x86_init(void);
+
+static const struct tetra_kernels *kernels_isa[_NUM_TETRA_ISA] = {
+	[TETRA_ISA_SCALAR]	= &kernels_c,
+	[TETRA_ISA_SSE2]	= &tetra_kernels_sse2,
+	[TETRA_ISA_AVX2]	= &tetra_kernels_avx2,
+	[TETRA_ISA_AVX512]	= &tetra_kernels_avx512,
+};
+#else
+static const struct tetra_kernels *kernels_isa[_NUM_TETRA_ISA] = {
+	[TETRA_ISA_SCALAR]	= &kernels_c,
+};
+#endif
+
+struct tetra_kernels tetra_kern = {
+	.viterbi_cch	= viterbi_cch_decode,
+	.find_seq	= tetra_find_seq,
+	.crc16		= crc16_itut_bits,
+	.scramb		= tetra_scramb_bits,
+	.gather		= tetra_perm_gather,
+	.fir_cf		= tetra_fir_cf,
+	.mac_cf		= tetra_mac_cf,
+	.slice		= tetra_slice_bits,
+	.slice_soft	= tetra_slice_soft,
+	.cvt_iq		= tetra_cvt_iq,
+};
+
+static enum tetra_kernel_isa cur_isa = TETRA_ISA_SCALAR;
+
+static const struct value_string isa_names[] = {
+	{ TETRA_ISA_SCALAR,	"scalar" },
+	{ TETRA_ISA_SSE2,	"sse2" },
+	{ TETRA_ISA_AVX2,	"avx2" },
+	{ TETRA_ISA_AVX512,	"avx512" },
+	{ 0, NULL }
+};
+
+const char *tetra_kernel_isa_name(enum tetra_kernel_isa isa)
+{
+	return get_value_string(isa_names, isa);
+}
+
+enum tetra_kernel_isa tetra_kernel_isa(void)
+{
+	return cur_isa;
+}
+
+enum tetra_kernel_isa tetra_kernel_cpu_isa(void)
+{
+#ifdef HAVE_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+		return TETRA_ISA_AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return TETRA_ISA_AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return TETRA_ISA_SSE2;
+#endif
+	return TETRA_ISA_SCALAR;
+}
+
+#define PICK(member) \
+	do { \
+		int i; \
+		for (i = isa; i >= 0; i--) { \
+			if (kernels_isa[i] && kernels_isa[i]->member) { \
+				k.member = kernels_isa[i]->member; \
+				break; \
+			} \
+		} \
+	} while (0)
+
+int tetra_kernel_select(enum tetra_kernel_isa isa)
+{
+	struct tetra_kernels k;
+
+	if (isa >= _NUM_TETRA_ISA || isa > tetra_kernel_cpu_isa())
+		return -EINVAL;
+
+#ifdef HAVE_X86_KERNELS
+	tetra_kernel_x86_init();
+#endif
+	PICK(viterbi_cch);
+	PICK(find_seq);
+	PICK(crc16);
+	PICK(scramb);
+	PICK(gather);
+	PICK(fir_cf);
+	PICK(mac_cf);
+	PICK(slice);
+	PICK(slice_soft);
+	PICK(cvt_iq);
+
+	tetra_kern = k;
+	cur_isa = isa;
+
+	return 0;
+}
+
+/* Self test: compare against the C reference on random input */
+
+static void rand_bits(uint8_t *out, unsigned int len)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		out[i] = rand() & 1;
+}
+
+static int test_viterbi_cch(void)
+{
+	static const unsigned int lens[] = { 80, 112, 144, 288 };
+	int8_t in[VITERBI_CCH_MAX_STEPS*4];
+	uint8_t out_ref[VITERBI_CCH_MAX_STEPS], out[VITERBI_CCH_MAX_STEPS];
+	unsigned int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(lens); i++) {
+		for (j = 0; j < lens[i]*4; j++)
+			in[j] = (rand() % 255) - 127;
+		viterbi_cch_decode(in, out_ref, lens[i]);
+		tetra_kern.viterbi_cch(in, out, lens[i]);
+		if (memcmp(out, out_ref, lens[i]))
+			return -1;
+	}
+	return 0;
+}
+
+static int test_find_seq(void)
+{
+	uint8_t buf[600], seq[38];
+	int i;
+
+	for (i = 0; i < 64; i++) {
+		unsigned int len = 1 + rand() % sizeof(buf);
+		unsigned int seq_len = 1 + rand() % sizeof(seq);
+
+		rand_bits(buf, len);
+		rand_bits(seq, seq_len);
+		/* plant the sequence in most of the runs */
+		if ((i & 3) && seq_len <= len)
+			memcpy(buf + rand() % (len - seq_len + 1), seq, seq_len);
+		if (tetra_kern.find_seq(buf, len, seq, seq_len) !=
+		    tetra_find_seq(buf, len, seq, seq_len))
+			return -1;
+	}
+	return 0;
+}
+
+static int test_crc16(void)
+{
+	uint8_t buf[512];
+	int len;
+
+	rand_bits(buf, sizeof(buf));
+	for (len = 0; len <= sizeof(buf); len += 1 + rand() % 7) {
+		if (tetra_kern.crc16(0xffff, buf, len) !=
+		    crc16_itut_bits(0xffff, buf, len))
+			return -1;
+	}
+	return 0;
+}
+
+static int test_scramb(void)
+{
+	uint8_t buf[512], ref[512];
+	int len;
+
+	for (len = 0; len <= sizeof(buf); len += 1 + rand() % 7) {
+		uint32_t init = tetra_scramb_get_init(rand(), rand(), rand());
+
+		rand_bits(buf, len);
+		memcpy(ref, buf, len);
+		tetra_scramb_bits(init, ref, len);
+		tetra_kern.scramb(init, buf, len);
+		if (memcmp(buf, ref, len))
+			return -1;
+	}
+	return 0;
+}
+
+static int test_gather(void)
+{
+	static const unsigned int lens[] = { 1, 3, 7, 30, 120, 216, 274, 432 };
+	uint16_t tbl[432];
+	uint8_t in[432], out[432], out_ref[432];
+	unsigned int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(lens); i++) {
+		unsigned int len = lens[i];
+
+		/* random permutation */
+		for (j = 0; j < len; j++)
+			tbl[j] = j;
+		for (j = len - 1; j > 0; j--) {
+			unsigned int k = rand() % (j + 1);
+			uint16_t t = tbl[j];
+			tbl[j] = tbl[k];
+			tbl[k] = t;
+		}
+		for (j = 0; j < len; j++)
+			in[j] = rand();
+		tetra_perm_gather(tbl, len, in, out_ref);
+		tetra_kern.gather(tbl, len, in, out);
+		if (memcmp(out, out_ref, len))
+			return -1;
+	}
+	return 0;
+}
+
+static int test_fir_cf(void)
+{
+	static const unsigned int lens[] = { 1, 2, 3, 7, 8, 64, 129 };
+	float in[2*(129+23)], taps[23], out[2*129], out_ref[2*129];
+	unsigned int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(in); i++)
+		in[i] = (rand() % 2001 - 1000) / 1000.0f;
+	for (i = 0; i < ARRAY_SIZE(lens); i++) {
+		unsigned int ntaps = 1 + rand() % ARRAY_SIZE(taps);
+
+		for (j = 0; j < ntaps; j++)
+			taps[j] = (rand() % 2001 - 1000) / 1000.0f;
+		tetra_fir_cf(in, taps, ntaps, out_ref, lens[i]);
+		tetra_kern.fir_cf(in, taps, ntaps, out, lens[i]);
+		/* the sums may be formed in a different order */
+		for (j = 0; j < 2*lens[i]; j++) {
+			if (fabsf(out[j] - out_ref[j]) > 1e-4f)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+static int test_mac_cf(void)
+{
+	float in[2*67], taps[67], acc[2*67], acc_ref[2*67];
+	unsigned int i, n;
+
+	for (n = 0; n <= ARRAY_SIZE(taps); n += 1 + rand() % 5) {
+		for (i = 0; i < n; i++) {
+			in[2*i] = (rand() % 2001 - 1000) / 1000.0f;
+			in[2*i+1] = (rand() % 2001 - 1000) / 1000.0f;
+			taps[i] = (rand() % 2001 - 1000) / 1000.0f;
+			acc[2*i] = acc_ref[2*i] = (rand() % 2001 - 1000) / 1000.0f;
+			acc[2*i+1] = acc_ref[2*i+1] = (rand() % 2001 - 1000) / 1000.0f;
+		}
+		tetra_mac_cf(in, taps, acc_ref, n);
+		tetra_kern.mac_cf(in, taps, acc, n);
+		if (memcmp(acc, acc_ref, 2 * n * sizeof(*acc)))
+			return -1;
+	}
+	return 0;
+}
+
+/* random symbols, with the thresholds, wrapping points and worse
+ * sprinkled in */
+static void rand_sym(float *sym, unsigned int n)
+{
+	static const float special[] = { 0, -0.0f, 2, -2, 4, -4, 1e-7f, 1e9f, -1e9f,
+					 INFINITY, -INFINITY, NAN };
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		if (rand() % 8)
+			sym[i] = (rand() % 9001 - 4500) / 1000.0f;
+		else
+			sym[i] = special[rand() % ARRAY_SIZE(special)];
+	}
+}
+
+static int test_slice(void)
+{
+	float sym[133];
+	uint8_t bits[2*133], bits_ref[2*133];
+	unsigned int n;
+
+	for (n = 0; n <= ARRAY_SIZE(sym); n += 1 + rand() % 9) {
+		rand_sym(sym, n);
+		tetra_slice_bits(sym, n, bits_ref);
+		tetra_kern.slice(sym, n, bits);
+		if (memcmp(bits, bits_ref, 2 * n))
+			return -1;
+	}
+	return 0;
+}
+
+static int test_slice_soft(void)
+{
+	float sym[133];
+	int8_t soft[2*133], soft_ref[2*133];
+	unsigned int n;
+
+	for (n = 0; n <= ARRAY_SIZE(sym); n += 1 + rand() % 9) {
+		rand_sym(sym, n);
+		tetra_slice_soft(sym, n, soft_ref);
+		tetra_kern.slice_soft(sym, n, soft);
+		if (memcmp(soft, soft_ref, 2 * n))
+			return -1;
+	}
+	return 0;
+}
+
+static int test_cvt_iq(void)
+{
+	static const float scales[] = { 1/128.0f, 1/128.0f, 1/32768.0f, 1 };
+	uint8_t in[8*67];
+	float out[2*67], out_ref[2*67];
+	enum tetra_iq_fmt fmt;
+	unsigned int i, n;
+
+	for (fmt = TETRA_IQ_CU8; fmt <= TETRA_IQ_CF32; fmt++) {
+		float off[2] = { (rand() % 2001 - 1000) / 100.0f, (rand() % 2001 - 1000) / 100.0f };
+
+		for (n = 0; n <= 67; n += 1 + rand() % 5) {
+			float sum[2] = { 0, 0 }, sum_ref[2] = { 0, 0 };
+
+			if (fmt == TETRA_IQ_CF32) {
+				for (i = 0; i < 2*n; i++)
+					((float *) in)[i] = (rand() % 2001 - 1000) / 1000.0f;
+			} else {
+				for (i = 0; i < sizeof(in); i++)
+					in[i] = rand();
+			}
+			tetra_cvt_iq(fmt, in, out_ref, n, off, scales[fmt], sum_ref);
+			tetra_kern.cvt_iq(fmt, in, out, n, off, scales[fmt], sum);
+			for (i = 0; i < 2*n; i++) {
+				if (fabsf(out[i] - out_ref[i]) > 1e-6f)
+					return -1;
+			}
+			/* the sums may be formed in a different order */
+			if (fabsf(sum[0] - sum_ref[0]) > 1e-3f || fabsf(sum[1] - sum_ref[1]) > 1e-3f)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+static const struct {
+	const char *name;
+	int (*test)(void);
+} selftests[] = {
+	{ "viterbi_cch",	test_viterbi_cch },
+	{ "find_seq",		test_find_seq },
+	{ "crc16",		test_crc16 },
+	{ "scramb",		test_scramb },
+	{ "gather",		test_gather },
+	{ "fir_cf",		test_fir_cf },
+	{ "mac_cf",		test_mac_cf },
+	{ "slice",		test_slice },
+	{ "slice_soft",		test_slice_soft },
+	{ "cvt_iq",		test_cvt_iq },
+};
+
+int tetra_kernel_selftest(void)
+{
+	unsigned int i;
+	int num_err = 0;
+
+	for (i = 0; i < ARRAY_SIZE(selftests); i++) {
+		if (selftests[i].test() < 0) {
+			fprintf(stderr, "kernel self-test: %s (%s) FAILED\n",
+				selftests[i].name, tetra_kernel_isa_name(cur_isa));
+			num_err++;
+		}
+	}
+	return num_err;
+}
+
+enum tetra_kernel_isa tetra_kernel_init(void)
+{
+	enum tetra_kernel_isa isa = tetra_kernel_cpu_isa();
+	const char *env = getenv("TETRA_KERNEL");
+
+	if (env && strcasecmp(env, "auto")) {
+		int req = get_string_value(isa_names, env);
+
+		if (req < 0)
+			fprintf(stderr, "TETRA_KERNEL=%s unknown, using %s\n",
+				env, tetra_kernel_isa_name(isa));
+		else if (req > isa)
+			fprintf(stderr, "TETRA_KERNEL=%s not supported by this CPU, "
+				"using %s\n", env, tetra_kernel_isa_name(isa));
+		else
+			isa = req;
+	}
+
+	tetra_kernel_select(isa);
+
+	if (isa != TETRA_ISA_SCALAR && tetra_kernel_selftest()) {
+		fprintf(stderr, "falling back to scalar kernels\n");
+		tetra_kernel_select(TETRA_ISA_SCALAR);
+	}
+
+	return cur_isa;
+}
@@ -0,0 +1,69 @@
+#ifndef TETRA_KERNEL_H
+#define TETRA_KERNEL_H
+
+#include <stdint.h>
+
+#include <tetra_common.h>
+
+/* Instruction set levels we have kernel variants for, in ascending order */
+enum tetra_kernel_isa {
+	TETRA_ISA_SCALAR,
+	TETRA_ISA_SSE2,
+	TETRA_ISA_AVX2,
+	TETRA_ISA_AVX512,
+	_NUM_TETRA_ISA
+};
+
+/* The hot inner loops of the receiver.  Every member has the semantics of
+ * the portable C reference noted next to it. */
+struct tetra_kernels {
+	/* viterbi_cch_decode() */
+	int (*viterbi_cch)(const int8_t *input, uint8_t *output, unsigned int n);
+	/* tetra_find_seq(): correlate for an exact bit sequence */
+	int (*find_seq)(const uint8_t *in, unsigned int len,
+			const uint8_t *seq, unsigned int seq_len);
+	/* crc16_itut_bits() */
+	uint16_t (*crc16)(uint16_t crc, const uint8_t *input, int number_bits);
+	/* tetra_scramb_bits() */
+	int (*scramb)(uint32_t lfsr_init, uint8_t *out, int len);
+	/* tetra_perm_gather() */
+	void (*gather)(const uint16_t *tbl, unsigned int len,
+		       const uint8_t *in, uint8_t *out);
+	/* tetra_fir_cf() */
+	void (*fir_cf)(const float *in, const float *taps, unsigned int ntaps,
+		       float *out, unsigned int n);
+	/* tetra_mac_cf() */
+	void (*mac_cf)(const float *in, const float *taps, float *acc, unsigned int n);
+	/* tetra_slice_bits() */
+	void (*slice)(const float *sym, unsigned int n, uint8_t *bits);
+	/* tetra_slice_soft() */
+	void (*slice_soft)(const float *sym, unsigned int n, int8_t *soft);
+	/* tetra_cvt_iq() */
+	void (*cvt_iq)(enum tetra_iq_fmt fmt, const void *in, float *out, unsigned int n,
+		       const float *off, float scale, float *sum);
+};
+
+/* Kernels currently in use.  Statically initialized to the C reference,
+ * so everything works even if tetra_kernel_init() is never called. */
+extern struct tetra_kernels tetra_kern;
+
+/* Select the best kernels for this CPU (or the ones requested by the
+ * TETRA_KERNEL environment variable) and self-test them against the C
+ * reference.  Returns the ISA level in use. */
+enum tetra_kernel_isa tetra_kernel_init(void);
+
+/* Select the kernels of a given ISA level, without self-test.  Returns
+ * -EINVAL if the CPU does not support it. */
+int tetra_kernel_select(enum tetra_kernel_isa isa);
+
+/* Compare the kernels in use against the C reference on random input.
+ * Returns the number of mismatching kernels. */
+int tetra_kernel_selftest(void);
+
+/* Highest ISA level supported by this CPU and this build */
+enum tetra_kernel_isa tetra_kernel_cpu_isa(void);
+
+enum tetra_kernel_isa tetra_kernel_isa(void);
+const char *tetra_kernel_isa_name(enum tetra_kernel_isa isa);
+
+#endif /* TETRA_KERNEL_H */
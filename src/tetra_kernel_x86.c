@@ -0,0 +1,809 @@
+/* SSE2 / AVX2 / AVX-512 variants of the kernels in tetra_kernel.h */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Everything in here is built without any -m flags; the functions carry
+ * their own target attribute and are only ever called after
+ * tetra_kernel_select() has checked the CPU. */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <stdint.h>
+#include <string.h>
+
+#include <immintrin.h>
+
+#include <tetra_kernel.h>
+#include <tetra_common.h>
+#include <lower_mac/crc_simple.h>
+#include <lower_mac/tetra_scramb.h>
+#include <lower_mac/viterbi_cch.h>
+
+#define TARGET_SSE2	__attribute__((target("sse2")))
+#define TARGET_AVX2	__attribute__((target("avx2")))
+#define TARGET_AVX512	__attribute__((target("avx2,avx512f,avx512bw")))
+
+/* Viterbi: sign of each of the 4 soft bits in the branch metric towards
+ * state s from its predecessor s>>1 */
+static int16_t vit_sign[4][16] __attribute__((aligned(32)));
+
+/* CRC16-CCITT over one MSB-first byte, and LSB-first to MSB-first */
+static uint16_t crc_tbl[256];
+static uint8_t bitrev8[256];
+
+/* scrambling LFSR: the next 32 state bits (= output bits, LSB first) are a
+ * linear function of the current state, applied one byte at a time */
+static uint32_t lfsr_tbl[4][256];
+
+static int initialized;
+
+void tetra_kernel_x86_init(void)
+{
+	uint8_t ks[32];
+	uint32_t basis[32];
+	int i, j, k;
+
+	if (initialized)
+		return;
+
+	for (i = 0; i < 16; i++) {
+		uint8_t o = conv_cch_next_output[i >> 1][i & 1];
+		for (j = 0; j < 4; j++)
+			vit_sign[j][i] = (o >> (3-j)) & 1 ? -1 : 1;
+	}
+
+	for (i = 0; i < 256; i++) {
+		uint16_t crc = i << 8;
+		uint8_t r = 0;
+
+		for (j = 0; j < 8; j++)
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+		crc_tbl[i] = crc;
+
+		for (j = 0; j < 8; j++)
+			r |= ((i >> j) & 1) << (7-j);
+		bitrev8[i] = r;
+	}
+
+	for (i = 0; i < 32; i++) {
+		tetra_scramb_get_bits(1 << i, ks, 32);
+		basis[i] = 0;
+		for (j = 0; j < 32; j++)
+			basis[i] |= (uint32_t)ks[j] << j;
+	}
+	for (k = 0; k < 4; k++) {
+		for (i = 0; i < 256; i++) {
+			uint32_t w = 0;
+			for (j = 0; j < 8; j++) {
+				if (i & (1 << j))
+					w ^= basis[k*8 + j];
+			}
+			lfsr_tbl[k][i] = w;
+		}
+	}
+
+	initialized = 1;
+}
+
+static inline uint32_t lfsr_next32(uint32_t s)
+{
+	return lfsr_tbl[0][s & 0xff] ^ lfsr_tbl[1][(s >> 8) & 0xff] ^
+	       lfsr_tbl[2][(s >> 16) & 0xff] ^ lfsr_tbl[3][s >> 24];
+}
+
+static inline uint16_t crc_byte(uint16_t crc, uint8_t lsb_first)
+{
+	return (crc << 8) ^ crc_tbl[(crc >> 8) ^ bitrev8[lsb_first]];
+}
+
+static void vit_traceback(const uint16_t *dec, uint8_t *output, unsigned int n)
+{
+	unsigned int i, s = 0;
+
+	for (i = n; i > 0; i--) {
+		output[i-1] = s & 1;
+		s = (s >> 1) + ((dec[i-1] >> s) & 1) * 8;
+	}
+}
+
+/***********************************************************************
+ * SSE2
+ ***********************************************************************/
+
+/* All 16 path metrics live in two registers, a = states 0..7 and
+ * b = states 8..15.  State s has the predecessors s>>1 and (s>>1)+8, so
+ * unpacklo/unpackhi of a register with itself line up the predecessors
+ * for states 0..7 resp. 8..15. */
+TARGET_SSE2
+static int viterbi_cch_sse2(const int8_t *input, uint8_t *output, unsigned int n)
+{
+	uint16_t dec[VITERBI_CCH_MAX_STEPS];
+	__m128i s_lo[4], s_hi[4], a, b;
+	unsigned int i, j;
+
+	if (n > VITERBI_CCH_MAX_STEPS)
+		return -1;
+
+	for (j = 0; j < 4; j++) {
+		s_lo[j] = _mm_load_si128((const __m128i *) &vit_sign[j][0]);
+		s_hi[j] = _mm_load_si128((const __m128i *) &vit_sign[j][8]);
+	}
+	a = _mm_insert_epi16(_mm_set1_epi16(VITERBI_CCH_M_INIT), 0, 0);
+	b = _mm_set1_epi16(VITERBI_CCH_M_INIT);
+
+	for (i = 0; i < n; i++) {
+		const int8_t *r = input + i*4;
+		__m128i r0 = _mm_set1_epi16(r[0]), r1 = _mm_set1_epi16(r[1]);
+		__m128i r2 = _mm_set1_epi16(r[2]), r3 = _mm_set1_epi16(r[3]);
+		__m128i bm_lo, bm_hi, m0_lo, m1_lo, m0_hi, m1_hi, n_lo, n_hi, norm;
+
+		bm_lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s_lo[0], r0),
+						    _mm_mullo_epi16(s_lo[1], r1)),
+				      _mm_add_epi16(_mm_mullo_epi16(s_lo[2], r2),
+						    _mm_mullo_epi16(s_lo[3], r3)));
+		bm_hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s_hi[0], r0),
+						    _mm_mullo_epi16(s_hi[1], r1)),
+				      _mm_add_epi16(_mm_mullo_epi16(s_hi[2], r2),
+						    _mm_mullo_epi16(s_hi[3], r3)));
+
+		m0_lo = _mm_add_epi16(_mm_unpacklo_epi16(a, a), bm_lo);
+		m1_lo = _mm_sub_epi16(_mm_unpacklo_epi16(b, b), bm_lo);
+		m0_hi = _mm_add_epi16(_mm_unpackhi_epi16(a, a), bm_hi);
+		m1_hi = _mm_sub_epi16(_mm_unpackhi_epi16(b, b), bm_hi);
+
+		dec[i] = _mm_movemask_epi8(_mm_packs_epi16(_mm_cmpgt_epi16(m1_lo, m0_lo),
+							   _mm_cmpgt_epi16(m1_hi, m0_hi)));
+		n_lo = _mm_max_epi16(m0_lo, m1_lo);
+		n_hi = _mm_max_epi16(m0_hi, m1_hi);
+
+		norm = _mm_set1_epi16(_mm_cvtsi128_si32(n_lo));
+		a = _mm_sub_epi16(n_lo, norm);
+		b = _mm_sub_epi16(n_hi, norm);
+	}
+
+	vit_traceback(dec, output, n);
+
+	return 0;
+}
+
+/* 16 candidate positions at a time, AND-ing the comparison for every
+ * sequence bit and giving up on the block as soon as none is left */
+TARGET_SSE2
+static int find_seq_sse2(const uint8_t *in, unsigned int len,
+			 const uint8_t *seq, unsigned int seq_len)
+{
+	unsigned int i, j;
+	int rc;
+
+	for (i = 0; seq_len && i + 15 + seq_len <= len; i += 16) {
+		__m128i acc = _mm_set1_epi8(-1);
+		unsigned int mask;
+
+		for (j = 0; j < seq_len; j++) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(in + i + j));
+			acc = _mm_and_si128(acc, _mm_cmpeq_epi8(v, _mm_set1_epi8(seq[j])));
+			if ((j & 3) == 3 && !_mm_movemask_epi8(acc))
+				break;
+		}
+		mask = _mm_movemask_epi8(acc);
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+
+	rc = tetra_find_seq(in + i, len - i, seq, seq_len);
+	return rc < 0 ? rc : i + rc;
+}
+
+TARGET_SSE2
+static uint16_t crc16_sse2(uint16_t crc, const uint8_t *input, int number_bits)
+{
+	int i;
+
+	for (i = 0; i + 16 <= number_bits; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(input + i));
+		unsigned int m = _mm_movemask_epi8(_mm_slli_epi16(v, 7));
+
+		crc = crc_byte(crc, m);
+		crc = crc_byte(crc, m >> 8);
+	}
+
+	return crc16_itut_bits(crc, input + i, number_bits - i);
+}
+
+/* 16 keystream bits to 16 ubits */
+TARGET_SSE2
+static inline __m128i expand16_sse2(uint32_t ks)
+{
+	const __m128i sel = _mm_set1_epi64x(0x8040201008040201ULL);
+	__m128i v = _mm_set_epi64x(0x0101010101010101ULL * ((ks >> 8) & 0xff),
+				   0x0101010101010101ULL * (ks & 0xff));
+
+	return _mm_min_epu8(_mm_and_si128(v, sel), _mm_set1_epi8(1));
+}
+
+TARGET_SSE2
+static int scramb_sse2(uint32_t lfsr_init, uint8_t *out, int len)
+{
+	uint32_t lfsr = lfsr_init;
+	int i;
+
+	for (i = 0; i < len; i += 32) {
+		__m128i *o = (__m128i *)(out + i);
+
+		lfsr = lfsr_next32(lfsr);
+		if (i + 32 <= len) {
+			_mm_storeu_si128(o, _mm_xor_si128(_mm_loadu_si128(o),
+							  expand16_sse2(lfsr)));
+			_mm_storeu_si128(o + 1, _mm_xor_si128(_mm_loadu_si128(o + 1),
+							      expand16_sse2(lfsr >> 16)));
+		} else {
+			int j;
+			for (j = 0; i + j < len; j++)
+				out[i + j] ^= (lfsr >> j) & 1;
+		}
+	}
+
+	return 0;
+}
+
+/* complex FIR: one tap at a time into two output samples, which are
+ * adjacent I/Q pairs and so take a single unaligned load */
+TARGET_SSE2
+static void fir_cf_sse2(const float *in, const float *taps, unsigned int ntaps,
+			float *out, unsigned int n)
+{
+	unsigned int i, k;
+
+	for (i = 0; i + 2 <= n; i += 2) {
+		__m128 acc = _mm_setzero_ps();
+
+		for (k = 0; k < ntaps; k++)
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[k]),
+							 _mm_loadu_ps(in + 2*(i+k))));
+		_mm_storeu_ps(out + 2*i, acc);
+	}
+
+	tetra_fir_cf(in + 2*i, taps, ntaps, out + 2*i, n - i);
+}
+
+/* complex multiply-accumulate: four real weights, each spread over an
+ * I/Q pair */
+TARGET_SSE2
+static void mac_cf_sse2(const float *in, const float *taps, float *acc, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		__m128 t = _mm_loadu_ps(taps + i);
+
+		_mm_storeu_ps(acc + 2*i, _mm_add_ps(_mm_loadu_ps(acc + 2*i),
+			_mm_mul_ps(_mm_unpacklo_ps(t, t), _mm_loadu_ps(in + 2*i))));
+		_mm_storeu_ps(acc + 2*i + 4, _mm_add_ps(_mm_loadu_ps(acc + 2*i + 4),
+			_mm_mul_ps(_mm_unpackhi_ps(t, t), _mm_loadu_ps(in + 2*i + 4))));
+	}
+
+	tetra_mac_cf(in + 2*i, taps + i, acc + 2*i, n - i);
+}
+
+/* four vectors of 32 bit lanes, each 0 or -1 or in int8 range, to 16
+ * bytes in order */
+TARGET_SSE2
+static inline __m128i pack4_sse2(__m128i v0, __m128i v1, __m128i v2, __m128i v3)
+{
+	return _mm_packs_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+}
+
+TARGET_SSE2
+static void slice_sse2(const float *sym, unsigned int n, uint8_t *bits)
+{
+	const __m128 zero = _mm_setzero_ps(), two = _mm_set1_ps(2), mtwo = _mm_set1_ps(-2);
+	const __m128i one = _mm_set1_epi8(1);
+	unsigned int i, k;
+
+	for (i = 0; i + 16 <= n; i += 16) {
+		__m128i pos[4], outer[4], b0, b1;
+
+		for (k = 0; k < 4; k++) {
+			__m128 s = _mm_loadu_ps(sym + i + 4*k);
+
+			/* NaN compares false everywhere, as in C */
+			pos[k] = _mm_castps_si128(_mm_cmpgt_ps(s, zero));
+			outer[k] = _mm_castps_si128(_mm_or_ps(_mm_cmpgt_ps(s, two),
+							      _mm_cmplt_ps(s, mtwo)));
+		}
+		b0 = _mm_andnot_si128(pack4_sse2(pos[0], pos[1], pos[2], pos[3]), one);
+		b1 = _mm_and_si128(pack4_sse2(outer[0], outer[1], outer[2], outer[3]), one);
+		_mm_storeu_si128((__m128i *) (bits + 2*i), _mm_unpacklo_epi8(b0, b1));
+		_mm_storeu_si128((__m128i *) (bits + 2*i + 16), _mm_unpackhi_epi8(b0, b1));
+	}
+
+	tetra_slice_bits(sym + i, n - i, bits + 2*i);
+}
+
+/* soft values of four symbols, the same operations as tetra_slice_soft() */
+TARGET_SSE2
+static inline void soft4_sse2(__m128 s, __m128i *soft0, __m128i *soft1)
+{
+	const __m128 sign = _mm_set1_ps(-0.0f), four = _mm_set1_ps(4), two = _mm_set1_ps(2);
+	const __m128 scale = _mm_set1_ps(TETRA_SOFT_SCALE);
+	const __m128 hi = _mm_set1_ps(127), lo = _mm_set1_ps(-127);
+	__m128 a, d0;
+
+	s = _mm_and_ps(s, _mm_cmpord_ps(s, s));
+	a = _mm_andnot_ps(sign, s);
+	d0 = _mm_xor_ps(_mm_min_ps(a, _mm_sub_ps(four, a)), _mm_and_ps(s, sign));
+	*soft0 = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(d0, scale), hi), lo));
+	*soft1 = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_sub_ps(two, a), scale),
+						       hi), lo));
+}
+
+TARGET_SSE2
+static void slice_soft_sse2(const float *sym, unsigned int n, int8_t *soft)
+{
+	unsigned int i, k;
+
+	for (i = 0; i + 16 <= n; i += 16) {
+		__m128i s0[4], s1[4], b0, b1;
+
+		for (k = 0; k < 4; k++)
+			soft4_sse2(_mm_loadu_ps(sym + i + 4*k), &s0[k], &s1[k]);
+		b0 = pack4_sse2(s0[0], s0[1], s0[2], s0[3]);
+		b1 = pack4_sse2(s1[0], s1[1], s1[2], s1[3]);
+		_mm_storeu_si128((__m128i *) (soft + 2*i), _mm_unpacklo_epi8(b0, b1));
+		_mm_storeu_si128((__m128i *) (soft + 2*i + 16), _mm_unpackhi_epi8(b0, b1));
+	}
+
+	tetra_slice_soft(sym + i, n - i, soft + 2*i);
+}
+
+/* IQ conversion: four values, two complex samples, at a time */
+TARGET_SSE2
+static inline __m128 cvt4_sse2(__m128 x, __m128 off, __m128 scale, __m128 *sum)
+{
+	__m128 y = _mm_mul_ps(_mm_sub_ps(x, off), scale);
+
+	*sum = _mm_add_ps(*sum, y);
+	return y;
+}
+
+TARGET_SSE2
+static void cvt_iq_sse2(enum tetra_iq_fmt fmt, const void *in, float *out, unsigned int n,
+			const float *off, float scale, float *sum)
+{
+	const __m128 o = _mm_setr_ps(off[0], off[1], off[0], off[1]);
+	const __m128 sc = _mm_set1_ps(scale);
+	const __m128i zero = _mm_setzero_si128();
+	const uint8_t *p = in;
+	__m128 acc = _mm_setzero_ps();
+	float part[4];
+	unsigned int i = 0;
+
+	switch (fmt) {
+	case TETRA_IQ_CU8:
+	case TETRA_IQ_CS8:
+		for (; i + 8 <= n; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i *) (p + 2*i));
+			__m128i lo, hi;
+
+			/* widen to 16 bit, zero or sign extended */
+			if (fmt == TETRA_IQ_CU8) {
+				lo = _mm_unpacklo_epi8(v, zero);
+				hi = _mm_unpackhi_epi8(v, zero);
+			} else {
+				lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+				hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+			}
+			_mm_storeu_ps(out + 2*i, cvt4_sse2(_mm_cvtepi32_ps(
+				_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)), o, sc, &acc));
+			_mm_storeu_ps(out + 2*i + 4, cvt4_sse2(_mm_cvtepi32_ps(
+				_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)), o, sc, &acc));
+			_mm_storeu_ps(out + 2*i + 8, cvt4_sse2(_mm_cvtepi32_ps(
+				_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)), o, sc, &acc));
+			_mm_storeu_ps(out + 2*i + 12, cvt4_sse2(_mm_cvtepi32_ps(
+				_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)), o, sc, &acc));
+		}
+		break;
+	case TETRA_IQ_CS16:
+		for (; i + 4 <= n; i += 4) {
+			__m128i v = _mm_loadu_si128((const __m128i *) (p + 4*i));
+
+			_mm_storeu_ps(out + 2*i, cvt4_sse2(_mm_cvtepi32_ps(
+				_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), o, sc, &acc));
+			_mm_storeu_ps(out + 2*i + 4, cvt4_sse2(_mm_cvtepi32_ps(
+				_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), o, sc, &acc));
+		}
+		break;
+	case TETRA_IQ_CF32:
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_ps(out + 2*i, cvt4_sse2(_mm_loadu_ps((const float *) p + 2*i),
+							   o, sc, &acc));
+		break;
+	}
+
+	_mm_storeu_ps(part, acc);
+	sum[0] += part[0] + part[2];
+	sum[1] += part[1] + part[3];
+	tetra_cvt_iq(fmt, p + i * tetra_iq_sample_size(fmt), out + 2*i, n - i, off, scale, sum);
+}
+
+/***********************************************************************
+ * AVX2
+ ***********************************************************************/
+
+TARGET_AVX2
+static int find_seq_avx2(const uint8_t *in, unsigned int len,
+			 const uint8_t *seq, unsigned int seq_len)
+{
+	unsigned int i, j;
+	int rc;
+
+	for (i = 0; seq_len && i + 31 + seq_len <= len; i += 32) {
+		__m256i acc = _mm256_set1_epi8(-1);
+		uint32_t mask;
+
+		for (j = 0; j < seq_len; j++) {
+			__m256i v = _mm256_loadu_si256((const __m256i *)(in + i + j));
+			acc = _mm256_and_si256(acc, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(seq[j])));
+			if ((j & 3) == 3 && _mm256_testz_si256(acc, acc))
+				break;
+		}
+		mask = _mm256_movemask_epi8(acc);
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+
+	rc = find_seq_sse2(in + i, len - i, seq, seq_len);
+	return rc < 0 ? rc : i + rc;
+}
+
+TARGET_AVX2
+static uint16_t crc16_avx2(uint16_t crc, const uint8_t *input, int number_bits)
+{
+	int i;
+
+	for (i = 0; i + 32 <= number_bits; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(input + i));
+		uint32_t m = _mm256_movemask_epi8(_mm256_slli_epi16(v, 7));
+
+		crc = crc_byte(crc, m);
+		crc = crc_byte(crc, m >> 8);
+		crc = crc_byte(crc, m >> 16);
+		crc = crc_byte(crc, m >> 24);
+	}
+
+	return crc16_sse2(crc, input + i, number_bits - i);
+}
+
+TARGET_AVX2
+static int scramb_avx2(uint32_t lfsr_init, uint8_t *out, int len)
+{
+	const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0,
+						1, 1, 1, 1, 1, 1, 1, 1,
+						2, 2, 2, 2, 2, 2, 2, 2,
+						3, 3, 3, 3, 3, 3, 3, 3);
+	const __m256i sel = _mm256_set1_epi64x(0x8040201008040201ULL);
+	const __m256i one = _mm256_set1_epi8(1);
+	uint32_t lfsr = lfsr_init;
+	int i;
+
+	for (i = 0; i < len; i += 32) {
+		lfsr = lfsr_next32(lfsr);
+		if (i + 32 <= len) {
+			__m256i *o = (__m256i *)(out + i);
+			__m256i ks = _mm256_shuffle_epi8(_mm256_set1_epi32(lfsr), spread);
+
+			ks = _mm256_min_epu8(_mm256_and_si256(ks, sel), one);
+			_mm256_storeu_si256(o, _mm256_xor_si256(_mm256_loadu_si256(o), ks));
+		} else {
+			int j;
+			for (j = 0; i + j < len; j++)
+				out[i + j] ^= (lfsr >> j) & 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Hardware gather of 32 bit words ending at in[tbl[i]], so that we never
+ * read beyond the highest index.  The (at most three) lanes with an index
+ * below 3 are masked off and filled in afterwards. */
+TARGET_AVX2
+static void gather_avx2(const uint16_t *tbl, unsigned int len,
+			const uint8_t *in, uint8_t *out)
+{
+	const __m256i pick = _mm256_setr_epi8(3, 7, 11, 15, -1, -1, -1, -1,
+					      -1, -1, -1, -1, -1, -1, -1, -1,
+					      3, 7, 11, 15, -1, -1, -1, -1,
+					      -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m256i three = _mm256_set1_epi32(3);
+	unsigned int i, j;
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		__m256i idx = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(tbl + i)));
+		__m256i mask = _mm256_cmpgt_epi32(idx, _mm256_set1_epi32(2));
+		__m256i w = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *) in,
+							_mm256_sub_epi32(idx, three), mask, 1);
+
+		w = _mm256_shuffle_epi8(w, pick);
+		w = _mm256_permutevar8x32_epi32(w, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+		_mm_storel_epi64((__m128i *)(out + i), _mm256_castsi256_si128(w));
+
+		if (_mm256_movemask_ps(_mm256_castsi256_ps(mask)) != 0xff) {
+			for (j = i; j < i + 8; j++)
+				out[j] = in[tbl[j]];
+		}
+	}
+
+	for (; i < len; i++)
+		out[i] = in[tbl[i]];
+}
+
+TARGET_AVX2
+static void fir_cf_avx2(const float *in, const float *taps, unsigned int ntaps,
+			float *out, unsigned int n)
+{
+	unsigned int i, k;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		__m256 acc = _mm256_setzero_ps();
+
+		for (k = 0; k < ntaps; k++)
+			acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(taps[k]),
+							       _mm256_loadu_ps(in + 2*(i+k))));
+		_mm256_storeu_ps(out + 2*i, acc);
+	}
+
+	fir_cf_sse2(in + 2*i, taps, ntaps, out + 2*i, n - i);
+}
+
+TARGET_AVX2
+static void mac_cf_avx2(const float *in, const float *taps, float *acc, unsigned int n)
+{
+	const __m256i dup = _mm256_set_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+	unsigned int i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		__m256 t = _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(taps + i)),
+						    dup);
+
+		_mm256_storeu_ps(acc + 2*i, _mm256_add_ps(_mm256_loadu_ps(acc + 2*i),
+			_mm256_mul_ps(t, _mm256_loadu_ps(in + 2*i))));
+	}
+
+	tetra_mac_cf(in + 2*i, taps + i, acc + 2*i, n - i);
+}
+
+/* as pack4_sse2(), 32 bytes.  The packs work within the 128 bit lanes,
+ * a permute of the 32 bit groups puts them back in order */
+TARGET_AVX2
+static inline __m256i pack4_avx2(__m256i v0, __m256i v1, __m256i v2, __m256i v3)
+{
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+	return _mm256_permutevar8x32_epi32(_mm256_packs_epi16(_mm256_packs_epi32(v0, v1),
+							      _mm256_packs_epi32(v2, v3)), order);
+}
+
+/* 32 first and 32 second bits of dibits, interleaved */
+TARGET_AVX2
+static inline void store_dibits_avx2(void *out, __m256i b0, __m256i b1)
+{
+	__m256i lo = _mm256_unpacklo_epi8(b0, b1), hi = _mm256_unpackhi_epi8(b0, b1);
+
+	_mm256_storeu_si256((__m256i *) out, _mm256_permute2x128_si256(lo, hi, 0x20));
+	_mm256_storeu_si256((__m256i *) out + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+TARGET_AVX2
+static void slice_avx2(const float *sym, unsigned int n, uint8_t *bits)
+{
+	const __m256 zero = _mm256_setzero_ps(), two = _mm256_set1_ps(2), mtwo = _mm256_set1_ps(-2);
+	const __m256i one = _mm256_set1_epi8(1);
+	unsigned int i, k;
+
+	for (i = 0; i + 32 <= n; i += 32) {
+		__m256i pos[4], outer[4], b0, b1;
+
+		for (k = 0; k < 4; k++) {
+			__m256 s = _mm256_loadu_ps(sym + i + 8*k);
+
+			pos[k] = _mm256_castps_si256(_mm256_cmp_ps(s, zero, _CMP_GT_OQ));
+			outer[k] = _mm256_castps_si256(_mm256_or_ps(_mm256_cmp_ps(s, two, _CMP_GT_OQ),
+								    _mm256_cmp_ps(s, mtwo, _CMP_LT_OQ)));
+		}
+		b0 = _mm256_andnot_si256(pack4_avx2(pos[0], pos[1], pos[2], pos[3]), one);
+		b1 = _mm256_and_si256(pack4_avx2(outer[0], outer[1], outer[2], outer[3]), one);
+		store_dibits_avx2(bits + 2*i, b0, b1);
+	}
+
+	slice_sse2(sym + i, n - i, bits + 2*i);
+}
+
+TARGET_AVX2
+static void slice_soft_avx2(const float *sym, unsigned int n, int8_t *soft)
+{
+	const __m256 sign = _mm256_set1_ps(-0.0f), four = _mm256_set1_ps(4), two = _mm256_set1_ps(2);
+	const __m256 scale = _mm256_set1_ps(TETRA_SOFT_SCALE);
+	const __m256 hi = _mm256_set1_ps(127), lo = _mm256_set1_ps(-127);
+	unsigned int i, k;
+
+	for (i = 0; i + 32 <= n; i += 32) {
+		__m256i s0[4], s1[4];
+
+		for (k = 0; k < 4; k++) {
+			__m256 s = _mm256_loadu_ps(sym + i + 8*k), a, d0;
+
+			s = _mm256_and_ps(s, _mm256_cmp_ps(s, s, _CMP_ORD_Q));
+			a = _mm256_andnot_ps(sign, s);
+			d0 = _mm256_xor_ps(_mm256_min_ps(a, _mm256_sub_ps(four, a)),
+					   _mm256_and_ps(s, sign));
+			s0[k] = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(
+					_mm256_mul_ps(d0, scale), hi), lo));
+			s1[k] = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(
+					_mm256_mul_ps(_mm256_sub_ps(two, a), scale), hi), lo));
+		}
+		store_dibits_avx2(soft + 2*i, pack4_avx2(s0[0], s0[1], s0[2], s0[3]),
+				  pack4_avx2(s1[0], s1[1], s1[2], s1[3]));
+	}
+
+	slice_soft_sse2(sym + i, n - i, soft + 2*i);
+}
+
+/* four complex samples per step, widened straight to 32 bit */
+TARGET_AVX2
+static void cvt_iq_avx2(enum tetra_iq_fmt fmt, const void *in, float *out, unsigned int n,
+			const float *off, float scale, float *sum)
+{
+	const __m256 o = _mm256_setr_ps(off[0], off[1], off[0], off[1],
+					off[0], off[1], off[0], off[1]);
+	const __m256 sc = _mm256_set1_ps(scale);
+	const uint8_t *p = in;
+	__m256 acc = _mm256_setzero_ps();
+	float part[8];
+	unsigned int i, size = tetra_iq_sample_size(fmt);
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		const uint8_t *q = p + size * i;
+		__m256 x, y;
+
+		switch (fmt) {
+		case TETRA_IQ_CU8:
+			x = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) q)));
+			break;
+		case TETRA_IQ_CS8:
+			x = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *) q)));
+			break;
+		case TETRA_IQ_CS16:
+			x = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) q)));
+			break;
+		default:
+			x = _mm256_loadu_ps((const float *) q);
+			break;
+		}
+		y = _mm256_mul_ps(_mm256_sub_ps(x, o), sc);
+		acc = _mm256_add_ps(acc, y);
+		_mm256_storeu_ps(out + 2*i, y);
+	}
+
+	_mm256_storeu_ps(part, acc);
+	sum[0] += (part[0] + part[2]) + (part[4] + part[6]);
+	sum[1] += (part[1] + part[3]) + (part[5] + part[7]);
+	cvt_iq_sse2(fmt, p + size * i, out + 2*i, n - i, off, scale, sum);
+}
+
+/***********************************************************************
+ * AVX-512 (F + BW)
+ ***********************************************************************/
+
+TARGET_AVX512
+static int find_seq_avx512(const uint8_t *in, unsigned int len,
+			   const uint8_t *seq, unsigned int seq_len)
+{
+	unsigned int i, j;
+	int rc;
+
+	for (i = 0; seq_len && i + 63 + seq_len <= len; i += 64) {
+		__mmask64 acc = ~0ULL;
+
+		for (j = 0; j < seq_len && acc; j++) {
+			__m512i v = _mm512_loadu_si512((const void *)(in + i + j));
+			acc = _mm512_mask_cmpeq_epi8_mask(acc, v, _mm512_set1_epi8(seq[j]));
+		}
+		if (acc)
+			return i + __builtin_ctzll(acc);
+	}
+
+	rc = find_seq_avx2(in + i, len - i, seq, seq_len);
+	return rc < 0 ? rc : i + rc;
+}
+
+TARGET_AVX512
+static uint16_t crc16_avx512(uint16_t crc, const uint8_t *input, int number_bits)
+{
+	int i, j;
+
+	for (i = 0; i + 64 <= number_bits; i += 64) {
+		__m512i v = _mm512_loadu_si512((const void *)(input + i));
+		uint64_t m = _mm512_test_epi8_mask(v, _mm512_set1_epi8(1));
+
+		for (j = 0; j < 8; j++)
+			crc = crc_byte(crc, m >> (j*8));
+	}
+
+	return crc16_avx2(crc, input + i, number_bits - i);
+}
+
+TARGET_AVX512
+static void gather_avx512(const uint16_t *tbl, unsigned int len,
+			  const uint8_t *in, uint8_t *out)
+{
+	const __m512i three = _mm512_set1_epi32(3);
+	unsigned int i, j;
+
+	for (i = 0; i + 16 <= len; i += 16) {
+		__m512i idx = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(tbl + i)));
+		__mmask16 mask = _mm512_cmpgt_epu32_mask(idx, _mm512_set1_epi32(2));
+		__m512i w = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), mask,
+							_mm512_sub_epi32(idx, three), in, 1);
+
+		_mm_storeu_si128((__m128i *)(out + i),
+				 _mm512_cvtepi32_epi8(_mm512_srli_epi32(w, 24)));
+
+		if (mask != 0xffff) {
+			for (j = i; j < i + 16; j++)
+				out[j] = in[tbl[j]];
+		}
+	}
+
+	gather_avx2(tbl + i, len - i, in, out + i);
+}
+
+const struct tetra_kernels tetra_kernels_sse2 = {
+	.viterbi_cch	= viterbi_cch_sse2,
+	.find_seq	= find_seq_sse2,
+	.crc16		= crc16_sse2,
+	.scramb		= scramb_sse2,
+	.fir_cf		= fir_cf_sse2,
+	.mac_cf		= mac_cf_sse2,
+	.slice		= slice_sse2,
+	.slice_soft	= slice_soft_sse2,
+	.cvt_iq		= cvt_iq_sse2,
+};
+
+/* A single-register AVX2 Viterbi needs a cross-lane permute per step and
+ * measured no faster than the SSE2 one, so there is none. */
+const struct tetra_kernels tetra_kernels_avx2 = {
+	.find_seq	= find_seq_avx2,
+	.crc16		= crc16_avx2,
+	.scramb		= scramb_avx2,
+	.gather		= gather_avx2,
+	.fir_cf		= fir_cf_avx2,
+	.mac_cf		= mac_cf_avx2,
+	.slice		= slice_avx2,
+	.slice_soft	= slice_soft_avx2,
+	.cvt_iq		= cvt_iq_avx2,
+};
+
+const struct tetra_kernels tetra_kernels_avx512 = {
+	.find_seq	= find_seq_avx512,
+	.crc16		= crc16_avx512,
+	.gather		= gather_avx512,
+};
+
+#endif /* __x86_64__ || __i386__ */
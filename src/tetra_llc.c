@@ -20,138 +20,247 @@
 
 #include <stdint.h>
 #include <stdio.h>
-#include <unistd.h>
 #include <string.h>
+#include <errno.h>
 
 #include <osmocom/core/msgb.h>
 #include <osmocom/core/talloc.h>
-#include <osmocom/core/bits.h>
 
+#include "tetra_common.h"
 #include "tetra_llc_pdu.h"
+#include "tetra_event.h"
 
-static int tun_fd = -1;
+/* The defragmenter keeps a fixed table of reassembly slots, indexed by a
+ * hash of (address, N(S)) with a short linear probe.  Active slots are
+ * also kept on a LRU list, which is used to expire them after a timeout
+ * and to evict the least recently used ones when running out of slots or
+ * over the memory cap. */
 
-static struct tllc_state g_llcs = {
-	.rx.defrag_list = LLIST_HEAD_INIT(g_llcs.rx.defrag_list),
-};
+static unsigned int defrag_hash(uint32_t addr, unsigned int ns)
+{
+	return ((addr ^ (ns << 24)) * 0x9e3779b1) >> 16;
+}
 
-int rx_tl_sdu(struct msgb *msg, unsigned int len);
+static void defrag_release(struct tllc_state *llcs, struct tllc_defrag_q_e *dqe)
+{
+	llist_del(&dqe->list);
+	llcs->rx.mem_used -= dqe->buf_size;
+	talloc_free(dqe->buf);
+	dqe->buf = NULL;
+	dqe->buf_size = 0;
+	dqe->len = 0;
+	dqe->in_use = 0;
+}
 
 static struct tllc_defrag_q_e *
-get_dqe_for_ns(struct tllc_state *llcs, uint8_t ns, int alloc_if_missing)
+defrag_find(struct tllc_state *llcs, uint32_t addr, unsigned int ns)
 {
-	struct tllc_defrag_q_e *dqe;
-	llist_for_each_entry(dqe, &llcs->rx.defrag_list, list) {
-		if (dqe->ns == ns)
+	unsigned int h = defrag_hash(addr, ns);
+	int i;
+
+	for (i = 0; i < TLLC_DEFRAG_PROBE; i++) {
+		struct tllc_defrag_q_e *dqe;
+
+		dqe = &llcs->rx.slot[(h + i) & (TLLC_DEFRAG_SLOTS-1)];
+		if (dqe->in_use && dqe->addr == addr && dqe->ns == ns)
 			return dqe;
 	}
-	if (alloc_if_missing) {
-		dqe = talloc_zero(NULL, struct tllc_defrag_q_e);
-		dqe->ns = ns;
-		dqe->tl_sdu = msgb_alloc(4096, "LLC defrag");
-		llist_add(&dqe->list, &llcs->rx.defrag_list);
-	} else
-		dqe = NULL;
+	return NULL;
+}
+
+static struct tllc_defrag_q_e *
+defrag_alloc(struct tllc_state *llcs, uint32_t addr, unsigned int ns, uint32_t ts)
+{
+	struct tllc_defrag_q_e *dqe, *oldest = NULL;
+	unsigned int h = defrag_hash(addr, ns);
+	int i;
+
+	for (i = 0; i < TLLC_DEFRAG_PROBE; i++) {
+		dqe = &llcs->rx.slot[(h + i) & (TLLC_DEFRAG_SLOTS-1)];
+		if (!dqe->in_use)
+			break;
+		if (!oldest || ts - dqe->last_ts > ts - oldest->last_ts)
+			oldest = dqe;
+	}
+	if (i == TLLC_DEFRAG_PROBE) {
+		/* all candidate slots busy, evict the least recently used */
+		TPRINTF(TETRA_V_PDU, "<<EVICT:%u>> ", oldest->ns);
+		tetra_event_defrag(TETRA_EV_DF_EVICT, oldest->addr, oldest->ns, oldest->last_ss);
+		llcs->rx.stats.evicted++;
+		defrag_release(llcs, oldest);
+		dqe = oldest;
+	}
+
+	dqe->in_use = 1;
+	dqe->addr = addr;
+	dqe->ns = ns;
+	llist_add_tail(&dqe->list, &llcs->rx.lru);
 
 	return dqe;
 }
 
-static int tllc_defrag_in(struct tllc_state *llcs,
-			  struct tetra_llc_pdu *lpp,
-			  struct msgb *msg, unsigned int len)
+static int defrag_append(struct tllc_state *llcs, struct tllc_defrag_q_e *dqe,
+			 const uint8_t *bits, unsigned int len)
 {
-	struct tllc_defrag_q_e *dqe;
+	unsigned int new_len = dqe->len + len;
+
+	if (new_len > TLLC_DEFRAG_MAX_BITS) {
+		TPRINTF(TETRA_V_PDU, "<<OVERFLOW>> ");
+		tetra_event_defrag(TETRA_EV_DF_OVERFLOW, dqe->addr, dqe->ns, dqe->last_ss);
+		llcs->rx.stats.overflow++;
+		defrag_release(llcs, dqe);
+		return -EMSGSIZE;
+	}
+
+	if (new_len > dqe->buf_size) {
+		unsigned int new_size = dqe->buf_size ? dqe->buf_size : 256;
+		uint8_t *buf;
+
+		while (new_size < new_len)
+			new_size *= 2;
+		if (new_size > TLLC_DEFRAG_MAX_BITS)
+			new_size = TLLC_DEFRAG_MAX_BITS;
 
-	dqe = get_dqe_for_ns(llcs, lpp->ns, 1);
+		/* make room below the memory cap, oldest reassemblies first */
+		while (llcs->rx.mem_used + new_size - dqe->buf_size > llcs->rx.mem_cap) {
+			struct tllc_defrag_q_e *lru;
+
+			lru = llist_entry(llcs->rx.lru.next, struct tllc_defrag_q_e, list);
+			if (lru == dqe)
+				lru = llist_entry(dqe->list.next, struct tllc_defrag_q_e, list);
+			if (&lru->list == &llcs->rx.lru) {
+				/* this one alone exceeds the cap */
+				lru = dqe;
+			}
+			TPRINTF(TETRA_V_PDU, "<<EVICT:%u>> ", lru->ns);
+			tetra_event_defrag(TETRA_EV_DF_EVICT, lru->addr, lru->ns, lru->last_ss);
+			llcs->rx.stats.evicted++;
+			defrag_release(llcs, lru);
+			if (lru == dqe)
+				return -ENOMEM;
+		}
+
+		buf = talloc_realloc_size(NULL, dqe->buf, new_size);
+		if (!buf) {
+			defrag_release(llcs, dqe);
+			return -ENOMEM;
+		}
+		llcs->rx.mem_used += new_size - dqe->buf_size;
+		dqe->buf = buf;
+		dqe->buf_size = new_size;
+	}
 
-	/* check if this is the first segment, or the next
-	 * expected segment */
-	if (!dqe->last_ss ||
-	    (dqe->last_ss == lpp->ss - 1)) {
-		/* FIXME: append */
-		printf("<<APPEND:%u>> ", lpp->ss);
-		dqe->last_ss = lpp->ss;
-		memcpy(msgb_put(dqe->tl_sdu, len), msg->l3h, len);
-	} else
-		printf("<<MISS:%u-%u>> ", dqe->last_ss, lpp->ss);
+	memcpy(dqe->buf + dqe->len, bits, len);
+	dqe->len = new_len;
+	llist_move_tail(&dqe->list, &llcs->rx.lru);
 
 	return 0;
 }
 
-static int tllc_defrag_out(struct tllc_state *llcs,
-			   struct tetra_llc_pdu *lpp)
+int tllc_defrag_in(struct tllc_state *llcs, uint32_t addr,
+		   const struct tetra_llc_pdu *lpp, uint32_t ts)
 {
 	struct tllc_defrag_q_e *dqe;
-	struct msgb *msg;
 
-	dqe = get_dqe_for_ns(llcs, lpp->ns, 0);
-	msg = dqe->tl_sdu;
+	dqe = defrag_find(llcs, addr, lpp->ns);
+
+	/* a repeated segment, e.g. after a lost acknowledgement */
+	if (dqe && lpp->ss == dqe->last_ss) {
+		TPRINTF(TETRA_V_PDU, "<<DUP:%u>> ", lpp->ss);
+		tetra_event_defrag(TETRA_EV_DF_DUP, addr, lpp->ns, lpp->ss);
+		llcs->rx.stats.dup++;
+		dqe->last_ts = ts;
+		llist_move_tail(&dqe->list, &llcs->rx.lru);
+		return 0;
+	}
 
-	printf("<<REMOVE>> ");
-	msg->l3h = msg->data;
-	rx_tl_sdu(msg, msgb_l3len(msg));
+	/* a new first segment or a gap: the old reassembly is useless */
+	if (dqe && (lpp->ss == 0 || lpp->ss != ((dqe->last_ss + 1) & 0xff))) {
+		TPRINTF(TETRA_V_PDU, "<<MISS:%u-%u>> ", dqe->last_ss, lpp->ss);
+		tetra_event_defrag(TETRA_EV_DF_MISS, addr, lpp->ns, lpp->ss);
+		llcs->rx.stats.missed++;
+		defrag_release(llcs, dqe);
+		dqe = NULL;
+		if (lpp->ss != 0)
+			return -EIO;
+	}
 
-	if (tun_fd < 0)
-		tun_fd = tun_alloc("tun0");
-		fprintf(stderr, "tun_fd=%d\n", tun_fd);
-	if (tun_fd >= 0) {
-		uint8_t buf[4096];
-		int len = osmo_ubit2pbit(buf, msg->l3h+3+4+4+4+4, msgb_l3len(msg)-3-4-4-4-4);
-		write(tun_fd, buf, len);
+	if (!dqe) {
+		if (lpp->ss != 0) {
+			TPRINTF(TETRA_V_PDU, "<<MISS:-%u>> ", lpp->ss);
+			tetra_event_defrag(TETRA_EV_DF_MISS, addr, lpp->ns, lpp->ss);
+			llcs->rx.stats.missed++;
+			return -ENOENT;
+		}
+		dqe = defrag_alloc(llcs, addr, lpp->ns, ts);
 	}
 
-	llist_del(&dqe->list);
-	talloc_free(msg);
-	talloc_free(dqe);
+	TPRINTF(TETRA_V_PDU, "<<APPEND:%u>> ", lpp->ss);
+	tetra_event_defrag(TETRA_EV_DF_APPEND, addr, lpp->ns, lpp->ss);
+	dqe->last_ss = lpp->ss;
+	dqe->last_ts = ts;
+
+	return defrag_append(llcs, dqe, lpp->tl_sdu, lpp->tl_sdu_len);
 }
 
-/* Receive TM-SDU (MAC SDU == LLC PDU) */
-/* this resembles TMA-UNITDATA.ind (TM-SDU / length) */
-int rx_tm_sdu(struct msgb *msg, unsigned int len)
+struct msgb *tllc_defrag_out(struct tllc_state *llcs, uint32_t addr,
+			     const struct tetra_llc_pdu *lpp)
 {
-	struct tetra_llc_pdu lpp;
-
-	memset(&lpp, 0, sizeof(lpp));
-	tetra_llc_pdu_parse(&lpp, msg->l2h, len);
-	msg->l3h = lpp.tl_sdu;
-
-	printf("TM-SDU(%s,%u,%u): ",
-		tetra_get_llc_pdut_dec_name(lpp.pdu_type), lpp.ns, lpp.ss);
-
-	switch (lpp.pdu_type) {
-	case TLLC_PDUT_DEC_BL_ADATA:
-	case TLLC_PDUT_DEC_BL_DATA:
-	case TLLC_PDUT_DEC_BL_UDATA:
-	case TLLC_PDUT_DEC_BL_ACK:
-	case TLLC_PDUT_DEC_AL_SETUP:
-	case TLLC_PDUT_DEC_AL_ACK:
-	case TLLC_PDUT_DEC_AL_RNR:
-	case TLLC_PDUT_DEC_AL_RECONNECT:
-	case TLLC_PDUT_DEC_AL_DISC:
-		/* directly hand it to MLE */
-		rx_tl_sdu(msg, lpp.tl_sdu_len);
-		break;
-	case TLLC_PDUT_DEC_AL_DATA:
-	case TLLC_PDUT_DEC_AL_UDATA:
-	case TLLC_PDUT_DEC_ALX_DATA:
-	case TLLC_PDUT_DEC_ALX_UDATA:
-		/* input into LLC defragmenter */
-		tllc_defrag_in(&g_llcs, &lpp, msg, len);
-		break;
-	case TLLC_PDUT_DEC_AL_FINAL:
-	case TLLC_PDUT_DEC_AL_UFINAL:
-	case TLLC_PDUT_DEC_ALX_FINAL:
-	case TLLC_PDUT_DEC_ALX_UFINAL:
-		/* input into LLC defragmenter */
-		tllc_defrag_in(&g_llcs, &lpp, msg, len);
-		/* check if the fragment is complete and hand it off*/
-		tllc_defrag_out(&g_llcs, &lpp);
-		break;
+	struct tllc_defrag_q_e *dqe;
+	struct msgb *msg;
+
+	dqe = defrag_find(llcs, addr, lpp->ns);
+	if (!dqe)
+		return NULL;
+
+	TPRINTF(TETRA_V_PDU, "<<REMOVE>> ");
+	tetra_event_defrag(TETRA_EV_DF_REMOVE, addr, lpp->ns, dqe->last_ss);
+	if (lpp->have_fcs &&
+	    (!lpp->fcs || !tetra_llc_fcs_ok(dqe->buf, dqe->len, *lpp->fcs))) {
+		TPRINTF(TETRA_V_PDU, "<<FCS BAD>> ");
+		tetra_event_defrag(TETRA_EV_DF_FCS_BAD, addr, lpp->ns, dqe->last_ss);
+		llcs->rx.stats.fcs_err++;
+		defrag_release(llcs, dqe);
+		return NULL;
+	}
+
+	msg = msgb_alloc(dqe->len, "LLC defrag");
+	if (msg) {
+		msg->l3h = msgb_put(msg, dqe->len);
+		memcpy(msg->l3h, dqe->buf, dqe->len);
+		llcs->rx.stats.completed++;
 	}
+	defrag_release(llcs, dqe);
+
+	return msg;
+}
 
-	if (lpp.tl_sdu && lpp.ss == 0) {
-		/* this resembles TMA-UNITDATA.ind */
-		//rx_tl_sdu(msg, lpp.tl_sdu_len);
+void tllc_defrag_expire(struct tllc_state *llcs, uint32_t ts)
+{
+	struct tllc_defrag_q_e *dqe, *dqe2;
+
+	llist_for_each_entry_safe(dqe, dqe2, &llcs->rx.lru, list) {
+		if (ts - dqe->last_ts <= llcs->rx.timeout)
+			break;
+		llcs->rx.stats.timed_out++;
+		tetra_event_defrag(TETRA_EV_DF_TIMEOUT, dqe->addr, dqe->ns, dqe->last_ss);
+		defrag_release(llcs, dqe);
 	}
-	return len;
+}
+
+void tllc_defrag_flush(struct tllc_state *llcs)
+{
+	struct tllc_defrag_q_e *dqe, *dqe2;
+
+	llist_for_each_entry_safe(dqe, dqe2, &llcs->rx.lru, list)
+		defrag_release(llcs, dqe);
+}
+
+void tllc_defrag_init(struct tllc_state *llcs)
+{
+	memset(&llcs->rx, 0, sizeof(llcs->rx));
+	INIT_LLIST_HEAD(&llcs->list);
+	INIT_LLIST_HEAD(&llcs->rx.lru);
+	llcs->rx.mem_cap = TLLC_DEFRAG_MEM_CAP;
+	llcs->rx.timeout = TLLC_DEFRAG_TIMEOUT;
 }
@@ -29,6 +29,8 @@
 
 #include "tetra_common.h"
 #include "tetra_llc_pdu.h"
+#include "tetra_field.h"
+#include <lower_mac/crc_simple.h>
 
 static const struct value_string tetra_llc_pdut_names[] = {
 	{ TLLC_PDUT_BL_ADATA,		"BL-ADATA" },
@@ -82,84 +84,139 @@ const char *tetra_get_llc_pdut_dec_name(enum tllc_pdut_dec pdut)
 	return get_value_string(pdut_dec_names, pdut);
 }
 
+/* Table 21.1 ff. */
+enum {
+	L_PDUT, L_BL_NR, L_BL_NS, L_AL_FINAL, L_AL_AR, L_AL_NS, L_AL_SS,
+	L_AL_FCS, L_AU_UFINAL, L_AU_NS, L_AU_SS,
+	_L_NUM
+};
+
+#define PDUT_BIT(x)	(1 << TLLC_PDUT_##x)
+
+static const struct tetra_field_desc llc_fields[_L_NUM] = {
+	[L_PDUT]	= TF_SKIP(4),
+	/* BL-ADATA, BL-DATA (21.2.2) */
+	[L_BL_NR]	= TF_IF(struct tetra_llc_pdu, nr, 1, TF_C_IN, L_PDUT,
+				PDUT_BIT(BL_ADATA) | PDUT_BIT(BL_ADATA_FCS)),
+	[L_BL_NS]	= TF_IF(struct tetra_llc_pdu, ns, 1, TF_C_IN, L_PDUT,
+				PDUT_BIT(BL_ADATA) | PDUT_BIT(BL_ADATA_FCS) |
+				PDUT_BIT(BL_DATA) | PDUT_BIT(BL_DATA_FCS)),
+	/* AL-DATA / AL-FINAL, Table 21.19 */
+	[L_AL_FINAL]	= TF_SKIP_IF(1, TF_C_EQ, L_PDUT, TLLC_PDUT_AL_DATA_FINAL),
+	[L_AL_AR]	= TF_SKIP_IF(1, TF_C_EQ, L_PDUT, TLLC_PDUT_AL_DATA_FINAL),
+	[L_AL_NS]	= TF_IF(struct tetra_llc_pdu, ns, 3,
+				TF_C_EQ, L_PDUT, TLLC_PDUT_AL_DATA_FINAL),
+	[L_AL_SS]	= TF_IF(struct tetra_llc_pdu, ss, 8,
+				TF_C_EQ, L_PDUT, TLLC_PDUT_AL_DATA_FINAL),
+	[L_AL_FCS]	= TF_SKIP_IF(1, TF_C_EQ, L_AL_FINAL, 1),
+	/* AL-UDATA / AL-UFINAL, 21.2.3.6 / 21.2.3.7 */
+	[L_AU_UFINAL]	= TF_SKIP_IF(1, TF_C_EQ, L_PDUT, TLLC_PDUT_AL_UDATA_UFINAL),
+	[L_AU_NS]	= TF_IF(struct tetra_llc_pdu, ns, 8,
+				TF_C_EQ, L_PDUT, TLLC_PDUT_AL_UDATA_UFINAL),
+	[L_AU_SS]	= TF_IF(struct tetra_llc_pdu, ss, 8,
+				TF_C_EQ, L_PDUT, TLLC_PDUT_AL_UDATA_UFINAL),
+};
+
+/* 22.3.3.3: the FCS is the inverted CRC-32 over the TL-SDU */
+int tetra_llc_fcs_ok(const uint8_t *bits, unsigned int len, uint32_t fcs)
+{
+	return ~crc32_bits(0xffffffff, bits, len) == fcs;
+}
+
 int tetra_llc_pdu_parse(struct tetra_llc_pdu *lpp, uint8_t *buf, int len)
 {
-	uint8_t *cur = buf;
-	uint8_t pdu_type;
+	uint32_t vals[_L_NUM];
+	int hdr_len, has_fcs = 0;
 
-	pdu_type = bits_to_uint(cur, 4);
-	cur += 4;
+	hdr_len = tetra_field_decode(llc_fields, _L_NUM, buf, lpp, vals);
 
-	switch (pdu_type) {
+	switch (vals[L_PDUT]) {
 	case TLLC_PDUT_BL_ADATA_FCS:
-		/* FIXME */
-		len -= 32;
+		has_fcs = 1;
 	case TLLC_PDUT_BL_ADATA:
-		lpp->nr = *cur++;
-		lpp->ns = *cur++;
-		lpp->tl_sdu = cur;
-		lpp->tl_sdu_len = len - (cur - buf);
 		lpp->pdu_type = TLLC_PDUT_DEC_BL_ADATA;
 		break;
 	case TLLC_PDUT_BL_DATA_FCS:
-		/* FIXME */
-		len -= 32;
+		has_fcs = 1;
 	case TLLC_PDUT_BL_DATA:
-		lpp->ns = *cur++;
-		lpp->tl_sdu = cur;
-		lpp->tl_sdu_len = len - (cur - buf);
 		lpp->pdu_type = TLLC_PDUT_DEC_BL_DATA;
 		break;
 	case TLLC_PDUT_BL_UDATA_FCS:
-		/* FIXME */
-		len -= 32;
+		has_fcs = 1;
 	case TLLC_PDUT_BL_UDATA:
-		lpp->tl_sdu = cur;
-		lpp->tl_sdu_len = len - (cur - buf);
 		lpp->pdu_type = TLLC_PDUT_DEC_BL_UDATA;
 		break;
 	case TLLC_PDUT_AL_DATA_FINAL:
-		if (*cur++) {
-			/* FINAL */
-			cur++;
-			lpp->ns = bits_to_uint(cur, 3); cur += 3;
-			lpp->ss = bits_to_uint(cur, 8); cur += 8;
-			if (*cur++) {
-				/* FIXME: FCS */
-				len -= 32;
-			}
-			lpp->tl_sdu = cur;
-			lpp->tl_sdu_len = len - (cur - buf);
+		if (vals[L_AL_FINAL]) {
+			has_fcs = vals[L_AL_FCS];
 			lpp->pdu_type = TLLC_PDUT_DEC_AL_FINAL;
-		} else {
-			/* DATA Table 21.19 */
-			cur++;
-			lpp->ns = bits_to_uint(cur, 3); cur += 3;
-			lpp->ss = bits_to_uint(cur, 8); cur += 8;
-			lpp->tl_sdu = cur;
-			lpp->tl_sdu_len = len - (cur - buf);
+		} else
 			lpp->pdu_type = TLLC_PDUT_DEC_AL_DATA;
-		}
 		break;
 	case TLLC_PDUT_AL_UDATA_UFINAL:
-		if (*cur++) {
-			/* UFINAL 21.2.3.7 / Table 21.26 */
-			lpp->ns = bits_to_uint(cur, 8); cur+= 8;
-			lpp->ss = bits_to_uint(cur, 8); cur+= 8;
-			lpp->tl_sdu = cur;
-			/* FIXME: FCS */
-			len -= 32;
-			lpp->tl_sdu_len = len - (cur - buf);
+		if (vals[L_AU_UFINAL]) {
+			has_fcs = 1;
 			lpp->pdu_type = TLLC_PDUT_DEC_AL_UFINAL;
-		} else {
-			/* UDATA 21.2.3.6 / Table 21.24 */
-			lpp->ns = bits_to_uint(cur, 8); cur+= 8;
-			lpp->ss = bits_to_uint(cur, 8); cur+= 8;
-			lpp->tl_sdu = cur;
-			lpp->tl_sdu_len = len - (cur - buf);
+		} else
 			lpp->pdu_type = TLLC_PDUT_DEC_AL_UDATA;
-		}
 		break;
+	default:
+		return hdr_len;
+	}
+
+	/* the FCS occupies the last 32 bits of the PDU, a truncated one
+	 * leaves lpp->fcs NULL and never matches */
+	if (has_fcs) {
+		lpp->have_fcs = 1;
+		if (len >= hdr_len + 32) {
+			len -= 32;
+			lpp->_fcs = bits_to_uint(buf + len, 32);
+			lpp->fcs = &lpp->_fcs;
+		} else
+			len = hdr_len;
+	}
+
+	lpp->tl_sdu = buf + hdr_len;
+	lpp->tl_sdu_len = len > hdr_len ? len - hdr_len : 0;
+
+	/* in advanced link mode the FCS covers the whole reassembled TL-SDU
+	 * and can only be checked after the final segment, see
+	 * tllc_defrag_out() */
+	if (lpp->fcs && vals[L_PDUT] < TLLC_PDUT_AL_SETUP)
+		lpp->fcs_valid = tetra_llc_fcs_ok(lpp->tl_sdu, lpp->tl_sdu_len,
+						  lpp->_fcs);
+
+	return hdr_len;
+}
+
+int tetra_llc_pdu_encode(const struct tetra_llc_pdu *lpp, const uint8_t *sdu,
+			 unsigned int sdu_len, uint8_t *bits)
+{
+	uint32_t vals[_L_NUM];
+	uint8_t *cur = bits;
+
+	memset(vals, 0, sizeof(vals));
+	switch (lpp->pdu_type) {
+	case TLLC_PDUT_DEC_BL_ADATA:
+		vals[L_PDUT] = lpp->have_fcs ? TLLC_PDUT_BL_ADATA_FCS : TLLC_PDUT_BL_ADATA;
+		break;
+	case TLLC_PDUT_DEC_BL_DATA:
+		vals[L_PDUT] = lpp->have_fcs ? TLLC_PDUT_BL_DATA_FCS : TLLC_PDUT_BL_DATA;
+		break;
+	case TLLC_PDUT_DEC_BL_UDATA:
+		vals[L_PDUT] = lpp->have_fcs ? TLLC_PDUT_BL_UDATA_FCS : TLLC_PDUT_BL_UDATA;
+		break;
+	default:
+		return -EINVAL;
 	}
-	return (cur - buf);
+
+	cur += tetra_field_encode(llc_fields, _L_NUM, lpp, vals, cur);
+	memcpy(cur, sdu, sdu_len);
+	cur += sdu_len;
+	if (lpp->have_fcs) {
+		uint_to_bits(~crc32_bits(0xffffffff, sdu, sdu_len), 32, cur);
+		cur += 32;
+	}
+
+	return cur - bits;
 }
@@ -1,8 +1,11 @@
 #ifndef TETRA_LLC_PDU_H
 #define TETRA_LLC_PDU_H
 
+#include <stdint.h>
 #include <osmocom/core/linuxlist.h>
 
+struct msgb;
+
 /* Table 21.1 */
 enum tetra_llc_pdu_t {
 	TLLC_PDUT_BL_ADATA		= 0,
@@ -74,28 +77,89 @@ struct tetra_llc_pdu {
 	uint8_t ss;		/* S(S) Segment (sent) */
 	uint32_t _fcs;
 	uint32_t *fcs;
+	uint8_t have_fcs;	/* PDU carries a FCS */
+	uint8_t fcs_valid;	/* FCS matches (basic link only) */
 	uint8_t *tl_sdu;	/* pointer to bitbuf */
-	uint8_t tl_sdu_len;	/* in bits */
+	unsigned int tl_sdu_len;	/* in bits */
 };
 
 /* parse a received LLC PDU and parse it into 'lpp' */
 int tetra_llc_pdu_parse(struct tetra_llc_pdu *lpp, uint8_t *buf, int len);
 
+/* The basic link PDU 'lpp' (BL-ADATA, BL-DATA or BL-UDATA, with a FCS if
+ * lpp->have_fcs) carrying 'sdu_len' bits of TL-SDU.  Returns the number
+ * of bits written, or -EINVAL for other PDU types. */
+int tetra_llc_pdu_encode(const struct tetra_llc_pdu *lpp, const uint8_t *sdu,
+			 unsigned int sdu_len, uint8_t *bits);
+
+/* check the FCS over the unpacked TL-SDU bits */
+int tetra_llc_fcs_ok(const uint8_t *bits, unsigned int len, uint32_t fcs);
+
+/* number of concurrent reassemblies, must be a power of two */
+#define TLLC_DEFRAG_SLOTS	64
+/* how many slots are probed for a (address, N(S)) pair */
+#define TLLC_DEFRAG_PROBE	8
+/* maximum length of a reassembled TL-SDU, in bits */
+#define TLLC_DEFRAG_MAX_BITS	4096
+/* default limit for the sum of all reassembly buffers, in bytes */
+#define TLLC_DEFRAG_MEM_CAP	(64*1024)
+/* default timeout without a new segment: 4 multiframes, in timeslots */
+#define TLLC_DEFRAG_TIMEOUT	(4*18*4)
+
+/* entry in the defragmentation table */
+struct tllc_defrag_q_e {
+	struct llist_head list;	/* in LRU order, least recently used first */
+	int in_use;
+	uint32_t addr;		/* SSI (or event label) of the sender/recipient */
+	unsigned int ns;	/* current de-fragmenting */
+	unsigned int last_ss;	/* last received S(S) */
+	uint32_t last_ts;	/* TDMA time of the last segment, in timeslots */
+
+	uint8_t *buf;		/* unpacked bits received so far */
+	unsigned int len;	/* in bits */
+	unsigned int buf_size;	/* allocated size of 'buf' */
+};
+
+struct tllc_defrag_stats {
+	unsigned int completed;	/* TL-SDUs handed up */
+	unsigned int missed;	/* segments out of sequence or without start */
+	unsigned int dup;	/* repeated segments, ignored */
+	unsigned int timed_out;	/* reassemblies without FINAL in time */
+	unsigned int evicted;	/* reassemblies dropped for slots or memory */
+	unsigned int overflow;	/* TL-SDUs longer than TLLC_DEFRAG_MAX_BITS */
+	unsigned int fcs_err;	/* TL-SDUs with bad FCS, reassembled or not */
+};
+
 /* TETRA LLC state */
 struct tllc_state {
 	struct llist_head list;
 
 	struct {
-		struct llist_head defrag_list;
+		struct tllc_defrag_q_e slot[TLLC_DEFRAG_SLOTS];
+		struct llist_head lru;
+		unsigned int mem_used;	/* sum of all buf_size */
+		unsigned int mem_cap;
+		uint32_t timeout;	/* in timeslots */
+		struct tllc_defrag_stats stats;
 	} rx;
 };
 
-/* entry in the defragmentation queue */
-struct tllc_defrag_q_e {
-	struct llist_head list;
-	unsigned int ns;	/* current de-fragmenting */
-	unsigned int last_ss;	/* last received S(S) */
+void tllc_defrag_init(struct tllc_state *llcs);
+void tllc_defrag_flush(struct tllc_state *llcs);
+
+/* feed one AL-DATA/AL-UDATA/AL-FINAL/AL-UFINAL segment received at TDMA
+ * time 'ts' (in timeslots) for 'addr' into the defragmenter.  Returns 0 or
+ * a negative error if the segment was dropped */
+int tllc_defrag_in(struct tllc_state *llcs, uint32_t addr,
+		   const struct tetra_llc_pdu *lpp, uint32_t ts);
+
+/* take the complete TL-SDU after a FINAL segment and check its FCS, if
+ * any.  Returns a msgb with the unpacked bits at l3h, which the caller has
+ * to free, or NULL */
+struct msgb *tllc_defrag_out(struct tllc_state *llcs, uint32_t addr,
+			     const struct tetra_llc_pdu *lpp);
+
+/* drop all reassemblies which did not see a segment in llcs->rx.timeout */
+void tllc_defrag_expire(struct tllc_state *llcs, uint32_t ts);
 
-	struct msgb *tl_sdu;
-};
 #endif /* TETRA_LLC_PDU_H */
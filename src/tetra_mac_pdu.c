@@ -29,111 +29,115 @@
 
 #include "tetra_common.h"
 #include "tetra_mac_pdu.h"
+#include "tetra_field.h"
 
-static void decode_d_mle_sysinfo(struct tetra_mle_si_decoded *msid, const uint8_t *bits)
-{
-	const uint8_t *cur = bits;
+/* see 21.4.4.1 */
+enum {
+	SI_HDR, SI_MAIN_CARRIER, SI_FREQ_BAND, SI_FREQ_OFFSET, SI_DUPLEX_SPC,
+	SI_REVERSE_OP, SI_NUM_CSCH, SI_TXPWR_MAX, SI_RXLEV_MIN, SI_ACC_PARAM,
+	SI_RADIO_DL_TOUT, SI_CCK_VALID, SI_CCK_ID, SI_HYPERFRAME, SI_OPT_FIELD,
+	SI_OPT_VALUE, SI_MLE_LA, SI_MLE_SUBSCR_CLASS, SI_MLE_BS_SERV_DET,
+	_SI_NUM
+};
 
-	msid->la = bits_to_uint(cur, 14); cur += 14;
-	msid->subscr_class = bits_to_uint(cur, 16); cur += 16;
-	msid->bs_service_details = bits_to_uint(cur, 12); cur += 12;
-}
+static const struct tetra_field_desc sysinfo_fields[_SI_NUM] = {
+	/* Broadcast PDU header, Sysinfo PDU header */
+	[SI_HDR]		= TF_SKIP(2+2),
+	[SI_MAIN_CARRIER]	= TF(struct tetra_si_decoded, main_carrier, 12),
+	[SI_FREQ_BAND]		= TF(struct tetra_si_decoded, freq_band, 4),
+	[SI_FREQ_OFFSET]	= TF(struct tetra_si_decoded, freq_offset, 2),
+	[SI_DUPLEX_SPC]		= TF(struct tetra_si_decoded, duplex_spacing, 3),
+	[SI_REVERSE_OP]		= TF(struct tetra_si_decoded, reverse_operation, 1),
+	[SI_NUM_CSCH]		= TF(struct tetra_si_decoded, num_of_csch, 2),
+	[SI_TXPWR_MAX]		= TF(struct tetra_si_decoded, ms_txpwr_max_cell, 3),
+	[SI_RXLEV_MIN]		= TF(struct tetra_si_decoded, rxlev_access_min, 4),
+	[SI_ACC_PARAM]		= TF(struct tetra_si_decoded, access_parameter, 4),
+	[SI_RADIO_DL_TOUT]	= TF(struct tetra_si_decoded, radio_dl_timeout, 4),
+	[SI_CCK_VALID]		= TF(struct tetra_si_decoded, cck_valid_no_hf, 1),
+	[SI_CCK_ID]		= TF_IF(struct tetra_si_decoded, cck_id, 16,
+					TF_C_EQ, SI_CCK_VALID, 1),
+	[SI_HYPERFRAME]		= TF_IF(struct tetra_si_decoded, hyperframe_number, 16,
+					TF_C_EQ, SI_CCK_VALID, 0),
+	[SI_OPT_FIELD]		= TF(struct tetra_si_decoded, option_field, 2),
+	/* frame_bitmap, access_code and ext_service share a union */
+	[SI_OPT_VALUE]		= TF(struct tetra_si_decoded, frame_bitmap, 20),
+	/* TM-SDU: D-MLE-SYSINFO */
+	[SI_MLE_LA]		= TF(struct tetra_si_decoded, mle_si.la, 14),
+	[SI_MLE_SUBSCR_CLASS]	= TF(struct tetra_si_decoded, mle_si.subscr_class, 16),
+	[SI_MLE_BS_SERV_DET]	= TF(struct tetra_si_decoded, mle_si.bs_service_details, 12),
+};
 
-/* see 21.4.4.1 */
 void macpdu_decode_sysinfo(struct tetra_si_decoded *sid, const uint8_t *si_bits)
 {
-	const uint8_t *cur     = si_bits;
-	cur += 2; // skip Broadcast PDU header
-	cur += 2; // skip Sysinfo PDU header
-
-	sid->main_carrier      = bits_to_uint(cur, 12); cur += 12;
-	sid->freq_band         = bits_to_uint(cur,  4); cur +=  4;
-	sid->freq_offset       = bits_to_uint(cur,  2); cur +=  2;
-	sid->duplex_spacing    = bits_to_uint(cur,  3); cur +=  3;
-	sid->reverse_operation = *cur++;
-	sid->num_of_csch       = bits_to_uint(cur,  2); cur +=  2;
-	sid->ms_txpwr_max_cell = bits_to_uint(cur,  3); cur +=  3;
-	sid->rxlev_access_min  = bits_to_uint(cur,  4); cur +=  4;
-	sid->access_parameter  = bits_to_uint(cur,  4); cur +=  4;
-	sid->radio_dl_timeout  = bits_to_uint(cur,  4); cur +=  4;
-	sid->cck_valid_no_hf   = *cur++;
-	if (sid->cck_valid_no_hf)
-		sid->cck_id = bits_to_uint(cur, 16);
-	else
-		sid->hyperframe_number = bits_to_uint(cur, 16);
-	
-	sid->option_field      = bits_to_uint(cur,  2); cur +=  2;
-	switch(sid->option_field)
-	{
-	  case TETRA_MAC_OPT_FIELD_EVEN_MULTIFRAME:     // Even multiframe definition for TS mode
-	  case TETRA_MAC_OPT_FIELD_ODD_MULTIFRAME:      // Odd multiframe definition for TS mode
-	    sid->frame_bitmap = bits_to_uint(cur, 20); cur += 20;
-	    break;
-	  case TETRA_MAC_OPT_FIELD_ACCESS_CODE:         // Default definition for access code A
-	    sid->access_code = bits_to_uint(cur, 20); cur += 20;
-	    break;
-	  case TETRA_MAC_OPT_FIELD_EXT_SERVICES:        // Extended services broadcast
-	    sid->ext_service = bits_to_uint(cur, 20); cur += 20;
-	    break;
-	}
+	tetra_field_decode(sysinfo_fields, _SI_NUM, si_bits, sid, NULL);
+}
 
-	decode_d_mle_sysinfo(&sid->mle_si, si_bits + 124-42);  // could be also cur due to previous fixes
+int macpdu_encode_sysinfo(const struct tetra_si_decoded *sid, uint8_t *si_bits)
+{
+	uint32_t vals[_SI_NUM] = {
+		[SI_HDR]	= (TETRA_PDU_T_BROADCAST << 2) | TETRA_MAC_BC_SYSINFO,
+	};
+
+	return tetra_field_encode(sysinfo_fields, _SI_NUM, sid, vals, si_bits);
 }
 
-static const uint8_t addr_len_by_type[] = {
-	[ADDR_TYPE_SSI]		= 24,
-	[ADDR_TYPE_EVENT_LABEL]	= 10,
-	[ADDR_TYPE_USSI]	= 24,
-	[ADDR_TYPE_SMI]		= 24,
-	[ADDR_TYPE_SSI_EVENT]	= 34,
-	[ADDR_TYPE_SSI_USAGE]	= 30,
-	[ADDR_TYPE_SMI_EVENT]	= 34,
+/* 21.5.2 */
+enum {
+	CA_TYPE, CA_TIMESLOT, CA_UL_DL, CA_CLCH_PERM, CA_CELL_CHG, CA_CARRIER,
+	CA_EXT_CARR_PRES, CA_EXT_BAND, CA_EXT_OFFSET, CA_EXT_DUPLEX, CA_EXT_REVERSE,
+	CA_MONIT_PATT, CA_MONIT_F18,
+	/* augmented channel allocation, only for ul_dl == 0 */
+	CA_AUG_UL_DL, CA_AUG_BW, CA_AUG_MOD, CA_AUG_MAX_UL_QAM, CA_AUG_RES1,
+	CA_AUG_CONF_CHAN, CA_AUG_BS_IMBAL, CA_AUG_BS_TX_REL, CA_AUG_NAPPING,
+	CA_AUG_NAPPING_INFO, CA_AUG_RES2, CA_AUG_COND1, CA_AUG_COND1_ELEM,
+	CA_AUG_COND2, CA_AUG_COND2_ELEM, CA_AUG_FURTHER,
+	_CA_NUM
+};
+
+#define CA_AUG(memb, bits) \
+	TF_IF(struct tetra_chan_alloc_decoded, aug.memb, bits, TF_C_EQ, CA_UL_DL, 0)
+
+static const struct tetra_field_desc chan_alloc_fields[_CA_NUM] = {
+	[CA_TYPE]		= TF(struct tetra_chan_alloc_decoded, type, 2),
+	[CA_TIMESLOT]		= TF(struct tetra_chan_alloc_decoded, timeslot, 4),
+	[CA_UL_DL]		= TF(struct tetra_chan_alloc_decoded, ul_dl, 2),
+	[CA_CLCH_PERM]		= TF(struct tetra_chan_alloc_decoded, clch_perm, 1),
+	[CA_CELL_CHG]		= TF(struct tetra_chan_alloc_decoded, cell_chg_f, 1),
+	[CA_CARRIER]		= TF(struct tetra_chan_alloc_decoded, carrier_nr, 12),
+	[CA_EXT_CARR_PRES]	= TF(struct tetra_chan_alloc_decoded, ext_carr_pres, 1),
+	[CA_EXT_BAND]		= TF_IF(struct tetra_chan_alloc_decoded, ext_carr.freq_band, 4,
+					TF_C_EQ, CA_EXT_CARR_PRES, 1),
+	[CA_EXT_OFFSET]		= TF_IF(struct tetra_chan_alloc_decoded, ext_carr.freq_offset, 2,
+					TF_C_EQ, CA_EXT_CARR_PRES, 1),
+	[CA_EXT_DUPLEX]		= TF_IF(struct tetra_chan_alloc_decoded, ext_carr.duplex_spc, 3,
+					TF_C_EQ, CA_EXT_CARR_PRES, 1),
+	[CA_EXT_REVERSE]	= TF_IF(struct tetra_chan_alloc_decoded, ext_carr.reverse_oper, 1,
+					TF_C_EQ, CA_EXT_CARR_PRES, 1),
+	[CA_MONIT_PATT]		= TF(struct tetra_chan_alloc_decoded, monit_pattern, 2),
+	[CA_MONIT_F18]		= TF_IF(struct tetra_chan_alloc_decoded, monit_patt_f18, 2,
+					TF_C_EQ, CA_MONIT_PATT, 0),
+	[CA_AUG_UL_DL]		= CA_AUG(ul_dl_ass, 2),
+	[CA_AUG_BW]		= CA_AUG(bandwidth, 3),
+	[CA_AUG_MOD]		= CA_AUG(modulation, 3),
+	[CA_AUG_MAX_UL_QAM]	= CA_AUG(max_ul_qam, 3),
+	[CA_AUG_RES1]		= TF_SKIP_IF(3, TF_C_EQ, CA_UL_DL, 0),
+	[CA_AUG_CONF_CHAN]	= CA_AUG(conf_chan_stat, 3),
+	[CA_AUG_BS_IMBAL]	= CA_AUG(bs_imbalance, 4),
+	[CA_AUG_BS_TX_REL]	= CA_AUG(bs_tx_rel, 5),
+	[CA_AUG_NAPPING]	= CA_AUG(napping_sts, 2),
+	/* napping information 21.5.2c */
+	[CA_AUG_NAPPING_INFO]	= TF_SKIP_IF(11, TF_C_EQ, CA_AUG_NAPPING, 1),
+	[CA_AUG_RES2]		= TF_SKIP_IF(4, TF_C_EQ, CA_UL_DL, 0),
+	[CA_AUG_COND1]		= TF_SKIP_IF(1, TF_C_EQ, CA_UL_DL, 0),
+	[CA_AUG_COND1_ELEM]	= TF_SKIP_IF(16, TF_C_EQ, CA_AUG_COND1, 1),
+	[CA_AUG_COND2]		= TF_SKIP_IF(1, TF_C_EQ, CA_UL_DL, 0),
+	[CA_AUG_COND2_ELEM]	= TF_SKIP_IF(16, TF_C_EQ, CA_AUG_COND2, 1),
+	[CA_AUG_FURTHER]	= TF_SKIP_IF(1, TF_C_EQ, CA_UL_DL, 0),
 };
 
-/* 21.5.2 */
 static int decode_chan_alloc(struct tetra_chan_alloc_decoded *cad, const uint8_t *bits)
 {
-	const uint8_t *cur = bits;
-
-	cad->type = 		bits_to_uint(cur, 2); cur += 2;
-	cad->timeslot = 	bits_to_uint(cur, 4); cur += 4;
-	cad->ul_dl = 		bits_to_uint(cur, 2); cur += 2;
-	cad->clch_perm = 	*cur++;
-	cad->cell_chg_f = 	*cur++;
-	cad->carrier_nr = 	bits_to_uint(cur, 12); cur += 12;
-
-	cad->ext_carr_pres =	*cur++;
-	if (cad->ext_carr_pres) {
-		cad->ext_carr.freq_band =	bits_to_uint(cur, 4); cur += 4;
-		cad->ext_carr.freq_offset =	bits_to_uint(cur, 2); cur += 2;
-		cad->ext_carr.duplex_spc =	bits_to_uint(cur, 3); cur += 3;
-		cad->ext_carr.reverse_oper =	bits_to_uint(cur, 1); cur += 1;
-	}
-	cad->monit_pattern =	bits_to_uint(cur, 2); cur += 2;
-	if (cad->monit_pattern == 0) {
-		cad->monit_patt_f18 =	bits_to_uint(cur, 2);
-		cur += 2;
-	}
-	if (cad->ul_dl == 0) {
-		cad->aug.ul_dl_ass =	bits_to_uint(cur, 2); cur += 2;
-		cad->aug.bandwidth =	bits_to_uint(cur, 3); cur += 3;
-		cad->aug.modulation =	bits_to_uint(cur, 3); cur += 3;
-		cad->aug.max_ul_qam =	bits_to_uint(cur, 3); cur += 3;
-		cur += 3; /* reserved */
-		cad->aug.conf_chan_stat=bits_to_uint(cur, 3); cur += 3;
-		cad->aug.bs_imbalance =	bits_to_uint(cur, 4); cur += 4;
-		cad->aug.bs_tx_rel =	bits_to_uint(cur, 5); cur += 5;
-		cad->aug.napping_sts =	bits_to_uint(cur, 2); cur += 2;
-		if (cad->aug.napping_sts == 1)
-			cur += 11; /* napping info 21.5.2c */
-		cur += 4; /* reserved */
-		if (*cur++)
-			cur += 16;
-		if (*cur++)
-			cur += 16;
-		cur++;
-	}
-	return cur - bits;
+	return tetra_field_decode(chan_alloc_fields, _CA_NUM, bits, cad, NULL);
 }
 
 /* According to table 21.90 */
@@ -160,9 +164,6 @@ static int decode_nr_slots(uint8_t in)
 	return dec_tbl[in & 0xf];
 }
 
-#define MACPDU_LEN_2ND_STOLEN	-1
-#define MACPDU_LEN_START_FRAG	-2
-
 static int decode_length(unsigned int length_ind)
 {
 	/* FIXME: Y2/Z2 for non-pi4 DQPSK */
@@ -183,62 +184,66 @@ static int decode_length(unsigned int length_ind)
 }
 
 /* Section 21.4.3.1 MAC-RESOURCE */
+enum {
+	RS_HDR, RS_ENCR, RS_RAND_ACC, RS_LENGTH, RS_ADDR_TYPE, RS_SSI,
+	RS_EVENT_LABEL, RS_USAGE_MARKER, RS_PWR_CTRL_PRES, RS_PWR_CTRL,
+	RS_SLOT_GRANT_PRES, RS_SLOT_GRANT_NR, RS_SLOT_GRANT_DELAY,
+	RS_CHAN_ALLOC_PRES,
+	_RS_NUM
+};
+
+#define ADDR_T(x)	(1 << ADDR_TYPE_##x)
+
+/* nothing follows the address of a Null PDU */
+#define RS_IF_NOT_NULL(memb, bits) \
+	TF_IF(struct tetra_resrc_decoded, memb, bits, \
+	      TF_C_NE, RS_ADDR_TYPE, ADDR_TYPE_NULL)
+
+static const struct tetra_field_desc resrc_fields[_RS_NUM] = {
+	/* MAC PDU type, fill bit indication, position of grant */
+	[RS_HDR]		= TF_SKIP(4),
+	[RS_ENCR]		= TF(struct tetra_resrc_decoded, encryption_mode, 2),
+	[RS_RAND_ACC]		= TF(struct tetra_resrc_decoded, rand_acc_flag, 1),
+	/* length indication, see decode_length() */
+	[RS_LENGTH]		= TF_SKIP(6),
+	[RS_ADDR_TYPE]		= TF(struct tetra_resrc_decoded, addr.type, 3),
+	[RS_SSI]		= TF_IF(struct tetra_resrc_decoded, addr.ssi, 24,
+					TF_C_IN, RS_ADDR_TYPE,
+					ADDR_T(SSI) | ADDR_T(USSI) | ADDR_T(SMI) |
+					ADDR_T(SSI_EVENT) | ADDR_T(SSI_USAGE) |
+					ADDR_T(SMI_EVENT)),
+	[RS_EVENT_LABEL]	= TF_IF(struct tetra_resrc_decoded, addr.event_label, 10,
+					TF_C_IN, RS_ADDR_TYPE,
+					ADDR_T(EVENT_LABEL) | ADDR_T(SSI_EVENT) |
+					ADDR_T(SMI_EVENT)),
+	[RS_USAGE_MARKER]	= TF_IF(struct tetra_resrc_decoded, addr.usage_marker, 6,
+					TF_C_EQ, RS_ADDR_TYPE, ADDR_TYPE_SSI_USAGE),
+	/* no intermediate napping in pi/4 */
+	[RS_PWR_CTRL_PRES]	= RS_IF_NOT_NULL(power_control_pres, 1),
+	[RS_PWR_CTRL]		= TF_SKIP_IF(4, TF_C_EQ, RS_PWR_CTRL_PRES, 1),
+	/* no multiple slot granting flag, it can only exist in QAM */
+	[RS_SLOT_GRANT_PRES]	= RS_IF_NOT_NULL(slot_granting.pres, 1),
+	/* see decode_nr_slots() */
+	[RS_SLOT_GRANT_NR]	= TF_SKIP_IF(4, TF_C_EQ, RS_SLOT_GRANT_PRES, 1),
+	[RS_SLOT_GRANT_DELAY]	= TF_IF(struct tetra_resrc_decoded, slot_granting.delay, 4,
+					TF_C_EQ, RS_SLOT_GRANT_PRES, 1),
+	[RS_CHAN_ALLOC_PRES]	= RS_IF_NOT_NULL(chan_alloc_pres, 1),
+};
+
 int macpdu_decode_resource(struct tetra_resrc_decoded *rsd, const uint8_t *bits)
 {
-	const uint8_t *cur = bits + 4;
+	uint32_t vals[_RS_NUM];
+	const uint8_t *cur = bits;
 
-	rsd->encryption_mode = bits_to_uint(cur, 2); cur += 2;
-	rsd->rand_acc_flag = *cur++;
-	rsd->macpdu_length = decode_length(bits_to_uint(cur, 6)); cur += 6;
-	rsd->addr.type = bits_to_uint(cur, 3); cur += 3;
-	switch (rsd->addr.type) {
-	case ADDR_TYPE_NULL:
+	cur += tetra_field_decode(resrc_fields, _RS_NUM, cur, rsd, vals);
+
+	rsd->fill_bits = (vals[RS_HDR] >> 1) & 1;
+	rsd->macpdu_length = decode_length(vals[RS_LENGTH]);
+	if (rsd->addr.type == ADDR_TYPE_NULL)
 		return 0;
-		break;
-	case ADDR_TYPE_SSI:
-	case ADDR_TYPE_USSI:
-	case ADDR_TYPE_SMI:
-		rsd->addr.ssi = bits_to_uint(cur, 24);
-		break;
-	case ADDR_TYPE_EVENT_LABEL:
-		rsd->addr.event_label = bits_to_uint(cur, 10);
-		break;
-	case ADDR_TYPE_SSI_EVENT:
-	case ADDR_TYPE_SMI_EVENT:
-		rsd->addr.ssi = bits_to_uint(cur, 24);
-		rsd->addr.event_label = bits_to_uint(cur+24, 10);
-		break;
-	case ADDR_TYPE_SSI_USAGE:
-		rsd->addr.ssi = bits_to_uint(cur, 24);
-		rsd->addr.usage_marker = bits_to_uint(cur+24, 6);
-		break;
-	default:
-		return -EINVAL;
-		break;
-	}
-	cur += addr_len_by_type[rsd->addr.type];
-	/* no intermediate napping in pi/4 */
-	rsd->power_control_pres = *cur++;
-	if (rsd->power_control_pres)
-		cur += 4;
-	rsd->slot_granting.pres = *cur++;
-	if (rsd->slot_granting.pres) {
-#if 0
-		/* check for multiple slot granting flag (can only exist in QAM) */
-		if (*cur++) {
-			cur += 0; //FIXME;
-		} else {
-#endif
-			rsd->slot_granting.nr_slots =
-				decode_nr_slots(bits_to_uint(cur, 4));
-			cur += 4;
-			rsd->slot_granting.delay = bits_to_uint(cur, 4);
-			cur += 4;
-#if 0
-		}
-#endif
-	}
-	rsd->chan_alloc_pres = *cur++;
+	if (rsd->slot_granting.pres)
+		rsd->slot_granting.nr_slots = decode_nr_slots(vals[RS_SLOT_GRANT_NR]);
+
 	/* FIXME: If encryption is enabled, Channel Allocation is encrypted !!! */
 	if (rsd->chan_alloc_pres)
 		cur += decode_chan_alloc(&rsd->cad, cur);
@@ -247,6 +252,35 @@ int macpdu_decode_resource(struct tetra_resrc_decoded *rsd, const uint8_t *bits)
 	return cur - bits;
 }
 
+int macpdu_encode_resource(const struct tetra_resrc_decoded *rsd, int fill, uint8_t *bits)
+{
+	uint32_t vals[_RS_NUM];
+	uint8_t *cur = bits;
+	int i;
+
+	memset(vals, 0, sizeof(vals));
+	/* decode_length() is the identity for pi/4-DQPSK */
+	if (rsd->macpdu_length < 1 || rsd->macpdu_length > 0x3a)
+		return -EINVAL;
+	vals[RS_HDR] = (TETRA_PDU_T_MAC_RESOURCE << 2) | (fill ? 2 : 0);
+	vals[RS_LENGTH] = rsd->macpdu_length;
+	if (rsd->slot_granting.pres) {
+		for (i = 0; i < 16; i++) {
+			if (decode_nr_slots(i) == rsd->slot_granting.nr_slots)
+				break;
+		}
+		if (i == 16)
+			return -EINVAL;
+		vals[RS_SLOT_GRANT_NR] = i;
+	}
+
+	cur += tetra_field_encode(resrc_fields, _RS_NUM, rsd, vals, cur);
+	if (rsd->addr.type != ADDR_TYPE_NULL && rsd->chan_alloc_pres)
+		cur += tetra_field_encode(chan_alloc_fields, _CA_NUM, &rsd->cad, NULL, cur);
+
+	return cur - bits;
+}
+
 static void decode_access_field(struct tetra_access_field *taf, uint8_t field)
 {
 	field &= 0x3f;
@@ -255,12 +289,26 @@ static void decode_access_field(struct tetra_access_field *taf, uint8_t field)
 }
 
 /* Section 21.4.7.2 ACCESS-ASSIGN PDU */
+enum {
+	AA_HDR, AA_FIELD1, AA_FIELD2,
+	_AA_NUM
+};
+
+/* the meaning of both fields depends on header and frame number */
+static const struct tetra_field_desc acc_ass_fields[_AA_NUM] = {
+	[AA_HDR]	= TF(struct tetra_acc_ass_decoded, hdr, 2),
+	[AA_FIELD1]	= TF_SKIP(6),
+	[AA_FIELD2]	= TF_SKIP(6),
+};
+
 void macpdu_decode_access_assign(struct tetra_acc_ass_decoded *aad, const uint8_t *bits, int f18)
 {
+	uint32_t vals[_AA_NUM];
 	uint8_t field1, field2;
-	aad->hdr = bits_to_uint(bits, 2);
-	field1 = bits_to_uint(bits+2, 6);
-	field2 = bits_to_uint(bits+8, 6);
+
+	tetra_field_decode(acc_ass_fields, _AA_NUM, bits, aad, vals);
+	field1 = vals[AA_FIELD1];
+	field2 = vals[AA_FIELD2];
 
 	if (f18 == 0) {
 		switch (aad->hdr) {
@@ -330,6 +378,31 @@ void macpdu_decode_access_assign(struct tetra_acc_ass_decoded *aad, const uint8_
 	}
 }
 
+static uint8_t encode_access_field(const struct tetra_access_field *taf)
+{
+	return ((taf->access_code & 3) << 4) | (taf->base_frame_len & 0xf);
+}
+
+int macpdu_encode_access_assign(const struct tetra_acc_ass_decoded *aad, uint8_t *bits, int f18)
+{
+	uint32_t vals[_AA_NUM];
+
+	vals[AA_FIELD1] = encode_access_field(&aad->access[0]);
+	vals[AA_FIELD2] = encode_access_field(&aad->access[1]);
+	if (f18 == 0) {
+		/* all but the first header carry the DL usage marker */
+		if (aad->hdr != TETRA_ACC_ASS_DLCC_ULCO)
+			vals[AA_FIELD1] = aad->dl_usage;
+		if (aad->hdr == TETRA_ACC_ASS_DLF1_ULF1)
+			vals[AA_FIELD2] = aad->ul_usage;
+	} else if (aad->hdr == TETRA_ACC_ASS_ULCA2) {
+		/* FIXME: traffic usage marker */
+		vals[AA_FIELD1] = 0;
+	}
+
+	return tetra_field_encode(acc_ass_fields, _AA_NUM, aad, vals, bits);
+}
+
 static const struct value_string tetra_macpdu_t_names[5] = {
 	{ TETRA_PDU_T_MAC_RESOURCE,	"RESOURCE" },
 	{ TETRA_PDU_T_MAC_FRAG_END,	"FRAG/END" },
@@ -79,6 +79,8 @@ struct tetra_si_decoded {
 const char *tetra_get_macpdu_name(uint8_t pdu_type);
 
 void macpdu_decode_sysinfo(struct tetra_si_decoded *sid, const uint8_t *si_bits);
+/* the 124 bits of a SYSINFO PDU, returns their number */
+int macpdu_encode_sysinfo(const struct tetra_si_decoded *sid, uint8_t *si_bits);
 
 
 /* Section 21.4.7.2 ACCESS-ASSIGN PDU */
@@ -151,6 +153,8 @@ struct tetra_acc_ass_decoded {
 };
 
 void macpdu_decode_access_assign(struct tetra_acc_ass_decoded *aad, const uint8_t *bits, int f18);
+/* the 14 bits of an ACCESS-ASSIGN PDU, fields as selected by the header */
+int macpdu_encode_access_assign(const struct tetra_acc_ass_decoded *aad, uint8_t *bits, int f18);
 const char *tetra_get_dl_usage_name(uint8_t num);
 const char *tetra_get_ul_usage_name(uint8_t num);
 
@@ -212,9 +216,14 @@ struct tetra_addr {
 	uint8_t usage_marker;
 };
 
+/* special values of tetra_resrc_decoded.macpdu_length */
+#define MACPDU_LEN_2ND_STOLEN	-1
+#define MACPDU_LEN_START_FRAG	-2
+
 struct tetra_resrc_decoded {
 	uint8_t encryption_mode;
 	uint8_t rand_acc_flag;
+	uint8_t fill_bits;	/* the PDU ends with fill bits */
 	int macpdu_length;
 	struct tetra_addr addr;
 
@@ -230,6 +239,10 @@ struct tetra_resrc_decoded {
 	struct tetra_chan_alloc_decoded cad;
 };
 int macpdu_decode_resource(struct tetra_resrc_decoded *rsd, const uint8_t *bits);
+/* The header of a MAC-RESOURCE PDU of rsd->macpdu_length octets, up to
+ * the TM-SDU.  'fill' is the fill bit indication.  Returns the number of
+ * bits written, or -EINVAL if the length cannot be encoded. */
+int macpdu_encode_resource(const struct tetra_resrc_decoded *rsd, int fill, uint8_t *bits);
 
 const char *tetra_addr_dump(const struct tetra_addr *addr);
 
@@ -27,7 +27,7 @@ struct tmv_unitdata_param {
 	enum tetra_log_chan lchan;	/* to which lchan do we belong? */
 	int crc_ok;			/* was the CRC verified OK? */
 	uint32_t scrambling_code;	/* which scrambling code was used */
-	struct tetra_tdma_time tdma_time;/* TDMA timestamp  */
+	uint64_t tdma_slot;		/* TDMA timestamp, see tetra_tdma.h */
 	//uint8_t mac_block[412];		/* maximum num of bits in a non-QAM chan */
 };
 
@@ -0,0 +1,268 @@
+/* Shared memory ring of decoded MAC blocks */
+
+/* (C) 2026 by agent <agent@local>
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <osmocom/core/bits.h>
+#include <osmocom/core/talloc.h>
+
+#include "tetra_shm.h"
+
+struct tetra_shm {
+	struct tetra_shm_hdr *hdr;
+	struct tetra_shm_rec *rec;
+	size_t map_len;
+	uint32_t mask;
+
+	/* reader only */
+	struct tetra_shm_reader_info *ri;
+	uint64_t pos;
+	uint64_t lost;
+};
+
+static size_t shm_len(unsigned int num_slots)
+{
+	return sizeof(struct tetra_shm_hdr) + num_slots * sizeof(struct tetra_shm_rec);
+}
+
+static struct tetra_shm *shm_map(void *ctx, int fd, size_t len, int prot)
+{
+	struct tetra_shm *shm;
+	void *map;
+
+	map = mmap(NULL, len, prot, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	shm = talloc_zero(ctx, struct tetra_shm);
+	if (!shm) {
+		munmap(map, len);
+		return NULL;
+	}
+	shm->hdr = map;
+	shm->rec = (struct tetra_shm_rec *) (shm->hdr + 1);
+	shm->map_len = len;
+
+	return shm;
+}
+
+struct tetra_shm *tetra_shm_create(void *ctx, const char *name, unsigned int num_slots)
+{
+	struct tetra_shm *shm;
+	size_t len;
+	int fd;
+
+	if (!num_slots)
+		num_slots = TETRA_SHM_DEFAULT_SLOTS;
+	if (num_slots & (num_slots - 1))
+		return NULL;
+	len = shm_len(num_slots);
+
+	fd = shm_open(name, O_RDWR|O_CREAT, 0644);
+	if (fd < 0)
+		return NULL;
+	if (ftruncate(fd, len) < 0) {
+		close(fd);
+		return NULL;
+	}
+	shm = shm_map(ctx, fd, len, PROT_READ|PROT_WRITE);
+	close(fd);
+	if (!shm)
+		return NULL;
+
+	/* readers wait for the magic, so it is written last */
+	memset(shm->hdr, 0, len);
+	shm->hdr->version = TETRA_SHM_VERSION;
+	shm->hdr->rec_size = sizeof(struct tetra_shm_rec);
+	shm->hdr->num_slots = num_slots;
+	__atomic_store_n(&shm->hdr->magic, TETRA_SHM_MAGIC, __ATOMIC_RELEASE);
+	shm->mask = num_slots - 1;
+
+	return shm;
+}
+
+/* claim a free reader slot, or one of a process which has gone away */
+static struct tetra_shm_reader_info *reader_register(struct tetra_shm_hdr *hdr)
+{
+	uint32_t me = getpid();
+	int i;
+
+	for (i = 0; i < TETRA_SHM_MAX_READERS; i++) {
+		struct tetra_shm_reader_info *ri = &hdr->reader[i];
+		uint32_t pid = __atomic_load_n(&ri->pid, __ATOMIC_RELAXED);
+
+		if (pid && (kill(pid, 0) == 0 || errno != ESRCH))
+			continue;
+		if (__atomic_compare_exchange_n(&ri->pid, &pid, me, 0,
+						__ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			return ri;
+	}
+	return NULL;
+}
+
+struct tetra_shm *tetra_shm_attach(void *ctx, const char *name)
+{
+	struct tetra_shm_hdr hdr;
+	struct tetra_shm *shm;
+	int fd, prot = PROT_READ|PROT_WRITE;
+
+	/* readers only write their own reader slot: without write access
+	 * to the object they follow the ring unregistered */
+	fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0 && errno == EACCES) {
+		fd = shm_open(name, O_RDONLY, 0);
+		prot = PROT_READ;
+	}
+	if (fd < 0)
+		return NULL;
+	if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+	    hdr.magic != TETRA_SHM_MAGIC || hdr.version != TETRA_SHM_VERSION ||
+	    hdr.rec_size != sizeof(struct tetra_shm_rec) ||
+	    !hdr.num_slots || (hdr.num_slots & (hdr.num_slots - 1))) {
+		close(fd);
+		return NULL;
+	}
+	shm = shm_map(ctx, fd, shm_len(hdr.num_slots), prot);
+	close(fd);
+	if (!shm)
+		return NULL;
+	shm->mask = hdr.num_slots - 1;
+
+	if (prot & PROT_WRITE)
+		shm->ri = reader_register(shm->hdr);
+	shm->pos = __atomic_load_n(&shm->hdr->head, __ATOMIC_ACQUIRE);
+	if (shm->ri) {
+		shm->ri->pos = shm->pos;
+		shm->ri->lost = 0;
+	}
+
+	return shm;
+}
+
+void tetra_shm_close(struct tetra_shm *shm)
+{
+	if (shm->ri)
+		__atomic_store_n(&shm->ri->pid, 0, __ATOMIC_RELEASE);
+	munmap(shm->hdr, shm->map_len);
+	talloc_free(shm);
+}
+
+int tetra_shm_publish(struct tetra_shm *shm, uint32_t ts, uint8_t tn, uint8_t fn,
+		      uint8_t mn, uint8_t lchan, uint8_t crc_ok,
+		      uint32_t scrambling_code, const uint8_t *bits,
+		      unsigned int num_bits)
+{
+	uint64_t n = shm->hdr->head;
+	struct tetra_shm_rec *rec = &shm->rec[n & shm->mask];
+
+	if (num_bits > TETRA_SHM_MAX_BITS)
+		return -EMSGSIZE;
+
+	/* invalidate the slot before touching its contents */
+	__atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	rec->ts = ts;
+	rec->scrambling_code = scrambling_code;
+	rec->num_bits = num_bits;
+	rec->lchan = lchan;
+	rec->crc_ok = crc_ok;
+	rec->tn = tn;
+	rec->fn = fn;
+	rec->mn = mn;
+	osmo_ubit2pbit(rec->bits, bits, num_bits);
+
+	__atomic_store_n(&rec->seq, n + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&shm->hdr->head, n + 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+static void reader_skip(struct tetra_shm *shm, uint64_t head)
+{
+	uint64_t oldest = head - shm->mask;
+
+	/* leave one slot of headroom for the record being written */
+	if (shm->pos < oldest) {
+		shm->lost += oldest - shm->pos;
+		shm->pos = oldest;
+		if (shm->ri)
+			__atomic_store_n(&shm->ri->lost, shm->lost, __ATOMIC_RELAXED);
+	}
+}
+
+const struct tetra_shm_rec *tetra_shm_peek(struct tetra_shm *shm)
+{
+	while (1) {
+		uint64_t head = __atomic_load_n(&shm->hdr->head, __ATOMIC_ACQUIRE);
+		const struct tetra_shm_rec *rec;
+		uint64_t seq;
+
+		if (shm->pos >= head)
+			return NULL;
+		if (head - shm->pos > shm->mask)
+			reader_skip(shm, head);
+
+		rec = &shm->rec[shm->pos & shm->mask];
+		seq = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+		if (seq == shm->pos + 1)
+			return rec;
+
+		/* overwritten since we loaded head, try again further on */
+		reader_skip(shm, __atomic_load_n(&shm->hdr->head, __ATOMIC_ACQUIRE) + 1);
+	}
+}
+
+int tetra_shm_consume(struct tetra_shm *shm, const struct tetra_shm_rec *rec)
+{
+	int rc = 0;
+
+	/* all reads of the record happen before we check it is still ours */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (__atomic_load_n(&rec->seq, __ATOMIC_RELAXED) != shm->pos + 1) {
+		shm->lost++;
+		rc = -ESTALE;
+	}
+	shm->pos++;
+	if (shm->ri) {
+		__atomic_store_n(&shm->ri->pos, shm->pos, __ATOMIC_RELAXED);
+		__atomic_store_n(&shm->ri->lost, shm->lost, __ATOMIC_RELAXED);
+	}
+
+	return rc;
+}
+
+uint64_t tetra_shm_lost(const struct tetra_shm *shm)
+{
+	return shm->lost;
+}
+
+const struct tetra_shm_hdr *tetra_shm_get_hdr(const struct tetra_shm *shm)
+{
+	return shm->hdr;
+}
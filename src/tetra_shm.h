@@ -0,0 +1,89 @@
+#ifndef TETRA_SHM_H
+#define TETRA_SHM_H
+
+#include <stdint.h>
+
+/* Shared memory ring of decoded MAC blocks.
+ *
+ * The decoder publishes one fixed size record per TMV-UNITDATA.ind into a
+ * POSIX shared memory object.  Any number of local readers follow the
+ * ring at their own pace, reading the records in place.  The writer never
+ * waits: if a reader falls behind by more than the ring size, the oldest
+ * records are overwritten and counted as lost for that reader.
+ *
+ * Each record is protected by its sequence number: it is 0 while the
+ * writer fills the slot and n+1 once it holds record number n. */
+
+#define TETRA_SHM_MAGIC		0x54534852	/* "TSHR" */
+#define TETRA_SHM_VERSION	1
+#define TETRA_SHM_DEFAULT_SLOTS	4096
+#define TETRA_SHM_MAX_READERS	16
+#define TETRA_SHM_MAX_BITS	320
+
+/* one cache line per block */
+struct tetra_shm_rec {
+	uint64_t seq;		/* record number + 1, 0 while being written */
+	uint32_t ts;		/* low 32 bits of the TDMA slot counter */
+	uint32_t scrambling_code;
+	uint16_t num_bits;	/* number of type-1 bits */
+	uint8_t lchan;		/* enum tetra_log_chan */
+	uint8_t crc_ok;
+	uint8_t tn, fn, mn;
+	uint8_t reserved;
+	uint8_t bits[TETRA_SHM_MAX_BITS/8];	/* packed, MSB first */
+} __attribute__((aligned(64)));
+
+/* readers register here, so their lag is visible to everyone */
+struct tetra_shm_reader_info {
+	uint32_t pid;		/* 0 if unused */
+	uint32_t reserved;
+	uint64_t pos;		/* next record number to read */
+	uint64_t lost;		/* records overwritten before they were read */
+};
+
+struct tetra_shm_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t rec_size;
+	uint32_t num_slots;	/* power of two */
+	uint32_t reserved;
+	uint64_t head;		/* number of records published */
+	struct tetra_shm_reader_info reader[TETRA_SHM_MAX_READERS];
+} __attribute__((aligned(64)));
+
+struct tetra_shm;
+
+/* create (or take over) the shared memory object 'name', e.g. "/tetra",
+ * with 'num_slots' records (0 for the default).  It is created with mode
+ * 0644: readers of other users can follow the ring, but not register */
+struct tetra_shm *tetra_shm_create(void *ctx, const char *name, unsigned int num_slots);
+
+/* attach to an existing ring as a reader, starting at the newest record.
+ * Without write access to the object the ring is mapped read-only, and
+ * the reader takes no reader slot */
+struct tetra_shm *tetra_shm_attach(void *ctx, const char *name);
+
+/* unmap the ring, a reader also gives up its reader slot.  The writer
+ * leaves the object in place, use shm_unlink() to remove it */
+void tetra_shm_close(struct tetra_shm *shm);
+
+/* publish a block of 'num_bits' unpacked type-1 bits.  Never blocks */
+int tetra_shm_publish(struct tetra_shm *shm, uint32_t ts, uint8_t tn, uint8_t fn,
+		      uint8_t mn, uint8_t lchan, uint8_t crc_ok,
+		      uint32_t scrambling_code, const uint8_t *bits,
+		      unsigned int num_bits);
+
+/* the next unread record, in place in the ring, or NULL if there is none.
+ * Records which were overwritten are skipped and counted as lost */
+const struct tetra_shm_rec *tetra_shm_peek(struct tetra_shm *shm);
+
+/* done with the record returned by tetra_shm_peek().  Returns -ESTALE if
+ * the writer overwrote it meanwhile, the data read from it is then void */
+int tetra_shm_consume(struct tetra_shm *shm, const struct tetra_shm_rec *rec);
+
+/* records lost by this reader */
+uint64_t tetra_shm_lost(const struct tetra_shm *shm);
+
+const struct tetra_shm_hdr *tetra_shm_get_hdr(const struct tetra_shm *shm);
+
+#endif /* TETRA_SHM_H */
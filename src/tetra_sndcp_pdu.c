@@ -19,9 +19,12 @@
  */
 
 #include <unistd.h>
+#include <errno.h>
 #include <osmocom/core/utils.h>
 
+#include "tetra_common.h"
 #include "tetra_sndcp_pdu.h"
+#include "tetra_field.h"
 
 static const struct value_string sndcp_pdut_names[] = {
 	{ SNDCP_PDU_T_ACT_PDP_ACCEPT,	"SN-ACTIVATE PDP ACCEPT" },
@@ -46,3 +49,40 @@ const char *tetra_get_sndcp_pdut_name(uint8_t pdut, int uplink)
 	/* FIXME: uplink */
 	return get_value_string(sndcp_pdut_names, pdut);
 }
+
+enum {
+	SN_PDU_TYPE, SN_NSAPI, SN_PCOMP, SN_DCOMP,
+	_SN_NUM
+};
+
+static const struct tetra_field_desc sndcp_data_fields[_SN_NUM] = {
+	[SN_PDU_TYPE]	= TF(struct tetra_sndcp_data, pdu_type, 4),
+	[SN_NSAPI]	= TF(struct tetra_sndcp_data, nsapi, 4),
+	[SN_PCOMP]	= TF(struct tetra_sndcp_data, pcomp, 4),
+	[SN_DCOMP]	= TF(struct tetra_sndcp_data, dcomp, 4),
+};
+
+int tetra_sndcp_parse_data(struct tetra_sndcp_data *sd, const uint8_t *bits,
+			   unsigned int len)
+{
+	unsigned int hdr_len;
+
+	if (len < 4)
+		return -EINVAL;
+
+	switch (bits_to_uint(bits, 4)) {
+	case SNDCP_PDU_T_UNITDATA:
+	case SNDCP_PDU_T_DATA:
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	hdr_len = tetra_field_decode(sndcp_data_fields, _SN_NUM, bits, sd, NULL);
+	if (len < hdr_len)
+		return -EINVAL;
+	sd->npdu = bits + hdr_len;
+	sd->npdu_len = len - hdr_len;
+
+	return 0;
+}
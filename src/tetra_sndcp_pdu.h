@@ -24,6 +24,21 @@ enum sndcp_pdu_type {
 #define SNDCP_PDU_T_ACT_PDP_DEMAND	SNDCP_PDU_T_ACT_PDP_ACCEPT
 #define	SNDCP_PDU_T_PAGE_RESPONSE	SNDCP_PDU_T_PAGE_REQUEST
 
-#endif /* TETRA_SNDCP_PDU_H */
-
 const char *tetra_get_sndcp_pdut_name(uint8_t pdut, int uplink);
+
+/* SN-DATA / SN-UNITDATA, 28.115 */
+struct tetra_sndcp_data {
+	uint8_t pdu_type;
+	uint8_t nsapi;
+	uint8_t pcomp;
+	uint8_t dcomp;
+	const uint8_t *npdu;	/* unpacked bits */
+	unsigned int npdu_len;	/* in bits */
+};
+
+/* parse the SNDCP PDU in the unpacked bits 'bits' (after the MLE protocol
+ * discriminator), returns -EINVAL if it does not carry a N-PDU */
+int tetra_sndcp_parse_data(struct tetra_sndcp_data *sd, const uint8_t *bits,
+			   unsigned int len);
+
+#endif /* TETRA_SNDCP_PDU_H */
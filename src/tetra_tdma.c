@@ -24,76 +24,57 @@
 
 #include "tetra_tdma.h"
 
-static void normalize_mn(struct tetra_tdma_time *tm)
+void tetra_tdma_slot2time(uint64_t slot, struct tetra_tdma_time *tm)
 {
-	if (tm->mn > 60)
-		tm->mn = (tm->mn%60);
+	tm->hn = tetra_tdma_hn(slot);
+	tm->mn = tetra_tdma_mn(slot);
+	tm->fn = tetra_tdma_fn(slot);
+	tm->tn = tetra_tdma_tn(slot);
 }
 
-static void normalize_fn(struct tetra_tdma_time *tm)
+static uint32_t clamp(uint32_t v, uint32_t max)
 {
-	uint32_t mn_delta;
-
-	if (tm->fn > 18) {
-		mn_delta = tm->fn/60;
-		tm->fn = (tm->fn%18);
-		tm->mn += mn_delta;
-	}
-	normalize_mn(tm);
-}
-
-static void normalize_tn(struct tetra_tdma_time *tm)
-{
-	uint32_t fn_delta;
-
-	if (tm->tn > 4) {
-		fn_delta = tm->tn/4;
-		tm->tn = (tm->tn%4);
-		tm->fn += fn_delta;
-	}
-	normalize_fn(tm);
+	if (v < 1)
+		return 1;
+	if (v > max)
+		return max;
+	return v;
 }
 
-static void normalize_sn(struct tetra_tdma_time *tm)
+uint64_t tetra_tdma_time2slot(const struct tetra_tdma_time *tm)
 {
-	uint32_t tn_delta;
-
-	if (tm->sn > 255) {
-		tn_delta = (tm->sn/255);
-		tm->sn = (tm->sn % 255) + 1;
-		tm->tn += tn_delta;
-	}
-	normalize_tn(tm);
+	return (uint64_t) tm->hn * TETRA_SLOTS_PER_HN +
+		(clamp(tm->mn, TETRA_MN_PER_HN) - 1) * TETRA_SLOTS_PER_MN +
+		(clamp(tm->fn, TETRA_FN_PER_MN) - 1) * TETRA_TN_PER_FN +
+		(clamp(tm->tn, TETRA_TN_PER_FN) - 1);
 }
 
-void tetra_tdma_time_add_sym(struct tetra_tdma_time *tm, uint32_t sym_count)
+uint64_t tetra_tdma_slot_set_hn(uint64_t slot, uint16_t hn)
 {
-	tm->sn += sym_count;
-	normalize_sn(tm);
+	return (uint64_t) hn * TETRA_SLOTS_PER_HN + slot % TETRA_SLOTS_PER_HN;
 }
 
-void tetra_tdma_time_add_tn(struct tetra_tdma_time *tm, uint32_t tn_count)
+char *tetra_tdma_slot_dump(uint64_t slot, char *buf)
 {
-	tm->tn += tn_count;
-	normalize_tn(tm);
-}
+	snprintf(buf, TETRA_TDMA_DUMP_LEN, "%02u/%02u/%u", tetra_tdma_mn(slot),
+		 tetra_tdma_fn(slot), tetra_tdma_tn(slot));
 
-void tetra_tdma_time_add_fn(struct tetra_tdma_time *tm, uint32_t fn_count)
-{
-	tm->fn += fn_count;
-	normalize_fn(tm);
+	return buf;
 }
 
-char *tetra_tdma_time_dump(const struct tetra_tdma_time *tm)
+uint64_t tetra_tdma_slot2ns(const struct tetra_tdma_clock *clk, uint64_t slot)
 {
-	static char buf[256];
+	int64_t d = slot - clk->slot;
 
-	snprintf(buf, sizeof(buf), "%02u/%02u/%u/%03u", tm->mn, tm->fn, tm->tn, tm->sn);
-
-	return buf;
+	return clk->ns + d * (int64_t) TETRA_SLOT_NS_NUM / TETRA_SLOT_NS_DEN;
 }
 
-uint32_t tetra_tdma_time2fn(struct tetra_tdma_time *tm)
+uint64_t tetra_tdma_ns2slot(const struct tetra_tdma_clock *clk, uint64_t ns)
 {
-	return (((tm->hn * 60) + tm->mn) * 18) + tm->fn;
+	int64_t d = (int64_t) (ns - clk->ns) * TETRA_SLOT_NS_DEN;
+
+	/* round towards the slot which started before 'ns' */
+	if (d < 0)
+		d -= TETRA_SLOT_NS_NUM - 1;
+	return clk->slot + d / (int64_t) TETRA_SLOT_NS_NUM;
 }
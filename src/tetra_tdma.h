@@ -3,19 +3,100 @@
 
 #include <stdint.h>
 
+/* The TDMA time is carried around as an absolute slot counter: the number
+ * of timeslots since TN 1 of FN 1 of MN 1 of hyperframe 0.  It advances by
+ * one per burst and is only reset by SYNC and SYSINFO.  TN, FN, MN and HN
+ * are derived from it whenever they are needed. */
+
+#define TETRA_TN_PER_FN		4
+#define TETRA_FN_PER_MN		18
+#define TETRA_MN_PER_HN		60
+#define TETRA_SLOTS_PER_MN	(TETRA_TN_PER_FN * TETRA_FN_PER_MN)
+#define TETRA_SLOTS_PER_HN	(TETRA_SLOTS_PER_MN * TETRA_MN_PER_HN)
+
+/* one timeslot is 255 symbols at 18 kSym/s, i.e. 85/6 ms */
+#define TETRA_SLOT_NS_NUM	85000000ULL
+#define TETRA_SLOT_NS_DEN	6
+/* two bits per symbol */
+#define TETRA_BIT_RATE		36000
+
+/* the TDMA time split up into its fields */
 struct tetra_tdma_time {
-	uint16_t hn;    /* hyperframe number (1 ... 65535) */
-	uint32_t sn;	/* symbol number (1 ... 255) */
+	uint16_t hn;    /* hyperframe number (0 ... 65535) */
 	uint32_t tn;	/* timeslot number (1 .. 4) */
 	uint32_t fn;	/* frame number (1 .. 18) */
 	uint32_t mn;	/* multiframe number (1 .. 60) */
 };
 
-void tetra_tdma_time_add_sym(struct tetra_tdma_time *tm, uint32_t sym_count);
-void tetra_tdma_time_add_tn(struct tetra_tdma_time *tm, uint32_t tn_count);
-void tetra_tdma_time_add_fn(struct tetra_tdma_time *tm, uint32_t fn_count);
-char *tetra_tdma_time_dump(const struct tetra_tdma_time *tm);
+static inline uint32_t tetra_tdma_tn(uint64_t slot)
+{
+	return slot % TETRA_TN_PER_FN + 1;
+}
+
+static inline uint32_t tetra_tdma_fn(uint64_t slot)
+{
+	return (slot / TETRA_TN_PER_FN) % TETRA_FN_PER_MN + 1;
+}
+
+static inline uint32_t tetra_tdma_mn(uint64_t slot)
+{
+	return (slot / TETRA_SLOTS_PER_MN) % TETRA_MN_PER_HN + 1;
+}
+
+static inline uint16_t tetra_tdma_hn(uint64_t slot)
+{
+	return slot / TETRA_SLOTS_PER_HN;
+}
+
+void tetra_tdma_slot2time(uint64_t slot, struct tetra_tdma_time *tm);
+
+/* fields out of range are clamped */
+uint64_t tetra_tdma_time2slot(const struct tetra_tdma_time *tm);
+
+/* the same TN/FN/MN in hyperframe 'hn' */
+uint64_t tetra_tdma_slot_set_hn(uint64_t slot, uint16_t hn);
+
+/* GSMTAP frame numbers count TDMA frames since hyperframe 0 */
+static inline uint32_t tetra_tdma_slot2gsmtap_fn(uint64_t slot)
+{
+	return slot / TETRA_TN_PER_FN;
+}
+
+static inline uint64_t tetra_tdma_gsmtap_fn2slot(uint32_t fn, uint8_t tn)
+{
+	return (uint64_t) fn * TETRA_TN_PER_FN + (tn ? tn - 1 : 0) % TETRA_TN_PER_FN;
+}
+
+/* "MN/FN/TN" into the buffer 'buf' of at least TETRA_TDMA_DUMP_LEN bytes */
+#define TETRA_TDMA_DUMP_LEN	32
+char *tetra_tdma_slot_dump(uint64_t slot, char *buf);
+
+/* Maps slots to wall clock time (ns since the epoch), anchored at the
+ * start of one slot received at a known time */
+struct tetra_tdma_clock {
+	int valid;
+	uint64_t slot;
+	uint64_t ns;
+};
+
+static inline void tetra_tdma_clock_set(struct tetra_tdma_clock *clk, uint64_t slot,
+					uint64_t ns)
+{
+	clk->slot = slot;
+	clk->ns = ns;
+	clk->valid = 1;
+}
+
+uint64_t tetra_tdma_slot2ns(const struct tetra_tdma_clock *clk, uint64_t slot);
+
+/* the slot running at time 'ns' */
+uint64_t tetra_tdma_ns2slot(const struct tetra_tdma_clock *clk, uint64_t ns);
 
-uint32_t tetra_tdma_time2fn(struct tetra_tdma_time *tm);
+/* time of input sample 'n' at 'rate' samples per second, the first sample
+ * being taken at 'ns0' */
+static inline uint64_t tetra_tdma_sample2ns(uint64_t ns0, uint64_t n, uint32_t rate)
+{
+	return ns0 + n / rate * 1000000000ULL + n % rate * 1000000000ULL / rate;
+}
 
 #endif
@@ -37,8 +37,28 @@
 #include "tetra_sndcp_pdu.h"
 #include "tetra_mle_pdu.h"
 #include "tetra_gsmtap.h"
+#include "tetra_egress.h"
+#include "tetra_event.h"
+#include "tetra_filter.h"
+#include "tetra_shm.h"
 
-static int rx_tm_sdu(struct tetra_mac_state *tms, struct msgb *msg, unsigned int len);
+static int rx_tm_sdu(struct tetra_mac_state *tms, struct msgb *msg, unsigned int len,
+		     uint32_t addr);
+
+/* emit a PDU event for the 'num_bits' bits at 'bits' */
+static void ev_pdu(uint8_t proto, uint8_t pdu_type, uint32_t addr, uint32_t aux,
+		   const uint8_t *bits, unsigned int num_bits)
+{
+	struct tetra_ev_pdu ev = {
+		.proto		= proto,
+		.pdu_type	= pdu_type,
+		.num_bits	= num_bits,
+		.addr		= addr,
+		.aux		= aux,
+	};
+
+	tetra_event_put(TETRA_EV_PDU, &ev, sizeof(ev), bits, num_bits);
+}
 
 static void rx_bcast(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms)
 {
@@ -49,7 +69,14 @@ static void rx_bcast(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms
 
 	memset(&sid, 0, sizeof(sid));
 	macpdu_decode_sysinfo(&sid, msg->l1h);
-	tmvp->u.unitdata.tdma_time.hn = sid.hyperframe_number;
+	/* the hyperframe number is only known from the SYSINFO, and not
+	 * from all of them: it shares its field with the CCK ID */
+	if (!sid.cck_valid_no_hf) {
+		tmvp->u.unitdata.tdma_slot = tetra_tdma_slot_set_hn(tmvp->u.unitdata.tdma_slot,
+								     sid.hyperframe_number);
+		t_phy_state.slot = tetra_tdma_slot_set_hn(t_phy_state.slot,
+							  sid.hyperframe_number);
+	}
 
 	dl_freq = tetra_dl_carrier_hz(sid.freq_band,
 				      sid.main_carrier,
@@ -61,17 +88,29 @@ static void rx_bcast(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms
 				      sid.duplex_spacing,
 				      sid.reverse_operation);
 
-	printf("BNCH SYSINFO (DL %u Hz, UL %u Hz), service_details 0x%04x ",
+	TPRINTF(TETRA_V_PDU, "BNCH SYSINFO (DL %u Hz, UL %u Hz), service_details 0x%04x ",
 		dl_freq, ul_freq, sid.mle_si.bs_service_details);
 	if (sid.cck_valid_no_hf)
-		printf("CCK ID %u", sid.cck_id);
+		TPRINTF(TETRA_V_PDU, "CCK ID %u", sid.cck_id);
 	else
-		printf("Hyperframe %u", sid.hyperframe_number);
-	printf("\n");
+		TPRINTF(TETRA_V_PDU, "Hyperframe %u", sid.hyperframe_number);
+	TPRINTF(TETRA_V_PDU, "\n");
 	for (i = 0; i < 12; i++)
-		printf("\t%s: %u\n", tetra_get_bs_serv_det_name(1 << i),
+		TPRINTF(TETRA_V_DUMP, "\t%s: %u\n", tetra_get_bs_serv_det_name(1 << i),
 			sid.mle_si.bs_service_details & (1 << i) ? 1 : 0);
 
+	if (tetra_event_active) {
+		struct tetra_ev_sysinfo ev = {
+			.dl_freq	= dl_freq,
+			.ul_freq	= ul_freq,
+			.service_details = sid.mle_si.bs_service_details,
+			.hf_or_cck	= sid.hyperframe_number,
+			.cck_valid	= sid.cck_valid_no_hf ? 1 : 0,
+		};
+
+		tetra_event_put(TETRA_EV_SYSINFO, &ev, sizeof(ev), NULL, 0);
+	}
+
 	memcpy(&tms->last_sid, &sid, sizeof(sid));
 }
 
@@ -98,91 +137,223 @@ const char *tetra_alloc_dump(const struct tetra_chan_alloc_decoded *cad, struct
 }
 
 /* Receive TL-SDU (LLC SDU == MLE PDU) */
-static int rx_tl_sdu(struct tetra_mac_state *tms, struct msgb *msg, unsigned int len)
+static int rx_tl_sdu(struct tetra_mac_state *tms, struct msgb *msg, unsigned int len,
+		     uint32_t addr)
 {
 	uint8_t *bits = msg->l3h;
 	uint8_t mle_pdisc = bits_to_uint(bits, 3);
+	uint32_t pdu_type = 0;
 
-	printf("TL-SDU(%s): %s", tetra_get_mle_pdisc_name(mle_pdisc),
-		osmo_ubit_dump(bits, len));
+	if (tms->filter && !tms->cur_burst.sdu_passed &&
+	    !tetra_filter_sdu(tms->filter, bits, len)) {
+		tms->cur_burst.filtered = 1;
+		return len;
+	}
+
+	TPRINTF(TETRA_V_PDU, "TL-SDU(%s): ", tetra_get_mle_pdisc_name(mle_pdisc));
+	TPRINTF(TETRA_V_DUMP, "%s", osmo_ubit_dump(bits, len));
 	switch (mle_pdisc) {
 	case TMLE_PDISC_MM:
-		printf(" %s", tetra_get_mm_pdut_name(bits_to_uint(bits+3, 4), 0));
+		pdu_type = bits_to_uint(bits+3, 4);
+		TPRINTF(TETRA_V_PDU, " %s", tetra_get_mm_pdut_name(pdu_type, 0));
 		break;
 	case TMLE_PDISC_CMCE:
-		printf(" %s", tetra_get_cmce_pdut_name(bits_to_uint(bits+3, 5), 0));
+		pdu_type = bits_to_uint(bits+3, 5);
+		TPRINTF(TETRA_V_PDU, " %s", tetra_get_cmce_pdut_name(pdu_type, 0));
 		break;
 	case TMLE_PDISC_SNDCP:
-		printf(" %s", tetra_get_sndcp_pdut_name(bits_to_uint(bits+3, 4), 0));
-		printf(" NSAPI=%u PCOMP=%u, DCOMP=%u",
+		pdu_type = bits_to_uint(bits+3, 4);
+		TPRINTF(TETRA_V_PDU, " %s", tetra_get_sndcp_pdut_name(pdu_type, 0));
+		TPRINTF(TETRA_V_PDU, " NSAPI=%u PCOMP=%u, DCOMP=%u",
 			bits_to_uint(bits+3+4, 4),
 			bits_to_uint(bits+3+4+4, 4),
 			bits_to_uint(bits+3+4+4+4, 4));
-		printf(" V%u, IHL=%u",
+		TPRINTF(TETRA_V_PDU, " V%u, IHL=%u",
 			bits_to_uint(bits+3+4+4+4+4, 4),
 			4*bits_to_uint(bits+3+4+4+4+4+4, 4));
-		printf(" Proto=%u",
+		TPRINTF(TETRA_V_PDU, " Proto=%u",
 			bits_to_uint(bits+3+4+4+4+4+4+4+64, 8));
+		if (tms->egress && len > 3) {
+			struct tetra_sndcp_data sd;
+
+			/* we can only pass on uncompressed packets */
+			if (!tetra_sndcp_parse_data(&sd, bits+3, len-3) &&
+			    !sd.pcomp && !sd.dcomp)
+				tetra_egress_put(tms->egress, sd.nsapi,
+						 sd.npdu, sd.npdu_len);
+		}
 		break;
 	case TMLE_PDISC_MLE:
-		printf(" %s", tetra_get_mle_pdut_name(bits_to_uint(bits+3, 3), 0));
+		pdu_type = bits_to_uint(bits+3, 3);
+		TPRINTF(TETRA_V_PDU, " %s", tetra_get_mle_pdut_name(pdu_type, 0));
 		break;
 	default:
 		break;
 	}
+
+	if (tetra_event_active)
+		ev_pdu(TETRA_EV_P_TL_SDU, mle_pdisc, addr, pdu_type, bits, len);
+
 	return len;
 }
 
-static int rx_tm_sdu(struct tetra_mac_state *tms, struct msgb *msg, unsigned int len)
+/* key for the LLC defragmenter, which has to keep the PDUs of different
+ * MSs apart */
+static uint32_t addr_key(const struct tetra_addr *addr)
+{
+	switch (addr->type) {
+	case ADDR_TYPE_EVENT_LABEL:
+		return (1 << 24) | addr->event_label;
+	default:
+		return addr->ssi;
+	}
+}
+
+static int rx_tm_sdu(struct tetra_mac_state *tms, struct msgb *msg, unsigned int len,
+		     uint32_t addr)
 {
 	struct tetra_llc_pdu lpp;
 	uint8_t *bits = msg->l2h;
+	struct msgb *sdu;
 
 	memset(&lpp, 0, sizeof(lpp));
 	tetra_llc_pdu_parse(&lpp, bits, len);
 
-	printf("TM-SDU(%s,%u,%u): ",
+	TPRINTF(TETRA_V_PDU, "TM-SDU(%s,%u,%u): ",
 		tetra_get_llc_pdut_dec_name(lpp.pdu_type), lpp.ns, lpp.ss);
-	if (lpp.tl_sdu && lpp.ss == 0) {
-		msg->l3h = lpp.tl_sdu;
-		rx_tl_sdu(tms, msg, lpp.tl_sdu_len);
+	if (tetra_event_active)
+		ev_pdu(TETRA_EV_P_LLC, lpp.pdu_type, addr, (lpp.ns << 8) | lpp.ss,
+		       bits, len);
+
+	switch (lpp.pdu_type) {
+	case TLLC_PDUT_DEC_AL_DATA:
+	case TLLC_PDUT_DEC_AL_UDATA:
+	case TLLC_PDUT_DEC_ALX_DATA:
+	case TLLC_PDUT_DEC_ALX_UDATA:
+		tllc_defrag_in(&tms->llcs, addr, &lpp, tms->cur_burst.ts);
+		break;
+	case TLLC_PDUT_DEC_AL_FINAL:
+	case TLLC_PDUT_DEC_AL_UFINAL:
+	case TLLC_PDUT_DEC_ALX_FINAL:
+	case TLLC_PDUT_DEC_ALX_UFINAL:
+		if (tllc_defrag_in(&tms->llcs, addr, &lpp, tms->cur_burst.ts) < 0)
+			break;
+		sdu = tllc_defrag_out(&tms->llcs, addr, &lpp);
+		if (sdu) {
+			rx_tl_sdu(tms, sdu, msgb_l3len(sdu), addr);
+			msgb_free(sdu);
+		}
+		break;
+	default:
+		if (lpp.have_fcs && !lpp.fcs_valid) {
+			TPRINTF(TETRA_V_PDU, "FCS BAD ");
+			tms->llcs.rx.stats.fcs_err++;
+			if (tetra_event_active)
+				tetra_event_defrag(TETRA_EV_DF_FCS_BAD, addr, lpp.ns, lpp.ss);
+			break;
+		}
+		if (lpp.tl_sdu) {
+			msg->l3h = lpp.tl_sdu;
+			rx_tl_sdu(tms, msg, lpp.tl_sdu_len, addr);
+		}
+		break;
 	}
 	return len;
 }
 
+/* The TL-SDU of a fragmented MAC PDU starts in its first fragment: the SDU
+ * filter decides there, before any of the fragments is sent to GSMTAP */
+static int frag_filter_sdu(struct tetra_mac_state *tms, struct msgb *msg)
+{
+	struct tetra_llc_pdu lpp;
+
+	memset(&lpp, 0, sizeof(lpp));
+	tetra_llc_pdu_parse(&lpp, msg->l2h, msgb_l1len(msg) - (msg->l2h - msg->l1h));
+
+	switch (lpp.pdu_type) {
+	case TLLC_PDUT_DEC_BL_ADATA:
+	case TLLC_PDUT_DEC_BL_DATA:
+	case TLLC_PDUT_DEC_BL_UDATA:
+		break;
+	case TLLC_PDUT_DEC_AL_DATA:
+	case TLLC_PDUT_DEC_AL_FINAL:
+	case TLLC_PDUT_DEC_AL_UDATA:
+	case TLLC_PDUT_DEC_AL_UFINAL:
+		if (lpp.ss == 0)
+			break;
+		/* fall through */
+	default:
+		/* no start of a TL-SDU here, only the address counts */
+		return 1;
+	}
+
+	return tetra_filter_sdu(tms->filter, lpp.tl_sdu, lpp.tl_sdu_len);
+}
+
 static void rx_resrc(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms)
 {
 	struct msgb *msg = tmvp->oph.msg;
 	struct tetra_resrc_decoded rsd;
+	unsigned int tn = tetra_tdma_tn(tmvp->u.unitdata.tdma_slot) - 1;
 	int tmpdu_offset;
 
 	memset(&rsd, 0, sizeof(rsd));
 	tmpdu_offset = macpdu_decode_resource(&rsd, msg->l1h);
 	msg->l2h = msg->l1h + tmpdu_offset;
 
-	printf("RESOURCE Encr=%u, Length=%d Addr=%s ",
+	/* a new MAC PDU ends any fragmented one on this timeslot */
+	tms->frag_pass[tn] = 0;
+
+	/* Null PDUs carry nothing, all others only if we are interested */
+	if (tms->filter && rsd.addr.type != ADDR_TYPE_NULL &&
+	    !tetra_filter_addr(tms->filter, &rsd.addr)) {
+		tms->cur_burst.filtered = 1;
+		return;
+	}
+	if (rsd.macpdu_length == MACPDU_LEN_START_FRAG && rsd.addr.type != ADDR_TYPE_NULL) {
+		if (tms->filter && rsd.encryption_mode == 0 && !frag_filter_sdu(tms, msg)) {
+			tms->cur_burst.filtered = 1;
+			return;
+		}
+		tms->frag_pass[tn] = 1;
+	}
+
+	TPRINTF(TETRA_V_PDU, "RESOURCE Encr=%u, Length=%d Addr=%s ",
 		rsd.encryption_mode, rsd.macpdu_length,
 		tetra_addr_dump(&rsd.addr));
+	if (tetra_event_active)
+		ev_pdu(TETRA_EV_P_MAC_RESOURCE, rsd.encryption_mode,
+		       addr_key(&rsd.addr), rsd.macpdu_length, NULL, 0);
 
 	if (rsd.addr.type == ADDR_TYPE_NULL)
 		goto out;
 
 	if (rsd.chan_alloc_pres)
-		printf("ChanAlloc=%s ", tetra_alloc_dump(&rsd.cad, tms));
+		TPRINTF(TETRA_V_PDU, "ChanAlloc=%s ", tetra_alloc_dump(&rsd.cad, tms));
 
 	if (rsd.slot_granting.pres)
-		printf("SlotGrant=%u/%u ", rsd.slot_granting.nr_slots,
+		TPRINTF(TETRA_V_PDU, "SlotGrant=%u/%u ", rsd.slot_granting.nr_slots,
 			rsd.slot_granting.delay);
 
 	if (rsd.macpdu_length > 0 && rsd.encryption_mode == 0) {
+		/* the length includes the MAC header and the fill bits */
 		int len_bits = rsd.macpdu_length*8;
-		if (msg->l2h + len_bits > msg->l1h + msgb_l1len(msg))
-			len_bits = msgb_l1len(msg) - tmpdu_offset;
-		rx_tm_sdu(tms, msg, len_bits);
+		if (len_bits > msgb_l1len(msg))
+			len_bits = msgb_l1len(msg);
+		len_bits -= tmpdu_offset;
+		/* fill bits are a 1 followed by 0s */
+		if (rsd.fill_bits) {
+			while (len_bits > 0 && !msg->l2h[len_bits-1])
+				len_bits--;
+			if (len_bits > 0)
+				len_bits--;
+		}
+		if (len_bits > 0)
+			rx_tm_sdu(tms, msg, len_bits, addr_key(&rsd.addr));
 	}
 
 out:
-	printf("\n");
+	TPRINTF(TETRA_V_PDU, "\n");
 }
 
 static void rx_suppl(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms)
@@ -205,18 +376,20 @@ static void rx_suppl(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms
 	}
 #endif
 
-	printf("SUPPLEMENTARY MAC-D-BLOCK ");
+	TPRINTF(TETRA_V_PDU, "SUPPLEMENTARY MAC-D-BLOCK ");
+	if (tetra_event_active)
+		ev_pdu(TETRA_EV_P_MAC_SUPPL, 0, 0, 0, NULL, 0);
 
 	//if (sud.encryption_mode == 0)
 		msg->l2h = msg->l1h + tmpdu_offset;
-		rx_tm_sdu(tms, msg, 100);
+		rx_tm_sdu(tms, msg, 100, 0);
 
-	printf("\n");
+	TPRINTF(TETRA_V_PDU, "\n");
 }
 
 static void dump_access(struct tetra_access_field *acc, unsigned int num)
 {
-	printf("ACCESS%u: %c/%u ", num, 'A'+acc->access_code, acc->base_frame_len);
+	TPRINTF(TETRA_V_BLOCK, "ACCESS%u: %c/%u ", num, 'A'+acc->access_code, acc->base_frame_len);
 }
 
 static void rx_aach(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms)
@@ -224,20 +397,20 @@ static void rx_aach(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms)
 	struct tmv_unitdata_param *tup = &tmvp->u.unitdata;
 	struct tetra_acc_ass_decoded aad;
 
-	printf("ACCESS-ASSIGN PDU: ");
+	TPRINTF(TETRA_V_BLOCK, "ACCESS-ASSIGN PDU: ");
 
 	memset(&aad, 0, sizeof(aad));
 	macpdu_decode_access_assign(&aad, tmvp->oph.msg->l1h,
-				    tup->tdma_time.fn == 18 ? 1 : 0);
+				    tetra_tdma_fn(tup->tdma_slot) == 18 ? 1 : 0);
 
 	if (aad.pres & TETRA_ACC_ASS_PRES_ACCESS1)
 		dump_access(&aad.access[0], 1);
 	if (aad.pres & TETRA_ACC_ASS_PRES_ACCESS2)
 		dump_access(&aad.access[1], 2);
 	if (aad.pres & TETRA_ACC_ASS_PRES_DL_USAGE)
-		printf("DL_USAGE: %s ", tetra_get_dl_usage_name(aad.dl_usage));
+		TPRINTF(TETRA_V_BLOCK, "DL_USAGE: %s ", tetra_get_dl_usage_name(aad.dl_usage));
 	if (aad.pres & TETRA_ACC_ASS_PRES_UL_USAGE)
-		printf("UL_USAGE: %s ", tetra_get_ul_usage_name(aad.ul_usage));
+		TPRINTF(TETRA_V_BLOCK, "UL_USAGE: %s ", tetra_get_ul_usage_name(aad.ul_usage));
 
 	/* save the state whether the current burst is traffic or not */
 	if (aad.dl_usage > 3)
@@ -245,7 +418,22 @@ static void rx_aach(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms)
 	else
 		tms->cur_burst.is_traffic = 0;
 
-	printf("\n");
+	TPRINTF(TETRA_V_BLOCK, "\n");
+}
+
+/* A MAC-FRAG, MAC-END or SUPPL block carries no address, it continues the
+ * fragmented MAC PDU on its timeslot.  With a filter it is only decoded if
+ * that PDU passed, and then the filter has seen the start of its TL-SDU. */
+static int frag_cont(struct tetra_mac_state *tms, uint64_t slot)
+{
+	if (!tms->filter)
+		return 1;
+	if (!tms->frag_pass[tetra_tdma_tn(slot) - 1]) {
+		tms->cur_burst.filtered = 1;
+		return 0;
+	}
+	tms->cur_burst.sdu_passed = 1;
+	return 1;
 }
 
 static int rx_tmv_unitdata_ind(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_state *tms)
@@ -254,7 +442,7 @@ static int rx_tmv_unitdata_ind(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_
 	struct msgb *msg = tmvp->oph.msg;
 	uint8_t pdu_type = bits_to_uint(msg->l1h, 2);
 	const char *pdu_name;
-	struct msgb *gsmtap_msg;
+	char time_str[TETRA_TDMA_DUMP_LEN];
 
 	if (tup->lchan == TETRA_LC_BSCH)
 		pdu_name = "SYNC";
@@ -265,21 +453,20 @@ static int rx_tmv_unitdata_ind(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_
 		pdu_name = tetra_get_macpdu_name(pdu_type);
 	}
 
-	printf("TMV-UNITDATA.ind %s %s CRC=%u %s\n",
-		tetra_tdma_time_dump(&tup->tdma_time),
+	TPRINTF(TETRA_V_BLOCK, "TMV-UNITDATA.ind %s %s CRC=%u %s\n",
+		tetra_tdma_slot_dump(tup->tdma_slot, time_str),
 		tetra_get_lchan_name(tup->lchan),
 		tup->crc_ok, pdu_name);
 
+	tms->cur_burst.ts = tup->tdma_slot;
+	tms->cur_burst.filtered = 0;
+	tms->cur_burst.sdu_passed = 0;
+	tetra_event_set_time(tup->tdma_slot);
+	tllc_defrag_expire(&tms->llcs, tms->cur_burst.ts);
+
 	if (!tup->crc_ok)
 		return 0;
 
-	gsmtap_msg = tetra_gsmtap_makemsg(&tup->tdma_time, tup->lchan,
-					  tup->tdma_time.tn,
-					  /* FIXME: */ 0, 0, 0,
-					msg->l1h, msgb_l1len(msg));
-	if (gsmtap_msg)
-		tetra_gsmtap_sendmsg(gsmtap_msg);
-
 	switch (tup->lchan) {
 	case TETRA_LC_AACH:
 		rx_aach(tmvp, tms);
@@ -295,29 +482,45 @@ static int rx_tmv_unitdata_ind(struct tetra_tmvsap_prim *tmvp, struct tetra_mac_
 			rx_resrc(tmvp, tms);
 			break;
 		case TETRA_PDU_T_MAC_SUPPL:
+			if (!frag_cont(tms, tup->tdma_slot))
+				break;
 			rx_suppl(tmvp, tms);
 			break;
 		case TETRA_PDU_T_MAC_FRAG_END:
+			if (!frag_cont(tms, tup->tdma_slot))
+				break;
 			if (msg->l1h[3] == TETRA_MAC_FRAGE_FRAG) {
-				printf("FRAG/END FRAG: ");
+				TPRINTF(TETRA_V_PDU, "FRAG/END FRAG: ");
+				if (tetra_event_active)
+					ev_pdu(TETRA_EV_P_MAC_FRAG, 0, 0, 0, NULL, 0);
 				msg->l2h = msg->l1h+4;
-				rx_tm_sdu(tms, msg, 100 /*FIXME*/);
-				printf("\n");
-			} else
-				printf("FRAG/END END\n");
+				rx_tm_sdu(tms, msg, 100 /*FIXME*/, 0);
+				TPRINTF(TETRA_V_PDU, "\n");
+			} else {
+				TPRINTF(TETRA_V_PDU, "FRAG/END END\n");
+				if (tetra_event_active)
+					ev_pdu(TETRA_EV_P_MAC_FRAG, 0, 0, 1, NULL, 0);
+				tms->frag_pass[tetra_tdma_tn(tup->tdma_slot) - 1] = 0;
+			}
 			break;
 		default:
-			printf("STRANGE pdu=%u\n", pdu_type);
+			TPRINTF(TETRA_V_PDU, "STRANGE pdu=%u\n", pdu_type);
 			break;
 		}
 		break;
 	case TETRA_LC_BSCH:
 		break;
 	default:
-		printf("STRANGE lchan=%u\n", tup->lchan);
+		TPRINTF(TETRA_V_PDU, "STRANGE lchan=%u\n", tup->lchan);
 		break;
 	}
 
+	/* only now we know whether the filter wants this block */
+	if (!tms->cur_burst.filtered)
+		tetra_gsmtap_enqueue(tup->tdma_slot, tup->lchan, tetra_tdma_tn(tup->tdma_slot),
+				     /* FIXME: */ 0, 0, 0,
+				     msg->l1h, msgb_l1len(msg));
+
 	return 0;
 }
 
@@ -331,9 +534,19 @@ int upper_mac_prim_recv(struct osmo_prim_hdr *op, void *priv)
 	case TETRA_SAP_TMV:
 		tmvp = (struct tetra_tmvsap_prim *) op;
 		rc = rx_tmv_unitdata_ind(tmvp, tms);
+		if (tms->shm) {
+			struct tmv_unitdata_param *tup = &tmvp->u.unitdata;
+
+			tetra_shm_publish(tms->shm, tms->cur_burst.ts,
+					  tetra_tdma_tn(tup->tdma_slot),
+					  tetra_tdma_fn(tup->tdma_slot),
+					  tetra_tdma_mn(tup->tdma_slot), tup->lchan, tup->crc_ok,
+					  tup->scrambling_code, op->msg->l1h,
+					  msgb_l1len(op->msg));
+		}
 		break;
 	default:
-		printf("primitive on unknown sap\n");
+		TPRINTF(TETRA_V_PDU, "primitive on unknown sap\n");
 		break;
 	}
 
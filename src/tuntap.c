@@ -1,8 +1,11 @@
+#include "tuntap.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
 
 #include <sys/socket.h>
 #include <sys/ioctl.h>
@@ -40,3 +43,37 @@ int tun_alloc(char *dev)
 #endif
       return fd;
   }              
+
+/* open 'num' queues of the multi-queue tun device 'dev' into 'fds',
+ * returns the number of queues opened or a negative error */
+int tun_alloc_mq(const char *dev, unsigned int num, int *fds)
+{
+	struct ifreq ifr;
+	unsigned int i;
+	int rc;
+
+	memset(&ifr, 0, sizeof(ifr));
+	ifr.ifr_flags = IFF_TUN|IFF_NO_PI;
+	if (num > 1)
+		ifr.ifr_flags |= IFF_MULTI_QUEUE;
+	strncpy(ifr.ifr_name, dev, IFNAMSIZ-1);
+
+	for (i = 0; i < num; i++) {
+		fds[i] = open("/dev/net/tun", O_RDWR);
+		if (fds[i] < 0) {
+			rc = -errno;
+			goto err;
+		}
+		if (ioctl(fds[i], TUNSETIFF, (void *) &ifr) < 0) {
+			rc = -errno;
+			close(fds[i]);
+			goto err;
+		}
+	}
+	return num;
+
+err:
+	while (i--)
+		close(fds[i]);
+	return rc;
+}
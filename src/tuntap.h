@@ -0,0 +1,7 @@
+#ifndef TUNTAP_H
+#define TUNTAP_H
+
+int tun_alloc(char *dev);
+int tun_alloc_mq(const char *dev, unsigned int num, int *fds);
+
+#endif